@@ -23,6 +23,14 @@
 static const char kHeaderTerminator[] = "\r\n\r\n";
 static const int kHeaderTerminatorLength = sizeof(kHeaderTerminator) - 1;
 
+// The backlog of pending connections, so that thousands of clients can
+// connect at once.
+#if defined(SOMAXCONN)
+static const int kListenBacklog = SOMAXCONN;
+#else
+static const int kListenBacklog = 128;
+#endif
+
 // static
 const char DataSocket::kCrossOriginAllowHeaders[] =
     "Access-Control-Allow-Origin: *\r\n"
@@ -83,6 +91,11 @@ bool DataSocket::PathEquals(const char* path) const {
   return request_path_.compare(path) == 0;
 }
 
+bool DataSocket::IdleFor(time_t timeout) const {
+  bool request_pending = headers_received() && !response_sent_;
+  return !request_pending && (time(NULL) - last_activity_) > timeout;
+}
+
 bool DataSocket::OnDataAvailable(bool* close_socket) {
   assert(valid());
   char buffer[0xfff] = {0};
@@ -93,6 +106,12 @@ bool DataSocket::OnDataAvailable(bool* close_socket) {
   }
 
   *close_socket = false;
+  last_activity_ = time(NULL);
+
+  // A kept-alive connection starts the next request once the previous one
+  // has been answered.
+  if (keep_alive_ && response_sent_)
+    Clear();
 
   bool ret = true;
   if (headers_received()) {
@@ -132,7 +151,9 @@ bool DataSocket::Send(const std::string& status,
       "Server: PeerConnectionTestServer/0.1\r\n"
       "Cache-Control: no-cache\r\n";
 
-  if (connection_close)
+  if (keep_alive_)
+    buffer += "Connection: keep-alive\r\n";
+  else if (connection_close)
     buffer += "Connection: close\r\n";
 
   if (!content_type.empty())
@@ -151,12 +172,15 @@ bool DataSocket::Send(const std::string& status,
   buffer += "\r\n";
   buffer += data;
 
+  response_sent_ = true;
   return Send(buffer);
 }
 
 void DataSocket::Clear() {
   method_ = INVALID;
   content_length_ = 0;
+  keep_alive_ = false;
+  response_sent_ = false;
   content_type_.clear();
   request_path_.clear();
   request_headers_.clear();
@@ -176,6 +200,9 @@ bool DataSocket::ParseHeaders() {
   assert(method_ != INVALID);
   assert(!request_path_.empty());
 
+  ParseConnection(request_headers_.data() + i + 2,
+                  request_headers_.length() - i - 2);
+
   if (method_ == POST) {
     const char* headers = request_headers_.data() + i + 2;
     size_t len = request_headers_.length() - i - 2;
@@ -259,6 +286,14 @@ bool DataSocket::ParseContentLengthAndType(const char* headers, size_t length) {
   return !content_type_.empty() && content_length_ != 0;
 }
 
+void DataSocket::ParseConnection(const char* headers, size_t length) {
+  static const char kKeepAlive[] = "\r\nConnection: keep-alive\r\n";
+  // Include the line break before the first header.
+  std::string lines("\r\n");
+  lines.append(headers, length);
+  keep_alive_ = lines.find(kKeepAlive) != std::string::npos;
+}
+
 //
 // ListeningSocket
 //
@@ -277,7 +312,7 @@ bool ListeningSocket::Listen(unsigned short port) {
     printf("bind failed\n");
     return false;
   }
-  return listen(socket_, 5) != SOCKET_ERROR;
+  return listen(socket_, kListenBacklog) != SOCKET_ERROR;
 }
 
 DataSocket* ListeningSocket::Accept() const {
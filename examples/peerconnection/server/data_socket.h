@@ -31,6 +31,8 @@ typedef int NativeSocket;
 #endif
 #endif
 
+#include <time.h>
+
 #include <string>
 
 class SocketBase {
@@ -60,7 +62,12 @@ class DataSocket : public SocketBase {
   };
 
   explicit DataSocket(NativeSocket socket)
-      : SocketBase(socket), method_(INVALID), content_length_(0) {}
+      : SocketBase(socket),
+        method_(INVALID),
+        content_length_(0),
+        keep_alive_(false),
+        response_sent_(false),
+        last_activity_(time(NULL)) {}
 
   ~DataSocket() {}
 
@@ -87,6 +94,17 @@ class DataSocket : public SocketBase {
     return method_ != POST || data_.length() >= content_length_;
   }
 
+  // True if the request has a "Connection: keep-alive" header. The socket is
+  // then kept open after the response, and may carry further requests.
+  bool keep_alive() const { return keep_alive_; }
+
+  // True if a response to the current request has been sent.
+  bool response_sent() const { return response_sent_; }
+
+  // True if the socket has no request pending a response and has not
+  // received data for |timeout| seconds.
+  bool IdleFor(time_t timeout) const;
+
   // Checks if the request path (minus arguments) matches a given path.
   bool PathEquals(const char* path) const;
 
@@ -100,7 +118,9 @@ class DataSocket : public SocketBase {
   // Send an HTTP response.  The |status| should start with a valid HTTP
   // response code, followed by a string.  E.g. "200 OK".
   // If |connection_close| is set to true, an extra "Connection: close" HTTP
-  // header will be included.  |content_type| is the mime content type, not
+  // header will be included, unless the request asked for keep-alive, in which
+  // case the socket is expected to be reused.  |content_type| is the mime
+  // content type, not
   // including the "Content-Type: " string.
   // |extra_headers| should be either empty or a list of headers where each
   // header terminates with "\r\n".
@@ -128,9 +148,15 @@ class DataSocket : public SocketBase {
   // Determines the length of the body and it's mime type.
   bool ParseContentLengthAndType(const char* headers, size_t length);
 
+  // Determines whether the client asked to keep the connection open.
+  void ParseConnection(const char* headers, size_t length);
+
  protected:
   RequestMethod method_;
   size_t content_length_;
+  bool keep_alive_;
+  mutable bool response_sent_;
+  time_t last_activity_;
   std::string content_type_;
   std::string request_path_;
   std::string request_headers_;
@@ -0,0 +1,371 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Simulates many peers signing in to the peerconnection server, waiting for
+// notifications and exchanging messages, and reports throughput and message
+// latency.
+//
+// Each peer uses two kept-alive connections: one for a /wait request that is
+// reissued whenever it is answered, with notifications batched, and one for
+// signing in and posting messages to random other peers. A message carries
+// its send time, so that the latency from posting it until the target's wait
+// request is answered can be measured.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "examples/peerconnection/server/data_socket.h"
+#include "examples/peerconnection/server/utils.h"
+#include "rtc_tools/simple_command_line_parser.h"
+
+namespace {
+
+const char kHeaderTerminator[] = "\r\n\r\n";
+const int kMaxEvents = 256;
+
+int64_t NowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+struct Stats {
+  Stats()
+      : sign_ins(0),
+        notifications(0),
+        messages_sent(0),
+        messages_received(0),
+        errors(0) {}
+
+  int sign_ins;
+  int notifications;
+  int messages_sent;
+  int messages_received;
+  int errors;
+  std::vector<int64_t> latencies_us;
+};
+
+struct Peer;
+
+// A kept-alive client connection with at most one outstanding request.
+struct Connection {
+  Connection(Peer* peer, bool wait)
+      : peer(peer), wait(wait), socket(INVALID_SOCKET), busy(false) {}
+
+  Peer* peer;
+  bool wait;
+  NativeSocket socket;
+  bool busy;
+  std::string received;
+};
+
+struct Peer {
+  Peer() : id(-1), control(this, false), waiter(this, true),
+           next_message_us(0) {}
+
+  std::string name;
+  int id;
+  Connection control;
+  Connection waiter;
+  std::vector<int> others;
+  int64_t next_message_us;
+};
+
+bool Connect(const struct sockaddr_in& addr, Connection* conn, int epoll_fd) {
+  conn->socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (conn->socket == INVALID_SOCKET)
+    return false;
+  if (connect(conn->socket, reinterpret_cast<const sockaddr*>(&addr),
+              sizeof(addr)) == SOCKET_ERROR) {
+    return false;
+  }
+  struct epoll_event event = {0};
+  event.events = EPOLLIN;
+  event.data.ptr = conn;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->socket, &event) == 0;
+}
+
+bool SendRequest(Connection* conn,
+                 const char* method,
+                 const std::string& path,
+                 const std::string& body) {
+  assert(!conn->busy);
+  std::string request(std::string(method) + " " + path + " HTTP/1.1\r\n");
+  request += "Host: localhost\r\n";
+  request += "Connection: keep-alive\r\n";
+  if (!body.empty()) {
+    request += "Content-Type: text/plain\r\n";
+    request +=
+        "Content-Length: " + int2str(static_cast<int>(body.size())) + "\r\n";
+  }
+  request += "\r\n";
+  request += body;
+  conn->busy = true;
+  return send(conn->socket, request.data(), request.size(), 0) ==
+         static_cast<ssize_t>(request.size());
+}
+
+void SendWait(Peer* peer) {
+  SendRequest(&peer->waiter, "GET",
+              "/wait?peer_id=" + int2str(peer->id) + "&batch=1", "");
+}
+
+// Returns the value of |header| in |headers|, or -1.
+int GetIntHeader(const std::string& headers, const char* header) {
+  size_t found = headers.find(std::string("\r\n") + header + ": ");
+  if (found == std::string::npos)
+    return -1;
+  return atoi(&headers[found + strlen(header) + 4]);
+}
+
+// Extracts a complete response from |conn| into |headers| and |body|.
+bool GetResponse(Connection* conn, std::string* headers, std::string* body) {
+  size_t found = conn->received.find(kHeaderTerminator);
+  if (found == std::string::npos)
+    return false;
+  size_t body_start = found + ARRAYSIZE(kHeaderTerminator) - 1;
+  *headers = conn->received.substr(0, body_start);
+  int length = GetIntHeader(*headers, "Content-Length");
+  if (length < 0 || conn->received.size() < body_start + length)
+    return false;
+  *body = conn->received.substr(body_start, length);
+  conn->received.erase(0, body_start + length);
+  conn->busy = false;
+  return true;
+}
+
+// Adds the ids of the connected peers in the "name,id,connected" lines of
+// |body| to |peer|, and removes disconnected ones.
+void UpdateOthers(Peer* peer, const std::string& body) {
+  size_t pos = 0;
+  while (pos < body.size()) {
+    size_t eol = body.find('\n', pos);
+    if (eol == std::string::npos)
+      eol = body.size();
+    std::string line = body.substr(pos, eol - pos);
+    pos = eol + 1;
+    size_t first = line.find(',');
+    if (first == std::string::npos)
+      continue;
+    int id = atoi(&line[first + 1]);
+    bool connected = atoi(&line[line.rfind(',') + 1]) != 0;
+    if (id == peer->id)
+      continue;
+    std::vector<int>::iterator it =
+        std::find(peer->others.begin(), peer->others.end(), id);
+    if (connected && it == peer->others.end()) {
+      peer->others.push_back(id);
+    } else if (!connected && it != peer->others.end()) {
+      peer->others.erase(it);
+    }
+  }
+}
+
+void OnResponse(Connection* conn,
+                const std::string& headers,
+                const std::string& body,
+                bool running,
+                Stats* stats) {
+  Peer* peer = conn->peer;
+  if (headers.compare(0, 12, "HTTP/1.1 200") != 0) {
+    ++stats->errors;
+  } else if (!conn->wait && peer->id == -1) {
+    // Response to the sign in: the first line is the peer itself.
+    peer->id = GetIntHeader(headers, "Pragma");
+    UpdateOthers(peer, body);
+    ++stats->sign_ins;
+  } else if (conn->wait) {
+    if (GetIntHeader(headers, "Pragma") == peer->id) {
+      UpdateOthers(peer, body);
+      stats->notifications += static_cast<int>(
+          std::count(body.begin(), body.end(), '\n'));
+    } else {
+      int64_t sent_us = strtoll(body.c_str(), NULL, 10);
+      stats->latencies_us.push_back(NowUs() - sent_us);
+      ++stats->messages_received;
+    }
+  }
+
+  if (conn->wait && running && peer->id != -1)
+    SendWait(peer);
+}
+
+void PrintLatencies(std::vector<int64_t>* latencies_us) {
+  if (latencies_us->empty())
+    return;
+  std::sort(latencies_us->begin(), latencies_us->end());
+  int64_t sum = 0;
+  for (size_t i = 0; i < latencies_us->size(); ++i)
+    sum += (*latencies_us)[i];
+  size_t n = latencies_us->size();
+  printf("Message latency: avg %lld us, p50 %lld us, p99 %lld us, max %lld us\n",
+         static_cast<long long>(sum / static_cast<int64_t>(n)),
+         static_cast<long long>((*latencies_us)[n / 2]),
+         static_cast<long long>((*latencies_us)[n * 99 / 100]),
+         static_cast<long long>((*latencies_us)[n - 1]));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage = "Example usage: " + program_name +
+                      " --server=127.0.0.1 --port=8888 --peers=1000"
+                      " --duration=10 --message_interval_ms=1000";
+  webrtc::test::CommandLineParser parser;
+  parser.Init(argc, argv);
+  parser.SetUsageMessage(usage);
+  parser.SetFlag("server", "127.0.0.1");
+  parser.SetFlag("port", "8888");
+  parser.SetFlag("peers", "1000");
+  parser.SetFlag("duration", "10");
+  parser.SetFlag("message_interval_ms", "1000");
+  parser.SetFlag("help", "false");
+  parser.ProcessFlags();
+
+  if (parser.GetFlag("help") == "true") {
+    parser.PrintUsageMessage();
+    return 0;
+  }
+
+  int port = strtol(parser.GetFlag("port").c_str(), NULL, 10);
+  int num_peers = strtol(parser.GetFlag("peers").c_str(), NULL, 10);
+  int duration_s = strtol(parser.GetFlag("duration").c_str(), NULL, 10);
+  int64_t interval_us =
+      strtol(parser.GetFlag("message_interval_ms").c_str(), NULL, 10) * 1000;
+  if (port < 1 || port > 65535 || num_peers < 1 || duration_s < 1 ||
+      interval_us < 1000) {
+    parser.PrintUsageMessage();
+    return -1;
+  }
+
+  struct sockaddr_in addr = {0};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, parser.GetFlag("server").c_str(), &addr.sin_addr) !=
+      1) {
+    printf("Error: %s is not a valid IPv4 address.\n",
+           parser.GetFlag("server").c_str());
+    return -1;
+  }
+
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1) {
+    printf("Failed to create epoll instance\n");
+    return -1;
+  }
+
+  Stats stats;
+  std::vector<Peer> peers(num_peers);
+  int64_t start_us = NowUs();
+  for (int i = 0; i < num_peers; ++i) {
+    Peer* peer = &peers[i];
+    peer->name = "peer_" + int2str(i) + "@loadgen";
+    if (!Connect(addr, &peer->control, epoll_fd) ||
+        !Connect(addr, &peer->waiter, epoll_fd)) {
+      printf("Failed to connect peer %i: %s\n", i, strerror(errno));
+      return -1;
+    }
+    // Spread the messages of the peers over the interval.
+    peer->next_message_us = start_us + interval_us * i / num_peers;
+    SendRequest(&peer->control, "GET", "/sign_in?" + peer->name, "");
+  }
+
+  struct epoll_event events[kMaxEvents];
+  char buffer[0xffff];
+  std::string headers, body;
+  int64_t end_us = start_us + static_cast<int64_t>(duration_s) * 1000000;
+  int64_t next_report_us = start_us + 1000000;
+  bool running = true;
+  while (running) {
+    int64_t now_us = NowUs();
+    running = now_us < end_us;
+
+    int count = epoll_wait(epoll_fd, events, kMaxEvents, 10);
+    if (count < 0 && errno != EINTR) {
+      printf("epoll_wait failed: %s\n", strerror(errno));
+      break;
+    }
+    for (int i = 0; i < count; ++i) {
+      Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+      ssize_t bytes = recv(conn->socket, buffer, sizeof(buffer), 0);
+      if (bytes <= 0) {
+        printf("Connection of %s closed\n", conn->peer->name.c_str());
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->socket, &events[i]);
+        ++stats.errors;
+        continue;
+      }
+      conn->received.append(buffer, bytes);
+      while (GetResponse(conn, &headers, &body)) {
+        bool signed_in = conn->peer->id != -1;
+        OnResponse(conn, headers, body, running, &stats);
+        if (!signed_in && conn->peer->id != -1)
+          SendWait(conn->peer);
+      }
+    }
+
+    now_us = NowUs();
+    for (size_t i = 0; running && i < peers.size(); ++i) {
+      Peer* peer = &peers[i];
+      if (peer->id == -1 || peer->control.busy || peer->others.empty() ||
+          now_us < peer->next_message_us) {
+        continue;
+      }
+      int to = peer->others[rand() % peer->others.size()];
+      SendRequest(&peer->control, "POST",
+                  "/message?peer_id=" + int2str(peer->id) +
+                      "&to=" + int2str(to),
+                  std::to_string(static_cast<long long>(now_us)));
+      ++stats.messages_sent;
+      peer->next_message_us += interval_us;
+    }
+
+    if (now_us >= next_report_us) {
+      next_report_us += 1000000;
+      printf("%llds: %i signed in, %i notifications, %i messages sent, "
+             "%i received, %i errors\n",
+             static_cast<long long>((now_us - start_us) / 1000000),
+             stats.sign_ins, stats.notifications, stats.messages_sent,
+             stats.messages_received, stats.errors);
+    }
+  }
+
+  double elapsed_s = (NowUs() - start_us) / 1e6;
+  printf("%i peers signed in, %i notifications received\n", stats.sign_ins,
+         stats.notifications);
+  printf("%i messages sent, %i received: %.1f messages/s\n",
+         stats.messages_sent, stats.messages_received,
+         stats.messages_received / elapsed_s);
+  printf("%i errors\n", stats.errors);
+  PrintLatencies(&stats.latencies_us);
+
+  // Sign out, so that the server does not have to time the peers out.
+  for (size_t i = 0; i < peers.size(); ++i) {
+    Peer* peer = &peers[i];
+    if (peer->id != -1 && !peer->control.busy) {
+      SendRequest(&peer->control, "GET",
+                  "/sign_out?peer_id=" + int2str(peer->id), "");
+    }
+    closesocket(peer->control.socket);
+    closesocket(peer->waiter.socket);
+  }
+  close(epoll_fd);
+  return 0;
+}
@@ -11,15 +11,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include <set>
 #include <vector>
 
 #include "examples/peerconnection/server/data_socket.h"
 #include "examples/peerconnection/server/peer_channel.h"
+#include "examples/peerconnection/server/socket_poller.h"
 #include "examples/peerconnection/server/utils.h"
 #include "rtc_tools/simple_command_line_parser.h"
 
-static const size_t kMaxConnections = (FD_SETSIZE - 2);
+// Kept-alive connections without a pending request are closed after this many
+// seconds.
+static const time_t kIdleTimeoutSeconds = 30;
 
 void HandleBrowserRequest(DataSocket* ds, bool* quit) {
   assert(ds && ds->valid());
@@ -46,6 +51,48 @@ void HandleBrowserRequest(DataSocket* ds, bool* quit) {
   }
 }
 
+// Handles a complete request on |s|. Sets |socket_done| if the socket should
+// be closed, and |quit| if the server should shut down.
+void HandleRequest(DataSocket* s,
+                   PeerChannel* clients,
+                   bool* socket_done,
+                   bool* quit) {
+  *socket_done = true;
+  ChannelMember* member = clients->Lookup(s);
+  if (member || PeerChannel::IsPeerConnection(s)) {
+    if (!member) {
+      if (s->PathEquals("/sign_in")) {
+        clients->AddMember(s);
+      } else {
+        printf("No member found for: %s\n", s->request_path().c_str());
+        s->Send("500 Error", true, "text/plain", "", "Peer most likely gone.");
+      }
+    } else if (member->is_wait_request(s)) {
+      // no need to do anything.
+      *socket_done = false;
+    } else {
+      ChannelMember* target = clients->IsTargetedRequest(s);
+      if (target) {
+        member->ForwardRequestToPeer(s, target);
+      } else if (s->PathEquals("/sign_out")) {
+        s->Send("200 OK", true, "text/plain", "", "");
+        // A kept-alive socket may not be closed for a while, so remove the
+        // member right away.
+        clients->OnClosing(s);
+      } else {
+        printf("Couldn't find target for request: %s\n",
+               s->request_path().c_str());
+        s->Send("500 Error", true, "text/plain", "", "Peer most likely gone.");
+      }
+    }
+  } else {
+    HandleBrowserRequest(s, quit);
+  }
+
+  if (*socket_done && s->keep_alive())
+    *socket_done = false;
+}
+
 int main(int argc, char* argv[]) {
   std::string program_name = argv[0];
   std::string usage = "Example usage: " + program_name + " --port=8888";
@@ -53,6 +100,7 @@ int main(int argc, char* argv[]) {
   parser.Init(argc, argv);
   parser.SetUsageMessage(usage);
   parser.SetFlag("port", "8888");
+  parser.SetFlag("max_connections", "10000");
   parser.SetFlag("help", "false");
   parser.ProcessFlags();
 
@@ -70,6 +118,18 @@ int main(int argc, char* argv[]) {
     return -1;
   }
 
+  SocketPoller poller;
+  if (!poller.valid()) {
+    printf("Failed to create socket poller\n");
+    return -1;
+  }
+
+  // The listening socket takes one slot of the poller.
+  size_t max_connections =
+      strtoul((parser.GetFlag("max_connections")).c_str(), NULL, 10);
+  if (max_connections < 1 || max_connections > poller.max_sockets() - 1)
+    max_connections = poller.max_sockets() - 1;
+
   ListeningSocket listener;
   if (!listener.Create()) {
     printf("Failed to create server socket\n");
@@ -77,101 +137,89 @@ int main(int argc, char* argv[]) {
   } else if (!listener.Listen(port)) {
     printf("Failed to listen on server socket\n");
     return -1;
+  } else if (!poller.Add(listener.socket(), &listener)) {
+    printf("Failed to poll server socket\n");
+    return -1;
   }
 
   printf("Server listening on port %i\n", port);
 
   PeerChannel clients;
-  typedef std::vector<DataSocket*> SocketArray;
-  SocketArray sockets;
+  typedef std::set<DataSocket*> SocketSet;
+  SocketSet sockets;
+  std::vector<void*> ready;
+  time_t last_check = time(NULL);
   bool quit = false;
   while (!quit) {
-    fd_set socket_set;
-    FD_ZERO(&socket_set);
-    if (listener.valid())
-      FD_SET(listener.socket(), &socket_set);
-
-    for (SocketArray::iterator i = sockets.begin(); i != sockets.end(); ++i)
-      FD_SET((*i)->socket(), &socket_set);
-
-    struct timeval timeout = {10, 0};
-    if (select(FD_SETSIZE, &socket_set, NULL, NULL, &timeout) == SOCKET_ERROR) {
-      printf("select failed\n");
+    if (!poller.Wait(1000, &ready)) {
+      printf("Waiting for sockets failed\n");
       break;
     }
 
-    for (SocketArray::iterator i = sockets.begin(); i != sockets.end(); ++i) {
-      DataSocket* s = *i;
+    bool accept = false;
+    for (size_t i = 0; i < ready.size(); ++i) {
+      if (ready[i] == &listener) {
+        accept = true;
+        continue;
+      }
+
+      DataSocket* s = static_cast<DataSocket*>(ready[i]);
       bool socket_done = true;
-      if (FD_ISSET(s->socket(), &socket_set)) {
-        if (s->OnDataAvailable(&socket_done) && s->request_received()) {
-          ChannelMember* member = clients.Lookup(s);
-          if (member || PeerChannel::IsPeerConnection(s)) {
-            if (!member) {
-              if (s->PathEquals("/sign_in")) {
-                clients.AddMember(s);
-              } else {
-                printf("No member found for: %s\n", s->request_path().c_str());
-                s->Send("500 Error", true, "text/plain", "",
-                        "Peer most likely gone.");
-              }
-            } else if (member->is_wait_request(s)) {
-              // no need to do anything.
-              socket_done = false;
-            } else {
-              ChannelMember* target = clients.IsTargetedRequest(s);
-              if (target) {
-                member->ForwardRequestToPeer(s, target);
-              } else if (s->PathEquals("/sign_out")) {
-                s->Send("200 OK", true, "text/plain", "", "");
-              } else {
-                printf("Couldn't find target for request: %s\n",
-                       s->request_path().c_str());
-                s->Send("500 Error", true, "text/plain", "",
-                        "Peer most likely gone.");
-              }
-            }
-          } else {
-            HandleBrowserRequest(s, &quit);
-            if (quit) {
-              printf("Quitting...\n");
-              FD_CLR(listener.socket(), &socket_set);
-              listener.Close();
-              clients.CloseAll();
-            }
-          }
+      if (s->OnDataAvailable(&socket_done) && s->request_received()) {
+        HandleRequest(s, &clients, &socket_done, &quit);
+        if (quit) {
+          printf("Quitting...\n");
+          poller.Remove(listener.socket());
+          listener.Close();
+          clients.CloseAll();
+          break;
         }
-      } else {
-        socket_done = false;
       }
 
       if (socket_done) {
         printf("Disconnecting socket\n");
         clients.OnClosing(s);
         assert(s->valid());  // Close must not have been called yet.
-        FD_CLR(s->socket(), &socket_set);
-        delete (*i);
-        i = sockets.erase(i);
-        if (i == sockets.end())
-          break;
+        poller.Remove(s->socket());
+        sockets.erase(s);
+        delete s;
       }
     }
 
-    clients.CheckForTimeout();
+    // Timeouts are in seconds, so there is no need to check more often.
+    time_t now = time(NULL);
+    if (!quit && now != last_check) {
+      last_check = now;
+      clients.CheckForTimeout();
+      for (SocketSet::iterator i = sockets.begin(); i != sockets.end();) {
+        DataSocket* s = *i;
+        if (s->IdleFor(kIdleTimeoutSeconds)) {
+          clients.OnClosing(s);
+          poller.Remove(s->socket());
+          delete s;
+          sockets.erase(i++);
+        } else {
+          ++i;
+        }
+      }
+    }
 
-    if (FD_ISSET(listener.socket(), &socket_set)) {
+    if (accept && listener.valid()) {
       DataSocket* s = listener.Accept();
-      if (sockets.size() >= kMaxConnections) {
+      if (!s) {
+        printf("Failed to accept connection\n");
+      } else if (sockets.size() >= max_connections ||
+                 !poller.Add(s->socket(), s)) {
         delete s;  // sorry, that's all we can take.
         printf("Connection limit reached\n");
       } else {
-        sockets.push_back(s);
+        sockets.insert(s);
         printf("New connection...\n");
       }
     }
   }
 
-  for (SocketArray::iterator i = sockets.begin(); i != sockets.end(); ++i)
+  for (SocketSet::iterator i = sockets.begin(); i != sockets.end(); ++i)
     delete (*i);
   sockets.clear();
 
@@ -48,6 +48,26 @@ enum RequestPathIndex {
 
 const size_t kMaxNameLength = 512;
 
+// Gets the "peer_id" argument of the request |ds|, which identifies the member
+// that sends a wait, sign out or message request.
+static bool GetPeerIdArgument(const DataSocket* ds, int* id) {
+  std::string args(ds->request_arguments());
+  static const char kPeerId[] = "peer_id=";
+  size_t found = args.find(kPeerId);
+  if (found == std::string::npos)
+    return false;
+  *id = atoi(&args[found + ARRAYSIZE(kPeerId) - 1]);
+  return true;
+}
+
+// Checks if the wait request |ds| asks for notifications to be batched.
+static bool IsBatchRequest(const DataSocket* ds) {
+  std::string args(ds->request_arguments());
+  static const char kBatch[] = "batch=1";
+  size_t found = args.find(kBatch);
+  return found != std::string::npos && (found == 0 || args[found - 1] == '&');
+}
+
 //
 // ChannelMember
 //
@@ -88,7 +108,13 @@ std::string ChannelMember::GetPeerIdHeader() const {
 
 bool ChannelMember::NotifyOfOtherMember(const ChannelMember& other) {
   assert(&other != this);
-  QueueResponse("200 OK", "text/plain", GetPeerIdHeader(), other.GetEntry());
+  QueuedResponse qr;
+  qr.status = "200 OK";
+  qr.content_type = "text/plain";
+  qr.extra_headers = GetPeerIdHeader();
+  qr.data = other.GetEntry();
+  qr.notification = true;
+  QueueResponse(qr);
   return true;
 }
 
@@ -130,23 +156,29 @@ void ChannelMember::QueueResponse(const std::string& status,
                                   const std::string& content_type,
                                   const std::string& extra_headers,
                                   const std::string& data) {
+  QueuedResponse qr;
+  qr.status = status;
+  qr.content_type = content_type;
+  qr.extra_headers = extra_headers;
+  qr.data = data;
+  qr.notification = false;
+  QueueResponse(qr);
+}
+
+void ChannelMember::QueueResponse(const QueuedResponse& response) {
   if (waiting_socket_) {
     assert(queue_.size() == 0);
     assert(waiting_socket_->method() == DataSocket::GET);
-    bool ok =
-        waiting_socket_->Send(status, true, content_type, extra_headers, data);
+    bool ok = waiting_socket_->Send(response.status, true,
+                                    response.content_type,
+                                    response.extra_headers, response.data);
     if (!ok) {
       printf("Failed to deliver data to waiting socket\n");
     }
     waiting_socket_ = NULL;
     timestamp_ = time(NULL);
   } else {
-    QueuedResponse qr;
-    qr.status = status;
-    qr.content_type = content_type;
-    qr.extra_headers = extra_headers;
-    qr.data = data;
-    queue_.push(qr);
+    queue_.push(response);
   }
 }
 
@@ -154,10 +186,16 @@ void ChannelMember::SetWaitingSocket(DataSocket* ds) {
   assert(ds->method() == DataSocket::GET);
   if (ds && !queue_.empty()) {
     assert(waiting_socket_ == NULL);
-    const QueuedResponse& response = queue_.front();
+    QueuedResponse response = queue_.front();
+    queue_.pop();
+    if (response.notification && IsBatchRequest(ds)) {
+      while (!queue_.empty() && queue_.front().notification) {
+        response.data += queue_.front().data;
+        queue_.pop();
+      }
+    }
     ds->Send(response.status, true, response.content_type,
              response.extra_headers, response.data);
-    queue_.pop();
   } else {
     waiting_socket_ = ds;
   }
@@ -189,25 +227,18 @@ ChannelMember* PeerChannel::Lookup(DataSocket* ds) const {
   if (i == ARRAYSIZE(kRequestPaths))
     return NULL;
 
-  std::string args(ds->request_arguments());
-  static const char kPeerId[] = "peer_id=";
-  size_t found = args.find(kPeerId);
-  if (found == std::string::npos)
+  int id = 0;
+  if (!GetPeerIdArgument(ds, &id))
     return NULL;
 
-  int id = atoi(&args[found + ARRAYSIZE(kPeerId) - 1]);
-  Members::const_iterator iter = members_.begin();
-  for (; iter != members_.end(); ++iter) {
-    if (id == (*iter)->id()) {
-      if (i == kWait)
-        (*iter)->SetWaitingSocket(ds);
-      if (i == kSignOut)
-        (*iter)->set_disconnected();
-      return *iter;
-    }
+  ChannelMember* member = FindMember(id);
+  if (member) {
+    if (i == kWait)
+      member->SetWaitingSocket(ds);
+    if (i == kSignOut)
+      member->set_disconnected();
   }
-
-  return NULL;
+  return member;
 }
 
 ChannelMember* PeerChannel::IsTargetedRequest(const DataSocket* ds) const {
@@ -231,13 +262,7 @@ ChannelMember* PeerChannel::IsTargetedRequest(const DataSocket* ds) const {
     args = found + ARRAYSIZE(kTargetPeerIdParam) - 1;
   } while (true);
   int id = atoi(&path[found]);
-  Members::const_iterator i = members_.begin();
-  for (; i != members_.end(); ++i) {
-    if ((*i)->id() == id) {
-      return *i;
-    }
-  }
-  return NULL;
+  return FindMember(id);
 }
 
 bool PeerChannel::AddMember(DataSocket* ds) {
@@ -247,6 +272,7 @@ bool PeerChannel::AddMember(DataSocket* ds) {
   BroadcastChangedState(*new_guy, &failures);
   HandleDeliveryFailures(&failures);
   members_.push_back(new_guy);
+  members_by_id_[new_guy->id()] = new_guy;
 
   printf("New member added (total=%s): %s\n",
          size_t2str(members_.size()).c_str(), new_guy->name().c_str());
@@ -268,20 +294,22 @@ void PeerChannel::CloseAll() {
 }
 
 void PeerChannel::OnClosing(DataSocket* ds) {
-  for (Members::iterator i = members_.begin(); i != members_.end(); ++i) {
-    ChannelMember* m = (*i);
-    m->OnClosing(ds);
-    if (!m->connected()) {
-      i = members_.erase(i);
-      Members failures;
-      BroadcastChangedState(*m, &failures);
-      HandleDeliveryFailures(&failures);
-      delete m;
-      if (i == members_.end())
-        break;
-    }
+  // Only the member that sent the request can be waiting on the socket or
+  // have signed out with it.
+  int id = 0;
+  ChannelMember* m = GetPeerIdArgument(ds, &id) ? FindMember(id) : NULL;
+  if (!m)
+    return;
+
+  m->OnClosing(ds);
+  if (!m->connected()) {
+    EraseMember(m);
+    Members failures;
+    BroadcastChangedState(*m, &failures);
+    HandleDeliveryFailures(&failures);
+    delete m;
+    printf("Total connected: %s\n", size_t2str(members_.size()).c_str());
   }
-  printf("Total connected: %s\n", size_t2str(members_.size()).c_str());
 }
 
 void PeerChannel::CheckForTimeout() {
@@ -290,6 +318,7 @@ void PeerChannel::CheckForTimeout() {
     if (m->TimedOut()) {
       printf("Timeout: %s\n", m->name().c_str());
       m->set_disconnected();
+      members_by_id_.erase(m->id());
       i = members_.erase(i);
       Members failures;
       BroadcastChangedState(*m, &failures);
@@ -305,6 +334,7 @@ void PeerChannel::DeleteAll() {
   for (Members::iterator i = members_.begin(); i != members_.end(); ++i)
     delete (*i);
   members_.clear();
+  members_by_id_.clear();
 }
 
 void PeerChannel::BroadcastChangedState(const ChannelMember& member,
@@ -322,6 +352,7 @@ void PeerChannel::BroadcastChangedState(const ChannelMember& member,
       if (!(*i)->NotifyOfOtherMember(member)) {
         (*i)->set_disconnected();
         delivery_failures->push_back(*i);
+        members_by_id_.erase((*i)->id());
         i = members_.erase(i);
         if (i == members_.end())
           break;
@@ -360,3 +391,17 @@ std::string PeerChannel::BuildResponseForNewMember(const ChannelMember& member,
 
   return response;
 }
+
+ChannelMember* PeerChannel::FindMember(int id) const {
+  std::map<int, ChannelMember*>::const_iterator found =
+      members_by_id_.find(id);
+  return found != members_by_id_.end() ? found->second : NULL;
+}
+
+void PeerChannel::EraseMember(ChannelMember* member) {
+  members_by_id_.erase(member->id());
+  Members::iterator found =
+      std::find(members_.begin(), members_.end(), member);
+  assert(found != members_.end());
+  members_.erase(found);
+}
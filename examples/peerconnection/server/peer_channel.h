@@ -13,6 +13,7 @@
 
 #include <time.h>
 
+#include <map>
 #include <queue>
 #include <string>
 #include <vector>
@@ -49,13 +50,21 @@ class ChannelMember {
                      const std::string& extra_headers,
                      const std::string& data);
 
+  // Responds to the wait request |ds| with the next queued response, or keeps
+  // it waiting for one. If the request has a "batch=1" argument, all queued
+  // notifications about other members are sent in one response, one entry
+  // per line, as in the response to a sign in.
   void SetWaitingSocket(DataSocket* ds);
 
  protected:
   struct QueuedResponse {
     std::string status, content_type, extra_headers, data;
+    // True for notifications from the server about other members.
+    bool notification;
   };
 
+  void QueueResponse(const QueuedResponse& response);
+
   DataSocket* waiting_socket_;
   int id_;
   bool connected_;
@@ -96,7 +105,7 @@ class PeerChannel {
   void CloseAll();
 
   // Called when a socket was determined to be closing by the peer (or if the
-  // connection went dead).
+  // connection went dead), or when a sign out request has been answered.
   void OnClosing(DataSocket* ds);
 
   void CheckForTimeout();
@@ -111,8 +120,16 @@ class PeerChannel {
   std::string BuildResponseForNewMember(const ChannelMember& member,
                                         std::string* content_type);
 
+  // Returns the member with |id|, or NULL.
+  ChannelMember* FindMember(int id) const;
+
+  // Removes |member| from |members_| and |members_by_id_|.
+  void EraseMember(ChannelMember* member);
+
  protected:
   Members members_;
+  // Indexes |members_| by id, since there may be thousands of them.
+  std::map<int, ChannelMember*> members_by_id_;
 };
 
 #endif  // EXAMPLES_PEERCONNECTION_SERVER_PEER_CHANNEL_H_
@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "examples/peerconnection/server/socket_poller.h"
+
+#include <errno.h>
+#include <limits.h>
+#if defined(WEBRTC_LINUX)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "examples/peerconnection/server/utils.h"
+
+#if defined(WEBRTC_LINUX)
+
+// The maximum number of events returned by one epoll_wait() call.
+static const int kMaxEvents = 256;
+
+SocketPoller::SocketPoller() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {}
+
+SocketPoller::~SocketPoller() {
+  if (epoll_fd_ != -1)
+    close(epoll_fd_);
+}
+
+bool SocketPoller::valid() const {
+  return epoll_fd_ != -1;
+}
+
+size_t SocketPoller::max_sockets() const {
+  return INT_MAX;
+}
+
+bool SocketPoller::Add(NativeSocket socket, void* context) {
+  assert(valid());
+  struct epoll_event event = {0};
+  event.events = EPOLLIN;
+  event.data.ptr = context;
+  return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+void SocketPoller::Remove(NativeSocket socket) {
+  assert(valid());
+  // The event argument is ignored, but must be non-null before Linux 2.6.9.
+  struct epoll_event event = {0};
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket, &event);
+}
+
+bool SocketPoller::Wait(int timeout_ms, std::vector<void*>* ready) {
+  assert(valid());
+  assert(ready);
+  ready->clear();
+  struct epoll_event events[kMaxEvents];
+  int count = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+  if (count < 0)
+    return errno == EINTR;
+  for (int i = 0; i < count; ++i)
+    ready->push_back(events[i].data.ptr);
+  return true;
+}
+
+#else  // defined(WEBRTC_LINUX)
+
+SocketPoller::SocketPoller() {}
+
+SocketPoller::~SocketPoller() {}
+
+bool SocketPoller::valid() const {
+  return true;
+}
+
+size_t SocketPoller::max_sockets() const {
+  return FD_SETSIZE;
+}
+
+bool SocketPoller::Add(NativeSocket socket, void* context) {
+  if (sockets_.size() >= max_sockets())
+    return false;
+  sockets_[socket] = context;
+  return true;
+}
+
+void SocketPoller::Remove(NativeSocket socket) {
+  sockets_.erase(socket);
+}
+
+bool SocketPoller::Wait(int timeout_ms, std::vector<void*>* ready) {
+  assert(ready);
+  ready->clear();
+  fd_set socket_set;
+  FD_ZERO(&socket_set);
+  for (const auto& socket : sockets_)
+    FD_SET(socket.first, &socket_set);
+
+  struct timeval timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+  if (select(FD_SETSIZE, &socket_set, NULL, NULL, &timeout) == SOCKET_ERROR)
+    return false;
+
+  for (const auto& socket : sockets_) {
+    if (FD_ISSET(socket.first, &socket_set))
+      ready->push_back(socket.second);
+  }
+  return true;
+}
+
+#endif  // defined(WEBRTC_LINUX)
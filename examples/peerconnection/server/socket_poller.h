@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef EXAMPLES_PEERCONNECTION_SERVER_SOCKET_POLLER_H_
+#define EXAMPLES_PEERCONNECTION_SERVER_SOCKET_POLLER_H_
+
+#include <map>
+#include <vector>
+
+#include "examples/peerconnection/server/data_socket.h"
+
+// Waits for sockets to become readable. Uses epoll on Linux, where the cost
+// of a wait depends on the number of ready sockets only, and select()
+// elsewhere, which limits the number of sockets to FD_SETSIZE.
+class SocketPoller {
+ public:
+  SocketPoller();
+  ~SocketPoller();
+
+  bool valid() const;
+
+  // The maximum number of sockets that can be added.
+  size_t max_sockets() const;
+
+  // Adds |socket|, which is reported as |context| when readable.
+  bool Add(NativeSocket socket, void* context);
+  void Remove(NativeSocket socket);
+
+  // Waits up to |timeout_ms| for sockets to become readable and sets |ready|
+  // to their contexts. Returns false if waiting failed.
+  bool Wait(int timeout_ms, std::vector<void*>* ready);
+
+ private:
+#if defined(WEBRTC_LINUX)
+  int epoll_fd_;
+#else
+  std::map<NativeSocket, void*> sockets_;
+#endif
+};
+
+#endif  // EXAMPLES_PEERCONNECTION_SERVER_SOCKET_POLLER_H_
@@ -0,0 +1,243 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "examples/stunserver/batched_stun_server.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "p2p/base/stun.h"
+#include "p2p/base/stunserver.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace {
+
+// The number of packets received or sent with one system call.
+const int kBatchSize = 64;
+// Larger packets are dropped; no client sends such requests.
+const size_t kMaxPacketSize = 1500;
+// How often the threads check whether they should stop.
+const int kReceiveTimeoutMs = 100;
+
+// Writes the response to |request| as cricket::StunServer does to |buf|.
+// |request| may be |buf|. Returns the size of the response, or 0 if there is
+// no response.
+size_t WriteParsedResponse(const char* request,
+                           size_t size,
+                           const rtc::SocketAddress& remote_addr,
+                           char* buf,
+                           size_t capacity) {
+  rtc::ByteBufferReader reader(request, size);
+  cricket::StunMessage msg;
+  if (!msg.Read(&reader) || !cricket::IsStunRequestType(msg.type()))
+    return 0;
+
+  cricket::StunMessage response;
+  response.SetTransactionID(msg.transaction_id());
+  if (msg.type() == cricket::STUN_BINDING_REQUEST) {
+    response.SetType(cricket::STUN_BINDING_RESPONSE);
+    std::unique_ptr<cricket::StunAddressAttribute> mapped_addr;
+    if (!msg.IsLegacy()) {
+      mapped_addr = cricket::StunAttribute::CreateAddress(
+          cricket::STUN_ATTR_MAPPED_ADDRESS);
+    } else {
+      mapped_addr = cricket::StunAttribute::CreateXorAddress(
+          cricket::STUN_ATTR_XOR_MAPPED_ADDRESS);
+    }
+    mapped_addr->SetAddress(remote_addr);
+    response.AddAttribute(std::move(mapped_addr));
+  } else {
+    response.SetType(cricket::GetStunErrorResponseType(msg.type()));
+    auto err_code = cricket::StunAttribute::CreateErrorCode();
+    err_code->SetCode(600);
+    err_code->SetReason("Operation Not Supported");
+    response.AddAttribute(std::move(err_code));
+  }
+
+  rtc::ByteBufferWriter writer;
+  if (!response.Write(&writer) || writer.Length() > capacity)
+    return 0;
+  memcpy(buf, writer.Data(), writer.Length());
+  return writer.Length();
+}
+
+}  // namespace
+
+BatchedStunServer::Shard::Shard(BatchedStunServer* server, int socket)
+    : server(server),
+      socket(socket),
+      packets_received(0),
+      responses_sent(0),
+      requests_parsed(0) {}
+
+BatchedStunServer::Shard::~Shard() {
+  close(socket);
+}
+
+BatchedStunServer::BatchedStunServer(const rtc::SocketAddress& address,
+                                     int num_threads)
+    : address_(address), num_threads_(num_threads), running_(false) {
+  RTC_DCHECK_GT(num_threads_, 0);
+}
+
+BatchedStunServer::~BatchedStunServer() {
+  Stop();
+}
+
+bool BatchedStunServer::Start() {
+  RTC_DCHECK(shards_.empty());
+  running_ = true;
+  for (int i = 0; i < num_threads_; ++i) {
+    int socket = CreateSocket();
+    if (socket < 0) {
+      Stop();
+      return false;
+    }
+    shards_.emplace_back(new Shard(this, socket));
+  }
+  for (const auto& shard : shards_) {
+    shard->thread.reset(
+        new rtc::PlatformThread(&BatchedStunServer::Run, shard.get(),
+                                "StunServer", rtc::kHighPriority));
+    shard->thread->Start();
+  }
+  return true;
+}
+
+void BatchedStunServer::Stop() {
+  running_ = false;
+  for (const auto& shard : shards_) {
+    if (shard->thread)
+      shard->thread->Stop();
+  }
+  shards_.clear();
+}
+
+BatchedStunServer::Stats BatchedStunServer::GetStats() const {
+  Stats stats;
+  for (const auto& shard : shards_) {
+    stats.packets_received += shard->packets_received.load();
+    stats.responses_sent += shard->responses_sent.load();
+    stats.requests_parsed += shard->requests_parsed.load();
+  }
+  return stats;
+}
+
+int BatchedStunServer::CreateSocket() {
+  int s = socket(address_.family(), SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (s < 0) {
+    RTC_LOG_ERR(LS_ERROR) << "socket";
+    return -1;
+  }
+  int one = 1;
+  struct timeval timeout = {0, kReceiveTimeoutMs * 1000};
+  sockaddr_storage addr = {0};
+  socklen_t addr_len = address_.ToSockAddrStorage(&addr);
+  if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 ||
+      setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+      bind(s, reinterpret_cast<sockaddr*>(&addr), addr_len) < 0) {
+    RTC_LOG_ERR(LS_ERROR) << "Failed to bind to " << address_.ToString();
+    close(s);
+    return -1;
+  }
+  // Bind the other sockets to the port chosen for the first.
+  if (address_.port() == 0) {
+    addr_len = sizeof(addr);
+    if (getsockname(s, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0)
+      rtc::SocketAddressFromSockAddrStorage(addr, &address_);
+  }
+  return s;
+}
+
+void BatchedStunServer::Run(void* obj) {
+  Shard* shard = static_cast<Shard*>(obj);
+  std::vector<char> buffers(kBatchSize * kMaxPacketSize);
+  struct mmsghdr messages[kBatchSize];
+  struct iovec iovecs[kBatchSize];
+  sockaddr_storage addrs[kBatchSize];
+  struct mmsghdr responses[kBatchSize];
+  struct iovec response_iovecs[kBatchSize];
+
+  while (shard->server->running_.load(std::memory_order_relaxed)) {
+    memset(messages, 0, sizeof(messages));
+    for (int i = 0; i < kBatchSize; ++i) {
+      iovecs[i].iov_base = &buffers[i * kMaxPacketSize];
+      iovecs[i].iov_len = kMaxPacketSize;
+      messages[i].msg_hdr.msg_name = &addrs[i];
+      messages[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    // Blocks for the first packet only, then takes what is queued.
+    int received =
+        recvmmsg(shard->socket, messages, kBatchSize, MSG_WAITFORONE, nullptr);
+    if (received < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        continue;
+      RTC_LOG_ERR(LS_ERROR) << "recvmmsg";
+      return;
+    }
+
+    int num_responses = 0;
+    int num_parsed = 0;
+    for (int i = 0; i < received; ++i) {
+      if (messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+        continue;
+      rtc::SocketAddress remote_addr;
+      if (!rtc::SocketAddressFromSockAddrStorage(addrs[i], &remote_addr))
+        continue;
+      char* buf = static_cast<char*>(iovecs[i].iov_base);
+      size_t size = messages[i].msg_len;
+      size_t response_size =
+          cricket::WriteStunBindingResponse(buf, size, remote_addr, buf);
+      if (response_size == 0) {
+        ++num_parsed;
+        response_size =
+            WriteParsedResponse(buf, size, remote_addr, buf, kMaxPacketSize);
+        if (response_size == 0)
+          continue;
+      }
+      struct mmsghdr& response = responses[num_responses];
+      memset(&response, 0, sizeof(response));
+      response_iovecs[num_responses].iov_base = buf;
+      response_iovecs[num_responses].iov_len = response_size;
+      response.msg_hdr.msg_name = &addrs[i];
+      response.msg_hdr.msg_namelen = messages[i].msg_hdr.msg_namelen;
+      response.msg_hdr.msg_iov = &response_iovecs[num_responses];
+      response.msg_hdr.msg_iovlen = 1;
+      ++num_responses;
+    }
+
+    int sent = 0;
+    while (sent < num_responses) {
+      int ret = sendmmsg(shard->socket, responses + sent,
+                         num_responses - sent, 0);
+      if (ret < 0) {
+        if (errno == EINTR)
+          continue;
+        // Drop the rest of the batch, as a failed sendto() would.
+        RTC_LOG_ERR(LS_ERROR) << "sendmmsg";
+        break;
+      }
+      sent += ret;
+    }
+
+    shard->packets_received.fetch_add(received, std::memory_order_relaxed);
+    shard->responses_sent.fetch_add(sent, std::memory_order_relaxed);
+    shard->requests_parsed.fetch_add(num_parsed, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef EXAMPLES_STUNSERVER_BATCHED_STUN_SERVER_H_
+#define EXAMPLES_STUNSERVER_BATCHED_STUN_SERVER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/socketaddress.h"
+
+// A STUN server for public service on Linux. Each of a number of threads
+// serves its own UDP socket, bound to the same address with SO_REUSEPORT so
+// that the kernel spreads the clients over them. Packets are received and
+// sent in batches with recvmmsg() and sendmmsg(), and binding requests are
+// answered by rewriting them in place with cricket::WriteStunBindingResponse().
+// Other requests are parsed and answered as by cricket::StunServer.
+class BatchedStunServer {
+ public:
+  struct Stats {
+    uint64_t packets_received = 0;
+    uint64_t responses_sent = 0;
+    // Requests that could not be answered in place.
+    uint64_t requests_parsed = 0;
+  };
+
+  BatchedStunServer(const rtc::SocketAddress& address, int num_threads);
+  ~BatchedStunServer();
+
+  // Binds the sockets and starts the threads. Returns false if a socket can
+  // not be bound.
+  bool Start();
+  void Stop();
+
+  // The address the sockets are bound to, with the port chosen if the port
+  // of the address given to the constructor was 0.
+  const rtc::SocketAddress& address() const { return address_; }
+
+  // Sums the statistics of all threads.
+  Stats GetStats() const;
+
+ private:
+  struct Shard {
+    Shard(BatchedStunServer* server, int socket);
+    ~Shard();
+
+    BatchedStunServer* const server;
+    const int socket;
+    std::unique_ptr<rtc::PlatformThread> thread;
+    std::atomic<uint64_t> packets_received;
+    std::atomic<uint64_t> responses_sent;
+    std::atomic<uint64_t> requests_parsed;
+  };
+
+  static void Run(void* shard);
+  // Returns a bound socket, or -1.
+  int CreateSocket();
+
+  rtc::SocketAddress address_;
+  const int num_threads_;
+  std::atomic<bool> running_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(BatchedStunServer);
+};
+
+#endif  // EXAMPLES_STUNSERVER_BATCHED_STUN_SERVER_H_
@@ -11,17 +11,55 @@
 #if defined(WEBRTC_POSIX)
 #include <errno.h>
 #endif  // WEBRTC_POSIX
+#include <stdlib.h>
 
 #include <iostream>
 
 #include "p2p/base/stunserver.h"
 #include "rtc_base/thread.h"
 
+#if defined(WEBRTC_LINUX)
+#include "examples/stunserver/batched_stun_server.h"
+#endif  // WEBRTC_LINUX
+
 using cricket::StunServer;
 
+#if defined(WEBRTC_LINUX)
+// Serves from |num_threads| threads until killed, and prints the request rate
+// every 10 seconds.
+int RunBatchedServer(const rtc::SocketAddress& server_addr, int num_threads) {
+  BatchedStunServer server(server_addr, num_threads);
+  if (!server.Start()) {
+    std::cerr << "Failed to bind UDP sockets" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Listening at " << server.address().ToString() << " with "
+            << num_threads << " threads" << std::endl;
+
+  const int kReportIntervalMs = 10000;
+  BatchedStunServer::Stats last;
+  while (true) {
+    rtc::Thread::SleepMs(kReportIntervalMs);
+    BatchedStunServer::Stats stats = server.GetStats();
+    std::cout << (stats.responses_sent - last.responses_sent) * 1000 /
+                     kReportIntervalMs
+              << " responses/s, "
+              << (stats.packets_received - last.packets_received) * 1000 /
+                     kReportIntervalMs
+              << " packets/s, "
+              << (stats.requests_parsed - last.requests_parsed) * 1000 /
+                     kReportIntervalMs
+              << " parsed requests/s" << std::endl;
+    last = stats;
+  }
+  return 0;
+}
+#endif  // WEBRTC_LINUX
+
 int main(int argc, char* argv[]) {
-  if (argc != 2) {
-    std::cerr << "usage: stunserver address" << std::endl;
+  if (argc != 2 && argc != 3) {
+    std::cerr << "usage: stunserver address [threads]" << std::endl;
     return 1;
   }
 
@@ -31,6 +69,19 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+#if defined(WEBRTC_LINUX)
+  int num_threads = argc == 3 ? atoi(argv[2]) : 1;
+  if (num_threads < 1) {
+    std::cerr << "Invalid number of threads: " << argv[2] << std::endl;
+    return 1;
+  }
+  return RunBatchedServer(server_addr, num_threads);
+#else
+  if (argc == 3) {
+    std::cerr << "Multiple threads are only supported on Linux" << std::endl;
+    return 1;
+  }
+
   rtc::Thread* pthMain = rtc::Thread::Current();
 
   rtc::AsyncUDPSocket* server_socket =
@@ -48,4 +99,5 @@ int main(int argc, char* argv[]) {
 
   delete server;
   return 0;
+#endif  // WEBRTC_LINUX
 }
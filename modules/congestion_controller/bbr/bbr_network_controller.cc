@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_cache.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/system/fallthrough.h"
 #include "system_wrappers/include/field_trial.h"
@@ -151,8 +152,9 @@ BbrNetworkController::BbrControllerConfig::BbrControllerConfig(
     const BbrControllerConfig&) = default;
 BbrNetworkController::BbrControllerConfig
 BbrNetworkController::BbrControllerConfig::FromTrial() {
-  return BbrControllerConfig(
-      webrtc::field_trial::FindFullName(kBbrConfigTrial));
+  static FieldTrialCache<BbrControllerConfig>* const cache =
+      new FieldTrialCache<BbrControllerConfig>(kBbrConfigTrial);
+  return cache->Get();
 }
 
 
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/remote_bitrate_estimator/aimd_rate_control.h"
+#include "modules/remote_bitrate_estimator/overuse_detector.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kNumStreams = 10000;
+// About as many trials as a production configuration has.
+const int kNumOtherTrials = 50;
+
+// Returns a configuration with |kNumOtherTrials| unrelated trials in front of
+// the trials read by the estimators.
+std::string MakeTrialsString() {
+  std::string trials;
+  for (int i = 0; i < kNumOtherTrials; ++i) {
+    trials += "WebRTC-UnrelatedExperiment" + rtc::ToString(i) + "/Enabled-" +
+              rtc::ToString(i) + "/";
+  }
+  trials += "WebRTC-AdaptiveBweThreshold/Enabled-0.5,0.002/";
+  trials += "WebRTC-BweBackOffFactor/Enabled-0.9/";
+  return trials;
+}
+
+double ElapsedMs(int64_t start_ns) {
+  return static_cast<double>(rtc::SystemTimeNanos() - start_ns) /
+         rtc::kNumNanosecsPerMillisec;
+}
+
+}  // namespace
+
+// Measures how fast the receive side bandwidth estimators, which read their
+// field trials when they are constructed, are set up for new streams, and how
+// fast a single field trial is looked up.
+TEST(EstimatorSetupPerformanceTest, CreateEstimators) {
+  test::ScopedFieldTrials field_trials(MakeTrialsString());
+
+  std::vector<std::unique_ptr<OveruseDetector>> detectors;
+  std::vector<std::unique_ptr<AimdRateControl>> rate_controls;
+  detectors.reserve(kNumStreams);
+  rate_controls.reserve(kNumStreams);
+  int64_t start_ns = rtc::SystemTimeNanos();
+  for (int i = 0; i < kNumStreams; ++i) {
+    detectors.emplace_back(new OveruseDetector());
+    rate_controls.emplace_back(new AimdRateControl());
+  }
+  test::PrintResult("estimator_setup", "", "overuse_detector_and_aimd",
+                    kNumStreams / ElapsedMs(start_ns) * 1000, "streams/s",
+                    false);
+
+  size_t found = 0;
+  start_ns = rtc::SystemTimeNanos();
+  for (int i = 0; i < kNumStreams; ++i)
+    found += field_trial::FindFullName("WebRTC-BweBackOffFactor").size();
+  test::PrintResult("field_trial_lookup", "", "find_full_name",
+                    kNumStreams / ElapsedMs(start_ns) * 1000, "lookups/s",
+                    false);
+  EXPECT_GT(found, 0u);
+}
+
+}  // namespace webrtc
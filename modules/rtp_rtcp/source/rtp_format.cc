@@ -18,27 +18,40 @@
 #include "modules/rtp_rtcp/source/rtp_format_vp9.h"
 
 namespace webrtc {
+namespace {
+template <typename T, typename... Args>
+T* New(rtc::Arena* arena, Args&&... args) {
+  if (arena)
+    return arena->New<T>(std::forward<Args>(args)...);
+  return new T(std::forward<Args>(args)...);
+}
+}  // namespace
+
 RtpPacketizer* RtpPacketizer::Create(VideoCodecType type,
                                      size_t max_payload_len,
                                      size_t last_packet_reduction_len,
                                      const RTPVideoHeader* rtp_video_header,
-                                     FrameType frame_type) {
+                                     FrameType frame_type,
+                                     rtc::Arena* arena) {
   switch (type) {
     case kVideoCodecH264:
       RTC_CHECK(rtp_video_header);
-      return new RtpPacketizerH264(max_payload_len, last_packet_reduction_len,
-                                   rtp_video_header->h264().packetization_mode);
+      return New<RtpPacketizerH264>(
+          arena, max_payload_len, last_packet_reduction_len,
+          rtp_video_header->h264().packetization_mode, arena);
     case kVideoCodecVP8:
       RTC_CHECK(rtp_video_header);
-      return new RtpPacketizerVp8(rtp_video_header->vp8(), max_payload_len,
-                                  last_packet_reduction_len);
+      return New<RtpPacketizerVp8>(arena, rtp_video_header->vp8(),
+                                   max_payload_len, last_packet_reduction_len,
+                                   arena);
     case kVideoCodecVP9:
       RTC_CHECK(rtp_video_header);
-      return new RtpPacketizerVp9(rtp_video_header->vp9(), max_payload_len,
-                                  last_packet_reduction_len);
+      return New<RtpPacketizerVp9>(arena, rtp_video_header->vp9(),
+                                   max_payload_len, last_packet_reduction_len,
+                                   arena);
     case kVideoCodecGeneric:
-      return new RtpPacketizerGeneric(frame_type, max_payload_len,
-                                      last_packet_reduction_len);
+      return New<RtpPacketizerGeneric>(arena, frame_type, max_payload_len,
+                                       last_packet_reduction_len);
     default:
       RTC_NOTREACHED();
   }
@@ -17,17 +17,22 @@
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/memory/arena.h"
 
 namespace webrtc {
 class RtpPacketToSend;
 
 class RtpPacketizer {
  public:
+  // If |arena| is given, the packetizer and its per-packet bookkeeping are
+  // allocated from it, and the packetizer must be destroyed with
+  // rtc::Arena::Deleter instead of being deleted.
   static RtpPacketizer* Create(VideoCodecType type,
                                size_t max_payload_len,
                                size_t last_packet_reduction_len,
                                const RTPVideoHeader* rtp_video_header,
-                               FrameType frame_type);
+                               FrameType frame_type,
+                               rtc::Arena* arena = nullptr);
 
   virtual ~RtpPacketizer() {}
 
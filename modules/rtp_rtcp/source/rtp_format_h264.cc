@@ -81,11 +81,15 @@ bool ParseStapAStartOffsets(const uint8_t* nalu_ptr,
 
 RtpPacketizerH264::RtpPacketizerH264(size_t max_payload_len,
                                      size_t last_packet_reduction_len,
-                                     H264PacketizationMode packetization_mode)
+                                     H264PacketizationMode packetization_mode,
+                                     rtc::Arena* arena)
     : max_payload_len_(max_payload_len),
       last_packet_reduction_len_(last_packet_reduction_len),
       num_packets_left_(0),
-      packetization_mode_(packetization_mode) {
+      packetization_mode_(packetization_mode),
+      input_fragments_(rtc::ArenaAllocator<Fragment>(arena)),
+      packets_(std::deque<PacketUnit, rtc::ArenaAllocator<PacketUnit>>(
+          rtc::ArenaAllocator<PacketUnit>(arena))) {
   // Guard against uninitialized memory in packetization_mode.
   RTC_CHECK(packetization_mode == H264PacketizationMode::NonInterleaved ||
             packetization_mode == H264PacketizationMode::SingleNalUnit);
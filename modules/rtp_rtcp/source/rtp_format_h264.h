@@ -19,6 +19,7 @@
 #include "modules/rtp_rtcp/source/rtp_format.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/memory/arena.h"
 
 namespace webrtc {
 
@@ -28,7 +29,8 @@ class RtpPacketizerH264 : public RtpPacketizer {
   // The payload_data must be exactly one encoded H264 frame.
   RtpPacketizerH264(size_t max_payload_len,
                     size_t last_packet_reduction_len,
-                    H264PacketizationMode packetization_mode);
+                    H264PacketizationMode packetization_mode,
+                    rtc::Arena* arena = nullptr);
 
   ~RtpPacketizerH264() override;
 
@@ -91,8 +93,10 @@ class RtpPacketizerH264 : public RtpPacketizer {
   const size_t last_packet_reduction_len_;
   size_t num_packets_left_;
   const H264PacketizationMode packetization_mode_;
-  std::deque<Fragment> input_fragments_;
-  std::queue<PacketUnit> packets_;
+  std::deque<Fragment, rtc::ArenaAllocator<Fragment>> input_fragments_;
+  std::queue<PacketUnit,
+             std::deque<PacketUnit, rtc::ArenaAllocator<PacketUnit>>>
+      packets_;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(RtpPacketizerH264);
 };
@@ -160,13 +160,16 @@ bool ValidateHeader(const RTPVideoHeaderVP8& hdr_info) {
 
 RtpPacketizerVp8::RtpPacketizerVp8(const RTPVideoHeaderVP8& hdr_info,
                                    size_t max_payload_len,
-                                   size_t last_packet_reduction_len)
+                                   size_t last_packet_reduction_len,
+                                   rtc::Arena* arena)
     : payload_data_(NULL),
       payload_size_(0),
       vp8_fixed_payload_descriptor_bytes_(1),
       hdr_info_(hdr_info),
       max_payload_len_(max_payload_len),
-      last_packet_reduction_len_(last_packet_reduction_len) {
+      last_packet_reduction_len_(last_packet_reduction_len),
+      packets_(std::deque<InfoStruct, rtc::ArenaAllocator<InfoStruct>>(
+          rtc::ArenaAllocator<InfoStruct>(arena))) {
   RTC_DCHECK(ValidateHeader(hdr_info));
 }
 
@@ -25,6 +25,7 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_VP8_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_VP8_H_
 
+#include <deque>
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/source/rtp_format.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/memory/arena.h"
 #include "typedefs.h"  // NOLINT(build/include)
 
 namespace webrtc {
@@ -43,7 +45,8 @@ class RtpPacketizerVp8 : public RtpPacketizer {
   // The payload_data must be exactly one encoded VP8 frame.
   RtpPacketizerVp8(const RTPVideoHeaderVP8& hdr_info,
                    size_t max_payload_len,
-                   size_t last_packet_reduction_len);
+                   size_t last_packet_reduction_len,
+                   rtc::Arena* arena = nullptr);
 
   ~RtpPacketizerVp8() override;
 
@@ -64,7 +67,9 @@ class RtpPacketizerVp8 : public RtpPacketizer {
     size_t size;
     bool first_packet;
   } InfoStruct;
-  typedef std::queue<InfoStruct> InfoQueue;
+  typedef std::queue<InfoStruct,
+                     std::deque<InfoStruct, rtc::ArenaAllocator<InfoStruct>>>
+      InfoQueue;
 
   static const int kXBit = 0x80;
   static const int kNBit = 0x20;
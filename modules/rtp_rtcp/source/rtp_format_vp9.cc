@@ -462,12 +462,15 @@ bool ParseSsData(rtc::BitBuffer* parser, RTPVideoHeaderVP9* vp9) {
 
 RtpPacketizerVp9::RtpPacketizerVp9(const RTPVideoHeaderVP9& hdr,
                                    size_t max_payload_length,
-                                   size_t last_packet_reduction_len)
+                                   size_t last_packet_reduction_len,
+                                   rtc::Arena* arena)
     : hdr_(hdr),
       max_payload_length_(max_payload_length),
       payload_(nullptr),
       payload_size_(0),
-      last_packet_reduction_len_(last_packet_reduction_len) {}
+      last_packet_reduction_len_(last_packet_reduction_len),
+      packets_(std::deque<PacketInfo, rtc::ArenaAllocator<PacketInfo>>(
+          rtc::ArenaAllocator<PacketInfo>(arena))) {}
 
 RtpPacketizerVp9::~RtpPacketizerVp9() {}
 
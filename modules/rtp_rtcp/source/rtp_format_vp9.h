@@ -21,12 +21,14 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_VP9_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_VP9_H_
 
+#include <deque>
 #include <queue>
 #include <string>
 
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/source/rtp_format.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/memory/arena.h"
 #include "typedefs.h"  // NOLINT(build/include)
 
 namespace webrtc {
@@ -35,7 +37,8 @@ class RtpPacketizerVp9 : public RtpPacketizer {
  public:
   RtpPacketizerVp9(const RTPVideoHeaderVP9& hdr,
                    size_t max_payload_length,
-                   size_t last_packet_reduction_len);
+                   size_t last_packet_reduction_len,
+                   rtc::Arena* arena = nullptr);
 
   ~RtpPacketizerVp9() override;
 
@@ -57,7 +60,9 @@ class RtpPacketizerVp9 : public RtpPacketizer {
     bool layer_begin;
     bool layer_end;
   } PacketInfo;
-  typedef std::queue<PacketInfo> PacketInfoQueue;
+  typedef std::queue<PacketInfo,
+                     std::deque<PacketInfo, rtc::ArenaAllocator<PacketInfo>>>
+      PacketInfoQueue;
 
  private:
   // Calculates all packet sizes and loads info to packet queue.
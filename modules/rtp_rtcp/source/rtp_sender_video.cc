@@ -278,9 +278,14 @@ bool RTPSenderVideo::SendVideo(enum VideoCodecType video_type,
                                const RTPFragmentationHeader* fragmentation,
                                const RTPVideoHeader* video_header,
                                int64_t expected_retransmission_time_ms) {
+  RTC_DCHECK_RUNS_SERIALIZED(&send_video_race_checker_);
   if (payload_size == 0)
     return false;
 
+  // Nothing allocated for the previous frame is alive anymore; its packets
+  // were handed to the pacer and its packetizer has been destroyed.
+  frame_arena_.Reset();
+
   // Create header that will be reused in all packets.
   std::unique_ptr<RtpPacketToSend> rtp_header = rtp_sender_->AllocatePacket();
   rtp_header->SetPayloadType(payload_type);
@@ -403,9 +408,9 @@ bool RTPSenderVideo::SendVideo(enum VideoCodecType video_type,
   size_t last_packet_reduction_len =
       last_packet->headers_size() - rtp_header->headers_size();
 
-  std::unique_ptr<RtpPacketizer> packetizer(RtpPacketizer::Create(
+  rtc::ArenaPtr<RtpPacketizer> packetizer(RtpPacketizer::Create(
       video_type, max_data_payload_length, last_packet_reduction_len,
-      video_header, frame_type));
+      video_header, frame_type, &frame_arena_));
 
   const uint8_t temporal_id =
       video_header ? GetTemporalId(*video_header) : kNoTemporalIdx;
@@ -23,7 +23,9 @@
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "modules/rtp_rtcp/source/ulpfec_generator.h"
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/memory/arena.h"
 #include "rtc_base/onetimeevent.h"
+#include "rtc_base/race_checker.h"
 #include "rtc_base/rate_statistics.h"
 #include "rtc_base/sequenced_task_checker.h"
 #include "rtc_base/thread_annotations.h"
@@ -159,6 +161,11 @@ class RTPSenderVideo {
       RTC_GUARDED_BY(stats_crit_);
 
   OneTimeEvent first_frame_sent_;
+
+  // Holds the packetizer and its bookkeeping while SendVideo() packetizes a
+  // frame, so that the memory is reused from frame to frame.
+  rtc::RaceChecker send_video_race_checker_;
+  rtc::Arena frame_arena_ RTC_GUARDED_BY(send_video_race_checker_);
 };
 
 }  // namespace webrtc
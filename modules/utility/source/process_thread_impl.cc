@@ -10,6 +10,8 @@
 
 #include "modules/utility/source/process_thread_impl.h"
 
+#include <utility>
+
 #include "modules/include/module.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/task_queue.h"
@@ -65,8 +67,8 @@ void ProcessThreadImpl::Start() {
 
   RTC_DCHECK(!stop_);
 
-  for (ModuleCallback& m : modules_)
-    m.module->ProcessThreadAttached(this);
+  for (auto& entry : modules_)
+    entry.second.module->ProcessThreadAttached(this);
 
   thread_.reset(
       new rtc::PlatformThread(&ProcessThreadImpl::Run, this, thread_name_));
@@ -89,17 +91,21 @@ void ProcessThreadImpl::Stop() {
   stop_ = false;
 
   thread_.reset();
-  for (ModuleCallback& m : modules_)
-    m.module->ProcessThreadAttached(nullptr);
+  for (auto& entry : modules_)
+    entry.second.module->ProcessThreadAttached(nullptr);
 }
 
 void ProcessThreadImpl::WakeUp(Module* module) {
   // Allowed to be called on any thread.
   {
     rtc::CritScope lock(&lock_);
-    for (ModuleCallback& m : modules_) {
-      if (m.module == module)
-        m.next_callback = kCallProcessImmediately;
+    auto it = modules_.find(module);
+    if (it != modules_.end()) {
+      ModuleCallback& m = it->second;
+      m.next_callback = kCallProcessImmediately;
+      // A module that is being processed is scheduled again afterwards.
+      if (m.deadline_index != kNotScheduled)
+        SiftUp(m.deadline_index);
     }
   }
   wake_up_->Set();
@@ -123,10 +129,11 @@ void ProcessThreadImpl::RegisterModule(Module* module,
   {
     // Catch programmer error.
     rtc::CritScope lock(&lock_);
-    for (const ModuleCallback& mc : modules_) {
-      RTC_DCHECK(mc.module != module)
-          << "Already registered here: " << mc.location.ToString() << "\n"
-          << "Now attempting from here: " << from.ToString();
+    auto it = modules_.find(module);
+    if (it != modules_.end()) {
+      RTC_NOTREACHED() << "Already registered here: "
+                       << it->second.location.ToString() << "\n"
+                       << "Now attempting from here: " << from.ToString();
     }
   }
 #endif
@@ -139,7 +146,9 @@ void ProcessThreadImpl::RegisterModule(Module* module,
 
   {
     rtc::CritScope lock(&lock_);
-    modules_.push_back(ModuleCallback(module, from));
+    auto result = modules_.emplace(module, ModuleCallback(module, from));
+    if (result.second)
+      ScheduleModule(&result.first->second);
   }
 
   // Wake the thread calling ProcessThreadImpl::Process() to update the
@@ -154,8 +163,11 @@ void ProcessThreadImpl::DeRegisterModule(Module* module) {
 
   {
     rtc::CritScope lock(&lock_);
-    modules_.remove_if(
-        [&module](const ModuleCallback& m) { return m.module == module; });
+    auto it = modules_.find(module);
+    if (it != modules_.end()) {
+      UnscheduleModule(&it->second);
+      modules_.erase(it);
+    }
   }
 
   // Notify the module that it's been detached.
@@ -176,31 +188,41 @@ bool ProcessThreadImpl::Process() {
     rtc::CritScope lock(&lock_);
     if (stop_)
       return false;
-    for (ModuleCallback& m : modules_) {
+    // Take the due modules off the heap first, so that each module is
+    // processed at most once per call even if it asks to be called right
+    // away again.
+    due_modules_.clear();
+    while (!deadlines_.empty() && deadlines_.front()->next_callback <= now) {
+      due_modules_.push_back(deadlines_.front());
+      UnscheduleModule(deadlines_.front());
+    }
+    for (ModuleCallback* m : due_modules_) {
       // TODO(tommi): Would be good to measure the time TimeUntilNextProcess
       // takes and dcheck if it takes too long (e.g. >=10ms).  Ideally this
       // operation should not require taking a lock, so querying all modules
       // should run in a matter of nanoseconds.
-      if (m.next_callback == 0)
-        m.next_callback = GetNextCallbackTime(m.module, now);
+      if (m->next_callback == 0)
+        m->next_callback = GetNextCallbackTime(m->module, now);
 
-      if (m.next_callback <= now ||
-          m.next_callback == kCallProcessImmediately) {
+      if (m->next_callback <= now ||
+          m->next_callback == kCallProcessImmediately) {
         {
           TRACE_EVENT2("webrtc", "ModuleProcess", "function",
-                       m.location.function_name(), "file",
-                       m.location.file_and_line());
-          m.module->Process();
+                       m->location.function_name(), "file",
+                       m->location.file_and_line());
+          m->module->Process();
         }
         // Use a new 'now' reference to calculate when the next callback
         // should occur.  We'll continue to use 'now' above for the baseline
         // of calculating how long we should wait, to reduce variance.
         int64_t new_now = rtc::TimeMillis();
-        m.next_callback = GetNextCallbackTime(m.module, new_now);
+        m->next_callback = GetNextCallbackTime(m->module, new_now);
       }
-
-      if (m.next_callback < next_checkpoint)
-        next_checkpoint = m.next_callback;
+      ScheduleModule(m);
+    }
+    if (!deadlines_.empty() &&
+        deadlines_.front()->next_callback < next_checkpoint) {
+      next_checkpoint = deadlines_.front()->next_callback;
     }
 
     while (!queue_.empty()) {
@@ -219,4 +241,63 @@ bool ProcessThreadImpl::Process() {
 
   return true;
 }
+
+void ProcessThreadImpl::ScheduleModule(ModuleCallback* m) {
+  RTC_DCHECK(m->deadline_index == kNotScheduled);
+  m->deadline_index = deadlines_.size();
+  deadlines_.push_back(m);
+  SiftUp(m->deadline_index);
+}
+
+void ProcessThreadImpl::UnscheduleModule(ModuleCallback* m) {
+  size_t index = m->deadline_index;
+  if (index == kNotScheduled)
+    return;
+  size_t last = deadlines_.size() - 1;
+  if (index != last) {
+    SwapDeadlines(index, last);
+    deadlines_.pop_back();
+    SiftUp(index);
+    SiftDown(index);
+  } else {
+    deadlines_.pop_back();
+  }
+  m->deadline_index = kNotScheduled;
+}
+
+void ProcessThreadImpl::SiftUp(size_t index) {
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (deadlines_[parent]->next_callback <= deadlines_[index]->next_callback)
+      break;
+    SwapDeadlines(index, parent);
+    index = parent;
+  }
+}
+
+void ProcessThreadImpl::SiftDown(size_t index) {
+  while (true) {
+    size_t smallest = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < deadlines_.size() &&
+        deadlines_[left]->next_callback < deadlines_[smallest]->next_callback) {
+      smallest = left;
+    }
+    if (right < deadlines_.size() && deadlines_[right]->next_callback <
+                                         deadlines_[smallest]->next_callback) {
+      smallest = right;
+    }
+    if (smallest == index)
+      break;
+    SwapDeadlines(index, smallest);
+    index = smallest;
+  }
+}
+
+void ProcessThreadImpl::SwapDeadlines(size_t a, size_t b) {
+  std::swap(deadlines_[a], deadlines_[b]);
+  deadlines_[a]->deadline_index = a;
+  deadlines_[b]->deadline_index = b;
+}
 }  // namespace webrtc
@@ -11,9 +11,10 @@
 #ifndef MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 #define MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 
-#include <list>
+#include <map>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/criticalsection.h"
@@ -57,12 +58,28 @@ class ProcessThreadImpl : public ProcessThread {
     Module* const module;
     int64_t next_callback = 0;  // Absolute timestamp.
     const rtc::Location location;
+    // Position in |deadlines_|, or kNotScheduled while the module is being
+    // processed.
+    size_t deadline_index = kNotScheduled;
 
    private:
     ModuleCallback& operator=(ModuleCallback&);
   };
 
-  typedef std::list<ModuleCallback> ModuleList;
+  // Registered modules. A map rather than a list so that WakeUp() finds the
+  // module without scanning, and so that pointers to the elements stay valid.
+  typedef std::map<Module*, ModuleCallback> ModuleMap;
+
+  static const size_t kNotScheduled = static_cast<size_t>(-1);
+
+  // |deadlines_| is a binary min-heap of all registered modules that are not
+  // being processed, ordered on |next_callback|. Each wakeup only looks at the
+  // modules that are due instead of at every registered module.
+  void ScheduleModule(ModuleCallback* m);
+  void UnscheduleModule(ModuleCallback* m);
+  void SiftUp(size_t index);
+  void SiftDown(size_t index);
+  void SwapDeadlines(size_t a, size_t b);
 
   // Warning: For some reason, if |lock_| comes immediately before |modules_|
   // with the current class layout, we will  start to have mysterious crashes
@@ -77,7 +94,10 @@ class ProcessThreadImpl : public ProcessThread {
   // TODO(pbos): Remove unique_ptr and stop recreating the thread.
   std::unique_ptr<rtc::PlatformThread> thread_;
 
-  ModuleList modules_;
+  ModuleMap modules_;
+  std::vector<ModuleCallback*> deadlines_;
+  // Modules due in the current call to Process(). Kept to avoid reallocating.
+  std::vector<ModuleCallback*> due_modules_;
   std::queue<rtc::QueuedTask*> queue_;
   bool stop_;
   const char* thread_name_;
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "modules/include/module.h"
+#include "modules/utility/include/process_thread.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/location.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kNumModules = 1000;
+const int kRunTimeMs = 2000;
+
+// Wants to be processed every |interval_ms|, like the RTCP timers and pacers
+// of many streams sharing a process thread.
+class PeriodicModule : public Module {
+ public:
+  explicit PeriodicModule(int64_t interval_ms) : interval_ms_(interval_ms) {}
+
+  int64_t TimeUntilNextProcess() override {
+    ++time_until_next_process_calls_;
+    return interval_ms_ - (rtc::TimeMillis() - last_process_ms_);
+  }
+
+  void Process() override {
+    last_process_ms_ = rtc::TimeMillis();
+    ++process_calls_;
+  }
+
+  int process_calls() const { return process_calls_; }
+  int time_until_next_process_calls() const {
+    return time_until_next_process_calls_;
+  }
+
+ private:
+  const int64_t interval_ms_;
+  int64_t last_process_ms_ = 0;
+  std::atomic<int> process_calls_{0};
+  std::atomic<int> time_until_next_process_calls_{0};
+};
+
+}  // namespace
+
+// Registers modules with intervals from 5 to 1000 ms on one process thread
+// and measures how much of the thread's time goes into scheduling rather than
+// into Process().
+TEST(ProcessThreadPerformanceTest, ThousandModules) {
+  std::unique_ptr<ProcessThread> thread =
+      ProcessThread::Create("ProcessThreadPerformanceTest");
+  std::vector<std::unique_ptr<PeriodicModule>> modules;
+  for (int i = 0; i < kNumModules; ++i) {
+    modules.emplace_back(new PeriodicModule(5 + (i * 37) % 996));
+    thread->RegisterModule(modules.back().get(), RTC_FROM_HERE);
+  }
+
+  int64_t start_ns = rtc::SystemTimeNanos();
+  int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+  thread->Start();
+  SleepMs(kRunTimeMs);
+  thread->Stop();
+  double cpu_ms =
+      static_cast<double>(rtc::GetProcessCpuTimeNanos() - start_cpu_ns) /
+      rtc::kNumNanosecsPerMillisec;
+  double elapsed_ms =
+      static_cast<double>(rtc::SystemTimeNanos() - start_ns) /
+      rtc::kNumNanosecsPerMillisec;
+
+  int process_calls = 0;
+  int time_until_next_process_calls = 0;
+  for (const auto& module : modules) {
+    process_calls += module->process_calls();
+    time_until_next_process_calls += module->time_until_next_process_calls();
+    thread->DeRegisterModule(module.get());
+  }
+  EXPECT_GT(process_calls, kNumModules);
+
+  test::PrintResult("process_thread", "", "process_calls",
+                    process_calls / elapsed_ms * 1000, "calls/s", false);
+  test::PrintResult("process_thread", "", "time_until_next_process_calls",
+                    time_until_next_process_calls / elapsed_ms * 1000,
+                    "calls/s", false);
+  test::PrintResult("process_thread", "", "cpu_per_process_call",
+                    cpu_ms * 1000 / process_calls, "us", false);
+}
+
+}  // namespace webrtc
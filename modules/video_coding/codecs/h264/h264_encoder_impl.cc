@@ -25,6 +25,7 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 #include "third_party/libyuv/include/libyuv/convert.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
@@ -35,6 +36,9 @@ namespace {
 
 const bool kOpenH264EncoderDetailedLogging = false;
 
+const char kH264MultiThreadingFieldTrial[] = "WebRTC-H264MultiThreadedEncoding";
+const char kH264ReuseEncoderFieldTrial[] = "WebRTC-H264ReuseEncoder";
+
 // QP scaling thresholds.
 static const int kLowH264QpThreshold = 24;
 static const int kHighH264QpThreshold = 37;
@@ -48,19 +52,19 @@ enum H264EncoderImplEvent {
 
 int NumberOfThreads(int width, int height, int number_of_cores) {
   // TODO(hbos): In Chromium, multiple threads do not work with sandbox on Mac,
-  // see crbug.com/583348. Until further investigated, only use one thread.
-  //  if (width * height >= 1920 * 1080 && number_of_cores > 8) {
-  //    return 8;  // 8 threads for 1080p on high perf machines.
-  //  } else if (width * height > 1280 * 960 && number_of_cores >= 6) {
-  //    return 3;  // 3 threads for 1080p.
-  //  } else if (width * height > 640 * 480 && number_of_cores >= 3) {
-  //    return 2;  // 2 threads for qHD/HD.
-  //  } else {
-  //    return 1;  // 1 thread for VGA or less.
-  //  }
-  // TODO(sprang): Also check sSliceArgument.uiSliceNum om GetEncoderPrams(),
-  //               before enabling multithreading here.
-  return 1;
+  // see crbug.com/583348. Until further investigated, only use more than one
+  // thread when explicitly enabled.
+  if (!field_trial::IsEnabled(kH264MultiThreadingFieldTrial))
+    return 1;
+  if (width * height >= 1920 * 1080 && number_of_cores > 8) {
+    return 8;  // 8 threads for 1080p on high perf machines.
+  } else if (width * height > 1280 * 960 && number_of_cores >= 6) {
+    return 3;  // 3 threads for 1080p.
+  } else if (width * height > 640 * 480 && number_of_cores >= 3) {
+    return 2;  // 2 threads for qHD/HD.
+  } else {
+    return 1;  // 1 thread for VGA or less.
+  }
 }
 
 FrameType ConvertToVideoFrameType(EVideoFrameType type) {
@@ -202,12 +206,6 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
   }
 
-  int32_t release_ret = Release();
-  if (release_ret != WEBRTC_VIDEO_CODEC_OK) {
-    ReportError();
-    return release_ret;
-  }
-
   int number_of_streams = SimulcastUtility::NumberOfSimulcastStreams(*inst);
   bool doing_simulcast = (number_of_streams > 1);
 
@@ -215,8 +213,31 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
                               *inst, number_of_streams) ||
                           !SimulcastUtility::ValidSimulcastTemporalLayers(
                               *inst, number_of_streams))) {
+    Release();
     return WEBRTC_VIDEO_CODEC_ERR_SIMULCAST_PARAMETERS_NOT_SUPPORTED;
   }
+
+  VideoCodec codec = *inst;
+  // Code expects simulcastStream resolutions to be correct, make sure they are
+  // filled even when there are no simulcast layers.
+  if (codec.numberOfSimulcastStreams == 0) {
+    codec.simulcastStream[0].width = codec.width;
+    codec.simulcastStream[0].height = codec.height;
+  }
+
+  // Recreating the encoders on every resolution change, e.g. when adapting to
+  // CPU load, reallocates all of their state and takes much longer than
+  // reconfiguring them in place.
+  const bool reuse_encoders =
+      CanReuseEncoders(codec, number_of_streams, number_of_cores,
+                       max_payload_size);
+  if (!reuse_encoders) {
+    int32_t release_ret = Release();
+    if (release_ret != WEBRTC_VIDEO_CODEC_OK) {
+      ReportError();
+      return release_ret;
+    }
+  }
   downscaled_buffers_.resize(number_of_streams - 1);
   encoded_images_.resize(number_of_streams);
   encoded_image_buffers_.resize(number_of_streams);
@@ -226,14 +247,7 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
 
   number_of_cores_ = number_of_cores;
   max_payload_size_ = max_payload_size;
-  codec_ = *inst;
-
-  // Code expects simulcastStream resolutions to be correct, make sure they are
-  // filled even when there are no simulcast layers.
-  if (codec_.numberOfSimulcastStreams == 0) {
-    codec_.simulcastStream[0].width = codec_.width;
-    codec_.simulcastStream[0].height = codec_.height;
-  }
+  codec_ = codec;
 
   for (int i = 0, idx = number_of_streams - 1; i < number_of_streams;
        ++i, --idx) {
@@ -242,25 +256,27 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
       Release();
       return WEBRTC_VIDEO_CODEC_ERR_SIMULCAST_PARAMETERS_NOT_SUPPORTED;
     }
-    ISVCEncoder* openh264_encoder;
-    // Create encoder.
-    if (WelsCreateSVCEncoder(&openh264_encoder) != 0) {
-      // Failed to create encoder.
-      RTC_LOG(LS_ERROR) << "Failed to create OpenH264 encoder";
-      RTC_DCHECK(!openh264_encoder);
-      Release();
-      ReportError();
-      return WEBRTC_VIDEO_CODEC_ERROR;
-    }
-    RTC_DCHECK(openh264_encoder);
-    if (kOpenH264EncoderDetailedLogging) {
-      int trace_level = WELS_LOG_DETAIL;
-      openh264_encoder->SetOption(ENCODER_OPTION_TRACE_LEVEL, &trace_level);
-    }
-    // else WELS_LOG_DEFAULT is used by default.
+    ISVCEncoder* openh264_encoder = encoders_[i];
+    if (!reuse_encoders) {
+      // Create encoder.
+      if (WelsCreateSVCEncoder(&openh264_encoder) != 0) {
+        // Failed to create encoder.
+        RTC_LOG(LS_ERROR) << "Failed to create OpenH264 encoder";
+        RTC_DCHECK(!openh264_encoder);
+        Release();
+        ReportError();
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+      RTC_DCHECK(openh264_encoder);
+      if (kOpenH264EncoderDetailedLogging) {
+        int trace_level = WELS_LOG_DETAIL;
+        openh264_encoder->SetOption(ENCODER_OPTION_TRACE_LEVEL, &trace_level);
+      }
+      // else WELS_LOG_DEFAULT is used by default.
 
-    // Store h264 encoder.
-    encoders_[i] = openh264_encoder;
+      // Store h264 encoder.
+      encoders_[i] = openh264_encoder;
+    }
 
     // Set internal settings from codec_settings
     configurations_[i].simulcast_idx = idx;
@@ -285,17 +301,32 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
 
     // Create encoder parameters based on the layer configuration.
     SEncParamExt encoder_params = CreateEncoderParams(i);
-
-    // Initialize.
-    if (openh264_encoder->InitializeExt(&encoder_params) != 0) {
-      RTC_LOG(LS_ERROR) << "Failed to initialize OpenH264 encoder";
-      Release();
-      ReportError();
-      return WEBRTC_VIDEO_CODEC_ERROR;
+    configurations_[i].num_threads = encoder_params.iMultipleThreadIdc;
+
+    if (reuse_encoders) {
+      // On a resolution change WelsEncoderParamAdjust() uninitializes and
+      // initializes the encoder again, threads included, and it starts over
+      // with an IDR frame. What is saved is destroying and creating the
+      // ISVCEncoder and setting its options again.
+      if (openh264_encoder->SetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT,
+                                      &encoder_params) != 0) {
+        RTC_LOG(LS_ERROR) << "Failed to reconfigure OpenH264 encoder";
+        Release();
+        ReportError();
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+    } else {
+      // Initialize.
+      if (openh264_encoder->InitializeExt(&encoder_params) != 0) {
+        RTC_LOG(LS_ERROR) << "Failed to initialize OpenH264 encoder";
+        Release();
+        ReportError();
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+      // TODO(pbos): Base init params on these values before submitting.
+      int video_format = EVideoFormatType::videoFormatI420;
+      openh264_encoder->SetOption(ENCODER_OPTION_DATAFORMAT, &video_format);
     }
-    // TODO(pbos): Base init params on these values before submitting.
-    int video_format = EVideoFormatType::videoFormatI420;
-    openh264_encoder->SetOption(ENCODER_OPTION_DATAFORMAT, &video_format);
 
     // Initialize encoded image. Default buffer size: size of unencoded data.
     encoded_images_[i]._size =
@@ -332,6 +363,30 @@ int32_t H264EncoderImpl::Release() {
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+bool H264EncoderImpl::CanReuseEncoders(const VideoCodec& codec,
+                                       int number_of_streams,
+                                       int32_t number_of_cores,
+                                       size_t max_payload_size) const {
+  if (encoders_.empty() ||
+      encoders_.size() != static_cast<size_t>(number_of_streams) ||
+      field_trial::IsDisabled(kH264ReuseEncoderFieldTrial)) {
+    return false;
+  }
+  // The usage type and slicing are fixed at initialization. So is the number
+  // of threads, which depends on the resolution.
+  if (codec.mode != codec_.mode || max_payload_size != max_payload_size_)
+    return false;
+  for (int i = 0, idx = number_of_streams - 1; i < number_of_streams;
+       ++i, --idx) {
+    if (NumberOfThreads(codec.simulcastStream[idx].width,
+                        codec.simulcastStream[idx].height,
+                        number_of_cores) != configurations_[i].num_threads) {
+      return false;
+    }
+  }
+  return true;
+}
+
 int32_t H264EncoderImpl::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   encoded_image_callback_ = callback;
@@ -597,11 +652,14 @@ SEncParamExt H264EncoderImpl::CreateEncoderParams(size_t i) const {
                     << max_payload_size_ << " bytes";
       break;
     case H264PacketizationMode::NonInterleaved:
-      // When uiSliceMode = SM_FIXEDSLCNUM_SLICE, uiSliceNum = 0 means auto
-      // design it with cpu core number.
-      // TODO(sprang): Set to 0 when we understand why the rate controller borks
-      //               when uiSliceNum > 1.
-      encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceNum = 1;
+      // One slice per thread, so that the threads encode the slices of a
+      // frame in parallel. uiSliceNum = 0 would have OpenH264 pick the number
+      // from the cpu core count instead of |number_of_cores_|.
+      // TODO(sprang): Rate control has been seen to misbehave with
+      //               uiSliceNum > 1. Check it before multithreading, and so
+      //               more than one slice, is enabled by default.
+      encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceNum =
+          encoder_params.iMultipleThreadIdc;
       encoder_params.sSpatialLayers[0].sSliceArgument.uiSliceMode =
           SM_FIXEDSLCNUM_SLICE;
       break;
@@ -39,6 +39,8 @@ class H264EncoderImpl : public H264Encoder {
     uint32_t max_bps = 0;
     bool frame_dropping_on = false;
     int key_frame_interval = 0;
+    // Threads the OpenH264 encoder was initialized with.
+    int num_threads = 1;
 
     void SetStreamState(bool send_stream);
   };
@@ -84,6 +86,12 @@ class H264EncoderImpl : public H264Encoder {
 
  private:
   SEncParamExt CreateEncoderParams(size_t i) const;
+  // Returns true if the current encoders can be reconfigured for |codec|
+  // instead of being recreated, i.e. if only resolutions and rates change.
+  bool CanReuseEncoders(const VideoCodec& codec,
+                        int number_of_streams,
+                        int32_t number_of_cores,
+                        size_t max_payload_size) const;
 
   webrtc::H264BitstreamParser h264_bitstream_parser_;
   // Reports statistics with histograms.
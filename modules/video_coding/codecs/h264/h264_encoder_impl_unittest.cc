@@ -11,6 +11,8 @@
 
 #include "modules/video_coding/codecs/h264/h264_encoder_impl.h"
 
+#include "api/video/i420_buffer.h"
+#include "test/field_trial.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -32,6 +34,45 @@ void SetDefaultSettings(VideoCodec* codec_settings) {
   codec_settings->maxBitrate = 4000;
 }
 
+// Keeps the type and size of the last encoded frame.
+class LastFrameCallback : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    ++num_frames_;
+    frame_type_ = encoded_image._frameType;
+    width_ = encoded_image._encodedWidth;
+    height_ = encoded_image._encodedHeight;
+    return Result(Result::OK);
+  }
+
+  int num_frames() const { return num_frames_; }
+  FrameType frame_type() const { return frame_type_; }
+  uint32_t width() const { return width_; }
+  uint32_t height() const { return height_; }
+
+ private:
+  int num_frames_ = 0;
+  FrameType frame_type_ = kEmptyFrame;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+};
+
+// Encodes a black frame of the size in |codec_settings|, without requesting
+// a key frame.
+void EncodeFrame(H264EncoderImpl* encoder,
+                 const VideoCodec& codec_settings,
+                 uint32_t rtp_timestamp) {
+  rtc::scoped_refptr<I420Buffer> buffer =
+      I420Buffer::Create(codec_settings.width, codec_settings.height);
+  I420Buffer::SetBlack(buffer);
+  VideoFrame frame(buffer, rtp_timestamp, 0, kVideoRotation_0);
+  std::vector<FrameType> frame_types = {kVideoFrameDelta};
+  ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder->Encode(frame, nullptr, &frame_types));
+}
+
 TEST(H264EncoderImplTest, CanInitializeWithDefaultParameters) {
   H264EncoderImpl encoder(cricket::VideoCodec("H264"));
   VideoCodec codec_settings;
@@ -78,6 +119,59 @@ TEST(H264EncoderImplTest, CanInitializeWithRemovedParameter) {
             encoder.PacketizationModeForTesting());
 }
 
+// Test that after every InitEncode(), whether the encoder is reused for the
+// new resolution or not, the next frame is an IDR frame of the new size.
+TEST(H264EncoderImplTest, CanReinitializeWithNewResolution) {
+  H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+  LastFrameCallback callback;
+  encoder.RegisterEncodeCompleteCallback(&callback);
+  VideoCodec codec_settings;
+  SetDefaultSettings(&codec_settings);
+  uint32_t rtp_timestamp = 0;
+  const int kNumDeltaFrames = 3;
+
+  auto init_and_expect_idr = [&]() {
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder.InitEncode(&codec_settings, kNumCores, kMaxPayloadSize));
+    const int num_frames = callback.num_frames();
+    EncodeFrame(&encoder, codec_settings, rtp_timestamp += 3000);
+    ASSERT_EQ(num_frames + 1, callback.num_frames());
+    EXPECT_EQ(kVideoFrameKey, callback.frame_type());
+    EXPECT_EQ(codec_settings.width, callback.width());
+    EXPECT_EQ(codec_settings.height, callback.height());
+    // Move past the IDR frame, so that the next InitEncode() must bring one.
+    for (int i = 0; i < kNumDeltaFrames; ++i)
+      EncodeFrame(&encoder, codec_settings, rtp_timestamp += 3000);
+    EXPECT_EQ(kVideoFrameDelta, callback.frame_type());
+  };
+
+  init_and_expect_idr();
+  codec_settings.width = 320;
+  codec_settings.height = 240;
+  init_and_expect_idr();
+  codec_settings.mode = VideoCodecMode::kScreensharing;
+  init_and_expect_idr();
+
+  encoder.Release();
+}
+
+TEST(H264EncoderImplTest, CanInitializeWithMultipleThreads) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-H264MultiThreadedEncoding/Enabled/");
+  H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+  VideoCodec codec_settings;
+  SetDefaultSettings(&codec_settings);
+  codec_settings.width = 1280;
+  codec_settings.height = 720;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings, 4, kMaxPayloadSize));
+  // Fewer threads at the lower resolution.
+  codec_settings.width = 640;
+  codec_settings.height = 360;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings, 4, kMaxPayloadSize));
+}
+
 }  // anonymous namespace
 
 }  // namespace webrtc
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+
+#include "media/base/mediaconstants.h"
+#include "modules/video_coding/codecs/h264/include/h264.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "test/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+#include "test/video_codec_settings.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kMaxPayloadSize = 1200;
+const int kWidth = 1280;
+const int kHeight = 720;
+// One step of CPU adaptation down from |kWidth| x |kHeight|.
+const int kAdaptedWidth = 960;
+const int kAdaptedHeight = 540;
+const int kBitrateKbps = 2500;
+const int kNumReconfigurations = 20;
+const int kFramesPerReconfiguration = 5;
+const int kNumThroughputFrames = 300;
+
+class CountingCallback : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    ++num_frames_;
+    return Result(Result::OK);
+  }
+
+  int num_frames() const { return num_frames_; }
+
+ private:
+  int num_frames_ = 0;
+};
+
+class H264EncoderPerformanceTest : public ::testing::Test {
+ protected:
+  H264EncoderPerformanceTest()
+      : encoder_(H264Encoder::Create(
+            cricket::VideoCodec(cricket::kH264CodecName))),
+        frame_generator_(test::FrameGenerator::CreateSquareGenerator(
+            kWidth,
+            kHeight,
+            absl::nullopt,
+            absl::nullopt)),
+        number_of_cores_(CpuInfo::DetectNumberOfCores()) {
+    encoder_->RegisterEncodeCompleteCallback(&callback_);
+  }
+
+  ~H264EncoderPerformanceTest() override { encoder_->Release(); }
+
+  void InitEncode(int width, int height) {
+    VideoCodec codec_settings;
+    test::CodecSettings(kVideoCodecH264, &codec_settings);
+    codec_settings.width = width;
+    codec_settings.height = height;
+    codec_settings.startBitrate = kBitrateKbps;
+    codec_settings.maxBitrate = kBitrateKbps;
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder_->InitEncode(&codec_settings, number_of_cores_,
+                                   kMaxPayloadSize));
+    frame_generator_->ChangeResolution(width, height);
+  }
+
+  void EncodeFrame() {
+    VideoFrame* frame = frame_generator_->NextFrame();
+    ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder_->Encode(*frame, nullptr, nullptr));
+  }
+
+  // Returns the average time it takes from InitEncode() with the new
+  // resolution until the first frame at it has been encoded.
+  double MeasureReconfigurationMs() {
+    InitEncode(kWidth, kHeight);
+    int64_t total_us = 0;
+    for (int i = 0; i < kNumReconfigurations; ++i) {
+      for (int j = 0; j < kFramesPerReconfiguration; ++j)
+        EncodeFrame();
+      bool adapted = i % 2 == 0;
+      int64_t start_us = rtc::TimeMicros();
+      InitEncode(adapted ? kAdaptedWidth : kWidth,
+                 adapted ? kAdaptedHeight : kHeight);
+      EncodeFrame();
+      total_us += rtc::TimeMicros() - start_us;
+    }
+    return static_cast<double>(total_us) / kNumReconfigurations /
+           rtc::kNumMicrosecsPerMillisec;
+  }
+
+  double MeasureEncodeFps() {
+    InitEncode(kWidth, kHeight);
+    int frames_before = callback_.num_frames();
+    int64_t start_us = rtc::TimeMicros();
+    for (int i = 0; i < kNumThroughputFrames; ++i)
+      EncodeFrame();
+    int64_t elapsed_us = rtc::TimeMicros() - start_us;
+    EXPECT_GT(callback_.num_frames(), frames_before);
+    return static_cast<double>(kNumThroughputFrames) *
+           rtc::kNumMicrosecsPerSec / elapsed_us;
+  }
+
+  CountingCallback callback_;
+  std::unique_ptr<VideoEncoder> encoder_;
+  std::unique_ptr<test::FrameGenerator> frame_generator_;
+  const int number_of_cores_;
+};
+
+}  // namespace
+
+// Measures the latency a resolution change from CPU adaptation adds, with the
+// encoder reconfigured in place and with it recreated.
+TEST_F(H264EncoderPerformanceTest, ReconfigurationLatency) {
+  double reuse_ms = MeasureReconfigurationMs();
+  test::PrintResult("h264_reconfiguration", "", "reuse_encoder", reuse_ms,
+                    "ms", false);
+  {
+    test::ScopedFieldTrials field_trials("WebRTC-H264ReuseEncoder/Disabled/");
+    double recreate_ms = MeasureReconfigurationMs();
+    test::PrintResult("h264_reconfiguration", "", "recreate_encoder",
+                      recreate_ms, "ms", false);
+  }
+}
+
+// Measures 720p encode throughput with one thread, and with the threads and
+// slices that |number_of_cores_| allows for.
+TEST_F(H264EncoderPerformanceTest, EncodeThroughput) {
+  test::PrintResult("h264_encode_720p", "", "single_thread",
+                    MeasureEncodeFps(), "fps", false);
+  {
+    test::ScopedFieldTrials field_trials(
+        "WebRTC-H264MultiThreadedEncoding/Enabled/");
+    test::PrintResult("h264_encode_720p", "",
+                      rtc::ToString(number_of_cores_) + "_cores",
+                      MeasureEncodeFps(), "fps", false);
+  }
+}
+
+}  // namespace webrtc
@@ -37,6 +37,13 @@ constexpr int kHighVp8QpThreshold = 95;
 constexpr int kTokenPartitions = VP8_ONE_TOKENPARTITION;
 constexpr uint32_t kVp832ByteAlign = 32u;
 
+// Range of the absolute cpu_speed that adaptive speed control moves the
+// encoder within, from the speed used for kComplexityHigher to the one used
+// for VGA on ARM. libvpx itself accepts up to 16.
+constexpr int kMinAdaptiveCpuSpeed = 4;
+constexpr int kMaxAdaptiveCpuSpeed = 12;
+constexpr int kMaxCpuSpeed = 16;
+
 // VP8 denoiser states.
 enum denoiserState {
   kDenoiserOff,
@@ -198,6 +205,7 @@ int LibvpxVp8Encoder::Release() {
   configurations_.clear();
   send_stream_.clear();
   cpu_speed_.clear();
+  speed_controller_.reset();
   while (!raw_images_.empty()) {
     vpx_img_free(&raw_images_.back());
     raw_images_.pop_back();
@@ -451,6 +459,10 @@ int LibvpxVp8Encoder::InitEncode(const VideoCodec* inst,
         SetCpuSpeed(inst->simulcastStream[number_of_streams - 1 - i].width,
                     inst->simulcastStream[number_of_streams - 1 - i].height);
   }
+  // The controller works on the speed of the top stream, the other streams
+  // follow it in steps of the same size.
+  speed_controller_ = EncoderSpeedController::CreateFromFieldTrial(
+      kMinAdaptiveCpuSpeed, kMaxAdaptiveCpuSpeed, -cpu_speed_[0]);
   configurations_[0].g_w = inst->width;
   configurations_[0].g_h = inst->height;
 
@@ -657,6 +669,20 @@ uint32_t LibvpxVp8Encoder::MaxIntraTarget(uint32_t optimalBuffersize) {
   return (targetPct < minIntraTh) ? minIntraTh : targetPct;
 }
 
+void LibvpxVp8Encoder::UpdateCpuSpeed(int64_t encode_time_us) {
+  absl::optional<int> speed =
+      speed_controller_->OnFrameEncoded(encode_time_us, codec_.maxFramerate);
+  if (!speed)
+    return;
+  // libvpx takes the speed as a negative number in real-time mode.
+  const int delta = *speed + cpu_speed_[0];
+  for (size_t i = 0; i < encoders_.size(); ++i) {
+    cpu_speed_[i] = -std::min(
+        std::max(-cpu_speed_[i] + delta, kMinAdaptiveCpuSpeed), kMaxCpuSpeed);
+    vpx_codec_control(&(encoders_[i]), VP8E_SET_CPUUSED, cpu_speed_[i]);
+  }
+}
+
 int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
                              const CodecSpecificInfo* codec_specific_info,
                              const std::vector<FrameType>* frame_types) {
@@ -793,8 +819,11 @@ int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
     ++num_tries;
     // Note we must pass 0 for |flags| field in encode call below since they are
     // set above in |vpx_codec_control| function for each encoder/spatial layer.
+    int64_t encode_start_us = rtc::TimeMicros();
     error = vpx_codec_encode(&encoders_[0], &raw_images_[0], timestamp_,
                              duration, 0, VPX_DL_REALTIME);
+    if (speed_controller_ && !send_key_frame && !error)
+      UpdateCpuSpeed(rtc::TimeMicros() - encode_start_us);
     // Reset specific intra frame thresholds, following the key frame.
     if (send_key_frame) {
       vpx_codec_control(&(encoders_[0]), VP8E_SET_MAX_INTRA_BITRATE_PCT,
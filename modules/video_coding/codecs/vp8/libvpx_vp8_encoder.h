@@ -21,6 +21,7 @@
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/codecs/vp8/temporal_layers.h"
 #include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/utility/encoder_speed_controller.h"
 
 #include "vpx/vp8cx.h"
 #include "vpx/vpx_encoder.h"
@@ -84,6 +85,10 @@ class LibvpxVp8Encoder : public VP8Encoder {
 
   uint32_t MaxIntraTarget(uint32_t optimal_buffer_size);
 
+  // Reports the time the last delta frame took to encode to
+  // |speed_controller_|, and applies the cpu_speed it asks for.
+  void UpdateCpuSpeed(int64_t encode_time_us);
+
   const bool use_gf_boost_;
   const bool prevent_kf_drop_;
 
@@ -100,6 +105,7 @@ class LibvpxVp8Encoder : public VP8Encoder {
   std::vector<bool> key_frame_request_;
   std::vector<bool> send_stream_;
   std::vector<int> cpu_speed_;
+  std::unique_ptr<EncoderSpeedController> speed_controller_;
   std::vector<vpx_image_t> raw_images_;
   std::vector<EncodedImage> encoded_images_;
   std::vector<vpx_codec_ctx_t> encoders_;
@@ -37,6 +37,9 @@ namespace webrtc {
 
 namespace {
 const float kMaxScreenSharingFramerateFps = 5.0f;
+// Real-time range of cpu_speed for adaptive speed control.
+const int kMinAdaptiveCpuSpeed = 5;
+const int kMaxAdaptiveCpuSpeed = 8;
 }
 
 // Only positive speeds, range for real-time coding currently is: 5 - 8.
@@ -131,6 +134,7 @@ int VP9EncoderImpl::Release() {
     vpx_img_free(raw_);
     raw_ = nullptr;
   }
+  speed_controller_.reset();
   inited_ = false;
   return ret_val;
 }
@@ -384,6 +388,8 @@ int VP9EncoderImpl::InitEncode(const VideoCodec* inst,
       NumberOfThreads(config_->g_w, config_->g_h, number_of_cores);
 
   cpu_speed_ = GetCpuSpeed(config_->g_w, config_->g_h);
+  speed_controller_ = EncoderSpeedController::CreateFromFieldTrial(
+      kMinAdaptiveCpuSpeed, kMaxAdaptiveCpuSpeed, cpu_speed_);
 
   // TODO(asapersson): Check configuration of temporal switch up and increase
   // pattern length.
@@ -680,8 +686,10 @@ int VP9EncoderImpl::Encode(const VideoFrame& input_image,
   }
 
   RTC_CHECK_GT(codec_.maxFramerate, 0);
-  uint32_t duration =
-      90000 / target_framerate_fps_.value_or(codec_.maxFramerate);
+  const float framerate_fps =
+      target_framerate_fps_.value_or(codec_.maxFramerate);
+  uint32_t duration = 90000 / framerate_fps;
+  const int64_t encode_start_us = rtc::TimeMicros();
   const vpx_codec_err_t rv = vpx_codec_encode(encoder_, raw_, timestamp_,
                                               duration, flags, VPX_DL_REALTIME);
   if (rv != VPX_CODEC_OK) {
@@ -693,6 +701,17 @@ int VP9EncoderImpl::Encode(const VideoFrame& input_image,
   }
   timestamp_ += duration;
 
+  // Key frames take longer to encode at any speed, so only delta frames are
+  // used to tune it.
+  if (speed_controller_ && !(flags & VPX_EFLAG_FORCE_KF)) {
+    absl::optional<int> speed = speed_controller_->OnFrameEncoded(
+        rtc::TimeMicros() - encode_start_us, framerate_fps);
+    if (speed) {
+      cpu_speed_ = *speed;
+      vpx_codec_control(encoder_, VP8E_SET_CPUUSED, cpu_speed_);
+    }
+  }
+
   const bool end_of_picture = true;
   DeliverBufferedFrame(end_of_picture);
 
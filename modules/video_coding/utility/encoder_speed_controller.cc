@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/encoder_speed_controller.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_cache.h"
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
+
+namespace webrtc {
+
+namespace {
+
+const char kFieldTrial[] = "WebRTC-VideoEncoderSpeedControl";
+
+// Well below the 85% at which OveruseFrameDetector adapts the resolution.
+const double kDefaultTargetLoad = 0.5;
+const double kMaxTargetLoad = 0.8;
+
+// The encode time is smoothed over roughly the last ten frames.
+const float kEncodeTimeAlpha = 0.9f;
+
+// A speed step changes the encode time by 10-25%, so slowing down only when
+// the load is this far below the target keeps the speed from oscillating.
+const double kSlowDownLoadRatio = 0.6;
+
+// Frames to encode at a new speed before changing it again. The encoder is
+// sped up quickly when over budget, but only slowed down when it's been well
+// under budget for a while.
+const int kMinFramesBeforeSpeedUp = 10;
+const int kMinFramesBeforeSlowDown = 60;
+
+struct SpeedControlTrial {
+  explicit SpeedControlTrial(const std::string& trial_string)
+      : enabled("Enabled"), target_load("target_load", kDefaultTargetLoad) {
+    ParseFieldTrial({&enabled, &target_load}, trial_string);
+  }
+
+  FieldTrialFlag enabled;
+  FieldTrialParameter<double> target_load;
+};
+
+SpeedControlTrial GetSpeedControlTrial() {
+  static FieldTrialCache<SpeedControlTrial>* const cache =
+      new FieldTrialCache<SpeedControlTrial>(kFieldTrial);
+  return cache->Get();
+}
+
+}  // namespace
+
+EncoderSpeedController::EncoderSpeedController(int min_speed,
+                                               int max_speed,
+                                               int initial_speed,
+                                               double target_load)
+    : min_speed_(min_speed),
+      max_speed_(max_speed),
+      target_load_(target_load),
+      speed_(std::min(std::max(initial_speed, min_speed), max_speed)),
+      encode_time_us_(kEncodeTimeAlpha) {
+  RTC_DCHECK_LE(min_speed_, max_speed_);
+  RTC_DCHECK_GT(target_load_, 0.0);
+}
+
+EncoderSpeedController::~EncoderSpeedController() = default;
+
+std::unique_ptr<EncoderSpeedController>
+EncoderSpeedController::CreateFromFieldTrial(int min_speed,
+                                             int max_speed,
+                                             int initial_speed) {
+  SpeedControlTrial trial = GetSpeedControlTrial();
+  if (!trial.enabled.Get())
+    return nullptr;
+  double target_load = trial.target_load.Get();
+  if (target_load <= 0.0 || target_load > kMaxTargetLoad) {
+    RTC_LOG(LS_WARNING) << "Invalid target_load " << target_load << " in "
+                        << kFieldTrial << ", using " << kDefaultTargetLoad;
+    target_load = kDefaultTargetLoad;
+  }
+  return absl::make_unique<EncoderSpeedController>(min_speed, max_speed,
+                                                   initial_speed, target_load);
+}
+
+absl::optional<int> EncoderSpeedController::OnFrameEncoded(
+    int64_t encode_time_us,
+    double framerate) {
+  if (framerate <= 0)
+    return absl::nullopt;
+  encode_time_us_.Apply(1.0f, static_cast<float>(encode_time_us));
+  load_ = encode_time_us_.filtered() * framerate / rtc::kNumMicrosecsPerSec;
+  ++frames_at_speed_;
+
+  if (load_ > target_load_ && speed_ < max_speed_ &&
+      frames_at_speed_ >= kMinFramesBeforeSpeedUp) {
+    SetSpeed(speed_ + 1);
+    return speed_;
+  }
+  if (load_ < target_load_ * kSlowDownLoadRatio && speed_ > min_speed_ &&
+      frames_at_speed_ >= kMinFramesBeforeSlowDown) {
+    SetSpeed(speed_ - 1);
+    return speed_;
+  }
+  return absl::nullopt;
+}
+
+void EncoderSpeedController::SetSpeed(int speed) {
+  RTC_LOG(LS_VERBOSE) << "Encoder speed " << speed_ << " -> " << speed
+                      << " at load " << load_;
+  speed_ = speed;
+  frames_at_speed_ = 0;
+  // Only the encode times at the new speed count from now on.
+  encode_time_us_.Reset(kEncodeTimeAlpha);
+}
+
+}  // namespace webrtc
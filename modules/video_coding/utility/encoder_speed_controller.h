@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_UTILITY_ENCODER_SPEED_CONTROLLER_H_
+#define MODULES_VIDEO_CODING_UTILITY_ENCODER_SPEED_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "rtc_base/numerics/exp_filter.h"
+
+namespace webrtc {
+
+// Tunes the speed setting of a software encoder, such as the libvpx
+// cpu_speed, from how long it takes to encode frames. The encoder is sped up
+// when encoding takes more than |target_load| of the frame interval, and
+// slowed down, for better quality, when it takes well below that.
+//
+// The target is kept below the load at which OveruseFrameDetector starts to
+// scale down the resolution, so that a stream first gives up encoder effort
+// and only has its resolution reduced once it runs at |max_speed|.
+//
+// Speeds are in the encoder's own units, higher being faster.
+class EncoderSpeedController {
+ public:
+  EncoderSpeedController(int min_speed,
+                         int max_speed,
+                         int initial_speed,
+                         double target_load);
+  ~EncoderSpeedController();
+
+  // Returns a controller configured by the "WebRTC-VideoEncoderSpeedControl"
+  // field trial, or null if the trial isn't enabled.
+  static std::unique_ptr<EncoderSpeedController> CreateFromFieldTrial(
+      int min_speed,
+      int max_speed,
+      int initial_speed);
+
+  // Reports the time it took to encode a delta frame at the current speed,
+  // with frames coming in at |framerate|. Returns the new speed if the
+  // encoder should change it.
+  absl::optional<int> OnFrameEncoded(int64_t encode_time_us,
+                                     double framerate);
+
+  int speed() const { return speed_; }
+
+  // Returns the share of the frame interval that encoding takes, as smoothed
+  // over the last frames.
+  double load() const { return load_; }
+
+ private:
+  void SetSpeed(int speed);
+
+  const int min_speed_;
+  const int max_speed_;
+  const double target_load_;
+  int speed_;
+  double load_ = 0.0;
+  int frames_at_speed_ = 0;
+  rtc::ExpFilter encode_time_us_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_UTILITY_ENCODER_SPEED_CONTROLLER_H_
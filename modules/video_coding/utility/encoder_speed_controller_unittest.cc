@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/encoder_speed_controller.h"
+
+#include <memory>
+
+#include "test/field_trial.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kMinSpeed = 5;
+const int kMaxSpeed = 8;
+const double kTargetLoad = 0.5;
+const double kFramerate = 30;
+// 50% of the frame interval at 30 fps.
+const int64_t kBudgetUs = 16667;
+
+// Encodes |num_frames| at a load of |load| times the budget at any speed, and
+// returns the speed the controller ends up at.
+int EncodeFrames(EncoderSpeedController* controller,
+                 int num_frames,
+                 double load) {
+  for (int i = 0; i < num_frames; ++i)
+    controller->OnFrameEncoded(static_cast<int64_t>(kBudgetUs * load),
+                               kFramerate);
+  return controller->speed();
+}
+
+}  // namespace
+
+TEST(EncoderSpeedControllerTest, KeepsSpeedWithinBudget) {
+  EncoderSpeedController controller(kMinSpeed, kMaxSpeed, 6, kTargetLoad);
+  EXPECT_EQ(6, EncodeFrames(&controller, 300, 0.8));
+  EXPECT_NEAR(0.8 * kTargetLoad, controller.load(), 0.01);
+}
+
+TEST(EncoderSpeedControllerTest, SpeedsUpWhenOverBudget) {
+  EncoderSpeedController controller(kMinSpeed, kMaxSpeed, 6, kTargetLoad);
+  // Not before a few frames have been measured.
+  EXPECT_EQ(6, EncodeFrames(&controller, 9, 1.5));
+  EXPECT_EQ(7, EncodeFrames(&controller, 1, 1.5));
+  EXPECT_EQ(8, EncodeFrames(&controller, 10, 1.5));
+  // Further overuse is left to resolution adaptation.
+  EXPECT_EQ(kMaxSpeed, EncodeFrames(&controller, 100, 1.5));
+}
+
+TEST(EncoderSpeedControllerTest, SlowsDownWhenWellUnderBudget) {
+  EncoderSpeedController controller(kMinSpeed, kMaxSpeed, 7, kTargetLoad);
+  EXPECT_EQ(7, EncodeFrames(&controller, 59, 0.3));
+  EXPECT_EQ(6, EncodeFrames(&controller, 1, 0.3));
+  EXPECT_EQ(kMinSpeed, EncodeFrames(&controller, 200, 0.3));
+}
+
+TEST(EncoderSpeedControllerTest, SettlesWhenSpeedChangesEncodeTime) {
+  EncoderSpeedController controller(kMinSpeed, kMaxSpeed, kMinSpeed,
+                                    kTargetLoad);
+  // Each speed step takes 20% off the encode time.
+  for (int i = 0; i < 1000; ++i) {
+    double load = 1.5;
+    for (int speed = kMinSpeed; speed < controller.speed(); ++speed)
+      load *= 0.8;
+    controller.OnFrameEncoded(static_cast<int64_t>(kBudgetUs * load),
+                              kFramerate);
+  }
+  // 1.5 * 0.8^2 = 0.96 is the first speed within budget.
+  EXPECT_EQ(kMinSpeed + 2, controller.speed());
+}
+
+TEST(EncoderSpeedControllerTest, ReportsChanges) {
+  EncoderSpeedController controller(kMinSpeed, kMaxSpeed, 6, kTargetLoad);
+  for (int i = 0; i < 9; ++i)
+    EXPECT_FALSE(controller.OnFrameEncoded(2 * kBudgetUs, kFramerate));
+  EXPECT_EQ(7, controller.OnFrameEncoded(2 * kBudgetUs, kFramerate));
+  EXPECT_FALSE(controller.OnFrameEncoded(2 * kBudgetUs, kFramerate));
+}
+
+TEST(EncoderSpeedControllerTest, DisabledWithoutFieldTrial) {
+  EXPECT_FALSE(
+      EncoderSpeedController::CreateFromFieldTrial(kMinSpeed, kMaxSpeed, 6));
+}
+
+TEST(EncoderSpeedControllerTest, ConfiguredByFieldTrial) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-VideoEncoderSpeedControl/Enabled,target_load:0.25/");
+  std::unique_ptr<EncoderSpeedController> controller =
+      EncoderSpeedController::CreateFromFieldTrial(kMinSpeed, kMaxSpeed, 6);
+  ASSERT_TRUE(controller);
+  // Within the default budget, but not within a quarter of the interval.
+  EXPECT_EQ(7, EncodeFrames(controller.get(), 10, 0.8));
+}
+
+}  // namespace webrtc
@@ -15,6 +15,7 @@
 #include "p2p/base/stun.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/thread.h"
 
 namespace cricket {
 
@@ -26,6 +27,8 @@ static const size_t kPacketLenOffset = 2;
 static const size_t kBufSize = kMaxPacketSize + kStunHeaderSize;
 static const size_t kTurnChannelDataHdrSize = 4;
 
+enum { MSG_FLUSH };
+
 inline bool IsStunMessage(uint16_t msg_type) {
   // The first two bits of a channel data message are 0b01.
   return (msg_type & 0xC000) ? false : true;
@@ -45,7 +48,8 @@ AsyncStunTCPSocket* AsyncStunTCPSocket::Create(
 }
 
 AsyncStunTCPSocket::AsyncStunTCPSocket(rtc::AsyncSocket* socket, bool listen)
-    : rtc::AsyncTCPSocketBase(socket, listen, kBufSize) {}
+    : rtc::AsyncTCPSocketBase(socket, listen, kBufSize),
+      thread_(rtc::Thread::Current()) {}
 
 int AsyncStunTCPSocket::Send(const void* pv,
                              size_t cb,
@@ -55,8 +59,9 @@ int AsyncStunTCPSocket::Send(const void* pv,
     return -1;
   }
 
-  // If we are blocking on send, then silently drop this packet
-  if (!IsOutBufferEmpty())
+  // If we are blocking on send, then silently drop this packet. Queued
+  // packets waiting for their flush do not count.
+  if (!IsOutBufferEmpty() && !flush_pending_)
     return static_cast<int>(cb);
 
   int pad_bytes;
@@ -66,12 +71,24 @@ int AsyncStunTCPSocket::Send(const void* pv,
   if (cb != expected_pkt_len)
     return -1;
 
+  RTC_DCHECK(pad_bytes < 4);
+  if (flush_pending_ && !OutBufferHasSpace(cb + pad_bytes))
+    return static_cast<int>(cb);
+
   AppendToOutBuffer(pv, cb);
 
-  RTC_DCHECK(pad_bytes < 4);
   char padding[4] = {0};
   AppendToOutBuffer(padding, pad_bytes);
 
+  if (write_coalescing_ && thread_) {
+    pending_packet_ids_.push_back(options.packet_id);
+    if (!flush_pending_) {
+      flush_pending_ = true;
+      thread_->Post(RTC_FROM_HERE, this, MSG_FLUSH);
+    }
+    return static_cast<int>(cb);
+  }
+
   int res = FlushOutBuffer();
   if (res <= 0) {
     // drop packet if we made no progress
@@ -86,6 +103,33 @@ int AsyncStunTCPSocket::Send(const void* pv,
   return static_cast<int>(cb);
 }
 
+void AsyncStunTCPSocket::OnMessage(rtc::Message* msg) {
+  RTC_DCHECK_EQ(MSG_FLUSH, msg->message_id);
+  FlushCoalescedPackets();
+}
+
+void AsyncStunTCPSocket::FlushCoalescedPackets() {
+  flush_pending_ = false;
+  std::vector<int64_t> packet_ids;
+  packet_ids.swap(pending_packet_ids_);
+  if (IsOutBufferEmpty())
+    return;
+
+  // The packets were reported as sent when queued, so they are not dropped
+  // if the socket blocks: what is left is written from OnWriteEvent, and
+  // until then Send() drops new packets like for a partial write.
+  int res = FlushOutBuffer();
+  if (res < 0 && !rtc::IsBlockingError(GetError())) {
+    ClearOutBuffer();
+    return;
+  }
+
+  const int64_t now = rtc::TimeMillis();
+  for (int64_t packet_id : packet_ids) {
+    SignalSentPacket(this, rtc::SentPacket(packet_id, now));
+  }
+}
+
 void AsyncStunTCPSocket::ProcessInput(char* data, size_t* len) {
   rtc::SocketAddress remote_addr(GetRemoteAddress());
   // STUN packet - First 4 bytes. Total header size is 20 bytes.
@@ -98,26 +142,32 @@ void AsyncStunTCPSocket::ProcessInput(char* data, size_t* len) {
   // |         Channel Number        |            Length             |
   // +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
+  // Signal the packets where they are, and move what is left of the last one
+  // to the front once.
+  size_t processed = 0;
   while (true) {
+    size_t remaining = *len - processed;
     // We need at least 4 bytes to read the STUN or ChannelData packet length.
-    if (*len < kPacketLenOffset + kPacketLenSize)
-      return;
+    if (remaining < kPacketLenOffset + kPacketLenSize)
+      break;
 
     int pad_bytes;
-    size_t expected_pkt_len = GetExpectedLength(data, *len, &pad_bytes);
+    size_t expected_pkt_len =
+        GetExpectedLength(data + processed, remaining, &pad_bytes);
     size_t actual_length = expected_pkt_len + pad_bytes;
 
-    if (*len < actual_length) {
-      return;
+    if (remaining < actual_length) {
+      break;
     }
 
-    SignalReadPacket(this, data, expected_pkt_len, remote_addr,
+    SignalReadPacket(this, data + processed, expected_pkt_len, remote_addr,
                      rtc::CreatePacketTime(0));
+    processed += actual_length;
+  }
 
-    *len -= actual_length;
-    if (*len > 0) {
-      memmove(data, data + actual_length, *len);
-    }
+  *len -= processed;
+  if (processed > 0 && *len > 0) {
+    memmove(data, data + processed, *len);
   }
 }
 
@@ -11,13 +11,20 @@
 #ifndef P2P_BASE_ASYNCSTUNTCPSOCKET_H_
 #define P2P_BASE_ASYNCSTUNTCPSOCKET_H_
 
+#include <stdint.h>
+
+#include <vector>
+
 #include "rtc_base/asynctcpsocket.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/messagehandler.h"
 #include "rtc_base/socketfactory.h"
+#include "rtc_base/thread.h"
 
 namespace cricket {
 
-class AsyncStunTCPSocket : public rtc::AsyncTCPSocketBase {
+class AsyncStunTCPSocket : public rtc::AsyncTCPSocketBase,
+                           public rtc::MessageHandler {
  public:
   // Binds and connects |socket| and creates AsyncTCPSocket for
   // it. Takes ownership of |socket|. Returns NULL if bind() or
@@ -28,18 +35,40 @@ class AsyncStunTCPSocket : public rtc::AsyncTCPSocketBase {
 
   AsyncStunTCPSocket(rtc::AsyncSocket* socket, bool listen);
 
+  // If enabled, packets are not written when they are sent, but once the
+  // current thread returns to its message loop, so that the packets sent in
+  // response to the same socket events go out with one system call and, over
+  // TLS, in one record. Packets are still dropped rather than buffered while
+  // the socket is blocked. Has no effect if the socket was created without a
+  // current thread. Defaults to false.
+  void SetWriteCoalescing(bool enable) { write_coalescing_ = enable; }
+
   int Send(const void* pv,
            size_t cb,
            const rtc::PacketOptions& options) override;
   void ProcessInput(char* data, size_t* len) override;
   void HandleIncomingConnection(rtc::AsyncSocket* socket) override;
 
+  // rtc::MessageHandler implementation, for coalesced writes.
+  void OnMessage(rtc::Message* msg) override;
+
  private:
   // This method returns the message hdr + length written in the header.
   // This method also returns the number of padding bytes needed/added to the
   // turn message. |pad_bytes| should be used only when |is_turn| is true.
   size_t GetExpectedLength(const void* data, size_t len, int* pad_bytes);
 
+  // Writes the packets queued since the last flush.
+  void FlushCoalescedPackets();
+
+  // The thread the socket was created on, which flushes are posted to.
+  rtc::Thread* const thread_;
+  bool write_coalescing_ = false;
+  // Whether a flush of queued packets is posted.
+  bool flush_pending_ = false;
+  // The packet ids of the queued packets, for SignalSentPacket.
+  std::vector<int64_t> pending_packet_ids_;
+
   RTC_DISALLOW_COPY_AND_ASSIGN(AsyncStunTCPSocket);
 };
 
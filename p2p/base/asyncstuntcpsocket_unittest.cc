@@ -274,4 +274,57 @@ TEST_F(AsyncStunTCPSocketTest, SignalSentPacketNotFiredWhenPacketNotSent) {
   EXPECT_EQ(0, sent_packets_);
 }
 
+// Test that with write coalescing, packets sent together are written when the
+// thread processes its messages, and arrive in order.
+TEST_F(AsyncStunTCPSocketTest, CoalescedPacketsSentOnFlush) {
+  send_socket_->SetWriteCoalescing(true);
+  rtc::PacketOptions options;
+  EXPECT_EQ(static_cast<int>(sizeof(kStunMessageWithZeroLength)),
+            send_socket_->Send(kStunMessageWithZeroLength,
+                               sizeof(kStunMessageWithZeroLength), options));
+  EXPECT_EQ(static_cast<int>(sizeof(kTurnChannelDataMessage)),
+            send_socket_->Send(kTurnChannelDataMessage,
+                               sizeof(kTurnChannelDataMessage), options));
+  EXPECT_EQ(static_cast<int>(sizeof(kTurnChannelDataMessageWithOddLength)),
+            send_socket_->Send(kTurnChannelDataMessageWithOddLength,
+                               sizeof(kTurnChannelDataMessageWithOddLength),
+                               options));
+  EXPECT_EQ(0, sent_packets_);
+
+  vss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(3, sent_packets_);
+  EXPECT_EQ(3u, recv_packets_.size());
+  EXPECT_TRUE(CheckData(kStunMessageWithZeroLength,
+                        sizeof(kStunMessageWithZeroLength)));
+  EXPECT_TRUE(
+      CheckData(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage)));
+  EXPECT_TRUE(CheckData(kTurnChannelDataMessageWithOddLength,
+                        sizeof(kTurnChannelDataMessageWithOddLength)));
+}
+
+// Test that coalesced packets are kept, not dropped, if the socket blocks
+// when they are flushed, and are written once it is writable again.
+TEST_F(AsyncStunTCPSocketTest, CoalescedPacketsKeptWhileBlocked) {
+  send_socket_->SetWriteCoalescing(true);
+  rtc::PacketOptions options;
+  send_socket_->Send(kStunMessageWithZeroLength,
+                     sizeof(kStunMessageWithZeroLength), options);
+  send_socket_->Send(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage),
+                     options);
+  // With no room in the send buffer, the flush gets EWOULDBLOCK.
+  vss_->set_send_buffer_capacity(0);
+  vss_->SetSendingBlocked(true);
+  vss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(0u, recv_packets_.size());
+
+  vss_->set_send_buffer_capacity(64 * 1024);
+  vss_->SetSendingBlocked(false);
+  vss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(2u, recv_packets_.size());
+  EXPECT_TRUE(CheckData(kStunMessageWithZeroLength,
+                        sizeof(kStunMessageWithZeroLength)));
+  EXPECT_TRUE(
+      CheckData(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage)));
+}
+
 }  // namespace cricket
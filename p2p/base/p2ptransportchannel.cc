@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <tuple>
 #include <utility>
 
 #include "api/candidate.h"
@@ -83,6 +84,50 @@ int CompareCandidatePairsByNetworkPreference(
   return a_and_b_equal;
 }
 
+// The values that P2PTransportChannel::CompareConnections() compares when
+// sorting, i.e. without a receiving threshold, except whether the port or
+// remote candidate was pruned, which is expensive to look up and only matters
+// for ties. The latency estimate breaks the remaining ties.
+struct ConnectionSortKey {
+  cricket::Connection* connection = nullptr;
+  bool writable = false;
+  int write_state = 0;
+  bool receiving = false;
+  bool writable_and_connected = false;
+  // Only set on the controlled side.
+  uint32_t remote_nomination = 0;
+  int64_t last_data_received = 0;
+  bool uses_preferred_network = false;
+  uint32_t network_cost = 0;
+  uint64_t priority = 0;
+  uint32_t generation = 0;
+  int rtt = 0;
+};
+
+// Returns a positive value if |a| is better than |b| up to the pruned state,
+// a negative value if |b| is better, and 0 if they are equal.
+int CompareConnectionSortKeys(const ConnectionSortKey& a,
+                              const ConnectionSortKey& b) {
+  // Greater values are better, except for those taken from |b| on the left.
+  auto a_values =
+      std::tie(a.writable, b.write_state, a.receiving, a.writable_and_connected,
+               a.remote_nomination, a.last_data_received,
+               a.uses_preferred_network, b.network_cost, a.priority,
+               a.generation);
+  auto b_values =
+      std::tie(b.writable, a.write_state, b.receiving, b.writable_and_connected,
+               b.remote_nomination, b.last_data_received,
+               b.uses_preferred_network, a.network_cost, b.priority,
+               b.generation);
+  if (a_values > b_values) {
+    return a_is_better;
+  }
+  if (a_values < b_values) {
+    return b_is_better;
+  }
+  return a_and_b_equal;
+}
+
 uint32_t GetWeakPingIntervalInFieldTrial() {
   uint32_t weak_ping_interval = ::strtoul(
       webrtc::field_trial::FindFullName("WebRTC-StunInterPacketDelay").c_str(),
@@ -179,7 +224,6 @@ void P2PTransportChannel::AddAllocatorSession(
 
 void P2PTransportChannel::AddConnection(Connection* connection) {
   connections_.push_back(connection);
-  unpinged_connections_.insert(connection);
   connection->set_remote_ice_mode(remote_ice_mode_);
   connection->set_receiving_timeout(config_.receiving_timeout);
   connection->set_unwritable_timeout(config_.ice_unwritable_timeout);
@@ -1519,6 +1563,65 @@ bool P2PTransportChannel::PresumedWritable(const Connection* conn) const {
            conn->remote_candidate().type() == PRFLX_PORT_TYPE));
 }
 
+void P2PTransportChannel::SortConnections() {
+  // The connections are usually still in order, or only a few of them have
+  // changed, so keep the order if it still holds and otherwise sort keys that
+  // are computed once per connection rather than once per comparison.
+  std::vector<ConnectionSortKey> keys(connections_.size());
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    Connection* conn = connections_[i];
+    ConnectionSortKey& key = keys[i];
+    key.connection = conn;
+    key.writable = conn->writable() || PresumedWritable(conn);
+    key.write_state = conn->write_state();
+    key.receiving = conn->receiving();
+    // Only makes a difference between connections in STATE_WRITABLE, since
+    // the write state is compared first.
+    key.writable_and_connected =
+        conn->write_state() == Connection::STATE_WRITABLE && conn->connected();
+    if (ice_role_ == ICEROLE_CONTROLLED) {
+      key.remote_nomination = conn->remote_nomination();
+      key.last_data_received = conn->last_data_received();
+    }
+    key.uses_preferred_network =
+        LocalCandidateUsesPreferredNetwork(conn, config_.network_preference);
+    key.network_cost = conn->ComputeNetworkCost();
+    key.priority = conn->priority();
+    key.generation =
+        conn->remote_candidate().generation() + conn->port()->generation();
+    key.rtt = conn->rtt();
+  }
+  auto is_better = [this](const ConnectionSortKey& a,
+                          const ConnectionSortKey& b) {
+    int cmp = CompareConnectionSortKeys(a, b);
+    if (cmp == a_and_b_equal) {
+      bool a_pruned = IsPortPruned(a.connection->port()) ||
+                      IsRemoteCandidatePruned(a.connection->remote_candidate());
+      bool b_pruned = IsPortPruned(b.connection->port()) ||
+                      IsRemoteCandidatePruned(b.connection->remote_candidate());
+      cmp = b_pruned - a_pruned;
+    }
+    if (cmp != a_and_b_equal) {
+      return cmp > 0;
+    }
+    return a.rtt < b.rtt;
+  };
+  if (std::is_sorted(keys.begin(), keys.end(), is_better)) {
+    return;
+  }
+  std::stable_sort(keys.begin(), keys.end(), is_better);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    connections_[i] = keys[i].connection;
+  }
+#if RTC_DCHECK_IS_ON
+  for (size_t i = 1; i < connections_.size(); ++i) {
+    RTC_DCHECK_GE(CompareConnections(connections_[i - 1], connections_[i],
+                                     absl::nullopt, nullptr),
+                  0);
+  }
+#endif
+}
+
 // Sort the available connections to find the best one.  We also monitor
 // the number of available connections and the current state.
 void P2PTransportChannel::SortConnectionsAndUpdateState(
@@ -1536,16 +1639,7 @@ void P2PTransportChannel::SortConnectionsAndUpdateState(
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  std::stable_sort(connections_.begin(), connections_.end(),
-                   [this](const Connection* a, const Connection* b) {
-                     int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
-                     if (cmp != 0) {
-                       return cmp > 0;
-                     }
-                     // Otherwise, sort based on latency estimate.
-                     return a->rtt() < b->rtt();
-                   });
+  SortConnections();
 
   RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
                       << " available connections";
@@ -1986,45 +2080,35 @@ Connection* P2PTransportChannel::FindNextPingableConnection() {
   }
 
   // Rule 4: Unpinged connections have priority over pinged ones.
-  RTC_CHECK(connections_.size() ==
-            pinged_connections_.size() + unpinged_connections_.size());
   // If there are unpinged and pingable connections, only ping those.
   // Otherwise, treat everything as unpinged.
-  // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
-  // "pinged" to filter out unpinged connections.
-  if (std::find_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-                   [this, now](Connection* conn) {
-                     return this->IsPingable(conn, now);
-                   }) == unpinged_connections_.end()) {
-    unpinged_connections_.insert(pinged_connections_.begin(),
-                                 pinged_connections_.end());
-    pinged_connections_.clear();
-  }
-
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<Connection*> pingable_connections;
-  std::copy_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-               std::back_inserter(pingable_connections),
-               [this, now](Connection* conn) { return IsPingable(conn, now); });
-  auto iter =
-      std::max_element(pingable_connections.begin(), pingable_connections.end(),
-                       [this](Connection* conn1, Connection* conn2) {
-                         // Some implementations of max_element compare an
-                         // element with itself.
-                         if (conn1 == conn2) {
-                           return false;
-                         }
-                         return MorePingable(conn1, conn2) == conn2;
-                       });
-  if (iter != pingable_connections.end()) {
-    return *iter;
+  // Among those, "more pingable" takes precedence. Both candidates are found in
+  // a single pass in sorted order, so that ties go to the better connection.
+  Connection* most_pingable_unpinged = nullptr;
+  Connection* most_pingable = nullptr;
+  for (Connection* conn : connections_) {
+    if (!IsPingable(conn, now)) {
+      continue;
+    }
+    if (!most_pingable || MorePingable(most_pingable, conn) == conn) {
+      most_pingable = conn;
+    }
+    if (pinged_connections_.count(conn) == 0 &&
+        (!most_pingable_unpinged ||
+         MorePingable(most_pingable_unpinged, conn) == conn)) {
+      most_pingable_unpinged = conn;
+    }
   }
-  return nullptr;
+  if (most_pingable_unpinged) {
+    return most_pingable_unpinged;
+  }
+  pinged_connections_.clear();
+  return most_pingable;
 }
 
 void P2PTransportChannel::MarkConnectionPinged(Connection* conn) {
-  if (conn && pinged_connections_.insert(conn).second) {
-    unpinged_connections_.erase(conn);
+  if (conn) {
+    pinged_connections_.insert(conn);
   }
 }
 
@@ -2128,7 +2212,6 @@ void P2PTransportChannel::OnConnectionDestroyed(Connection* connection) {
       std::find(connections_.begin(), connections_.end(), connection);
   RTC_DCHECK(iter != connections_.end());
   pinged_connections_.erase(*iter);
-  unpinged_connections_.erase(*iter);
   connections_.erase(iter);
 
   RTC_LOG(LS_INFO) << ToString() << ": Removed connection " << connection
@@ -2321,11 +2404,8 @@ Connection* P2PTransportChannel::MorePingable(Connection* conn1,
   }
 
   // During the initial state when nothing has been pinged yet, return the first
-  // one in the ordered |connections_|.
-  return *(std::find_if(connections_.begin(), connections_.end(),
-                        [conn1, conn2](Connection* conn) {
-                          return conn == conn1 || conn == conn2;
-                        }));
+  // one in the ordered |connections_|, which the caller passes as |conn1|.
+  return conn1;
 }
 
 void P2PTransportChannel::set_writable(bool writable) {
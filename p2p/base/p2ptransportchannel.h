@@ -25,6 +25,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "api/candidate.h"
@@ -230,6 +231,8 @@ class P2PTransportChannel : public IceTransportInternal {
 
   bool PresumedWritable(const cricket::Connection* conn) const;
 
+  // Sorts |connections_| by CompareConnections() and then latency.
+  void SortConnections();
   void SortConnectionsAndUpdateState(const std::string& reason_to_sort);
   void SwitchSelectedConnection(Connection* conn);
   void UpdateState();
@@ -320,7 +323,8 @@ class P2PTransportChannel : public IceTransportInternal {
 
   Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
   // Between |conn1| and |conn2|, this function returns the one which should
-  // be pinged first.
+  // be pinged first, or |conn1| if they are equally pingable. Callers pass the
+  // one that comes first in |connections_| as |conn1|.
   Connection* MorePingable(Connection* conn1, Connection* conn2);
   // Select the connection which is Relay/Relay. If both of them are,
   // UDP relay protocol takes precedence.
@@ -374,13 +378,11 @@ class P2PTransportChannel : public IceTransportInternal {
   std::vector<PortInterface*> pruned_ports_;
 
   // |connections_| is a sorted list with the first one always be the
-  // |selected_connection_| when it's not nullptr. The combination of
-  // |pinged_connections_| and |unpinged_connections_| has the same
-  // connections as |connections_|. These 2 sets maintain whether a
-  // connection should be pinged next or not.
+  // |selected_connection_| when it's not nullptr. |pinged_connections_| holds
+  // the connections of |connections_| that have been pinged in the current
+  // round; the others are pinged first.
   std::vector<Connection*> connections_;
-  std::set<Connection*> pinged_connections_;
-  std::set<Connection*> unpinged_connections_;
+  std::unordered_set<Connection*> pinged_connections_;
 
   Connection* selected_connection_ = nullptr;
 
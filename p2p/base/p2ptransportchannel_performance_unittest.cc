@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/fakeportallocator.h"
+#include "p2p/base/p2ptransportchannel.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const IceParameters kLocalIceParams("UFRAG0", "TESTICEPWD00000000000000", false);
+const IceParameters kRemoteIceParams("UFRAG1",
+                                     "TESTICEPWD00000000000001",
+                                     false);
+const int kPingRounds = 10;
+const int kRtt = 50;
+
+// Returns a distinct remote host candidate for each |index|, with priorities
+// increasing with |index|.
+Candidate RemoteCandidate(int index) {
+  Candidate c;
+  c.set_address(
+      rtc::SocketAddress(rtc::IPAddress(0x14000000 + index), 10000 + index));
+  c.set_component(ICE_CANDIDATE_COMPONENT_DEFAULT);
+  c.set_protocol(UDP_PROTOCOL_NAME);
+  c.set_priority(index + 1);
+  c.set_type(LOCAL_PORT_TYPE);
+  return c;
+}
+
+}  // namespace
+
+// The fake clock keeps the periodic tasks of the channel from running, so that
+// only the processing triggered by the test is measured (in wall-clock time).
+class P2PTransportChannelPerformanceTest : public testing::Test {
+ public:
+  P2PTransportChannelPerformanceTest()
+      : vss_(new rtc::VirtualSocketServer()),
+        thread_(vss_.get()),
+        allocator_(rtc::Thread::Current(), nullptr) {
+    clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+  }
+
+  // Creates a channel on the controlled side with |num_pairs| candidate pairs,
+  // none of which is writable yet.
+  void CreateChannel(int num_pairs) {
+    channel_ = absl::make_unique<P2PTransportChannel>("perf", 1, &allocator_);
+    channel_->SetIceRole(ICEROLE_CONTROLLED);
+    channel_->SetIceParameters(kLocalIceParams);
+    channel_->SetRemoteIceParameters(kRemoteIceParams);
+    channel_->MaybeStartGathering();
+    for (int i = 0; i < num_pairs; ++i) {
+      channel_->AddRemoteCandidate(RemoteCandidate(i));
+    }
+    ASSERT_EQ(static_cast<size_t>(num_pairs), channel_->connections().size());
+    rtc::Thread::Current()->ProcessMessages(0);
+  }
+
+  // Returns the average time in nanoseconds of choosing the next connection
+  // to ping, over |kPingRounds| rounds of the check list.
+  double MeasureFindNextPingableNs() {
+    const int num_checks =
+        kPingRounds * static_cast<int>(channel_->connections().size());
+    const int64_t start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < num_checks; ++i) {
+      Connection* conn = channel_->FindNextPingableConnection();
+      channel_->MarkConnectionPinged(conn);
+    }
+    const int64_t elapsed_ns = rtc::SystemTimeNanos() - start_ns;
+    return static_cast<double>(elapsed_ns) / num_checks;
+  }
+
+  // Returns the average time in nanoseconds of handling a pair becoming
+  // writable, including the re-sort of the pairs it triggers. The pairs become
+  // writable from the lowest to the highest priority, so that each moves to
+  // the front of the list.
+  double MeasureBecomeWritableNs() {
+    std::vector<Connection*> connections = channel_->connections();
+    const int64_t start_ns = rtc::SystemTimeNanos();
+    for (auto it = connections.rbegin(); it != connections.rend(); ++it) {
+      (*it)->ReceivedPingResponse(kRtt, "id");
+      rtc::Thread::Current()->ProcessMessages(0);
+    }
+    const int64_t elapsed_ns = rtc::SystemTimeNanos() - start_ns;
+    EXPECT_TRUE(channel_->connections().front()->writable());
+    return static_cast<double>(elapsed_ns) / connections.size();
+  }
+
+ protected:
+  rtc::ScopedFakeClock clock_;
+  std::unique_ptr<rtc::VirtualSocketServer> vss_;
+  rtc::AutoSocketServerThread thread_;
+  FakePortAllocator allocator_;
+  std::unique_ptr<P2PTransportChannel> channel_;
+};
+
+// Measures the per-check cost of the check list of a channel with many
+// candidate pairs, e.g. for multi-homed or dual-stack endpoints with TURN.
+TEST_F(P2PTransportChannelPerformanceTest, CheckList) {
+  for (int num_pairs : {100, 500}) {
+    CreateChannel(num_pairs);
+    const std::string trace = rtc::ToString(num_pairs) + "_pairs";
+    webrtc::test::PrintResult("p2p_find_next_pingable_connection", "", trace,
+                              MeasureFindNextPingableNs(), "ns", false);
+    webrtc::test::PrintResult("p2p_pair_becomes_writable", "", trace,
+                              MeasureBecomeWritableNs(), "ns", false);
+    channel_.reset();
+  }
+}
+
+}  // namespace cricket
@@ -3286,6 +3286,31 @@ TEST_F(P2PTransportChannelPingTest, TestTriggeredChecks) {
   EXPECT_EQ(conn1, FindNextPingableConnectionAndPingIt(&ch));
 }
 
+// Test that every pingable connection is pinged once, in sorted order when
+// they are equally pingable, before any is pinged again.
+TEST_F(P2PTransportChannelPingTest, TestPingRoundsInSortedOrder) {
+  FakePortAllocator pa(rtc::Thread::Current(), nullptr);
+  P2PTransportChannel ch("ping rounds", 1, &pa);
+  PrepareChannel(&ch);
+  ch.MaybeStartGathering();
+  ch.AddRemoteCandidate(CreateUdpCandidate(LOCAL_PORT_TYPE, "1.1.1.1", 1, 1));
+  ch.AddRemoteCandidate(CreateUdpCandidate(LOCAL_PORT_TYPE, "2.2.2.2", 2, 3));
+  ch.AddRemoteCandidate(CreateUdpCandidate(LOCAL_PORT_TYPE, "3.3.3.3", 3, 2));
+
+  Connection* conn1 = WaitForConnectionTo(&ch, "1.1.1.1", 1);
+  Connection* conn2 = WaitForConnectionTo(&ch, "2.2.2.2", 2);
+  Connection* conn3 = WaitForConnectionTo(&ch, "3.3.3.3", 3);
+  ASSERT_TRUE(conn1 != nullptr);
+  ASSERT_TRUE(conn2 != nullptr);
+  ASSERT_TRUE(conn3 != nullptr);
+
+  for (int round = 0; round < 2; ++round) {
+    EXPECT_EQ(conn2, FindNextPingableConnectionAndPingIt(&ch));
+    EXPECT_EQ(conn3, FindNextPingableConnectionAndPingIt(&ch));
+    EXPECT_EQ(conn1, FindNextPingableConnectionAndPingIt(&ch));
+  }
+}
+
 TEST_F(P2PTransportChannelPingTest, TestAllConnectionsPingedSufficiently) {
   FakePortAllocator pa(rtc::Thread::Current(), nullptr);
   P2PTransportChannel ch("ping sufficiently", 1, &pa);
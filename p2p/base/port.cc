@@ -131,6 +131,13 @@ rtc::PacketInfoProtocolType ConvertProtocolTypeToPacketInfoProtocolType(
   }
 }
 
+// Returns true if |addr| compares equal to other addresses by IP and port
+// alone, i.e. its IP is neither any nor unspecified (see
+// rtc::SocketAddress::EqualIPs).
+inline bool HasResolvedIp(const rtc::SocketAddress& addr) {
+  return !rtc::IPIsAny(addr.ipaddr()) && !rtc::IPIsUnspec(addr.ipaddr());
+}
+
 // We will restrict RTT estimates (when used for determining state) to be
 // within a reasonable range.
 const int MINIMUM_RTT = 100;    // 0.1 seconds
@@ -380,11 +387,24 @@ const std::vector<Candidate>& Port::Candidates() const {
 }
 
 Connection* Port::GetConnection(const rtc::SocketAddress& remote_addr) {
-  AddressMap::const_iterator iter = connections_.find(remote_addr);
-  if (iter != connections_.end())
-    return iter->second;
-  else
+  if (!HasResolvedIp(remote_addr)) {
+    AddressMap::const_iterator iter = connections_.find(remote_addr);
+    if (iter != connections_.end())
+      return iter->second;
+    else
+      return NULL;
+  }
+
+  if (last_connection_ &&
+      IpPortEqual()(last_connection_->remote_candidate().address(),
+                    remote_addr)) {
+    return last_connection_;
+  }
+  auto iter = connections_by_ip_port_.find(remote_addr);
+  if (iter == connections_by_ip_port_.end())
     return NULL;
+  last_connection_ = iter->second;
+  return last_connection_;
 }
 
 void Port::AddAddress(const rtc::SocketAddress& address,
@@ -450,6 +470,10 @@ void Port::AddOrReplaceConnection(Connection* conn) {
     ret.first->second->SignalDestroyed.disconnect(this);
     ret.first->second->Destroy();
     ret.first->second = conn;
+    last_connection_ = nullptr;
+  }
+  if (HasResolvedIp(conn->remote_candidate().address())) {
+    connections_by_ip_port_[conn->remote_candidate().address()] = conn;
   }
   conn->SignalDestroyed.connect(this, &Port::OnConnectionDestroyed);
   SignalConnectionCreated(this, conn);
@@ -567,7 +591,8 @@ bool Port::GetStunMessage(const char* data,
     }
 
     // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (!stun_msg->ValidateMessageIntegrity(data, size, password_)) {
+    if (!stun_msg->ValidateMessageIntegrity(data, size,
+                                            password_key_.Get(password_))) {
       RTC_LOG(LS_ERROR) << ToString()
                         << ": Received STUN request with bad M-I from "
                         << addr.ToSensitiveString()
@@ -775,7 +800,7 @@ void Port::SendBindingResponse(StunMessage* request,
 
   response.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
       STUN_ATTR_XOR_MAPPED_ADDRESS, addr));
-  response.AddMessageIntegrity(password_);
+  response.AddMessageIntegrity(password_key_.Get(password_));
   response.AddFingerprint();
 
   // Send the response message.
@@ -828,7 +853,7 @@ void Port::SendBindingErrorResponse(StunMessage* request,
   // because we don't have enough information to determine the shared secret.
   if (error_code != STUN_ERROR_BAD_REQUEST &&
       error_code != STUN_ERROR_UNAUTHORIZED)
-    response.AddMessageIntegrity(password_);
+    response.AddMessageIntegrity(password_key_.Get(password_));
   response.AddFingerprint();
 
   // Send the response message.
@@ -913,6 +938,12 @@ void Port::OnConnectionDestroyed(Connection* conn) {
       connections_.find(conn->remote_candidate().address());
   RTC_DCHECK(iter != connections_.end());
   connections_.erase(iter);
+  if (HasResolvedIp(conn->remote_candidate().address())) {
+    connections_by_ip_port_.erase(conn->remote_candidate().address());
+  }
+  if (last_connection_ == conn) {
+    last_connection_ = nullptr;
+  }
   HandleConnectionDestroyed(conn);
 
   // Ports time out after all connections fail if it is not marked as
@@ -1008,7 +1039,8 @@ class ConnectionRequest : public StunRequest {
         STUN_ATTR_PRIORITY, prflx_priority));
 
     // Adding Message Integrity attribute.
-    request->AddMessageIntegrity(connection_->remote_candidate().password());
+    request->AddMessageIntegrity(connection_->remote_password_key_.Get(
+        connection_->remote_candidate().password()));
     // Adding Fingerprint.
     request->AddFingerprint();
   }
@@ -1247,8 +1279,9 @@ void Connection::OnReadPacket(const char* data,
       // id's match.
       case STUN_BINDING_RESPONSE:
       case STUN_BINDING_ERROR_RESPONSE:
-        if (msg->ValidateMessageIntegrity(data, size,
-                                          remote_candidate().password())) {
+        if (msg->ValidateMessageIntegrity(
+                data, size,
+                remote_password_key_.Get(remote_candidate().password()))) {
           requests_.CheckResponse(msg.get());
         }
         // Otherwise silently discard the response message.
@@ -15,6 +15,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/types/optional.h"
@@ -291,6 +292,9 @@ class Port : public PortInterface,
   const AddressMap& connections() { return connections_; }
 
   // Returns the connection to the given address or NULL if none exists.
+  // Addresses with a resolved IP are looked up by IP and port only, through a
+  // hash index and a one-entry cache of the last connection found, since this
+  // is done for every packet received.
   Connection* GetConnection(const rtc::SocketAddress& remote_addr) override;
 
   // Called each time a connection is created.
@@ -470,8 +474,29 @@ class Port : public PortInterface,
   // username_fragment().
   std::string ice_username_fragment_;
   std::string password_;
+  // HMAC for MESSAGE-INTEGRITY with |password_|.
+  StunMessageIntegrityKey password_key_;
   std::vector<Candidate> candidates_;
   AddressMap connections_;
+  // Hash index over the entries of |connections_| whose remote address has a
+  // resolved IP, keyed by IP and port only. Entries whose IP is any or
+  // unspecified are compared by hostname and are only kept in |connections_|.
+  struct IpPortHash {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  struct IpPortEqual {
+    bool operator()(const rtc::SocketAddress& a,
+                    const rtc::SocketAddress& b) const {
+      return a.port() == b.port() && a.ipaddr() == b.ipaddr();
+    }
+  };
+  std::unordered_map<rtc::SocketAddress, Connection*, IpPortHash, IpPortEqual>
+      connections_by_ip_port_;
+  // The connection last returned from |connections_by_ip_port_|, if it still
+  // exists.
+  Connection* last_connection_ = nullptr;
   int timeout_delay_;
   bool enable_port_packets_;
   IceRole ice_role_;
@@ -787,6 +812,8 @@ class Connection : public CandidatePairInterface,
 
   IceMode remote_ice_mode_;
   StunRequestManager requests_;
+  // HMAC for MESSAGE-INTEGRITY with the remote candidate's password.
+  StunMessageIntegrityKey remote_password_key_;
   int rtt_;
   int rtt_samples_ = 0;
   // https://w3c.github.io/webrtc-stats/#dom-rtcicecandidatepairstats-totalroundtriptime
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "p2p/base/basicpacketsocketfactory.h"
+#include "p2p/base/stunport.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const rtc::SocketAddress kLocalAddr("10.0.0.1", 0);
+const int kNumLookups = 1000000;
+
+// Returns a distinct remote address for each |index|, as seen by an ICE-lite
+// server port with many remote candidates.
+rtc::SocketAddress RemoteAddress(int index) {
+  return rtc::SocketAddress(rtc::IPAddress(0x14000000 + index),
+                            10000 + index % 1000);
+}
+
+}  // namespace
+
+class PortPerformanceTest : public testing::Test {
+ public:
+  PortPerformanceTest()
+      : ss_(new rtc::VirtualSocketServer()),
+        thread_(ss_.get()),
+        network_("unittest", "unittest", kLocalAddr.ipaddr(), 32),
+        socket_factory_(rtc::Thread::Current()) {
+    network_.AddIP(kLocalAddr.ipaddr());
+  }
+
+  void CreatePortWithConnections(int num_connections) {
+    port_.reset(UDPPort::Create(rtc::Thread::Current(), &socket_factory_,
+                                &network_, 0, 0, "ufrag0123456789a",
+                                "password0123456789abcd", std::string(), false,
+                                absl::nullopt));
+    ASSERT_TRUE(port_);
+    for (int i = 0; i < num_connections; ++i) {
+      Candidate candidate(ICE_CANDIDATE_COMPONENT_RTP, UDP_PROTOCOL_NAME,
+                          RemoteAddress(i), 0, "", "", LOCAL_PORT_TYPE, 0, "");
+      ASSERT_TRUE(port_->CreateConnection(candidate, Port::ORIGIN_MESSAGE));
+    }
+  }
+
+  // Returns the average time in nanoseconds of looking up the connections for
+  // |remote_addrs|, visited round-robin.
+  double MeasureLookupNs(const std::vector<rtc::SocketAddress>& remote_addrs) {
+    int found = 0;
+    const int64_t start_ns = rtc::TimeNanos();
+    for (int i = 0; i < kNumLookups; ++i) {
+      if (port_->GetConnection(remote_addrs[i % remote_addrs.size()]))
+        ++found;
+    }
+    const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+    EXPECT_EQ(kNumLookups, found);
+    return static_cast<double>(elapsed_ns) / kNumLookups;
+  }
+
+ protected:
+  std::unique_ptr<rtc::VirtualSocketServer> ss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::Network network_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  std::unique_ptr<UDPPort> port_;
+};
+
+// Measures the per-packet cost of demultiplexing received packets to
+// connections on a port shared by many remote candidates.
+TEST_F(PortPerformanceTest, GetConnection) {
+  for (int num_connections : {10, 1000, 10000}) {
+    CreatePortWithConnections(num_connections);
+    std::vector<rtc::SocketAddress> interleaved;
+    for (int i = 0; i < num_connections; ++i)
+      interleaved.push_back(RemoteAddress(i));
+    const std::vector<rtc::SocketAddress> single(1, RemoteAddress(0));
+
+    const std::string trace = rtc::ToString(num_connections) + "_connections";
+    webrtc::test::PrintResult("port_get_connection", "_interleaved", trace,
+                              MeasureLookupNs(interleaved), "ns", false);
+    webrtc::test::PrintResult("port_get_connection", "_same_remote", trace,
+                              MeasureLookupNs(single), "ns", false);
+    port_.reset();
+  }
+}
+
+}  // namespace cricket
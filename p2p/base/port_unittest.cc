@@ -2945,4 +2945,30 @@ TEST_F(PortTest, TestAddConnectionWithSameAddress) {
   EXPECT_TRUE(port->GetConnection(address) != nullptr);
 }
 
+// Test that GetConnection finds connections by IP and port, and does not
+// return a connection (e.g. from its last-connection cache) once it has been
+// destroyed.
+TEST_F(PortTest, TestGetConnectionAfterConnectionDestroyed) {
+  std::unique_ptr<TestPort> port(
+      CreateTestPort(kLocalAddr1, "ufrag1", "password1"));
+  port->PrepareAddress();
+  rtc::SocketAddress address1("1.1.1.1", 5000);
+  rtc::SocketAddress address2("2.2.2.2", 5000);
+  cricket::Candidate candidate1(1, "udp", address1, 0, "", "", "local", 0, "");
+  cricket::Candidate candidate2(1, "udp", address2, 0, "", "", "local", 0, "");
+  cricket::Connection* conn1 =
+      port->CreateConnection(candidate1, Port::ORIGIN_MESSAGE);
+  cricket::Connection* conn2 =
+      port->CreateConnection(candidate2, Port::ORIGIN_MESSAGE);
+  EXPECT_EQ(conn1, port->GetConnection(address1));
+  EXPECT_EQ(conn2, port->GetConnection(address2));
+  EXPECT_EQ(conn2, port->GetConnection(rtc::SocketAddress("2.2.2.2", 5000)));
+  EXPECT_EQ(nullptr, port->GetConnection(rtc::SocketAddress("2.2.2.2", 5001)));
+
+  conn2->Destroy();
+  rtc::Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(nullptr, port->GetConnection(address2));
+  EXPECT_EQ(conn1, port->GetConnection(address1));
+}
+
 }  // namespace cricket
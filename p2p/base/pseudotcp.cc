@@ -14,8 +14,10 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "rtc_base/arraysize.h"
 #include "rtc_base/bytebuffer.h"
@@ -99,6 +101,10 @@ const uint32_t DEFAULT_SND_BUF_SIZE = 90 * 1024;
 // 24 |                             data                              |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //
+// When selective acknowledgements have been negotiated, Control holds the
+// number of SACK blocks in ACKs without data. The blocks follow the header,
+// each as the 32-bit left and right edges of a range received out of order.
+//
 //////////////////////////////////////////////////////////////////////
 
 #define PSEUDO_KEEPALIVE 0
@@ -123,6 +129,14 @@ const uint8_t TCP_OPT_EOL = 0;        // End of list.
 const uint8_t TCP_OPT_NOOP = 1;       // No-op.
 const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
 const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective acknowledgements.
+
+// The size of a SACK block in the header of an ACK: its left and right edges.
+const uint32_t SACK_BLOCK_SIZE = 8;
+
+// CUBIC (RFC 8312) multiplicative decrease factor and scaling constant.
+const double CUBIC_BETA = 0.7;
+const double CUBIC_C = 0.4;
 
 const long DEFAULT_TIMEOUT =
     4000;  // If there are no pending clocks, wake up every 4 seconds
@@ -246,6 +260,16 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
 
   m_dup_acks = 0;
   m_recover = 0;
+  m_congestion_control = CC_RENO;
+
+  m_cubic_wmax = m_cubic_origin = 0;
+  m_cubic_in_epoch = false;
+  m_cubic_epoch_start = m_cubic_k = 0;
+  m_cubic_reno_cwnd = 0;
+
+  m_sack_enabled = false;
+  m_sacked_bytes = m_high_sacked = m_high_rxt = 0;
+  m_last_rcv_seq = 0;
 
   m_ts_recent = m_ts_lastack = 0;
 
@@ -255,6 +279,7 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_use_nagling = true;
   m_ack_delay = DEF_ACK_DELAY;
   m_support_wnd_scale = true;
+  m_support_sack = true;
 }
 
 PseudoTcp::~PseudoTcp() {}
@@ -303,10 +328,8 @@ void PseudoTcp::NotifyClock(uint32_t now) {
         return;
       }
 
-      uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-      // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
-      // nInFlight << "  m_mss: " << m_mss;
+      ++m_recovery_stats.timeouts;
+      onCongestionEvent(m_snd_nxt - m_snd_una);
       m_cwnd = m_mss;
 
       // Back off retransmit timer.  Note: the limit is lower when connecting.
@@ -374,6 +397,8 @@ void PseudoTcp::GetOption(Option opt, int* value) {
     *value = m_sbuf_len;
   } else if (opt == OPT_RCVBUF) {
     *value = m_rbuf_len;
+  } else if (opt == OPT_CONGESTION_CONTROL) {
+    *value = m_congestion_control;
   } else {
     RTC_NOTREACHED();
   }
@@ -389,6 +414,10 @@ void PseudoTcp::SetOption(Option opt, int value) {
   } else if (opt == OPT_RCVBUF) {
     RTC_DCHECK(m_state == TCP_LISTEN);
     resizeReceiveBuffer(value);
+  } else if (opt == OPT_CONGESTION_CONTROL) {
+    RTC_DCHECK(value == CC_RENO || value == CC_CUBIC);
+    m_congestion_control = static_cast<CongestionControl>(value);
+    m_cubic_in_epoch = false;
   } else {
     RTC_NOTREACHED();
   }
@@ -522,6 +551,12 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
   long_to_bytes(seq, buffer.get() + 4);
   long_to_bytes(m_rcv_nxt, buffer.get() + 8);
   buffer[12] = 0;
+  // ACKs without data report the data received out of order.
+  uint32_t header_size = HEADER_SIZE;
+  if (len == 0 && m_sack_enabled && !m_rlist.empty()) {
+    buffer[12] = writeSackBlocks(buffer.get() + HEADER_SIZE);
+    header_size += buffer[12] * SACK_BLOCK_SIZE;
+  }
   buffer[13] = flags;
   short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale),
                  buffer.get() + 14);
@@ -550,7 +585,7 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif  // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char*>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer.get()), len + header_size);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value
   // for those, and thus we won't retry.  So go ahead and treat the packet as a
   // success (basically simulate as if it were dropped), which will prevent our
@@ -582,8 +617,20 @@ bool PseudoTcp::parse(const uint8_t* buffer, uint32_t size) {
   seg.tsval = bytes_to_long(buffer + 16);
   seg.tsecr = bytes_to_long(buffer + 20);
 
-  seg.data = reinterpret_cast<const char*>(buffer) + HEADER_SIZE;
-  seg.len = size - HEADER_SIZE;
+  seg.sack_count = buffer[12];
+  if (seg.sack_count > kMaxSackBlocks ||
+      size < HEADER_SIZE + seg.sack_count * SACK_BLOCK_SIZE) {
+    return false;
+  }
+  uint32_t header_size = HEADER_SIZE;
+  for (uint8_t i = 0; i < seg.sack_count; ++i) {
+    seg.sack[i].left = bytes_to_long(buffer + header_size);
+    seg.sack[i].right = bytes_to_long(buffer + header_size + 4);
+    header_size += SACK_BLOCK_SIZE;
+  }
+
+  seg.data = reinterpret_cast<const char*>(buffer) + header_size;
+  seg.len = size - header_size;
 
 #if _DEBUGMSG >= _DBG_VERBOSE
   RTC_LOG(LS_INFO) << "--> <CONV=" << seg.conv
@@ -705,6 +752,10 @@ bool PseudoTcp::process(Segment& seg) {
     m_ts_recent = seg.tsval;
   }
 
+  if (m_sack_enabled) {
+    applySack(seg);
+  }
+
   // Check if this is a valuable ack
   if ((seg.ack > m_snd_una) && (seg.ack <= m_snd_nxt)) {
     // Calculate round-trip time
@@ -744,22 +795,35 @@ bool PseudoTcp::process(Segment& seg) {
 
     for (uint32_t nFree = nAcked; nFree > 0;) {
       RTC_DCHECK(!m_slist.empty());
-      if (nFree < m_slist.front().len) {
-        m_slist.front().len -= nFree;
+      SSegment& front = m_slist.front();
+      if (nFree < front.len) {
+        if (front.bSacked) {
+          m_sacked_bytes -= nFree;
+        }
+        front.seq += nFree;
+        front.len -= nFree;
         nFree = 0;
       } else {
-        if (m_slist.front().len > m_largest) {
-          m_largest = m_slist.front().len;
+        if (front.len > m_largest) {
+          m_largest = front.len;
         }
-        nFree -= m_slist.front().len;
+        if (front.bSacked) {
+          m_sacked_bytes -= front.len;
+        }
+        nFree -= front.len;
         m_slist.pop_front();
       }
     }
+    if (m_snd_una >= m_high_sacked) {
+      RTC_DCHECK_EQ(0, m_sacked_bytes);
+      m_high_sacked = m_snd_una;
+    }
 
     if (m_dup_acks >= 3) {
       if (m_snd_una >= m_recover) {  // NewReno
         uint32_t nInFlight = m_snd_nxt - m_snd_una;
         m_cwnd = std::min(m_ssthresh, nInFlight + m_mss);  // (Fast Retransmit)
+        m_recovery_stats.cwnd_after_recovery = m_cwnd;
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "exit recovery";
 #endif  // _DEBUGMSG
@@ -768,20 +832,28 @@ bool PseudoTcp::process(Segment& seg) {
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
-          closedown(ECONNABORTED);
-          return false;
+        // With SACK, move on to the next hole once the first one has been
+        // retransmitted; otherwise retransmit the first unacknowledged segment.
+        SList::iterator seg = m_slist.begin();
+        bool from_sack = m_sack_enabled && seg->seq < m_high_rxt;
+        if (from_sack) {
+          seg = nextSackHole();
+        }
+        if (seg != m_slist.end()) {
+          if (!transmit(seg, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+          if (from_sack) {
+            ++m_recovery_stats.sack_retransmits;
+          }
+          m_high_rxt = std::max(m_high_rxt, seg->seq + seg->len);
         }
         m_cwnd += m_mss - std::min(nAcked, m_cwnd);
       }
     } else {
       m_dup_acks = 0;
-      // Slow start, congestion avoidance
-      if (m_cwnd < m_ssthresh) {
-        m_cwnd += m_mss;
-      } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
-      }
+      growCongestionWindow(now);
     }
   } else if (seg.ack == m_snd_una) {
     // !?! Note, tcp says don't do this... but otherwise how does a closed
@@ -798,18 +870,31 @@ bool PseudoTcp::process(Segment& seg) {
         RTC_LOG(LS_INFO) << "enter recovery";
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
+        SList::iterator seg = m_slist.begin();
+        if (!transmit(seg, now)) {
           closedown(ECONNABORTED);
           return false;
         }
+        m_high_rxt = seg->seq + seg->len;
         m_recover = m_snd_nxt;
-        uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-        // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
-        // << nInFlight << "  m_mss: " << m_mss;
+        ++m_recovery_stats.fast_retransmits;
+        onCongestionEvent(m_snd_nxt - m_snd_una);
         m_cwnd = m_ssthresh + 3 * m_mss;
       } else if (m_dup_acks > 3) {
-        m_cwnd += m_mss;
+        // Each further duplicate ACK means that a segment has left the
+        // network. With SACK its slot goes to the next hole, if any;
+        // otherwise the window is inflated to send new data.
+        SList::iterator seg = m_sack_enabled ? nextSackHole() : m_slist.end();
+        if (seg != m_slist.end()) {
+          if (!transmit(seg, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+          ++m_recovery_stats.sack_retransmits;
+          m_high_rxt = seg->seq + seg->len;
+        } else {
+          m_cwnd += m_mss;
+        }
       }
     } else {
       m_dup_acks = 0;
@@ -950,6 +1035,7 @@ bool PseudoTcp::process(Segment& seg) {
         RSegment rseg;
         rseg.seq = seg.seq;
         rseg.len = seg.len;
+        m_last_rcv_seq = seg.seq;
         RList::iterator it = m_rlist.begin();
         while ((it != m_rlist.end()) && (it->seq < rseg.seq)) {
           ++it;
@@ -1041,6 +1127,7 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
     SSegment subseg(seg->seq + nTransmit, seg->len - nTransmit, seg->bCtrl);
     // subseg.tstamp = seg->tstamp;
     subseg.xmit = seg->xmit;
+    subseg.bSacked = seg->bSacked;
     seg->len = nTransmit;
 
     SList::iterator next = seg;
@@ -1059,6 +1146,137 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
   return true;
 }
 
+uint8_t PseudoTcp::writeSackBlocks(uint8_t* buf) const {
+  // Merge the segments received out of order, which are sorted by sequence
+  // number but may overlap, into contiguous blocks.
+  std::vector<SackBlock> blocks;
+  for (const RSegment& rseg : m_rlist) {
+    if (!blocks.empty() && rseg.seq <= blocks.back().right) {
+      blocks.back().right = std::max(blocks.back().right, rseg.seq + rseg.len);
+    } else {
+      blocks.push_back({rseg.seq, rseg.seq + rseg.len});
+    }
+  }
+
+  // RFC 2018: the first block holds the segment received last, so that the
+  // sender learns about every segment even if only the first few blocks fit.
+  auto last = std::find_if(
+      blocks.begin(), blocks.end(), [this](const SackBlock& block) {
+        return block.left <= m_last_rcv_seq && m_last_rcv_seq < block.right;
+      });
+  if (last != blocks.end()) {
+    std::rotate(blocks.begin(), last, last + 1);
+  }
+
+  uint8_t count =
+      static_cast<uint8_t>(std::min<size_t>(blocks.size(), kMaxSackBlocks));
+  for (uint8_t i = 0; i < count; ++i) {
+    long_to_bytes(blocks[i].left, buf + i * SACK_BLOCK_SIZE);
+    long_to_bytes(blocks[i].right, buf + i * SACK_BLOCK_SIZE + 4);
+  }
+  return count;
+}
+
+void PseudoTcp::applySack(const Segment& seg) {
+  for (uint8_t i = 0; i < seg.sack_count; ++i) {
+    const SackBlock& block = seg.sack[i];
+    // Ignore blocks that are acknowledged already or were never sent.
+    if (block.left >= block.right || block.right <= m_snd_una ||
+        block.right > m_snd_nxt) {
+      continue;
+    }
+    for (SList::iterator it = m_slist.begin();
+         it != m_slist.end() && it->xmit > 0 && it->seq < block.right; ++it) {
+      if (!it->bSacked && it->seq >= block.left &&
+          it->seq + it->len <= block.right) {
+        it->bSacked = true;
+        m_sacked_bytes += it->len;
+        m_high_sacked = std::max(m_high_sacked, it->seq + it->len);
+      }
+    }
+  }
+}
+
+PseudoTcp::SList::iterator PseudoTcp::nextSackHole() {
+  for (SList::iterator it = m_slist.begin();
+       it != m_slist.end() && it->xmit > 0 && it->seq < m_high_sacked; ++it) {
+    if (!it->bSacked && it->seq >= m_high_rxt) {
+      return it;
+    }
+  }
+  return m_slist.end();
+}
+
+void PseudoTcp::onCongestionEvent(uint32_t nInFlight) {
+  m_recovery_stats.flight_at_last_loss = nInFlight;
+  if (m_congestion_control == CC_CUBIC) {
+    // Fast convergence: release bandwidth to new flows if the window did not
+    // get back to where it was at the previous loss.
+    if (nInFlight < m_cubic_wmax) {
+      m_cubic_wmax =
+          static_cast<uint32_t>(nInFlight * (1.0 + CUBIC_BETA) / 2.0);
+    } else {
+      m_cubic_wmax = nInFlight;
+    }
+    m_ssthresh = std::max(static_cast<uint32_t>(nInFlight * CUBIC_BETA),
+                          2 * m_mss);
+    m_cubic_in_epoch = false;
+  } else {
+    m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+  }
+  // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
+  // nInFlight << "  m_mss: " << m_mss;
+}
+
+void PseudoTcp::growCongestionWindow(uint32_t now) {
+  // Slow start
+  if (m_cwnd < m_ssthresh) {
+    m_cwnd += m_mss;
+    return;
+  }
+
+  // Congestion avoidance
+  if (m_congestion_control == CC_RENO) {
+    m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
+    return;
+  }
+
+  if (!m_cubic_in_epoch) {
+    m_cubic_in_epoch = true;
+    m_cubic_epoch_start = now;
+    if (m_cwnd < m_cubic_wmax) {
+      double segments = static_cast<double>(m_cubic_wmax - m_cwnd) / m_mss;
+      m_cubic_k = static_cast<uint32_t>(std::cbrt(segments / CUBIC_C) * 1000);
+      m_cubic_origin = m_cubic_wmax;
+    } else {
+      m_cubic_k = 0;
+      m_cubic_origin = m_cwnd;
+    }
+    m_cubic_reno_cwnd = m_cwnd;
+  }
+
+  // The window one round trip from now: W(t) = C * (t - K)^3 + W_max.
+  double t = (static_cast<double>(rtc::TimeDiff32(now, m_cubic_epoch_start)) +
+              m_rx_srtt - m_cubic_k) /
+             1000.0;
+  double target = m_cubic_origin + CUBIC_C * t * t * t * m_mss;
+
+  // Never grow slower than Reno would with the same decrease factor.
+  m_cubic_reno_cwnd += std::max<uint32_t>(
+      1, static_cast<uint32_t>(3.0 * (1.0 - CUBIC_BETA) / (1.0 + CUBIC_BETA) *
+                               m_mss * m_mss / m_cubic_reno_cwnd));
+  target = std::max(target, static_cast<double>(m_cubic_reno_cwnd));
+
+  if (target > m_cwnd) {
+    // Grow by (target - cwnd) / cwnd segments per ACK, but by at most half a
+    // segment, i.e. 1.5 times per round trip.
+    double growth = std::min((target - m_cwnd) * m_mss / m_cwnd, m_mss / 2.0);
+    m_cwnd += std::max<uint32_t>(1, static_cast<uint32_t>(growth));
+  } else {
+    m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / (100 * m_cwnd));
+  }
+}
+
 void PseudoTcp::attemptSend(SendFlags sflags) {
   uint32_t now = Now();
 
@@ -1190,6 +1408,10 @@ void PseudoTcp::disableWindowScale() {
   m_support_wnd_scale = false;
 }
 
+void PseudoTcp::disableSack() {
+  m_support_sack = false;
+}
+
 void PseudoTcp::queueConnectMessage() {
   rtc::ByteBufferWriter buf(rtc::ByteBuffer::ORDER_NETWORK);
 
@@ -1199,6 +1421,10 @@ void PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1247,6 +1473,10 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
       m_swnd_scale = 0;
     }
   }
+
+  // http://www.ietf.org/rfc/rfc2018.txt
+  m_sack_enabled = m_support_sack &&
+                   options_specified.count(TCP_OPT_SACK_PERMITTED) > 0;
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
@@ -87,16 +87,25 @@ class PseudoTcp {
   // If an unrecognized option is set or got, an assertion will fire.
   //
   // Setting options for OPT_RCVBUF or OPT_SNDBUF after Connect() is called
-  // will result in an assertion.
+  // will result in an assertion. Receive buffers larger than 64 KB are
+  // advertised with window scaling, if the peer supports it.
   enum Option {
-    OPT_NODELAY,   // Whether to enable Nagle's algorithm (0 == off)
-    OPT_ACKDELAY,  // The Delayed ACK timeout (0 == off).
-    OPT_RCVBUF,    // Set the receive buffer size, in bytes.
-    OPT_SNDBUF,    // Set the send buffer size, in bytes.
+    OPT_NODELAY,             // Whether to enable Nagle's algorithm (0 == off)
+    OPT_ACKDELAY,            // The Delayed ACK timeout (0 == off).
+    OPT_RCVBUF,              // Set the receive buffer size, in bytes.
+    OPT_SNDBUF,              // Set the send buffer size, in bytes.
+    OPT_CONGESTION_CONTROL,  // A CongestionControl value (CC_RENO default).
   };
   void GetOption(Option opt, int* value);
   void SetOption(Option opt, int value);
 
+  enum CongestionControl {
+    CC_RENO,   // NewReno (RFC 6582).
+    // CUBIC (RFC 8312), which grows the window faster on paths with a large
+    // bandwidth-delay product.
+    CC_CUBIC,
+  };
+
   // Returns current congestion window in bytes.
   uint32_t GetCongestionWindow() const;
 
@@ -114,6 +123,14 @@ class PseudoTcp {
  protected:
   enum SendFlags { sfNone, sfDelayedAck, sfImmediateAck };
 
+  // The maximum number of SACK blocks in an ACK.
+  static const uint8_t kMaxSackBlocks = 4;
+
+  // A range of sequence numbers that has been received out of order.
+  struct SackBlock {
+    uint32_t left, right;
+  };
+
   struct Segment {
     uint32_t conv, seq, ack;
     uint8_t flags;
@@ -121,15 +138,19 @@ class PseudoTcp {
     const char* data;
     uint32_t len;
     uint32_t tsval, tsecr;
+    uint8_t sack_count;
+    SackBlock sack[kMaxSackBlocks];
   };
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c), bSacked(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Whether the peer has selectively acknowledged the segment.
+    bool bSacked;
   };
   typedef std::list<SSegment> SList;
 
@@ -162,6 +183,22 @@ class PseudoTcp {
   bool process(Segment& seg);
   bool transmit(const SList::iterator& seg, uint32_t now);
 
+  // Writes the SACK blocks of the data received out of order to |buf|, with
+  // room for kMaxSackBlocks, and returns their number.
+  uint8_t writeSackBlocks(uint8_t* buf) const;
+  // Marks the segments covered by the SACK blocks of |seg| as received.
+  void applySack(const Segment& seg);
+  // Returns the next segment to retransmit in loss recovery: a segment that
+  // was sent before a selectively acknowledged one, but is not acknowledged
+  // and has not been retransmitted yet in this recovery.
+  SList::iterator nextSackHole();
+
+  // Updates the slow start threshold when a loss is detected with |nInFlight|
+  // bytes in flight.
+  void onCongestionEvent(uint32_t nInFlight);
+  // Grows the congestion window when new data is acknowledged.
+  void growCongestionWindow(uint32_t now);
+
   void adjustMTU();
 
  protected:
@@ -172,6 +209,25 @@ class PseudoTcp {
   // support for testing backward compatibility.
   void disableWindowScale();
 
+  // This method is only used in tests, to disable selective acknowledgements.
+  void disableSack();
+
+  // Loss recovery statistics, only used in tests.
+  struct RecoveryStats {
+    // Retransmission timeouts.
+    uint32_t timeouts = 0;
+    // Losses detected by three duplicate ACKs.
+    uint32_t fast_retransmits = 0;
+    // Further holes retransmitted from the SACK scoreboard in recovery.
+    uint32_t sack_retransmits = 0;
+    // Bytes in flight when the last loss was detected.
+    uint32_t flight_at_last_loss = 0;
+    // Congestion window when the last fast recovery ended.
+    uint32_t cwnd_after_recovery = 0;
+  };
+  const RecoveryStats& recoveryStats() const { return m_recovery_stats; }
+  uint32_t slowStartThreshold() const { return m_ssthresh; }
+
  private:
   // Queue the connect message with TCP options.
   void queueConnectMessage();
@@ -231,6 +287,26 @@ class PseudoTcp {
   uint8_t m_dup_acks;
   uint32_t m_recover;
   uint32_t m_t_ack;
+  CongestionControl m_congestion_control;
+
+  // CUBIC state: the window before the last reduction, the start of the
+  // current congestion avoidance epoch, the time (in ms from its start) at
+  // which the window gets back to |m_cubic_origin|, and the window of an
+  // equivalent Reno flow.
+  uint32_t m_cubic_wmax, m_cubic_origin;
+  bool m_cubic_in_epoch;
+  uint32_t m_cubic_epoch_start, m_cubic_k;
+  uint32_t m_cubic_reno_cwnd;
+
+  // Selective acknowledgements (RFC 2018), which are used when both sides
+  // support them: the bytes in |m_slist| selectively acknowledged, the end
+  // of the highest segment selectively acknowledged and the end of the
+  // highest hole retransmitted in the current recovery.
+  bool m_sack_enabled;
+  uint32_t m_sacked_bytes, m_high_sacked, m_high_rxt;
+  // Start of the segment last received out of order, which goes first in the
+  // SACK blocks.
+  uint32_t m_last_rcv_seq;
 
   // Configuration options
   bool m_use_nagling;
@@ -239,6 +315,10 @@ class PseudoTcp {
   // This is used by unit tests to test backward compatibility of
   // PseudoTcp implementations that don't support window scaling.
   bool m_support_wnd_scale;
+  // Likewise for selective acknowledgements.
+  bool m_support_sack;
+
+  RecoveryStats m_recovery_stats;
 };
 
 }  // namespace cricket
@@ -0,0 +1,231 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "p2p/base/basicpacketsocketfactory.h"
+#include "p2p/base/pseudotcp.h"
+#include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/messagehandler.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const rtc::SocketAddress kSenderAddr("11.11.11.11", 5000);
+const rtc::SocketAddress kReceiverAddr("22.22.22.22", 5000);
+const int kMtu = 1500;
+const size_t kTransferSize = 8 * 1024 * 1024;
+const int kLargeBufferSize = 1024 * 1024;
+// Transfers that have not completed after this much simulated time fail.
+const int64_t kTimeoutMs = 600 * 1000;
+
+struct Config {
+  const char* name;
+  // 0 for the default buffer sizes.
+  int buffer_size;
+  bool sack;
+  PseudoTcp::CongestionControl congestion_control;
+};
+
+const Config kConfigs[] = {
+    {"_default_buffers", 0, true, PseudoTcp::CC_RENO},
+    {"_reno", kLargeBufferSize, false, PseudoTcp::CC_RENO},
+    {"_reno_sack", kLargeBufferSize, true, PseudoTcp::CC_RENO},
+    {"_cubic_sack", kLargeBufferSize, true, PseudoTcp::CC_CUBIC},
+};
+
+class PseudoTcpForTest : public PseudoTcp {
+ public:
+  PseudoTcpForTest(IPseudoTcpNotify* notify, uint32_t conv)
+      : PseudoTcp(notify, conv) {}
+
+  void disableSack() { PseudoTcp::disableSack(); }
+};
+
+// A PseudoTcp endpoint that sends its packets over a UDP socket, and writes or
+// reads a number of bytes as fast as the connection allows.
+class PseudoTcpEndpoint : public IPseudoTcpNotify,
+                          public rtc::MessageHandler,
+                          public sigslot::has_slots<> {
+ public:
+  PseudoTcpEndpoint(rtc::AsyncPacketSocket* socket,
+                    const rtc::SocketAddress& remote_addr,
+                    const Config& config)
+      : socket_(socket), remote_addr_(remote_addr), tcp_(this, 1) {
+    socket_->SignalReadPacket.connect(this, &PseudoTcpEndpoint::OnReadPacket);
+    tcp_.NotifyMTU(kMtu);
+    if (config.buffer_size) {
+      tcp_.SetOption(PseudoTcp::OPT_RCVBUF, config.buffer_size);
+      tcp_.SetOption(PseudoTcp::OPT_SNDBUF, config.buffer_size);
+    }
+    if (!config.sack) {
+      tcp_.disableSack();
+    }
+    tcp_.SetOption(PseudoTcp::OPT_CONGESTION_CONTROL,
+                   config.congestion_control);
+  }
+  ~PseudoTcpEndpoint() override { rtc::Thread::Current()->Clear(this); }
+
+  size_t bytes_received() const { return bytes_received_; }
+
+  void Connect() {
+    tcp_.Connect();
+    UpdateClock();
+  }
+
+  void Send(size_t size) { bytes_to_send_ = size; }
+
+  // IPseudoTcpNotify implementation.
+  void OnTcpOpen(PseudoTcp* tcp) override { WriteData(); }
+  void OnTcpReadable(PseudoTcp* tcp) override {
+    char buffer[4096];
+    int received;
+    while ((received = tcp_.Recv(buffer, sizeof(buffer))) > 0) {
+      bytes_received_ += received;
+    }
+  }
+  void OnTcpWriteable(PseudoTcp* tcp) override { WriteData(); }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {
+    ADD_FAILURE() << "Connection closed with error " << error;
+  }
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    // Packets dropped by the network still count as sent.
+    return socket_->SendTo(buffer, len, remote_addr_, rtc::PacketOptions()) < 0
+               ? WR_FAIL
+               : WR_SUCCESS;
+  }
+
+  // rtc::MessageHandler implementation, for the clock.
+  void OnMessage(rtc::Message* message) override {
+    tcp_.NotifyClock(PseudoTcp::Now());
+    UpdateClock();
+  }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time) {
+    tcp_.NotifyPacket(data, size);
+    UpdateClock();
+  }
+
+  void UpdateClock() {
+    long interval = 0;  // NOLINT
+    if (!tcp_.GetNextClock(PseudoTcp::Now(), interval))
+      return;
+    rtc::Thread::Current()->Clear(this);
+    rtc::Thread::Current()->PostDelayed(RTC_FROM_HERE,
+                                        std::max<long>(interval, 0L), this);
+  }
+
+  void WriteData() {
+    static const char kData[4096] = {0};
+    while (bytes_sent_ < bytes_to_send_) {
+      int sent = tcp_.Send(
+          kData, std::min(sizeof(kData), bytes_to_send_ - bytes_sent_));
+      if (sent <= 0)
+        break;
+      bytes_sent_ += sent;
+    }
+  }
+
+  rtc::AsyncPacketSocket* const socket_;
+  const rtc::SocketAddress remote_addr_;
+  PseudoTcpForTest tcp_;
+  size_t bytes_to_send_ = 0;
+  size_t bytes_sent_ = 0;
+  size_t bytes_received_ = 0;
+};
+
+}  // namespace
+
+class PseudoTcpPerformanceTest : public testing::Test {
+ public:
+  PseudoTcpPerformanceTest()
+      : ss_(&fake_clock_),
+        thread_(&ss_),
+        socket_factory_(rtc::Thread::Current()) {
+    // Use the same loss pattern for every configuration.
+    srand(1);
+  }
+
+  // Transfers kTransferSize bytes over a path with |rtt_ms| of round-trip time
+  // and |loss_percent| of random loss in both directions, and returns the
+  // throughput in kbps of simulated time.
+  double MeasureThroughputKbps(const Config& config,
+                               int rtt_ms,
+                               int loss_percent) {
+    ss_.set_delay_mean(rtt_ms / 2);
+    ss_.UpdateDelayDistribution();
+    ss_.set_drop_probability(loss_percent / 100.0);
+
+    std::unique_ptr<rtc::AsyncPacketSocket> sender_socket(
+        socket_factory_.CreateUdpSocket(kSenderAddr, 0, 0));
+    std::unique_ptr<rtc::AsyncPacketSocket> receiver_socket(
+        socket_factory_.CreateUdpSocket(kReceiverAddr, 0, 0));
+    PseudoTcpEndpoint sender(sender_socket.get(), kReceiverAddr, config);
+    PseudoTcpEndpoint receiver(receiver_socket.get(), kSenderAddr, config);
+
+    const int64_t start_ms = rtc::TimeMillis();
+    sender.Send(kTransferSize);
+    sender.Connect();
+    while (receiver.bytes_received() < kTransferSize &&
+           rtc::TimeMillis() - start_ms < kTimeoutMs) {
+      fake_clock_.AdvanceTime(webrtc::TimeDelta::ms(1));
+    }
+    const int64_t elapsed_ms = rtc::TimeMillis() - start_ms;
+    EXPECT_EQ(kTransferSize, receiver.bytes_received());
+    return receiver.bytes_received() * 8.0 / elapsed_ms;
+  }
+
+ protected:
+  rtc::ScopedFakeClock fake_clock_;
+  rtc::VirtualSocketServer ss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+};
+
+// Measures the bulk transfer throughput over paths with a range of round-trip
+// times and random loss rates, with the default buffers, and with buffers large
+// enough for window scaling combined with each loss recovery and congestion
+// control.
+TEST_F(PseudoTcpPerformanceTest, Throughput) {
+  for (int rtt_ms : {10, 50, 200}) {
+    for (int loss_percent : {0, 1, 3}) {
+      const std::string trace = "rtt_" + rtc::ToString(rtt_ms) + "ms_loss_" +
+                                rtc::ToString(loss_percent) + "pct";
+      for (const Config& config : kConfigs) {
+        webrtc::test::PrintResult(
+            "pseudotcp_throughput", config.name, trace,
+            MeasureThroughputKbps(config, rtt_ms, loss_percent), "kbps",
+            false);
+      }
+    }
+  }
+}
+
+}  // namespace cricket
@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,16 @@ class PseudoTcpForTest : public cricket::PseudoTcp {
   bool isReceiveBufferFull() const { return PseudoTcp::isReceiveBufferFull(); }
 
   void disableWindowScale() { PseudoTcp::disableWindowScale(); }
+
+  void disableSack() { PseudoTcp::disableSack(); }
+
+  const RecoveryStats& recoveryStats() const {
+    return PseudoTcp::recoveryStats();
+  }
+
+  uint32_t slowStartThreshold() const {
+    return PseudoTcp::slowStartThreshold();
+  }
 };
 
 class PseudoTcpTestBase : public testing::Test,
@@ -74,6 +85,11 @@ class PseudoTcpTestBase : public testing::Test,
   // Used to cause the initial "connect" segment to be lost, needed for a
   // regression test.
   void DropNextPacket() { drop_next_packet_ = true; }
+  // Drops the packets sent by |local_| with the given indices, counting from
+  // 0 for the "connect" segment.
+  void DropLocalPackets(const std::set<int>& indices) {
+    local_drops_ = indices;
+  }
   void SetOptNagling(bool enable_nagles) {
     local_.SetOption(PseudoTcp::OPT_NODELAY, !enable_nagles);
     remote_.SetOption(PseudoTcp::OPT_NODELAY, !enable_nagles);
@@ -94,6 +110,12 @@ class PseudoTcpTestBase : public testing::Test,
   }
   void DisableRemoteWindowScale() { remote_.disableWindowScale(); }
   void DisableLocalWindowScale() { local_.disableWindowScale(); }
+  void DisableRemoteSack() { remote_.disableSack(); }
+  void DisableLocalSack() { local_.disableSack(); }
+  void SetOptCongestionControl(PseudoTcp::CongestionControl cc) {
+    local_.SetOption(PseudoTcp::OPT_CONGESTION_CONTROL, cc);
+    remote_.SetOption(PseudoTcp::OPT_CONGESTION_CONTROL, cc);
+  }
 
  protected:
   int Connect() {
@@ -148,6 +170,12 @@ class PseudoTcpTestBase : public testing::Test,
   virtual WriteResult TcpWritePacket(PseudoTcp* tcp,
                                      const char* buffer,
                                      size_t len) {
+    // Drop the packets the test asked for with DropLocalPackets.
+    if (tcp == &local_ && local_drops_.count(local_packets_++)) {
+      RTC_LOG(LS_VERBOSE) << "Dropping packet due to DropLocalPackets, size="
+                          << len;
+      return WR_SUCCESS;
+    }
     // Drop a packet if the test called DropNextPacket.
     if (drop_next_packet_) {
       drop_next_packet_ = false;
@@ -222,6 +250,8 @@ class PseudoTcpTestBase : public testing::Test,
   int delay_;
   int loss_;
   bool drop_next_packet_ = false;
+  std::set<int> local_drops_;
+  int local_packets_ = 0;
   bool simultaneous_open_ = false;
 };
 
@@ -740,6 +770,119 @@ TEST_F(PseudoTcpTest, TestSendBothUseLargeWindowScale) {
   TestTransfer(10000000);
 }
 
+// Test sending data with packet loss and a large window, where losses are
+// recovered with selective acknowledgements.
+TEST_F(PseudoTcpTest, TestSendWithLossAndLargeWindow) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetLoss(10);
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test the same with a receiver that doesn't support SACK.
+TEST_F(PseudoTcpTest, TestSendWithLossRemoteNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetLoss(10);
+  DisableRemoteSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test the same with a sender that doesn't support SACK.
+TEST_F(PseudoTcpTest, TestSendWithLossLocalNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetLoss(10);
+  DisableLocalSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test sending data with CUBIC congestion control.
+TEST_F(PseudoTcpTest, TestSendWithCubic) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetOptCongestionControl(PseudoTcp::CC_CUBIC);
+  TestTransfer(1000000);
+}
+
+// Test sending data with CUBIC congestion control, a 50 ms RTT and 10% packet
+// loss.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossAndCubic) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  SetOptCongestionControl(PseudoTcp::CC_CUBIC);
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test that several losses in one window are all repaired in a single fast
+// recovery with SACK, without waiting for a retransmission timeout, and that
+// NewReno halves the window.
+TEST_F(PseudoTcpTest, TestSackRecoversLossesInOneWindow) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetDelay(20);
+  DropLocalPackets({100, 103, 106});
+  TestTransfer(1000000);
+
+  const auto& stats = local_.recoveryStats();
+  EXPECT_EQ(0u, stats.timeouts);
+  EXPECT_EQ(1u, stats.fast_retransmits);
+  // The first hole is the fast retransmit, the other two come from the
+  // SACK scoreboard.
+  EXPECT_EQ(2u, stats.sack_retransmits);
+  EXPECT_EQ(stats.flight_at_last_loss / 2, local_.slowStartThreshold());
+  EXPECT_LE(stats.cwnd_after_recovery, local_.slowStartThreshold());
+  EXPECT_GT(stats.cwnd_after_recovery, 1500u);
+}
+
+// Test that without SACK the holes are repaired from partial ACKs instead.
+TEST_F(PseudoTcpTest, TestNoSackRecoversLossesFromPartialAcks) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetDelay(20);
+  DisableRemoteSack();
+  DropLocalPackets({100, 103, 106});
+  TestTransfer(1000000);
+
+  const auto& stats = local_.recoveryStats();
+  EXPECT_EQ(0u, stats.timeouts);
+  EXPECT_EQ(1u, stats.fast_retransmits);
+  EXPECT_EQ(0u, stats.sack_retransmits);
+}
+
+// Test that CUBIC reduces the window by its multiplicative decrease factor
+// of 0.7 on a loss, instead of halving it.
+TEST_F(PseudoTcpTest, TestCubicWindowReductionOnLoss) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetRemoteOptRcvBuf(1000000);
+  SetLocalOptRcvBuf(1000000);
+  SetDelay(20);
+  SetOptCongestionControl(PseudoTcp::CC_CUBIC);
+  DropLocalPackets({100});
+  TestTransfer(1000000);
+
+  const auto& stats = local_.recoveryStats();
+  EXPECT_EQ(0u, stats.timeouts);
+  EXPECT_EQ(1u, stats.fast_retransmits);
+  EXPECT_EQ(static_cast<uint32_t>(stats.flight_at_last_loss * 0.7),
+            local_.slowStartThreshold());
+  EXPECT_LE(stats.cwnd_after_recovery, local_.slowStartThreshold());
+  EXPECT_GT(stats.cwnd_after_recovery, 1500u);
+}
+
 // Test using a small receive buffer.
 TEST_F(PseudoTcpTest, TestSendSmallReceiveBuffer) {
   SetLocalMtu(1500);
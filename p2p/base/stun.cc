@@ -22,6 +22,7 @@
 #include "rtc_base/crc32.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/messagedigest.h"
+#include "rtc_base/opensslhmac.h"
 #include "rtc_base/stringencode.h"
 
 using rtc::ByteBufferReader;
@@ -164,6 +165,13 @@ const StunUInt16ListAttribute* StunMessage::GetUnknownAttributes() const {
 bool StunMessage::ValidateMessageIntegrity(const char* data,
                                            size_t size,
                                            const std::string& password) {
+  rtc::OpenSSLHmac hmac(rtc::DIGEST_SHA_1, password.c_str(), password.size());
+  return ValidateMessageIntegrity(data, size, &hmac);
+}
+
+bool StunMessage::ValidateMessageIntegrity(const char* data,
+                                           size_t size,
+                                           rtc::OpenSSLHmac* hmac) {
   // Verifying the size of the message.
   if ((size % 4) != 0 || size < kStunHeaderSize) {
     return false;
@@ -206,10 +214,11 @@ bool StunMessage::ValidateMessageIntegrity(const char* data,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
+  // Getting length of the message to calculate Message Integrity. Only the
+  // header may need to be modified, so the rest is hashed in place.
   size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
+  char header[kStunHeaderSize];
+  memcpy(header, data, kStunHeaderSize);
   if (size > mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize) {
     // Stun message has other attributes after message integrity.
     // Adjust the length parameter in stun message to calculate HMAC.
@@ -223,20 +232,20 @@ bool StunMessage::ValidateMessageIntegrity(const char* data,
     //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
     //     |0 0|     STUN Message Type     |         Message Length        |
     //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
+    rtc::SetBE16(header + 2, static_cast<uint16_t>(new_adjusted_len));
   }
 
-  char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac))
+  char computed_hmac[kStunMessageIntegritySize];
+  hmac->Update(header, kStunHeaderSize);
+  hmac->Update(data + kStunHeaderSize, mi_pos - kStunHeaderSize);
+  size_t ret = hmac->Finish(computed_hmac, sizeof(computed_hmac));
+  RTC_DCHECK(ret == sizeof(computed_hmac));
+  if (ret != sizeof(computed_hmac))
     return false;
 
   // Comparing the calculated HMAC with the one present in the message.
-  return memcmp(data + current_pos + kStunAttributeHeaderSize, hmac,
-                sizeof(hmac)) == 0;
+  return memcmp(data + current_pos + kStunAttributeHeaderSize, computed_hmac,
+                sizeof(computed_hmac)) == 0;
 }
 
 bool StunMessage::AddMessageIntegrity(const std::string& password) {
@@ -244,6 +253,11 @@ bool StunMessage::AddMessageIntegrity(const std::string& password) {
 }
 
 bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
+  rtc::OpenSSLHmac hmac(rtc::DIGEST_SHA_1, key, keylen);
+  return AddMessageIntegrity(&hmac);
+}
+
+bool StunMessage::AddMessageIntegrity(rtc::OpenSSLHmac* hmac) {
   // Add the attribute with a dummy value. Since this is a known attribute, it
   // can't fail.
   auto msg_integrity_attr_ptr = absl::make_unique<StunByteStringAttribute>(
@@ -258,18 +272,18 @@ bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
 
   int msg_len_for_hmac = static_cast<int>(
       buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
-  char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1, key, keylen, buf.Data(),
-                                msg_len_for_hmac, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  char computed_hmac[kStunMessageIntegritySize];
+  hmac->Update(buf.Data(), msg_len_for_hmac);
+  size_t ret = hmac->Finish(computed_hmac, sizeof(computed_hmac));
+  RTC_DCHECK(ret == sizeof(computed_hmac));
+  if (ret != sizeof(computed_hmac)) {
     RTC_LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
                          "has dummy value.";
     return false;
   }
 
   // Insert correct HMAC into the attribute.
-  msg_integrity_attr->CopyBytes(hmac, sizeof(hmac));
+  msg_integrity_attr->CopyBytes(computed_hmac, sizeof(computed_hmac));
   return true;
 }
 
@@ -476,6 +490,21 @@ bool StunMessage::IsValidTransactionId(const std::string& transaction_id) {
          transaction_id.size() == kStunLegacyTransactionIdLength;
 }
 
+// StunMessageIntegrityKey
+
+StunMessageIntegrityKey::StunMessageIntegrityKey() = default;
+
+StunMessageIntegrityKey::~StunMessageIntegrityKey() = default;
+
+rtc::OpenSSLHmac* StunMessageIntegrityKey::Get(const std::string& password) {
+  if (!hmac_ || password != password_) {
+    password_ = password;
+    hmac_ = absl::make_unique<rtc::OpenSSLHmac>(
+        rtc::DIGEST_SHA_1, password.c_str(), password.size());
+  }
+  return hmac_.get();
+}
+
 // StunAttribute
 
 StunAttribute::StunAttribute(uint16_t type, uint16_t length)
@@ -21,6 +21,10 @@
 #include "rtc_base/bytebuffer.h"
 #include "rtc_base/socketaddress.h"
 
+namespace rtc {
+class OpenSSLHmac;
+}  // namespace rtc
+
 namespace cricket {
 
 // These are the types of STUN messages defined in RFC 5389.
@@ -173,9 +177,15 @@ class StunMessage {
   static bool ValidateMessageIntegrity(const char* data,
                                        size_t size,
                                        const std::string& password);
+  // Same as above, with the HMAC-SHA1 of the password precomputed (see
+  // StunMessageIntegrityKey).
+  static bool ValidateMessageIntegrity(const char* data,
+                                       size_t size,
+                                       rtc::OpenSSLHmac* hmac);
   // Adds a MESSAGE-INTEGRITY attribute that is valid for the current message.
   bool AddMessageIntegrity(const std::string& password);
   bool AddMessageIntegrity(const char* key, size_t keylen);
+  bool AddMessageIntegrity(rtc::OpenSSLHmac* hmac);
 
   // Verifies that a given buffer is STUN by checking for a correct FINGERPRINT.
   static bool ValidateFingerprint(const char* data, size_t size);
@@ -214,6 +224,23 @@ class StunMessage {
   uint32_t stun_magic_cookie_;
 };
 
+// Keeps the HMAC-SHA1 for MESSAGE-INTEGRITY with a long-lived password, such
+// as an ICE password, so that the key pads are not derived again for every
+// message checked or sent.
+class StunMessageIntegrityKey {
+ public:
+  StunMessageIntegrityKey();
+  ~StunMessageIntegrityKey();
+
+  // Returns the HMAC keyed with |password|. It is recreated only when
+  // |password| differs from the one of the previous call.
+  rtc::OpenSSLHmac* Get(const std::string& password);
+
+ private:
+  std::string password_;
+  std::unique_ptr<rtc::OpenSSLHmac> hmac_;
+};
+
 // Base class for all STUN/TURN attributes.
 class StunAttribute {
  public:
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/stun.h"
+#include "p2p/base/stunserver.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/timeutils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const char kPassword[] = "password0123456789abcd";
+const int kNumMessages = 100000;
+
+// Returns a serialized connectivity check as sent by a full ICE agent.
+std::string BindingRequest() {
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddAttribute(absl::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, "ufrag0123456789a:ufragbcdef012345"));
+  msg.AddAttribute(absl::make_unique<StunUInt64Attribute>(
+      STUN_ATTR_ICE_CONTROLLING, 0x0123456789abcdefULL));
+  msg.AddAttribute(absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY,
+                                                          0x6e0001ff));
+  msg.AddAttribute(
+      absl::make_unique<StunUInt32Attribute>(STUN_ATTR_NETWORK_INFO, 0x10000));
+  msg.AddMessageIntegrity(kPassword);
+  msg.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+std::unique_ptr<IceMessage> BindingResponse() {
+  auto msg = absl::make_unique<IceMessage>();
+  msg->SetType(STUN_BINDING_RESPONSE);
+  msg->SetTransactionID("0123456789ab");
+  msg->AddAttribute(absl::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_MAPPED_ADDRESS, rtc::SocketAddress("1.2.3.4", 5678)));
+  return msg;
+}
+
+template <typename F>
+double MeasureNs(F f) {
+  int valid = 0;
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kNumMessages; ++i) {
+    if (f())
+      ++valid;
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(kNumMessages, valid);
+  return static_cast<double>(elapsed_ns) / kNumMessages;
+}
+
+}  // namespace
+
+// Measures the per-message cost of authenticating connectivity checks, which
+// dominates the STUN processing of a server with many ICE sessions.
+TEST(StunPerformanceTest, MessageIntegrity) {
+  const std::string request = BindingRequest();
+
+  webrtc::test::PrintResult(
+      "stun_validate_message_integrity", "_password", "binding_request",
+      MeasureNs([&request] {
+        return StunMessage::ValidateMessageIntegrity(
+            request.data(), request.size(), kPassword);
+      }),
+      "ns", false);
+
+  StunMessageIntegrityKey key;
+  webrtc::test::PrintResult(
+      "stun_validate_message_integrity", "_cached_key", "binding_request",
+      MeasureNs([&request, &key] {
+        return StunMessage::ValidateMessageIntegrity(
+            request.data(), request.size(), key.Get(kPassword));
+      }),
+      "ns", false);
+
+  // Includes building and serializing the response, which is the same in
+  // both cases.
+  webrtc::test::PrintResult(
+      "stun_add_message_integrity", "_password", "binding_response",
+      MeasureNs([] {
+        std::unique_ptr<IceMessage> msg = BindingResponse();
+        return msg->AddMessageIntegrity(kPassword);
+      }),
+      "ns", false);
+  webrtc::test::PrintResult(
+      "stun_add_message_integrity", "_cached_key", "binding_response",
+      MeasureNs([&key] {
+        std::unique_ptr<IceMessage> msg = BindingResponse();
+        return msg->AddMessageIntegrity(key.Get(kPassword));
+      }),
+      "ns", false);
+}
+
+TEST(StunPerformanceTest, Fingerprint) {
+  const std::string request = BindingRequest();
+  webrtc::test::PrintResult(
+      "stun_validate_fingerprint", "", "binding_request",
+      MeasureNs([&request] {
+        return StunMessage::ValidateFingerprint(request.data(),
+                                                request.size());
+      }),
+      "ns", false);
+}
+
+// Compares answering a binding request from a client of a public STUN server
+// by parsing it and serializing the response, as StunServer does, with
+// rewriting it in place.
+TEST(StunPerformanceTest, BindingResponse) {
+  StunMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddFingerprint();
+  rtc::ByteBufferWriter request;
+  msg.Write(&request);
+  const rtc::SocketAddress remote_addr("1.2.3.4", 5678);
+
+  webrtc::test::PrintResult(
+      "stun_binding_response", "_parsed", "binding_request",
+      MeasureNs([&request, &remote_addr] {
+        rtc::ByteBufferReader reader(request.Data(), request.Length());
+        StunMessage parsed;
+        if (!parsed.Read(&reader))
+          return false;
+        StunMessage response;
+        response.SetType(STUN_BINDING_RESPONSE);
+        response.SetTransactionID(parsed.transaction_id());
+        auto mapped_addr =
+            StunAttribute::CreateAddress(STUN_ATTR_MAPPED_ADDRESS);
+        mapped_addr->SetAddress(remote_addr);
+        response.AddAttribute(std::move(mapped_addr));
+        rtc::ByteBufferWriter writer;
+        return response.Write(&writer);
+      }),
+      "ns", false);
+
+  char buf[kStunBindingResponseMaxSize + 16];
+  webrtc::test::PrintResult(
+      "stun_binding_response", "_in_place", "binding_request",
+      MeasureNs([&request, &remote_addr, &buf] {
+        memcpy(buf, request.Data(), request.Length());
+        return WriteStunBindingResponse(buf, request.Length(), remote_addr,
+                                        buf) > 0;
+      }),
+      "ns", false);
+}
+
+}  // namespace cricket
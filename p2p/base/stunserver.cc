@@ -10,13 +10,99 @@
 
 #include "p2p/base/stunserver.h"
 
+#include <string.h>
+
 #include <utility>
 
 #include "rtc_base/bytebuffer.h"
+#include "rtc_base/byteorder.h"
 #include "rtc_base/logging.h"
 
 namespace cricket {
 
+namespace {
+
+// Writes an address attribute of |type| for |addr| at |buf|, xored with the
+// magic cookie and |transaction_id| for XOR-MAPPED-ADDRESS. Returns the size
+// of the attribute.
+size_t WriteAddressAttribute(uint16_t type,
+                             const rtc::SocketAddress& addr,
+                             const char* transaction_id,
+                             char* buf) {
+  const bool xor_address = type == STUN_ATTR_XOR_MAPPED_ADDRESS;
+  const bool ipv4 = addr.family() == AF_INET;
+  const size_t length = ipv4 ? 8 : 20;
+  rtc::SetBE16(buf, type);
+  rtc::SetBE16(buf + 2, static_cast<uint16_t>(length));
+  buf[4] = 0;
+  buf[5] = ipv4 ? STUN_ADDRESS_IPV4 : STUN_ADDRESS_IPV6;
+  uint16_t port = addr.port();
+  if (xor_address)
+    port ^= kStunMagicCookie >> 16;
+  rtc::SetBE16(buf + 6, port);
+
+  char* ip = buf + 8;
+  if (ipv4) {
+    // In network byte order, as the rest of the message.
+    in_addr ipv4_addr = addr.ipaddr().ipv4_address();
+    memcpy(ip, &ipv4_addr, 4);
+  } else {
+    in6_addr ipv6_addr = addr.ipaddr().ipv6_address();
+    memcpy(ip, &ipv6_addr, 16);
+  }
+  if (xor_address) {
+    // The address is xored with the magic cookie and, for IPv6, the
+    // transaction ID, which follows the magic cookie in the header.
+    char mask[16];
+    rtc::SetBE32(mask, kStunMagicCookie);
+    memcpy(mask + 4, transaction_id, kStunTransactionIdLength);
+    for (size_t i = 0; i < length - 4; ++i)
+      ip[i] ^= mask[i];
+  }
+  return kStunAttributeHeaderSize + length;
+}
+
+}  // namespace
+
+size_t WriteStunBindingResponse(const char* request,
+                                size_t size,
+                                const rtc::SocketAddress& remote_addr,
+                                char* response) {
+  if (size < kStunHeaderSize || rtc::GetBE16(request) != STUN_BINDING_REQUEST ||
+      rtc::GetBE32(request + 4) != kStunMagicCookie ||
+      kStunHeaderSize + rtc::GetBE16(request + 2) != size) {
+    return 0;
+  }
+  // Reject requests that StunMessage::Read() could not get through.
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    if (pos + kStunAttributeHeaderSize > size)
+      return 0;
+    size_t attr_length = rtc::GetBE16(request + pos + 2);
+    pos += kStunAttributeHeaderSize + ((attr_length + 3) & ~3);
+  }
+  if (pos != size)
+    return 0;
+  const rtc::IPAddress& ip = remote_addr.ipaddr();
+  if (ip.family() != AF_INET && ip.family() != AF_INET6)
+    return 0;
+
+  // The magic cookie and transaction ID stay in place, and the attributes of
+  // the request are overwritten.
+  if (response != request)
+    memcpy(response, request, kStunHeaderSize);
+  const char* transaction_id = response + kStunTransactionIdOffset;
+  size_t length = WriteAddressAttribute(STUN_ATTR_MAPPED_ADDRESS, remote_addr,
+                                        transaction_id,
+                                        response + kStunHeaderSize);
+  length += WriteAddressAttribute(STUN_ATTR_XOR_MAPPED_ADDRESS, remote_addr,
+                                  transaction_id,
+                                  response + kStunHeaderSize + length);
+  rtc::SetBE16(response, STUN_BINDING_RESPONSE);
+  rtc::SetBE16(response + 2, static_cast<uint16_t>(length));
+  return kStunHeaderSize + length;
+}
+
 StunServer::StunServer(rtc::AsyncUDPSocket* socket) : socket_(socket) {
   socket_->SignalReadPacket.connect(this, &StunServer::OnPacket);
 }
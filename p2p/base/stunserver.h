@@ -20,6 +20,26 @@ namespace cricket {
 
 const int STUN_SERVER_PORT = 3478;
 
+// The size of the largest response written by WriteStunBindingResponse(),
+// which is the response to an IPv6 address.
+const size_t kStunBindingResponseMaxSize = kStunHeaderSize + 2 * 24;
+
+// Writes the binding response to the RFC 5389 binding request of |size| bytes
+// in |request| to |response|, without parsing the request into a StunMessage.
+// |response| must have room for kStunBindingResponseMaxSize bytes, and may be
+// |request|, in which case the request is rewritten in place.
+//
+// The response has the transaction ID of the request and both MAPPED-ADDRESS,
+// as sent by StunServer, and XOR-MAPPED-ADDRESS of |remote_addr|. The
+// attributes of the request are checked for consistent lengths only.
+//
+// Returns the size of the response, or 0 if |request| is not a binding
+// request with the magic cookie, which must then be handled by parsing it.
+size_t WriteStunBindingResponse(const char* request,
+                                size_t size,
+                                const rtc::SocketAddress& remote_addr,
+                                char* response);
+
 class StunServer : public sigslot::has_slots<> {
  public:
   // Creates a STUN server, which will listen on the given socket.
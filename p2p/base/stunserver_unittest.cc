@@ -8,11 +8,14 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
 #include <memory>
 #include <string>
 
 #include "absl/memory/memory.h"
 #include "p2p/base/stunserver.h"
+#include "rtc_base/byteorder.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/testclient.h"
@@ -24,6 +27,39 @@ namespace cricket {
 namespace {
 const rtc::SocketAddress server_addr("99.99.99.1", 3478);
 const rtc::SocketAddress client_addr("1.2.3.4", 1234);
+const rtc::SocketAddress client_addr_v6("2001:db8::1234", 1234);
+
+std::string BindingRequest(const std::string& transaction_id) {
+  StunMessage req;
+  req.SetType(STUN_BINDING_REQUEST);
+  req.SetTransactionID(transaction_id);
+  req.AddAttribute(
+      absl::make_unique<StunByteStringAttribute>(STUN_ATTR_SOFTWARE, "test"));
+  req.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  req.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+// Checks that |response| is the binding response to |remote_addr|.
+void ExpectBindingResponse(const char* response,
+                           size_t size,
+                           const std::string& transaction_id,
+                           const rtc::SocketAddress& remote_addr) {
+  rtc::ByteBufferReader buf(response, size);
+  StunMessage msg;
+  ASSERT_TRUE(msg.Read(&buf));
+  EXPECT_EQ(STUN_BINDING_RESPONSE, msg.type());
+  EXPECT_EQ(transaction_id, msg.transaction_id());
+  const StunAddressAttribute* mapped_addr =
+      msg.GetAddress(STUN_ATTR_MAPPED_ADDRESS);
+  ASSERT_TRUE(mapped_addr != NULL);
+  EXPECT_EQ(remote_addr, mapped_addr->GetAddress());
+  const StunAddressAttribute* xor_mapped_addr =
+      msg.GetAddress(STUN_ATTR_XOR_MAPPED_ADDRESS);
+  ASSERT_TRUE(xor_mapped_addr != NULL);
+  EXPECT_EQ(remote_addr, xor_mapped_addr->GetAddress());
+}
 }  // namespace
 
 class StunServerTest : public testing::Test {
@@ -107,4 +143,53 @@ TEST_F(StunServerTest, TestBad) {
   ASSERT_TRUE(ReceiveFails());
 }
 
+TEST(StunBindingResponseTest, WriteInPlace) {
+  std::string request = BindingRequest("0123456789ab");
+  char buf[kStunBindingResponseMaxSize + 64];
+  ASSERT_LE(request.size(), sizeof(buf));
+  memcpy(buf, request.data(), request.size());
+
+  size_t size = WriteStunBindingResponse(buf, request.size(), client_addr, buf);
+  EXPECT_EQ(kStunHeaderSize + 24, size);
+  ExpectBindingResponse(buf, size, "0123456789ab", client_addr);
+}
+
+TEST(StunBindingResponseTest, WriteIpv6) {
+  std::string request = BindingRequest("ba9876543210");
+  char buf[kStunBindingResponseMaxSize];
+  size_t size = WriteStunBindingResponse(request.data(), request.size(),
+                                         client_addr_v6, buf);
+  EXPECT_EQ(kStunBindingResponseMaxSize, size);
+  ExpectBindingResponse(buf, size, "ba9876543210", client_addr_v6);
+}
+
+TEST(StunBindingResponseTest, RejectsOtherMessages) {
+  char buf[kStunBindingResponseMaxSize];
+  std::string request = BindingRequest("0123456789ab");
+  // Truncated.
+  EXPECT_EQ(0u, WriteStunBindingResponse(request.data(), request.size() - 4,
+                                         client_addr, buf));
+  // Attribute longer than the message.
+  std::string bad_attribute = request;
+  rtc::SetBE16(&bad_attribute[kStunHeaderSize + 2], 0x100);
+  EXPECT_EQ(0u, WriteStunBindingResponse(bad_attribute.data(),
+                                         bad_attribute.size(), client_addr,
+                                         buf));
+  // Not a binding request.
+  std::string indication = request;
+  rtc::SetBE16(&indication[0], STUN_BINDING_INDICATION);
+  EXPECT_EQ(0u, WriteStunBindingResponse(indication.data(), indication.size(),
+                                         client_addr, buf));
+
+  // RFC 3489 requests without the magic cookie are left to StunServer.
+  StunMessage legacy;
+  legacy.SetType(STUN_BINDING_REQUEST);
+  legacy.SetTransactionID("0123456789abcdef");
+  rtc::ByteBufferWriter legacy_buf;
+  legacy.Write(&legacy_buf);
+  EXPECT_EQ(0u, WriteStunBindingResponse(legacy_buf.Data(),
+                                         legacy_buf.Length(), client_addr,
+                                         buf));
+}
+
 }  // namespace cricket
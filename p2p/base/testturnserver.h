@@ -87,6 +87,11 @@ class TestTurnServer : public TurnAuthInterface {
     server_.set_enable_permission_checks(enable);
   }
 
+  void set_enable_kernel_tls(bool enable) {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    server_.set_enable_kernel_tls(enable);
+  }
+
   void AddInternalSocket(const rtc::SocketAddress& int_addr,
                          ProtocolType proto,
                          bool ignore_bad_cert = true,
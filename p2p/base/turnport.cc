@@ -25,6 +25,7 @@
 #include "rtc_base/nethelpers.h"
 #include "rtc_base/socketaddress.h"
 #include "rtc_base/stringencode.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace cricket {
 
@@ -44,6 +45,12 @@ static const size_t MAX_ALLOCATE_MISMATCH_RETRIES = 2;
 
 static const int TURN_SUCCESS_RESULT_CODE = 0;
 
+// Binds the channel for a peer as soon as its permission is created, so that
+// the first payload packets are sent as ChannelData rather than as Send
+// indications.
+static const char kEagerChannelBindFieldTrial[] =
+    "WebRTC-TurnEagerChannelBind";
+
 inline bool IsTurnChannelData(uint16_t msg_type) {
   return ((msg_type & 0xC000) == 0x4000);  // MSB are 0b01
 }
@@ -214,7 +221,9 @@ TurnPort::TurnPort(rtc::Thread* thread,
       state_(STATE_CONNECTING),
       server_priority_(server_priority),
       allocate_mismatch_retries_(0),
-      turn_customizer_(customizer) {
+      turn_customizer_(customizer),
+      eager_channel_bind_(
+          webrtc::field_trial::IsEnabled(kEagerChannelBindFieldTrial)) {
   request_manager_.SignalSendPacket.connect(this, &TurnPort::OnSendStunPacket);
   request_manager_.set_origin(origin);
 }
@@ -255,7 +264,9 @@ TurnPort::TurnPort(rtc::Thread* thread,
       state_(STATE_CONNECTING),
       server_priority_(server_priority),
       allocate_mismatch_retries_(0),
-      turn_customizer_(customizer) {
+      turn_customizer_(customizer),
+      eager_channel_bind_(
+          webrtc::field_trial::IsEnabled(kEagerChannelBindFieldTrial)) {
   request_manager_.SignalSendPacket.connect(this, &TurnPort::OnSendStunPacket);
   request_manager_.set_origin(origin);
 }
@@ -1689,36 +1700,42 @@ int TurnEntry::Send(const void* data,
                     size_t size,
                     bool payload,
                     const rtc::PacketOptions& options) {
-  rtc::ByteBufferWriter buf;
-  if (state_ != STATE_BOUND ||
-      !port_->TurnCustomizerAllowChannelData(data, size, payload)) {
-    // If we haven't bound the channel yet, we have to use a Send Indication.
-    // The turn_customizer_ can also make us use Send Indication.
-    TurnMessage msg;
-    msg.SetType(TURN_SEND_INDICATION);
-    msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
-    msg.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
-        STUN_ATTR_XOR_PEER_ADDRESS, ext_addr_));
-    msg.AddAttribute(
-        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_DATA, data, size));
-
-    port_->TurnCustomizerMaybeModifyOutgoingStunMessage(&msg);
-
-    const bool success = msg.Write(&buf);
-    RTC_DCHECK(success);
-
-    // If we're sending real data, request a channel bind that we can use later.
-    if (state_ == STATE_UNBOUND && payload) {
-      SendChannelBindRequest(0);
-      state_ = STATE_BINDING;
-    }
-  } else {
+  rtc::PacketOptions modified_options(options);
+  if (state_ == STATE_BOUND &&
+      port_->TurnCustomizerAllowChannelData(data, size, payload)) {
     // If the channel is bound, we can send the data as a Channel Message.
-    buf.WriteUInt16(channel_id_);
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(reinterpret_cast<const char*>(data), size);
+    rtc::Buffer& buf = port_->channel_data_buffer_;
+    buf.SetSize(TURN_CHANNEL_HEADER_SIZE + size);
+    rtc::SetBE16(buf.data(), static_cast<uint16_t>(channel_id_));
+    rtc::SetBE16(buf.data() + 2, static_cast<uint16_t>(size));
+    memcpy(buf.data() + TURN_CHANNEL_HEADER_SIZE, data, size);
+    modified_options.info_signaled_after_sent.turn_overhead_bytes =
+        TURN_CHANNEL_HEADER_SIZE;
+    return port_->Send(buf.data(), buf.size(), modified_options);
+  }
+
+  // If we haven't bound the channel yet, we have to use a Send Indication.
+  // The turn_customizer_ can also make us use Send Indication.
+  rtc::ByteBufferWriter buf;
+  TurnMessage msg;
+  msg.SetType(TURN_SEND_INDICATION);
+  msg.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  msg.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_PEER_ADDRESS, ext_addr_));
+  msg.AddAttribute(
+      absl::make_unique<StunByteStringAttribute>(STUN_ATTR_DATA, data, size));
+
+  port_->TurnCustomizerMaybeModifyOutgoingStunMessage(&msg);
+
+  const bool success = msg.Write(&buf);
+  RTC_DCHECK(success);
+
+  // If we're sending real data, request a channel bind that we can use later.
+  if (state_ == STATE_UNBOUND && payload) {
+    SendChannelBindRequest(0);
+    state_ = STATE_BINDING;
   }
-  rtc::PacketOptions modified_options(options);
+
   modified_options.info_signaled_after_sent.turn_overhead_bytes =
       buf.Length() - size;
   return port_->Send(buf.Data(), buf.Length(), modified_options);
@@ -1730,9 +1747,15 @@ void TurnEntry::OnCreatePermissionSuccess() {
   port_->SignalCreatePermissionResult(port_, ext_addr_,
                                       TURN_SUCCESS_RESULT_CODE);
 
-  // If |state_| is STATE_BOUND, the permission will be refreshed
-  // by ChannelBindRequest.
-  if (state_ != STATE_BOUND) {
+  // The channel bind request refreshes the permission as well.
+  if (state_ == STATE_UNBOUND && port_->eager_channel_bind_) {
+    SendChannelBindRequest(0);
+    state_ = STATE_BINDING;
+  }
+
+  // If |state_| is STATE_BOUND or STATE_BINDING, the permission will be
+  // refreshed by ChannelBindRequest.
+  if (state_ == STATE_UNBOUND) {
     // Refresh the permission request about 1 minute before the permission
     // times out.
     int delay = TURN_PERMISSION_TIMEOUT - 60000;
@@ -22,6 +22,7 @@
 #include "p2p/client/basicportallocator.h"
 #include "rtc_base/asyncinvoker.h"
 #include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/buffer.h"
 #include "rtc_base/sslcertificate.h"
 
 namespace rtc {
@@ -338,6 +339,13 @@ class TurnPort : public Port {
   // must outlive the TurnPort's lifetime.
   webrtc::TurnCustomizer *turn_customizer_ = nullptr;
 
+  // Whether channels are bound as soon as the permission for a peer is
+  // created, rather than when the first payload is sent to it.
+  const bool eager_channel_bind_;
+  // Reused for the ChannelData messages sent by the entries, so that framing
+  // a packet does not allocate.
+  rtc::Buffer channel_data_buffer_;
+
   friend class TurnEntry;
   friend class TurnAllocateRequest;
   friend class TurnRefreshRequest;
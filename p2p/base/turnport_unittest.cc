@@ -39,6 +39,7 @@
 #include "rtc_base/ssladapter.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/virtualsocketserver.h"
+#include "test/field_trial.h"
 
 using rtc::SocketAddress;
 
@@ -1283,6 +1284,15 @@ TEST_F(TurnPortTest, TestTurnTlsConnection) {
   TestTurnConnection(PROTO_TLS);
 }
 
+// Test that a TURN server with kernel TLS enabled still serves TLS clients.
+// Virtual sockets have no kernel TLS, so the records are sent with SSL_write.
+TEST_F(TurnPortTest, TestTurnTlsConnectionWithKernelTls) {
+  turn_server_.set_enable_kernel_tls(true);
+  turn_server_.AddInternalSocket(kTurnTcpIntAddr, PROTO_TLS);
+  CreateTurnPort(kTurnUsername, kTurnPassword, kTurnTlsProtoAddr);
+  TestTurnConnection(PROTO_TLS);
+}
+
 // Test that if a connection on a TURN port is destroyed, the TURN port can
 // still receive ping on that connection as if it is from an unknown address.
 // If the connection is created again, it will be used to receive ping.
@@ -1596,6 +1606,39 @@ class MessageObserver : public StunMessageObserver {
   unsigned int* attr_counter_ = nullptr;
 };
 
+// Test that with eager channel binding, the channel is bound before any
+// payload is sent, so that the first payload packet is sent as ChannelData.
+TEST_F(TurnPortTest, TestEagerChannelBind) {
+  webrtc::test::ScopedFieldTrials field_trials(
+      "WebRTC-TurnEagerChannelBind/Enabled/");
+  unsigned int observer_channel_data_counter = 0;
+  turn_server_.server()->SetStunMessageObserver(
+      absl::make_unique<MessageObserver>(
+          nullptr, &observer_channel_data_counter, nullptr));
+
+  CreateTurnPort(kTurnUsername, kTurnPassword, kTurnUdpProtoAddr);
+  PrepareTurnAndUdpPorts(PROTO_UDP);
+  Connection* conn1 = turn_port_->CreateConnection(udp_port_->Candidates()[0],
+                                                   Port::ORIGIN_MESSAGE);
+  Connection* conn2 = udp_port_->CreateConnection(turn_port_->Candidates()[0],
+                                                  Port::ORIGIN_MESSAGE);
+  ASSERT_TRUE(conn1 != nullptr);
+  ASSERT_TRUE(conn2 != nullptr);
+  conn2->SignalReadPacket.connect(static_cast<TurnPortTest*>(this),
+                                  &TurnPortTest::OnUdpReadPacket);
+  conn1->Ping(0);
+  EXPECT_EQ_SIMULATED_WAIT(Connection::STATE_WRITABLE, conn1->write_state(),
+                           kSimulatedRtt * 2, fake_clock_);
+
+  const unsigned int channel_data_before_payload =
+      observer_channel_data_counter;
+  std::string data = "ABC";
+  conn1->Send(data.data(), data.length(), options);
+  EXPECT_TRUE_SIMULATED_WAIT(!udp_packets_.empty(), kSimulatedRtt,
+                             fake_clock_);
+  EXPECT_EQ(channel_data_before_payload + 1, observer_channel_data_counter);
+}
+
 // Do a TURN allocation, establish a TLS connection, and send some data.
 // Add customizer and check that it get called.
 TEST_F(TurnPortTest, TestTurnCustomizerCount) {
@@ -24,6 +24,7 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/messagedigest.h"
 #include "rtc_base/socketadapters.h"
+#include "rtc_base/ssladapter.h"
 #include "rtc_base/stringencode.h"
 #include "rtc_base/thread.h"
 
@@ -157,6 +158,10 @@ void TurnServer::AddInternalServerSocket(rtc::AsyncSocket* socket,
   RTC_DCHECK(server_listen_sockets_.end() ==
              server_listen_sockets_.find(socket));
   server_listen_sockets_[socket] = proto;
+  if (proto == PROTO_TLS && enable_kernel_tls_) {
+    // The connections it accepts inherit the setting.
+    static_cast<rtc::SSLAdapter*>(socket)->SetKernelTlsOffload(true);
+  }
   socket->SignalReadEvent.connect(this, &TurnServer::OnNewInternalConnection);
 }
 
@@ -184,6 +189,9 @@ void TurnServer::AcceptConnection(rtc::AsyncSocket* server_socket) {
     ProtocolType proto = server_listen_sockets_[server_socket];
     cricket::AsyncStunTCPSocket* tcp_socket =
         new cricket::AsyncStunTCPSocket(accepted_socket, false);
+    // A relay forwards packets from many peers to the client; write those
+    // relayed while handling one round of socket events together.
+    tcp_socket->SetWriteCoalescing(true);
 
     tcp_socket->SignalClose.connect(this, &TurnServer::OnInternalSocketClose);
     // Finally add the socket so it can start communicating with the client.
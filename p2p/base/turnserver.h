@@ -230,6 +230,14 @@ class TurnServer : public sigslot::has_slots<> {
     enable_permission_checks_ = enable;
   }
 
+  // If set to true, the TLS connections accepted on the server sockets added
+  // after this send their records with kernel TLS, where it is available. The
+  // PROTO_TLS server sockets must then be rtc::SSLAdapters.
+  void set_enable_kernel_tls(bool enable) {
+    RTC_DCHECK(thread_checker_.CalledOnValidThread());
+    enable_kernel_tls_ = enable;
+  }
+
   // Starts listening for packets from internal clients.
   void AddInternalSocket(rtc::AsyncPacketSocket* socket,
                          ProtocolType proto);
@@ -321,6 +329,7 @@ class TurnServer : public sigslot::has_slots<> {
   bool reject_private_addresses_ = false;
   // Check for permission when receiving an external packet.
   bool enable_permission_checks_ = true;
+  bool enable_kernel_tls_ = false;
 
   InternalSocketMap server_sockets_;
   ServerSocketMap server_listen_sockets_;
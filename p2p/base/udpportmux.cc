@@ -0,0 +1,346 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/udpportmux.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "p2p/base/stun.h"
+#include "p2p/base/stunrequest.h"
+#include "rtc_base/byteorder.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
+
+namespace cricket {
+
+namespace {
+
+// Reads the type and transaction ID of an RFC 5389 STUN message.
+bool GetStunTypeAndTransactionId(const char* data,
+                                 size_t size,
+                                 int* type,
+                                 std::string* transaction_id) {
+  // The two most significant bits of a STUN message are zero.
+  if (size < kStunHeaderSize || (data[0] & 0xc0) != 0 ||
+      rtc::GetBE32(data + 4) != kStunMagicCookie) {
+    return false;
+  }
+  *type = rtc::GetBE16(data);
+  transaction_id->assign(data + kStunTransactionIdOffset,
+                         kStunTransactionIdLength);
+  return true;
+}
+
+}  // namespace
+
+bool GetStunBindingRequestLocalUfrag(const char* data,
+                                     size_t size,
+                                     std::string* local_ufrag) {
+  if (size < kStunHeaderSize || rtc::GetBE16(data) != STUN_BINDING_REQUEST ||
+      rtc::GetBE32(data + 4) != kStunMagicCookie) {
+    return false;
+  }
+  size_t length = rtc::GetBE16(data + 2);
+  if (length % 4 != 0 || kStunHeaderSize + length > size) {
+    return false;
+  }
+  size_t pos = kStunHeaderSize;
+  const size_t end = kStunHeaderSize + length;
+  while (pos + kStunAttributeHeaderSize <= end) {
+    uint16_t attr_type = rtc::GetBE16(data + pos);
+    size_t attr_length = rtc::GetBE16(data + pos + 2);
+    pos += kStunAttributeHeaderSize;
+    if (pos + attr_length > end) {
+      return false;
+    }
+    if (attr_type == STUN_ATTR_USERNAME) {
+      const char* username = data + pos;
+      const char* colon =
+          static_cast<const char*>(memchr(username, ':', attr_length));
+      if (!colon) {
+        return false;
+      }
+      local_ufrag->assign(username, colon - username);
+      return true;
+    }
+    // Attributes are padded to a multiple of 4 bytes.
+    pos += (attr_length + 3) & ~3;
+  }
+  return false;
+}
+
+MuxedUdpSocket::MuxedUdpSocket(UdpPortMux* mux, const std::string& local_ufrag)
+    : mux_(mux), local_ufrag_(local_ufrag) {}
+
+MuxedUdpSocket::~MuxedUdpSocket() {
+  mux_->RemoveSocket(this);
+}
+
+void MuxedUdpSocket::SetLocalUfrag(const std::string& local_ufrag) {
+  if (local_ufrag == local_ufrag_) {
+    return;
+  }
+  std::string old_ufrag = local_ufrag_;
+  local_ufrag_ = local_ufrag;
+  mux_->UpdateLocalUfrag(this, old_ufrag);
+}
+
+rtc::SocketAddress MuxedUdpSocket::GetLocalAddress() const {
+  return mux_->GetLocalAddress();
+}
+
+rtc::SocketAddress MuxedUdpSocket::GetRemoteAddress() const {
+  return rtc::SocketAddress();
+}
+
+int MuxedUdpSocket::Send(const void* pv,
+                         size_t cb,
+                         const rtc::PacketOptions& options) {
+  // A muxed socket is never connected to a single remote address.
+  SetError(ENOTCONN);
+  return -1;
+}
+
+int MuxedUdpSocket::SendTo(const void* pv,
+                           size_t cb,
+                           const rtc::SocketAddress& addr,
+                           const rtc::PacketOptions& options) {
+  if (closed_) {
+    SetError(ENOTCONN);
+    return -1;
+  }
+  return mux_->SendTo(this, pv, cb, addr, options);
+}
+
+int MuxedUdpSocket::Close() {
+  closed_ = true;
+  return 0;
+}
+
+rtc::AsyncPacketSocket::State MuxedUdpSocket::GetState() const {
+  return closed_ ? STATE_CLOSED : STATE_BOUND;
+}
+
+int MuxedUdpSocket::GetOption(rtc::Socket::Option opt, int* value) {
+  return mux_->socket_->GetOption(opt, value);
+}
+
+int MuxedUdpSocket::SetOption(rtc::Socket::Option opt, int value) {
+  return mux_->socket_->SetOption(opt, value);
+}
+
+int MuxedUdpSocket::GetError() const {
+  return mux_->socket_->GetError();
+}
+
+void MuxedUdpSocket::SetError(int error) {
+  mux_->socket_->SetError(error);
+}
+
+UdpPortMux::UdpPortMux(rtc::AsyncPacketSocket* socket) : socket_(socket) {
+  RTC_DCHECK(socket_);
+  socket_->SignalReadPacket.connect(this, &UdpPortMux::OnReadPacket);
+  socket_->SignalSentPacket.connect(this, &UdpPortMux::OnSentPacket);
+  socket_->SignalReadyToSend.connect(this, &UdpPortMux::OnReadyToSend);
+}
+
+UdpPortMux::~UdpPortMux() {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  RTC_DCHECK(sockets_.empty());
+}
+
+rtc::SocketAddress UdpPortMux::GetLocalAddress() const {
+  return socket_->GetLocalAddress();
+}
+
+MuxedUdpSocket* UdpPortMux::CreateSocket(const std::string& local_ufrag) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  MuxedUdpSocket* socket = new MuxedUdpSocket(this, local_ufrag);
+  sockets_.insert(socket);
+  UpdateLocalUfrag(socket, std::string());
+  return socket;
+}
+
+void UdpPortMux::RemoveSocket(MuxedUdpSocket* socket) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  sockets_.erase(socket);
+  for (const rtc::SocketAddress& addr : socket->remote_addresses_) {
+    sockets_by_address_.erase(addr);
+  }
+  for (const auto& pending : socket->pending_transaction_ids_) {
+    auto it = sockets_by_transaction_id_.find(pending.second);
+    if (it != sockets_by_transaction_id_.end() && it->second == socket) {
+      sockets_by_transaction_id_.erase(it);
+    }
+  }
+  // Hand the ufrag over to another socket using it, if any.
+  auto it = sockets_by_ufrag_.find(socket->local_ufrag());
+  if (it != sockets_by_ufrag_.end() && it->second == socket) {
+    sockets_by_ufrag_.erase(it);
+    for (MuxedUdpSocket* other : sockets_) {
+      if (other->local_ufrag() == socket->local_ufrag()) {
+        sockets_by_ufrag_[other->local_ufrag()] = other;
+        break;
+      }
+    }
+  }
+  if (sending_socket_ == socket) {
+    sending_socket_ = nullptr;
+  }
+}
+
+void UdpPortMux::UpdateLocalUfrag(MuxedUdpSocket* socket,
+                                  const std::string& old_ufrag) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  auto it = sockets_by_ufrag_.find(old_ufrag);
+  if (it != sockets_by_ufrag_.end() && it->second == socket) {
+    sockets_by_ufrag_.erase(it);
+  }
+  MuxedUdpSocket*& entry = sockets_by_ufrag_[socket->local_ufrag()];
+  if (entry && entry != socket) {
+    RTC_LOG(LS_WARNING) << "Two sessions on " << GetLocalAddress().ToString()
+                        << " use the ufrag " << socket->local_ufrag()
+                        << "; STUN requests go to the latest one.";
+  }
+  entry = socket;
+}
+
+int UdpPortMux::SendTo(MuxedUdpSocket* socket,
+                       const void* data,
+                       size_t size,
+                       const rtc::SocketAddress& addr,
+                       const rtc::PacketOptions& options) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  int type;
+  std::string transaction_id;
+  if (GetStunTypeAndTransactionId(static_cast<const char*>(data), size, &type,
+                                  &transaction_id) &&
+      IsStunRequestType(type)) {
+    // The response is routed by the transaction ID. Not claiming the address
+    // keeps a STUN or TURN server shared by several sessions from being
+    // taken over by the last one to send to it.
+    AddPendingTransaction(transaction_id, socket);
+  } else {
+    AddRemoteAddress(addr, socket);
+  }
+  // The shared socket signals SignalSentPacket synchronously from SendTo.
+  sending_socket_ = socket;
+  int ret = socket_->SendTo(data, size, addr, options);
+  sending_socket_ = nullptr;
+  return ret;
+}
+
+void UdpPortMux::AddRemoteAddress(const rtc::SocketAddress& addr,
+                                  MuxedUdpSocket* socket) {
+  auto result = sockets_by_address_.emplace(addr, socket);
+  if (result.second) {
+    socket->remote_addresses_.insert(addr);
+  } else if (result.first->second != socket) {
+    result.first->second->remote_addresses_.erase(addr);
+    result.first->second = socket;
+    socket->remote_addresses_.insert(addr);
+  }
+}
+
+void UdpPortMux::AddPendingTransaction(const std::string& transaction_id,
+                                       MuxedUdpSocket* socket) {
+  // Retransmissions reuse the transaction ID.
+  if (!sockets_by_transaction_id_.emplace(transaction_id, socket).second) {
+    return;
+  }
+  // Forget the requests that can no longer be answered.
+  int64_t now = rtc::TimeMillis();
+  auto& pending = socket->pending_transaction_ids_;
+  while (!pending.empty() && now - pending.front().first > STUN_TOTAL_TIMEOUT) {
+    auto it = sockets_by_transaction_id_.find(pending.front().second);
+    if (it != sockets_by_transaction_id_.end() && it->second == socket) {
+      sockets_by_transaction_id_.erase(it);
+    }
+    pending.pop_front();
+  }
+  pending.emplace_back(now, transaction_id);
+}
+
+void UdpPortMux::OnReadPacket(rtc::AsyncPacketSocket* socket,
+                              const char* data,
+                              size_t size,
+                              const rtc::SocketAddress& remote_addr,
+                              const rtc::PacketTime& packet_time) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  RTC_DCHECK(socket == socket_.get());
+
+  MuxedUdpSocket* target = nullptr;
+  std::string local_ufrag;
+  int type;
+  std::string transaction_id;
+  if (GetStunTypeAndTransactionId(data, size, &type, &transaction_id) &&
+      (IsStunSuccessResponseType(type) || IsStunErrorResponseType(type))) {
+    auto it = sockets_by_transaction_id_.find(transaction_id);
+    if (it != sockets_by_transaction_id_.end()) {
+      target = it->second;
+      // Left in the pending list of the socket until it expires there.
+      sockets_by_transaction_id_.erase(it);
+    } else {
+      auto addr_it = sockets_by_address_.find(remote_addr);
+      if (addr_it != sockets_by_address_.end()) {
+        target = addr_it->second;
+      }
+    }
+  } else if (GetStunBindingRequestLocalUfrag(data, size, &local_ufrag)) {
+    auto it = sockets_by_ufrag_.find(local_ufrag);
+    if (it != sockets_by_ufrag_.end()) {
+      target = it->second;
+      // Requests only route addresses that are not yet known, so that they
+      // can't take over the media of another session; the session may still
+      // reject the request.
+      if (sockets_by_address_.find(remote_addr) == sockets_by_address_.end()) {
+        AddRemoteAddress(remote_addr, target);
+      }
+    }
+  } else {
+    auto it = sockets_by_address_.find(remote_addr);
+    if (it != sockets_by_address_.end()) {
+      target = it->second;
+    }
+  }
+
+  if (!target) {
+    RTC_LOG(LS_VERBOSE) << "Dropping packet from unknown remote address "
+                        << remote_addr.ToSensitiveString() << " on "
+                        << GetLocalAddress().ToString();
+    return;
+  }
+  if (target->closed_) {
+    return;
+  }
+  target->SignalReadPacket(target, data, size, remote_addr, packet_time);
+}
+
+void UdpPortMux::OnSentPacket(rtc::AsyncPacketSocket* socket,
+                              const rtc::SentPacket& sent_packet) {
+  if (sending_socket_) {
+    sending_socket_->SignalSentPacket(sending_socket_, sent_packet);
+  }
+}
+
+void UdpPortMux::OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  // Copy, since a handler may destroy its socket.
+  std::set<MuxedUdpSocket*> sockets = sockets_;
+  for (MuxedUdpSocket* muxed_socket : sockets) {
+    if (sockets_.count(muxed_socket)) {
+      muxed_socket->SignalReadyToSend(muxed_socket);
+    }
+  }
+}
+
+}  // namespace cricket
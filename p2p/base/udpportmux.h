@@ -0,0 +1,186 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_UDPPORTMUX_H_
+#define P2P_BASE_UDPPORTMUX_H_
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread_checker.h"
+
+namespace cricket {
+
+class UdpPortMux;
+
+// Hash and equality on IP and port only, for addresses received from or sent
+// to the network.
+struct SocketAddressIpPortHash {
+  size_t operator()(const rtc::SocketAddress& addr) const {
+    return addr.Hash();
+  }
+};
+struct SocketAddressIpPortEqual {
+  bool operator()(const rtc::SocketAddress& a,
+                  const rtc::SocketAddress& b) const {
+    return a.port() == b.port() && a.ipaddr() == b.ipaddr();
+  }
+};
+
+// A UDP socket of one ICE session on a UdpPortMux. Packets sent on it go out
+// through the shared socket; it receives the packets that the mux routes to
+// the session. Closing or destroying it does not affect the shared socket.
+class MuxedUdpSocket : public rtc::AsyncPacketSocket {
+ public:
+  ~MuxedUdpSocket() override;
+
+  const std::string& local_ufrag() const { return local_ufrag_; }
+  // Must be called when the ICE credentials of the session change (e.g. when
+  // a pooled session is taken), so that STUN requests for the new ufrag are
+  // routed here.
+  void SetLocalUfrag(const std::string& local_ufrag);
+
+  // rtc::AsyncPacketSocket implementation.
+  rtc::SocketAddress GetLocalAddress() const override;
+  rtc::SocketAddress GetRemoteAddress() const override;
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override;
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override;
+  int Close() override;
+  State GetState() const override;
+  // Options are applied to the shared socket, and thus to all sessions.
+  int GetOption(rtc::Socket::Option opt, int* value) override;
+  int SetOption(rtc::Socket::Option opt, int value) override;
+  int GetError() const override;
+  void SetError(int error) override;
+
+ private:
+  friend class UdpPortMux;
+
+  MuxedUdpSocket(UdpPortMux* mux, const std::string& local_ufrag);
+
+  UdpPortMux* mux_;
+  std::string local_ufrag_;
+  bool closed_ = false;
+  // Remote addresses currently routed to this socket.
+  std::unordered_set<rtc::SocketAddress,
+                     SocketAddressIpPortHash,
+                     SocketAddressIpPortEqual>
+      remote_addresses_;
+  // Transaction IDs of the STUN requests sent on this socket, with the time
+  // they were first sent, oldest first.
+  std::deque<std::pair<int64_t, std::string>> pending_transaction_ids_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(MuxedUdpSocket);
+};
+
+// Serves the UDP ports of many ICE sessions (typically ICE-lite sessions of a
+// media server, one per PeerConnection) from one shared UDP socket, so that
+// the number of sockets and poll registrations does not grow with the number
+// of sessions.
+//
+// Incoming packets are demultiplexed to the MuxedUdpSocket of a session:
+//  - STUN binding requests by the local ufrag, i.e. the part of the USERNAME
+//    attribute before the colon;
+//  - STUN responses by transaction ID, to the session that sent the request.
+//    This keeps the responses of a STUN server shared by several sessions
+//    apart;
+//  - all other packets (media, DTLS) by remote address. A remote address is
+//    routed to a session once the session has sent anything but a STUN
+//    request to it, or once it has sent a binding request for the session's
+//    ufrag.
+// Packets from unknown remote addresses are dropped.
+//
+// BUNDLE and rtcp-mux are expected; sessions with the same local ufrag can
+// not be told apart, in which case requests go to the latest one. TURN
+// allocations are keyed by the local address, so a relay port can't use a
+// muxed socket and must have a socket of its own.
+//
+// All methods must be called on the thread of the shared socket.
+class UdpPortMux : public sigslot::has_slots<> {
+ public:
+  // Takes ownership of |socket|, which must be a bound UDP socket.
+  explicit UdpPortMux(rtc::AsyncPacketSocket* socket);
+  ~UdpPortMux() override;
+
+  rtc::SocketAddress GetLocalAddress() const;
+
+  // Creates a socket for the session with |local_ufrag|. The caller owns the
+  // returned socket, which must be destroyed before the mux.
+  MuxedUdpSocket* CreateSocket(const std::string& local_ufrag);
+
+  size_t num_sockets() const { return sockets_.size(); }
+  size_t num_remote_addresses() const { return sockets_by_address_.size(); }
+  size_t num_pending_transactions() const {
+    return sockets_by_transaction_id_.size();
+  }
+
+ private:
+  friend class MuxedUdpSocket;
+
+  void RemoveSocket(MuxedUdpSocket* socket);
+  void UpdateLocalUfrag(MuxedUdpSocket* socket, const std::string& old_ufrag);
+  int SendTo(MuxedUdpSocket* socket,
+             const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options);
+  void AddRemoteAddress(const rtc::SocketAddress& addr,
+                        MuxedUdpSocket* socket);
+  void AddPendingTransaction(const std::string& transaction_id,
+                             MuxedUdpSocket* socket);
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time);
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet);
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket);
+
+  rtc::ThreadChecker thread_checker_;
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::set<MuxedUdpSocket*> sockets_;
+  std::unordered_map<std::string, MuxedUdpSocket*> sockets_by_ufrag_;
+  std::unordered_map<rtc::SocketAddress,
+                     MuxedUdpSocket*,
+                     SocketAddressIpPortHash,
+                     SocketAddressIpPortEqual>
+      sockets_by_address_;
+  std::unordered_map<std::string, MuxedUdpSocket*> sockets_by_transaction_id_;
+  // The socket currently sending, which SignalSentPacket of the shared socket
+  // is forwarded to.
+  MuxedUdpSocket* sending_socket_ = nullptr;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(UdpPortMux);
+};
+
+// Returns the local ufrag of the USERNAME attribute if |data| is a STUN
+// binding request, without parsing the rest of the message.
+bool GetStunBindingRequestLocalUfrag(const char* data,
+                                     size_t size,
+                                     std::string* local_ufrag);
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_UDPPORTMUX_H_
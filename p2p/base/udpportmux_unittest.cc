@@ -0,0 +1,232 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/basicpacketsocketfactory.h"
+#include "p2p/base/stun.h"
+#include "p2p/base/teststunserver.h"
+#include "p2p/base/udpportmux.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtualsocketserver.h"
+
+namespace cricket {
+
+namespace {
+
+const rtc::SocketAddress kMuxAddr("11.11.11.11", 3478);
+const rtc::SocketAddress kClientAddr1("22.22.22.22", 5000);
+const rtc::SocketAddress kClientAddr2("33.33.33.33", 5000);
+const rtc::SocketAddress kStunAddr("44.44.44.44", 3478);
+
+// Records the packets received on a socket.
+class PacketReceiver : public sigslot::has_slots<> {
+ public:
+  explicit PacketReceiver(rtc::AsyncPacketSocket* socket) {
+    socket->SignalReadPacket.connect(this, &PacketReceiver::OnReadPacket);
+  }
+
+  int num_packets() const { return num_packets_; }
+  const rtc::SocketAddress& last_remote_addr() const {
+    return last_remote_addr_;
+  }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time) {
+    ++num_packets_;
+    last_remote_addr_ = remote_addr;
+  }
+
+  int num_packets_ = 0;
+  rtc::SocketAddress last_remote_addr_;
+};
+
+std::string BindingRequest(const std::string& username) {
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddAttribute(
+      absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USERNAME, username));
+  msg.AddAttribute(absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY,
+                                                          0x6e0001ff));
+  msg.AddMessageIntegrity("password");
+  msg.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+// A binding request to a STUN server, as sent to gather a srflx candidate.
+std::string StunServerRequest(const std::string& transaction_id) {
+  StunMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID(transaction_id);
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+}  // namespace
+
+class UdpPortMuxTest : public testing::Test {
+ public:
+  UdpPortMuxTest()
+      : ss_(new rtc::VirtualSocketServer()),
+        thread_(ss_.get()),
+        socket_factory_(rtc::Thread::Current()),
+        mux_(socket_factory_.CreateUdpSocket(kMuxAddr, 0, 0)),
+        client1_(socket_factory_.CreateUdpSocket(kClientAddr1, 0, 0)),
+        client2_(socket_factory_.CreateUdpSocket(kClientAddr2, 0, 0)) {}
+
+  void SendFrom(rtc::AsyncPacketSocket* client, const std::string& data) {
+    client->SendTo(data.data(), data.size(), kMuxAddr, rtc::PacketOptions());
+    ss_->ProcessMessagesUntilIdle();
+  }
+
+ protected:
+  std::unique_ptr<rtc::VirtualSocketServer> ss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  UdpPortMux mux_;
+  std::unique_ptr<rtc::AsyncPacketSocket> client1_;
+  std::unique_ptr<rtc::AsyncPacketSocket> client2_;
+};
+
+TEST_F(UdpPortMuxTest, GetStunBindingRequestLocalUfrag) {
+  std::string request = BindingRequest("local:remote");
+  std::string ufrag;
+  EXPECT_TRUE(
+      GetStunBindingRequestLocalUfrag(request.data(), request.size(), &ufrag));
+  EXPECT_EQ("local", ufrag);
+
+  EXPECT_FALSE(GetStunBindingRequestLocalUfrag(request.data(), 19, &ufrag));
+  std::string no_colon = BindingRequest("localremote");
+  EXPECT_FALSE(GetStunBindingRequestLocalUfrag(no_colon.data(),
+                                               no_colon.size(), &ufrag));
+  std::string media = "\x80\x60media packet";
+  EXPECT_FALSE(
+      GetStunBindingRequestLocalUfrag(media.data(), media.size(), &ufrag));
+}
+
+TEST_F(UdpPortMuxTest, RoutesBindingRequestsByUfragAndMediaByAddress) {
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  std::unique_ptr<MuxedUdpSocket> socket2(mux_.CreateSocket("ufrag2"));
+  PacketReceiver receiver1(socket1.get());
+  PacketReceiver receiver2(socket2.get());
+  EXPECT_EQ(kMuxAddr, socket1->GetLocalAddress());
+
+  // Media from an unknown address is dropped.
+  SendFrom(client1_.get(), "media");
+  EXPECT_EQ(0, receiver1.num_packets());
+  EXPECT_EQ(0, receiver2.num_packets());
+
+  SendFrom(client1_.get(), BindingRequest("ufrag2:remote"));
+  EXPECT_EQ(1, receiver2.num_packets());
+  EXPECT_EQ(kClientAddr1, receiver2.last_remote_addr());
+
+  // Once learned, media from the same address goes to the same session.
+  SendFrom(client1_.get(), "media");
+  EXPECT_EQ(0, receiver1.num_packets());
+  EXPECT_EQ(2, receiver2.num_packets());
+
+  // A request for another ufrag from a known address does not move it.
+  SendFrom(client1_.get(), BindingRequest("ufrag1:remote"));
+  EXPECT_EQ(1, receiver1.num_packets());
+  SendFrom(client1_.get(), "media");
+  EXPECT_EQ(3, receiver2.num_packets());
+}
+
+TEST_F(UdpPortMuxTest, SendingRoutesRemoteAddress) {
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  PacketReceiver receiver1(socket1.get());
+  PacketReceiver client_receiver(client2_.get());
+
+  EXPECT_EQ(5, socket1->SendTo("hello", 5, kClientAddr2, rtc::PacketOptions()));
+  ss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(1, client_receiver.num_packets());
+  EXPECT_EQ(kMuxAddr, client_receiver.last_remote_addr());
+
+  SendFrom(client2_.get(), "media");
+  EXPECT_EQ(1, receiver1.num_packets());
+}
+
+TEST_F(UdpPortMuxTest, DestroyedSocketStopsReceiving) {
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  SendFrom(client1_.get(), BindingRequest("ufrag1:remote"));
+  EXPECT_EQ(1u, mux_.num_remote_addresses());
+
+  socket1.reset();
+  EXPECT_EQ(0u, mux_.num_sockets());
+  EXPECT_EQ(0u, mux_.num_remote_addresses());
+  // Does not crash.
+  SendFrom(client1_.get(), "media");
+}
+
+TEST_F(UdpPortMuxTest, RoutesResponsesOfSharedStunServerByTransactionId) {
+  std::unique_ptr<TestStunServer> stun_server(
+      TestStunServer::Create(rtc::Thread::Current(), kStunAddr));
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  std::unique_ptr<MuxedUdpSocket> socket2(mux_.CreateSocket("ufrag2"));
+  PacketReceiver receiver1(socket1.get());
+  PacketReceiver receiver2(socket2.get());
+
+  // Both sessions have requests outstanding when the responses arrive, the
+  // second one having sent to the server last.
+  std::string request1 = StunServerRequest("transaction1");
+  std::string request2 = StunServerRequest("transaction2");
+  socket1->SendTo(request1.data(), request1.size(), kStunAddr,
+                  rtc::PacketOptions());
+  socket2->SendTo(request2.data(), request2.size(), kStunAddr,
+                  rtc::PacketOptions());
+  EXPECT_EQ(2u, mux_.num_pending_transactions());
+  ss_->ProcessMessagesUntilIdle();
+
+  EXPECT_EQ(1, receiver1.num_packets());
+  EXPECT_EQ(kStunAddr, receiver1.last_remote_addr());
+  EXPECT_EQ(1, receiver2.num_packets());
+  EXPECT_EQ(kStunAddr, receiver2.last_remote_addr());
+  EXPECT_EQ(0u, mux_.num_pending_transactions());
+  // The server address is not claimed by either session.
+  EXPECT_EQ(0u, mux_.num_remote_addresses());
+}
+
+TEST_F(UdpPortMuxTest, DestroyedSocketForgetsPendingTransactions) {
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  std::string request = StunServerRequest("transaction1");
+  socket1->SendTo(request.data(), request.size(), kStunAddr,
+                  rtc::PacketOptions());
+  // A retransmission is the same transaction.
+  socket1->SendTo(request.data(), request.size(), kStunAddr,
+                  rtc::PacketOptions());
+  EXPECT_EQ(1u, mux_.num_pending_transactions());
+  socket1.reset();
+  EXPECT_EQ(0u, mux_.num_pending_transactions());
+}
+
+TEST_F(UdpPortMuxTest, SetLocalUfrag) {
+  std::unique_ptr<MuxedUdpSocket> socket1(mux_.CreateSocket("ufrag1"));
+  PacketReceiver receiver1(socket1.get());
+  socket1->SetLocalUfrag("ufrag3");
+
+  SendFrom(client1_.get(), BindingRequest("ufrag1:remote"));
+  EXPECT_EQ(0, receiver1.num_packets());
+  SendFrom(client1_.get(), BindingRequest("ufrag3:remote"));
+  EXPECT_EQ(1, receiver1.num_packets());
+}
+
+}  // namespace cricket
@@ -245,6 +245,11 @@ void BasicPortAllocator::AddTurnServer(const RelayServerConfig& turn_server) {
                    prune_turn_ports(), turn_customizer());
 }
 
+void BasicPortAllocator::SetUdpPortMux(UdpPortMux* udp_port_mux) {
+  CheckRunOnValidThreadIfInitialized();
+  udp_port_mux_ = udp_port_mux;
+}
+
 void BasicPortAllocator::InitRelayPortFactory(
     RelayPortFactoryInterface* relay_port_factory) {
   if (relay_port_factory != nullptr) {
@@ -584,6 +589,9 @@ void BasicPortAllocatorSession::UpdateIceParametersInternal() {
     port.port()->set_content_name(content_name());
     port.port()->SetIceParameters(component(), ice_ufrag(), ice_pwd());
   }
+  for (AllocationSequence* sequence : sequences_) {
+    sequence->OnIceParametersChanged();
+  }
 }
 
 void BasicPortAllocatorSession::GetPortConfigurations() {
@@ -1330,9 +1338,17 @@ AllocationSequence::AllocationSequence(BasicPortAllocatorSession* session,
 
 void AllocationSequence::Init() {
   if (IsFlagSet(PORTALLOCATOR_ENABLE_SHARED_SOCKET)) {
-    udp_socket_.reset(session_->socket_factory()->CreateUdpSocket(
-        rtc::SocketAddress(network_->GetBestIP(), 0),
-        session_->allocator()->min_port(), session_->allocator()->max_port()));
+    UdpPortMux* udp_port_mux = session_->allocator()->udp_port_mux();
+    if (udp_port_mux &&
+        udp_port_mux->GetLocalAddress().ipaddr() == network_->GetBestIP()) {
+      muxed_udp_socket_ = udp_port_mux->CreateSocket(session_->username());
+      udp_socket_.reset(muxed_udp_socket_);
+    } else {
+      udp_socket_.reset(session_->socket_factory()->CreateUdpSocket(
+          rtc::SocketAddress(network_->GetBestIP(), 0),
+          session_->allocator()->min_port(),
+          session_->allocator()->max_port()));
+    }
     if (udp_socket_) {
       udp_socket_->SignalReadPacket.connect(this,
                                             &AllocationSequence::OnReadPacket);
@@ -1347,6 +1363,12 @@ void AllocationSequence::Clear() {
   relay_ports_.clear();
 }
 
+void AllocationSequence::OnIceParametersChanged() {
+  if (muxed_udp_socket_) {
+    muxed_udp_socket_->SetLocalUfrag(session_->username());
+  }
+}
+
 void AllocationSequence::OnNetworkFailed() {
   RTC_DCHECK(!network_failed_);
   network_failed_ = true;
@@ -1662,8 +1684,10 @@ void AllocationSequence::CreateTurnPort(const RelayServerConfig& config) {
     // don't pass shared socket for ports which will create TCP sockets.
     // TODO(mallinath) - Enable shared socket mode for TURN ports. Disabled
     // due to webrtc bug https://code.google.com/p/webrtc/issues/detail?id=3537
+    // A socket on the UdpPortMux is shared with other sessions, whose
+    // allocations on the same TURN server would collide with this one.
     if (IsFlagSet(PORTALLOCATOR_ENABLE_SHARED_SOCKET) &&
-        relay_port->proto == PROTO_UDP && udp_socket_) {
+        relay_port->proto == PROTO_UDP && udp_socket_ && !muxed_udp_socket_) {
       port = session_->allocator()->relay_port_factory()->Create(
           args, udp_socket_.get());
 
@@ -17,6 +17,7 @@
 
 #include "api/turncustomizer.h"
 #include "p2p/base/portallocator.h"
+#include "p2p/base/udpportmux.h"
 #include "p2p/client/relayportfactoryinterface.h"
 #include "p2p/client/turnportfactory.h"
 #include "rtc_base/checks.h"
@@ -78,6 +79,17 @@ class BasicPortAllocator : public PortAllocator {
     return relay_port_factory_;
   }
 
+  // Sets a mux whose shared socket is used, instead of a socket per session,
+  // for the UDP ports of sessions allocated in shared socket mode
+  // (PORTALLOCATOR_ENABLE_SHARED_SOCKET) on the network of the mux's local
+  // address. Relay ports of these sessions still get a socket of their own.
+  // Not owned; must outlive the sessions of this allocator.
+  void SetUdpPortMux(UdpPortMux* udp_port_mux);
+  UdpPortMux* udp_port_mux() {
+    CheckRunOnValidThreadIfInitialized();
+    return udp_port_mux_;
+  }
+
  private:
   void Construct();
 
@@ -97,6 +109,8 @@ class BasicPortAllocator : public PortAllocator {
 
   // This instance is created if caller does pass a factory.
   std::unique_ptr<RelayPortFactoryInterface> default_relay_port_factory_;
+
+  UdpPortMux* udp_port_mux_ = nullptr;
 };
 
 struct PortConfiguration;
@@ -350,6 +364,8 @@ class AllocationSequence : public rtc::MessageHandler,
   void Init();
   void Clear();
   void OnNetworkFailed();
+  // Called when the ICE credentials of the session change.
+  void OnIceParametersChanged();
 
   State state() const { return state_; }
   rtc::Network* network() const { return network_; }
@@ -411,6 +427,8 @@ class AllocationSequence : public rtc::MessageHandler,
   uint32_t flags_;
   ProtocolList protocols_;
   std::unique_ptr<rtc::AsyncPacketSocket> udp_socket_;
+  // Set if |udp_socket_| is a socket on the allocator's UdpPortMux.
+  MuxedUdpSocket* muxed_udp_socket_ = nullptr;
   // There will be only one udp port per AllocationSequence.
   UDPPort* udp_port_;
   std::vector<Port*> relay_ports_;
@@ -199,10 +199,7 @@ bool FindMatchingCrypto(const CryptoParamsVec& cryptos,
 // low overhead.
 void GetSupportedAudioSdesCryptoSuites(const rtc::CryptoOptions& crypto_options,
                                        std::vector<int>* crypto_suites) {
-  if (crypto_options.enable_gcm_crypto_suites) {
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_256_GCM);
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_128_GCM);
-  }
+  rtc::GetSupportedGcmCryptoSuites(crypto_options, crypto_suites);
   if (crypto_options.enable_aes128_sha1_32_crypto_cipher) {
     crypto_suites->push_back(rtc::SRTP_AES128_CM_SHA1_32);
   }
@@ -218,10 +215,7 @@ void GetSupportedAudioSdesCryptoSuiteNames(
 
 void GetSupportedVideoSdesCryptoSuites(const rtc::CryptoOptions& crypto_options,
                                        std::vector<int>* crypto_suites) {
-  if (crypto_options.enable_gcm_crypto_suites) {
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_256_GCM);
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_128_GCM);
-  }
+  rtc::GetSupportedGcmCryptoSuites(crypto_options, crypto_suites);
   crypto_suites->push_back(rtc::SRTP_AES128_CM_SHA1_80);
 }
 
@@ -234,10 +228,7 @@ void GetSupportedVideoSdesCryptoSuiteNames(
 
 void GetSupportedDataSdesCryptoSuites(const rtc::CryptoOptions& crypto_options,
                                       std::vector<int>* crypto_suites) {
-  if (crypto_options.enable_gcm_crypto_suites) {
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_256_GCM);
-    crypto_suites->push_back(rtc::SRTP_AEAD_AES_128_GCM);
-  }
+  rtc::GetSupportedGcmCryptoSuites(crypto_options, crypto_suites);
   crypto_suites->push_back(rtc::SRTP_AES128_CM_SHA1_80);
 }
 
@@ -25,6 +25,7 @@
 #include "pc/peerconnection.h"
 #include "pc/rtcstatstraversal.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/future.h"
 #include "rtc_base/strings/string_builder.h"
 #include "rtc_base/timeutils.h"
 #include "rtc_base/trace_event.h"
@@ -707,6 +708,12 @@ RTCStatsCollector::RequestInfo::RequestInfo(
   RTC_DCHECK(!sender_selector_ || !receiver_selector_);
 }
 
+RTCStatsCollector::MediaStats::MediaStats() = default;
+
+RTCStatsCollector::MediaStats::MediaStats(MediaStats&& other) = default;
+
+RTCStatsCollector::MediaStats::~MediaStats() = default;
+
 rtc::scoped_refptr<RTCStatsCollector> RTCStatsCollector::Create(
     PeerConnectionInternal* pc,
     int64_t cache_lifetime_us) {
@@ -787,24 +794,68 @@ void RTCStatsCollector::GetStatsReportInternal(
 
     // Prepare |transceiver_stats_infos_| for use in
     // |ProducePartialResultsOnNetworkThread| and
-    // |ProducePartialResultsOnSignalingThread|.
+    // |ProducePartialResultsOnSignalingThread|. Their TrackMediaInfoMaps are
+    // filled in by |OnMediaStats_s|.
     transceiver_stats_infos_ = PrepareTransceiverStatsInfos_s();
     // Prepare |transport_names_| for use in
     // |ProducePartialResultsOnNetworkThread|.
     transport_names_ = PrepareTransportNames_s();
 
-    // Prepare |call_stats_| here since GetCallStats() will hop to the worker
-    // thread.
-    // TODO(holmer): To avoid the hop we could move BWE and BWE stats to the
-    // network thread, where it more naturally belongs.
-    call_stats_ = pc_->GetCallStats();
+    // Get the media channel stats and the call stats on the worker thread
+    // without blocking the signaling thread, and produce the partial results
+    // once they are back.
+    rtc::InvokeAsync<MediaStats>(
+        &invoker_, RTC_FROM_HERE, worker_thread_,
+        rtc::Bind(&RTCStatsCollector::GetMediaStats_w,
+                  rtc::scoped_refptr<RTCStatsCollector>(this)))
+        .Then(signaling_thread_, [this, timestamp_us](MediaStats media_stats) {
+          OnMediaStats_s(timestamp_us, std::move(media_stats));
+        });
+  }
+}
 
-    invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, network_thread_,
-        rtc::Bind(&RTCStatsCollector::ProducePartialResultsOnNetworkThread,
-                  rtc::scoped_refptr<RTCStatsCollector>(this), timestamp_us));
-    ProducePartialResultsOnSignalingThread(timestamp_us);
+void RTCStatsCollector::OnMediaStats_s(int64_t timestamp_us,
+                                       MediaStats media_stats) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  call_stats_ = media_stats.call_stats;
+
+  // Create the TrackMediaInfoMap for each transceiver stats object.
+  for (auto& stats : transceiver_stats_infos_) {
+    auto transceiver = stats.transceiver;
+    std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info;
+    std::unique_ptr<cricket::VideoMediaInfo> video_media_info;
+    if (stats.media_channel) {
+      if (stats.media_type == cricket::MEDIA_TYPE_AUDIO) {
+        voice_media_info = std::move(media_stats.voice[static_cast<
+            cricket::VoiceMediaChannel*>(stats.media_channel)]);
+      } else if (stats.media_type == cricket::MEDIA_TYPE_VIDEO) {
+        video_media_info = std::move(media_stats.video[static_cast<
+            cricket::VideoMediaChannel*>(stats.media_channel)]);
+      }
+      if (!voice_media_info && !video_media_info) {
+        // The channel was destroyed before its stats were read.
+        stats.mid = absl::nullopt;
+        stats.transport_name = absl::nullopt;
+      }
+    }
+    std::vector<rtc::scoped_refptr<RtpSenderInternal>> senders;
+    for (auto sender : transceiver->senders()) {
+      senders.push_back(sender->internal());
+    }
+    std::vector<rtc::scoped_refptr<RtpReceiverInternal>> receivers;
+    for (auto receiver : transceiver->receivers()) {
+      receivers.push_back(receiver->internal());
+    }
+    stats.track_media_info_map = absl::make_unique<TrackMediaInfoMap>(
+        std::move(voice_media_info), std::move(video_media_info), senders,
+        receivers);
   }
+
+  invoker_.AsyncInvoke<void>(
+      RTC_FROM_HERE, network_thread_,
+      rtc::Bind(&RTCStatsCollector::ProducePartialResultsOnNetworkThread,
+                rtc::scoped_refptr<RTCStatsCollector>(this), timestamp_us));
+  ProducePartialResultsOnSignalingThread(timestamp_us);
 }
 
 void RTCStatsCollector::ClearCachedStatsReport() {
@@ -823,6 +874,18 @@ void RTCStatsCollector::WaitForPendingRequest() {
   }
 }
 
+void RTCStatsCollector::OnChannelDestroyed(cricket::BaseChannel* channel) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  rtc::CritScope lock(&media_channels_lock_);
+  if (channel->media_type() == cricket::MEDIA_TYPE_AUDIO) {
+    voice_media_channels_.erase(
+        static_cast<cricket::VoiceChannel*>(channel)->media_channel());
+  } else if (channel->media_type() == cricket::MEDIA_TYPE_VIDEO) {
+    video_media_channels_.erase(
+        static_cast<cricket::VideoChannel*>(channel)->media_channel());
+  }
+}
+
 void RTCStatsCollector::ProducePartialResultsOnSignalingThread(
     int64_t timestamp_us) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
@@ -1393,17 +1456,14 @@ RTCStatsCollector::PrepareTransportCertificateStats_n(
 }
 
 std::vector<RTCStatsCollector::RtpTransceiverStatsInfo>
-RTCStatsCollector::PrepareTransceiverStatsInfos_s() const {
+RTCStatsCollector::PrepareTransceiverStatsInfos_s() {
   std::vector<RtpTransceiverStatsInfo> transceiver_stats_infos;
 
   // These are used to invoke GetStats for all the media channels together in
   // one worker thread hop.
-  std::map<cricket::VoiceMediaChannel*,
-           std::unique_ptr<cricket::VoiceMediaInfo>>
-      voice_stats;
-  std::map<cricket::VideoMediaChannel*,
-           std::unique_ptr<cricket::VideoMediaInfo>>
-      video_stats;
+  rtc::CritScope lock(&media_channels_lock_);
+  voice_media_channels_.clear();
+  video_media_channels_.clear();
 
   for (auto transceiver : pc_->GetTransceiversInternal()) {
     cricket::MediaType media_type = transceiver->media_type();
@@ -1426,71 +1486,51 @@ RTCStatsCollector::PrepareTransceiverStatsInfos_s() const {
 
     if (media_type == cricket::MEDIA_TYPE_AUDIO) {
       auto* voice_channel = static_cast<cricket::VoiceChannel*>(channel);
-      RTC_DCHECK(voice_stats.find(voice_channel->media_channel()) ==
-                 voice_stats.end());
-      voice_stats[voice_channel->media_channel()] =
-          absl::make_unique<cricket::VoiceMediaInfo>();
+      RTC_DCHECK(voice_media_channels_.find(voice_channel->media_channel()) ==
+                 voice_media_channels_.end());
+      voice_media_channels_.insert(voice_channel->media_channel());
+      stats.media_channel = voice_channel->media_channel();
     } else if (media_type == cricket::MEDIA_TYPE_VIDEO) {
       auto* video_channel = static_cast<cricket::VideoChannel*>(channel);
-      RTC_DCHECK(video_stats.find(video_channel->media_channel()) ==
-                 video_stats.end());
-      video_stats[video_channel->media_channel()] =
-          absl::make_unique<cricket::VideoMediaInfo>();
+      RTC_DCHECK(video_media_channels_.find(video_channel->media_channel()) ==
+                 video_media_channels_.end());
+      video_media_channels_.insert(video_channel->media_channel());
+      stats.media_channel = video_channel->media_channel();
     } else {
       RTC_NOTREACHED();
     }
   }
 
-  // Call GetStats for all media channels together on the worker thread in one
-  // hop.
-  worker_thread_->Invoke<void>(RTC_FROM_HERE, [&] {
-    for (const auto& entry : voice_stats) {
-      if (!entry.first->GetStats(entry.second.get())) {
+  return transceiver_stats_infos;
+}
+
+RTCStatsCollector::MediaStats RTCStatsCollector::GetMediaStats_w() {
+  RTC_DCHECK(worker_thread_->IsCurrent());
+  MediaStats media_stats;
+  {
+    // Holding the lock keeps the channels from being destroyed while their
+    // stats are read, see |OnChannelDestroyed|.
+    rtc::CritScope lock(&media_channels_lock_);
+    for (cricket::VoiceMediaChannel* channel : voice_media_channels_) {
+      auto info = absl::make_unique<cricket::VoiceMediaInfo>();
+      if (!channel->GetStats(info.get())) {
         RTC_LOG(LS_WARNING) << "Failed to get voice stats.";
       }
+      media_stats.voice[channel] = std::move(info);
     }
-    for (const auto& entry : video_stats) {
-      if (!entry.first->GetStats(entry.second.get())) {
+    for (cricket::VideoMediaChannel* channel : video_media_channels_) {
+      auto info = absl::make_unique<cricket::VideoMediaInfo>();
+      if (!channel->GetStats(info.get())) {
         RTC_LOG(LS_WARNING) << "Failed to get video stats.";
       }
+      media_stats.video[channel] = std::move(info);
     }
-  });
-
-  // Create the TrackMediaInfoMap for each transceiver stats object.
-  for (auto& stats : transceiver_stats_infos) {
-    auto transceiver = stats.transceiver;
-    std::unique_ptr<cricket::VoiceMediaInfo> voice_media_info;
-    std::unique_ptr<cricket::VideoMediaInfo> video_media_info;
-    if (transceiver->channel()) {
-      cricket::MediaType media_type = transceiver->media_type();
-      if (media_type == cricket::MEDIA_TYPE_AUDIO) {
-        auto* voice_channel =
-            static_cast<cricket::VoiceChannel*>(transceiver->channel());
-        RTC_DCHECK(voice_stats[voice_channel->media_channel()]);
-        voice_media_info =
-            std::move(voice_stats[voice_channel->media_channel()]);
-      } else if (media_type == cricket::MEDIA_TYPE_VIDEO) {
-        auto* video_channel =
-            static_cast<cricket::VideoChannel*>(transceiver->channel());
-        RTC_DCHECK(video_stats[video_channel->media_channel()]);
-        video_media_info =
-            std::move(video_stats[video_channel->media_channel()]);
-      }
-    }
-    std::vector<rtc::scoped_refptr<RtpSenderInternal>> senders;
-    for (auto sender : transceiver->senders()) {
-      senders.push_back(sender->internal());
-    }
-    std::vector<rtc::scoped_refptr<RtpReceiverInternal>> receivers;
-    for (auto receiver : transceiver->receivers()) {
-      receivers.push_back(receiver->internal());
-    }
-    stats.track_media_info_map = absl::make_unique<TrackMediaInfoMap>(
-        std::move(voice_media_info), std::move(video_media_info), senders,
-        receivers);
+    voice_media_channels_.clear();
+    video_media_channels_.clear();
   }
-
-  return transceiver_stats_infos;
+  // GetCallStats() does not hop when called on the worker thread.
+  media_stats.call_stats = pc_->GetCallStats();
+  return media_stats;
 }
 
 std::set<std::string> RTCStatsCollector::PrepareTransportNames_s() const {
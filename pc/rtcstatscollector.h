@@ -27,10 +27,12 @@
 #include "pc/peerconnectioninternal.h"
 #include "pc/trackmediainfomap.h"
 #include "rtc_base/asyncinvoker.h"
+#include "rtc_base/criticalsection.h"
 #include "rtc_base/refcount.h"
 #include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/sigslot.h"
 #include "rtc_base/sslidentity.h"
+#include "rtc_base/thread_annotations.h"
 #include "rtc_base/timeutils.h"
 
 namespace webrtc {
@@ -73,6 +75,11 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // completed. Must be called on the signaling thread.
   void WaitForPendingRequest();
 
+  // Must be called on the signaling thread before |channel| is destroyed, so
+  // that a request in flight on the worker thread no longer reads from its
+  // media channel.
+  void OnChannelDestroyed(cricket::BaseChannel* channel);
+
  protected:
   RTCStatsCollector(PeerConnectionInternal* pc, int64_t cache_lifetime_us);
   ~RTCStatsCollector();
@@ -148,6 +155,24 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
     absl::optional<std::string> mid;
     absl::optional<std::string> transport_name;
     std::unique_ptr<TrackMediaInfoMap> track_media_info_map;
+    // The media channel of the BaseChannel when the request was made. Only
+    // used to look up the stats fetched on the worker thread.
+    cricket::MediaChannel* media_channel = nullptr;
+  };
+
+  // Stats fetched on the worker thread for a request, in one hop.
+  struct MediaStats {
+    MediaStats();
+    MediaStats(MediaStats&& other);
+    ~MediaStats();
+
+    std::map<cricket::VoiceMediaChannel*,
+             std::unique_ptr<cricket::VoiceMediaInfo>>
+        voice;
+    std::map<cricket::VideoMediaChannel*,
+             std::unique_ptr<cricket::VideoMediaInfo>>
+        video;
+    Call::Stats call_stats;
   };
 
   void AddPartialResults_s(rtc::scoped_refptr<RTCStatsReport> partial_report);
@@ -208,7 +233,13 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   PrepareTransportCertificateStats_n(
       const std::map<std::string, cricket::TransportStats>&
           transport_stats_by_name) const;
-  std::vector<RtpTransceiverStatsInfo> PrepareTransceiverStatsInfos_s() const;
+  // Returns the transceiver stats without their TrackMediaInfoMap, and records
+  // the media channels to read stats from on the worker thread.
+  std::vector<RtpTransceiverStatsInfo> PrepareTransceiverStatsInfos_s();
+  MediaStats GetMediaStats_w();
+  // Fills in the TrackMediaInfoMaps of |transceiver_stats_infos_| from
+  // |media_stats| and produces the partial results.
+  void OnMediaStats_s(int64_t timestamp_us, MediaStats media_stats);
   std::set<std::string> PrepareTransportNames_s() const;
 
   // Slots for signals (sigslot) that are wired up to |pc_|.
@@ -237,6 +268,13 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
 
   Call::Stats call_stats_;
 
+  // The media channels whose stats are read by |GetMediaStats_w|.
+  rtc::CriticalSection media_channels_lock_;
+  std::set<cricket::VoiceMediaChannel*> voice_media_channels_
+      RTC_GUARDED_BY(media_channels_lock_);
+  std::set<cricket::VideoMediaChannel*> video_media_channels_
+      RTC_GUARDED_BY(media_channels_lock_);
+
   // A timestamp, in microseconds, that is based on a timer that is
   // monotonically increasing. That is, even if the system clock is modified the
   // difference between the timer and this timestamp is how fresh the cached
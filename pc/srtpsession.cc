@@ -16,6 +16,7 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/sslstreamadapter.h"
 #include "system_wrappers/include/metrics.h"
+#include "third_party/libsrtp/crypto/include/crypto_kernel.h"
 #include "third_party/libsrtp/include/srtp.h"
 #include "third_party/libsrtp/include/srtp_priv.h"
 
@@ -26,6 +27,25 @@ namespace cricket {
 // in srtp.h.
 constexpr int kSrtpErrorCodeBoundary = 28;
 
+namespace {
+
+// libsrtp only registers the GCM ciphers when its crypto is OpenSSL, so this
+// tells the backend apart at runtime, whichever build flags libsrtp was built
+// with. Requires libsrtp to be initialized.
+bool CryptoKernelHasGcm() {
+  srtp_cipher_t* cipher = nullptr;
+  const int kGcmAuthTagLen = 16;
+  if (srtp_crypto_kernel_alloc_cipher(SRTP_AES_GCM_128, &cipher,
+                                      SRTP_AES_GCM_128_KEY_LEN_WSALT,
+                                      kGcmAuthTagLen) != srtp_err_status_ok) {
+    return false;
+  }
+  srtp_cipher_dealloc(cipher);
+  return true;
+}
+
+}  // namespace
+
 SrtpSession::SrtpSession() {}
 
 SrtpSession::~SrtpSession() {
@@ -323,6 +343,24 @@ bool SrtpSession::DoSetKey(int type,
   rtp_auth_tag_len_ = policy.rtp.auth_tag_len;
   rtcp_auth_tag_len_ = policy.rtcp.auth_tag_len;
   external_auth_active_ = (policy.rtp.auth_type == EXTERNAL_HMAC_SHA1);
+
+  // The stream template holds the cipher and auth instances that libsrtp
+  // allocated for the policy; their types tell which implementation is used.
+  srtp_stream_ctx_t* srtp_context = session_->stream_template;
+  if (srtp_context && srtp_context->session_keys &&
+      srtp_context->session_keys->rtp_cipher &&
+      srtp_context->session_keys->rtp_auth) {
+    const srtp_session_keys_t* keys = srtp_context->session_keys;
+    std::string crypto_backend =
+        std::string(keys->rtp_cipher->type->description) + ", " +
+        keys->rtp_auth->type->description;
+    if (crypto_backend != crypto_backend_) {
+      crypto_backend_ = crypto_backend;
+      RTC_LOG(LS_INFO) << "SRTP session using "
+                       << rtc::SrtpCryptoSuiteToName(cs) << " with "
+                       << crypto_backend_;
+    }
+  }
   return true;
 }
 
@@ -368,6 +406,15 @@ void SrtpSession::SetMetricsObserver(
   metrics_observer_ = metrics_observer;
 }
 
+// static
+bool SrtpSession::IsOpenSslCryptoBackend() {
+  if (!IncrementLibsrtpUsageCountAndMaybeInit())
+    return false;
+  bool has_gcm = CryptoKernelHasGcm();
+  DecrementLibsrtpUsageCountAndMaybeDeinit();
+  return has_gcm;
+}
+
 int g_libsrtp_usage_count = 0;
 rtc::GlobalLockPod g_libsrtp_lock;
 
@@ -395,6 +442,12 @@ bool SrtpSession::IncrementLibsrtpUsageCountAndMaybeInit() {
       RTC_LOG(LS_ERROR) << "Failed to initialize fake auth, err=" << err;
       return false;
     }
+
+    if (!CryptoKernelHasGcm()) {
+      RTC_LOG(LS_WARNING) << "libsrtp is built with its internal crypto; "
+                             "SRTP won't use AES-NI or the SHA extensions, "
+                             "and GCM cipher suites are unavailable.";
+    }
   }
   ++g_libsrtp_usage_count;
   return true;
@@ -11,6 +11,7 @@
 #ifndef PC_SRTPSESSION_H_
 #define PC_SRTPSESSION_H_
 
+#include <string>
 #include <vector>
 
 #include "api/umametrics.h"
@@ -87,6 +88,17 @@ class SrtpSession {
   void SetMetricsObserver(
       rtc::scoped_refptr<webrtc::MetricsObserverInterface> metrics_observer);
 
+  // Describes the cipher and authentication implementations that libsrtp
+  // picked for the current cipher suite, e.g. "AES-128 GCM using openssl".
+  // Empty until the keys have been set.
+  const std::string& crypto_backend() const { return crypto_backend_; }
+
+  // Returns true if libsrtp does its crypto with OpenSSL/BoringSSL, which uses
+  // AES-NI and the SHA extensions on CPUs that have them, rather than with
+  // its own portable C implementations. The GCM cipher suites are only
+  // available with OpenSSL, which is what this probes libsrtp for.
+  static bool IsOpenSslCryptoBackend();
+
   static bool Init();
   // Calls srtp_shutdown if it's initialized.
   static void Terminate();
@@ -130,6 +142,7 @@ class SrtpSession {
   int last_send_seq_num_ = -1;
   bool external_auth_active_ = false;
   bool external_auth_enabled_ = false;
+  std::string crypto_backend_;
   rtc::scoped_refptr<webrtc::MetricsObserverInterface> metrics_observer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(SrtpSession);
 };
@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "pc/srtpsession.h"
+#include "rtc_base/byteorder.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/sslstreamadapter.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+
+namespace {
+
+const int kNumPackets = 20000;
+const size_t kRtpHeaderSize = 12;
+const size_t kMaxSrtpOverhead = 16;
+// Audio, a typical small video packet and a full-size video packet.
+const size_t kPacketSizes[] = {100, 300, 1200};
+const int kCryptoSuites[] = {rtc::SRTP_AES128_CM_SHA1_80,
+                             rtc::SRTP_AES128_CM_SHA1_32,
+                             rtc::SRTP_AEAD_AES_128_GCM,
+                             rtc::SRTP_AEAD_AES_256_GCM};
+
+// Enough for the longest key and salt, AES-256 GCM.
+const uint8_t kKey[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefgh";
+
+std::vector<std::vector<uint8_t>> CreateRtpPackets(size_t packet_size) {
+  std::vector<std::vector<uint8_t>> packets(kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    std::vector<uint8_t>& packet = packets[i];
+    packet.resize(packet_size + kMaxSrtpOverhead);
+    for (size_t j = kRtpHeaderSize; j < packet_size; ++j)
+      packet[j] = static_cast<uint8_t>(i + j);
+    packet[0] = 0x80;
+    packet[1] = 96;
+    rtc::SetBE16(&packet[2], static_cast<uint16_t>(i));
+    rtc::SetBE32(&packet[4], i * 3000);
+    rtc::SetBE32(&packet[8], 0x12345678);
+  }
+  return packets;
+}
+
+double ToMbps(size_t packet_size, int64_t elapsed_ns) {
+  return 8.0 * packet_size * kNumPackets * 1000 / elapsed_ns;
+}
+
+void PrintThroughput(const std::string& direction,
+                     int crypto_suite,
+                     size_t packet_size,
+                     double mbps) {
+  webrtc::test::PrintResult(
+      "srtp_" + direction, "_" + rtc::SrtpCryptoSuiteToName(crypto_suite),
+      rtc::ToString(packet_size) + "_bytes", mbps, "Mbps", false);
+}
+
+}  // namespace
+
+// Measures how fast packets of typical sizes are protected and unprotected
+// with each SRTP crypto suite. The numbers depend heavily on whether libsrtp
+// uses OpenSSL, which is reported alongside them.
+TEST(SrtpPerformanceTest, ProtectAndUnprotectRtp) {
+  const std::vector<int> no_extension_ids;
+  for (int crypto_suite : kCryptoSuites) {
+    int key_len;
+    int salt_len;
+    ASSERT_TRUE(rtc::GetSrtpKeyAndSaltLengths(crypto_suite, &key_len,
+                                              &salt_len));
+    for (size_t packet_size : kPacketSizes) {
+      SrtpSession sender;
+      SrtpSession receiver;
+      if (!sender.SetSend(crypto_suite, kKey, key_len + salt_len,
+                          no_extension_ids)) {
+        // GCM needs libsrtp built with OpenSSL.
+        RTC_LOG(LS_WARNING) << rtc::SrtpCryptoSuiteToName(crypto_suite)
+                            << " is not supported, skipping.";
+        break;
+      }
+      ASSERT_TRUE(receiver.SetRecv(crypto_suite, kKey, key_len + salt_len,
+                                   no_extension_ids));
+      std::vector<std::vector<uint8_t>> packets =
+          CreateRtpPackets(packet_size);
+      std::vector<int> protected_sizes(kNumPackets);
+
+      int64_t start_ns = rtc::SystemTimeNanos();
+      for (int i = 0; i < kNumPackets; ++i) {
+        ASSERT_TRUE(sender.ProtectRtp(
+            packets[i].data(), static_cast<int>(packet_size),
+            static_cast<int>(packets[i].size()), &protected_sizes[i]));
+      }
+      PrintThroughput("protect", crypto_suite, packet_size,
+                      ToMbps(packet_size, rtc::SystemTimeNanos() - start_ns));
+
+      start_ns = rtc::SystemTimeNanos();
+      for (int i = 0; i < kNumPackets; ++i) {
+        int out_len;
+        ASSERT_TRUE(receiver.UnprotectRtp(packets[i].data(),
+                                          protected_sizes[i], &out_len));
+        ASSERT_EQ(static_cast<int>(packet_size), out_len);
+      }
+      PrintThroughput("unprotect", crypto_suite, packet_size,
+                      ToMbps(packet_size, rtc::SystemTimeNanos() - start_ns));
+
+      if (packet_size == kPacketSizes[0]) {
+        RTC_LOG(LS_INFO) << rtc::SrtpCryptoSuiteToName(crypto_suite)
+                         << " uses " << sender.crypto_backend();
+      }
+    }
+  }
+  RTC_LOG(LS_INFO) << "libsrtp crypto backend: "
+                   << (SrtpSession::IsOpenSslCryptoBackend() ? "OpenSSL"
+                                                             : "internal");
+}
+
+}  // namespace cricket
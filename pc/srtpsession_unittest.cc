@@ -99,6 +99,16 @@ TEST_F(SrtpSessionTest, TestKeysTooShort) {
                            kEncryptedHeaderExtensionIds));
 }
 
+// Test that the crypto backend detected at runtime agrees with whether libsrtp
+// can set up a GCM session.
+TEST_F(SrtpSessionTest, TestCryptoBackendMatchesGcmSupport) {
+  // AEAD_AES_128_GCM uses a 16 byte key and a 12 byte salt.
+  const size_t kGcmKeyLen = 28;
+  EXPECT_EQ(cricket::SrtpSession::IsOpenSslCryptoBackend(),
+            s1_.SetSend(SRTP_AEAD_AES_128_GCM, kTestKey1, kGcmKeyLen,
+                        kEncryptedHeaderExtensionIds));
+}
+
 // Test that we can encrypt and decrypt RTP/RTCP using AES_CM_128_HMAC_SHA1_80.
 TEST_F(SrtpSessionTest, TestProtect_AES_CM_128_HMAC_SHA1_80) {
   EXPECT_TRUE(s1_.SetSend(SRTP_AES128_CM_SHA1_80, kTestKey1, kTestKeyLen,
@@ -311,21 +311,26 @@ int AsyncTCPSocket::Send(const void* pv,
 void AsyncTCPSocket::ProcessInput(char* data, size_t* len) {
   SocketAddress remote_addr(GetRemoteAddress());
 
+  // Signal the packets where they are, and move what is left of the last one
+  // to the front once.
+  size_t processed = 0;
   while (true) {
-    if (*len < kPacketLenSize)
-      return;
+    size_t remaining = *len - processed;
+    if (remaining < kPacketLenSize)
+      break;
 
-    PacketLength pkt_len = rtc::GetBE16(data);
-    if (*len < kPacketLenSize + pkt_len)
-      return;
+    PacketLength pkt_len = rtc::GetBE16(data + processed);
+    if (remaining < kPacketLenSize + pkt_len)
+      break;
 
-    SignalReadPacket(this, data + kPacketLenSize, pkt_len, remote_addr,
-                     CreatePacketTime(0));
+    SignalReadPacket(this, data + processed + kPacketLenSize, pkt_len,
+                     remote_addr, CreatePacketTime(0));
+    processed += kPacketLenSize + pkt_len;
+  }
 
-    *len -= kPacketLenSize + pkt_len;
-    if (*len > 0) {
-      memmove(data, data + kPacketLenSize + pkt_len, *len);
-    }
+  *len -= processed;
+  if (processed > 0 && *len > 0) {
+    memmove(data, data + processed, *len);
   }
 }
 
@@ -64,6 +64,9 @@ class AsyncTCPSocketBase : public AsyncPacketSocket {
 
   // Helper methods for |outpos_|.
   bool IsOutBufferEmpty() const { return outbuf_.size() == 0; }
+  bool OutBufferHasSpace(size_t cb) const {
+    return outbuf_.size() + cb <= max_outsize_;
+  }
   void ClearOutBuffer() { outbuf_.Clear(); }
 
  private:
@@ -11,6 +11,11 @@
 #include "rtc_base/crc32.h"
 
 #include "rtc_base/arraysize.h"
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "rtc_base/crc32_pclmul.h"
+#endif
 
 namespace rtc {
 
@@ -42,6 +47,16 @@ uint32_t UpdateCrc32(uint32_t start, const void* buf, size_t len) {
 
   uint32_t c = start ^ 0xFFFFFFFF;
   const uint8_t* u = static_cast<const uint8_t*>(buf);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  // Fold the 16-byte aligned part of the input with PCLMULQDQ, and only the
+  // tail through the table.
+  if (len >= kCrc32PclmulMinLength && Crc32PclmulSupported()) {
+    const size_t folded_len = len & ~static_cast<size_t>(15);
+    c = UpdateCrc32Pclmul(c, u, folded_len);
+    u += folded_len;
+    len -= folded_len;
+  }
+#endif
   for (size_t i = 0; i < len; ++i) {
     c = kCrc32Table[(c ^ u[i]) & 0xFF] ^ (c >> 8);
   }
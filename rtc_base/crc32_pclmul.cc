@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/crc32_pclmul.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <smmintrin.h>
+#include <wmmintrin.h>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+namespace {
+
+#if !defined(_MSC_VER)
+#if defined(__pic__) && defined(__i386__)
+inline void __cpuid(int cpu_info[4], int info_type) {
+  __asm__ volatile(
+      "mov %%ebx, %%edi\n"
+      "cpuid\n"
+      "xchg %%edi, %%ebx\n"
+      : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
+        "=d"(cpu_info[3])
+      : "a"(info_type));
+}
+#else
+inline void __cpuid(int cpu_info[4], int info_type) {
+  __asm__ volatile("cpuid\n"
+                   : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
+                     "=d"(cpu_info[3])
+                   : "a"(info_type));
+}
+#endif
+#endif  // !defined(_MSC_VER)
+
+bool DetectPclmul() {
+  int cpu_info[4];
+  __cpuid(cpu_info, 1);
+  const bool has_pclmulqdq = (cpu_info[2] & (1 << 1)) != 0;
+  const bool has_sse41 = (cpu_info[2] & (1 << 19)) != 0;
+  return has_pclmulqdq && has_sse41;
+}
+
+// Folding constants for the bit-reflected CRC32 polynomial 0x04C11DB7, from
+// the end of the paper: k1 = x^(4*128+32) mod P, k2 = x^(4*128-32) mod P,
+// k3 = x^(128+32) mod P, k4 = x^(128-32) mod P, k5 = x^64 mod P, and the
+// polynomial and its Barrett constant.
+alignas(16) const uint64_t kK1K2[] = {0x0154442bd4, 0x01c6e41596};
+alignas(16) const uint64_t kK3K4[] = {0x01751997d0, 0x00ccaa009e};
+alignas(16) const uint64_t kK5K0[] = {0x0163cd6124, 0x0000000000};
+alignas(16) const uint64_t kPoly[] = {0x01db710641, 0x01f7011641};
+
+// Returns |a| folded forward by the constant pair in |k|, xored with |b|.
+inline __m128i Fold(__m128i a, __m128i k, __m128i b) {
+  __m128i lo = _mm_clmulepi64_si128(a, k, 0x00);
+  __m128i hi = _mm_clmulepi64_si128(a, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(hi, lo), b);
+}
+
+inline __m128i Load(const uint8_t* buf) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+}
+
+}  // namespace
+
+bool Crc32PclmulSupported() {
+  static const bool supported = DetectPclmul();
+  return supported;
+}
+
+uint32_t UpdateCrc32Pclmul(uint32_t crc, const uint8_t* buf, size_t len) {
+  RTC_DCHECK_GE(len, kCrc32PclmulMinLength);
+  RTC_DCHECK_EQ(0, len % 16);
+
+  // Fold four 128-bit lanes in parallel over 64-byte blocks.
+  __m128i x1 = _mm_xor_si128(Load(buf), _mm_cvtsi32_si128(crc));
+  __m128i x2 = Load(buf + 16);
+  __m128i x3 = Load(buf + 32);
+  __m128i x4 = Load(buf + 48);
+  buf += 64;
+  len -= 64;
+
+  __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(kK1K2));
+  while (len >= 64) {
+    x1 = Fold(x1, k, Load(buf));
+    x2 = Fold(x2, k, Load(buf + 16));
+    x3 = Fold(x3, k, Load(buf + 32));
+    x4 = Fold(x4, k, Load(buf + 48));
+    buf += 64;
+    len -= 64;
+  }
+
+  // Fold the four lanes into one, then the remaining 16-byte blocks.
+  k = _mm_load_si128(reinterpret_cast<const __m128i*>(kK3K4));
+  x1 = Fold(x1, k, x2);
+  x1 = Fold(x1, k, x3);
+  x1 = Fold(x1, k, x4);
+  while (len >= 16) {
+    x1 = Fold(x1, k, Load(buf));
+    buf += 16;
+    len -= 16;
+  }
+
+  // Fold 128 bits to 64 bits.
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(kK5K0));
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits.
+  k = _mm_load_si128(reinterpret_cast<const __m128i*>(kPoly));
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+}  // namespace rtc
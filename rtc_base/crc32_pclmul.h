@@ -0,0 +1,35 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_CRC32_PCLMUL_H_
+#define RTC_BASE_CRC32_PCLMUL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rtc {
+
+// Inputs shorter than this are not worth folding with carry-less multiplies.
+constexpr size_t kCrc32PclmulMinLength = 64;
+
+// Returns true if the CPU supports the SSE4.1 and PCLMULQDQ instructions used
+// by UpdateCrc32Pclmul.
+bool Crc32PclmulSupported();
+
+// Folds |len| bytes from |buf| into the CRC32 register value |crc| (i.e. the
+// checksum before its final inversion) using carry-less multiplication, as
+// described in "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+// Instruction" (Intel, 2009). |len| must be a multiple of 16 and at least
+// kCrc32PclmulMinLength.
+uint32_t UpdateCrc32Pclmul(uint32_t crc, const uint8_t* buf, size_t len);
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_CRC32_PCLMUL_H_
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_EXPERIMENTS_FIELD_TRIAL_CACHE_H_
+#define RTC_BASE_EXPERIMENTS_FIELD_TRIAL_CACHE_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/field_trial.h"
+
+namespace webrtc {
+
+// Keeps the typed parameters parsed from a field trial, so that objects created
+// per stream do not parse the same trial string again. |T| is constructed from
+// the trial string, typically with ParseFieldTrial() and FieldTrialParameter
+// members, and must be copyable. The trial is parsed again only if its value
+// changes, so the cache can be kept for the lifetime of the process:
+//
+//   MyConfig MyConfig::FromTrial() {
+//     static FieldTrialCache<MyConfig>* const cache =
+//         new FieldTrialCache<MyConfig>("WebRTC-MyTrial");
+//     return cache->Get();
+//   }
+template <typename T>
+class FieldTrialCache {
+ public:
+  explicit FieldTrialCache(const char* trial_name) : trial_name_(trial_name) {}
+
+  // Returns the parameters parsed from the current value of the trial.
+  T Get() {
+    std::string trial_string = field_trial::FindFullName(trial_name_);
+    rtc::CritScope cs(&crit_);
+    if (!parsed_ || trial_string != trial_string_) {
+      parsed_.emplace(trial_string);
+      trial_string_ = std::move(trial_string);
+    }
+    return *parsed_;
+  }
+
+ private:
+  const char* const trial_name_;
+  rtc::CriticalSection crit_;
+  std::string trial_string_ RTC_GUARDED_BY(crit_);
+  absl::optional<T> parsed_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(FieldTrialCache);
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_EXPERIMENTS_FIELD_TRIAL_CACHE_H_
@@ -0,0 +1,58 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_base/experiments/field_trial_cache.h"
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/gunit.h"
+#include "test/field_trial.h"
+
+namespace webrtc {
+namespace {
+const char kDummyExperiment[] = "WebRTC-DummyExperiment";
+
+int parse_count = 0;
+
+struct DummyExperiment {
+  FieldTrialFlag enabled = FieldTrialFlag("Enabled");
+  FieldTrialParameter<int> retries = FieldTrialParameter<int>("r", 5);
+
+  explicit DummyExperiment(std::string field_trial) {
+    ++parse_count;
+    ParseFieldTrial({&enabled, &retries}, field_trial);
+  }
+};
+}  // namespace
+
+TEST(FieldTrialCacheTest, ParsesOnlyWhenTrialChanges) {
+  FieldTrialCache<DummyExperiment> cache(kDummyExperiment);
+  parse_count = 0;
+  {
+    test::ScopedFieldTrials field_trials(
+        "WebRTC-DummyExperiment/Enabled,r:3/");
+    EXPECT_TRUE(cache.Get().enabled.Get());
+    EXPECT_EQ(3, cache.Get().retries.Get());
+    EXPECT_EQ(1, parse_count);
+  }
+  {
+    test::ScopedFieldTrials field_trials(
+        "WebRTC-OtherExperiment/Enabled/WebRTC-DummyExperiment/r:7/");
+    EXPECT_FALSE(cache.Get().enabled.Get());
+    EXPECT_EQ(7, cache.Get().retries.Get());
+    EXPECT_EQ(2, parse_count);
+  }
+}
+
+TEST(FieldTrialCacheTest, UsesDefaultsWithoutTrial) {
+  test::ScopedFieldTrials field_trials("WebRTC-OtherExperiment/Enabled/");
+  FieldTrialCache<DummyExperiment> cache(kDummyExperiment);
+  EXPECT_FALSE(cache.Get().enabled.Get());
+  EXPECT_EQ(5, cache.Get().retries.Get());
+}
+
+}  // namespace webrtc
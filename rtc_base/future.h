@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_FUTURE_H_
+#define RTC_BASE_FUTURE_H_
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "rtc_base/asyncinvoker.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/location.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+namespace future_impl {
+
+// State shared by a Future and the call that produces its value. The
+// continuation is posted with |invoker| once both the value and the
+// continuation are known, whichever comes last.
+template <typename T>
+class FutureState : public RefCountInterface {
+ public:
+  explicit FutureState(AsyncInvoker* invoker) : invoker_(invoker) {}
+
+  void Set(T value) {
+    Thread* thread;
+    {
+      CritScope lock(&crit_);
+      RTC_DCHECK(!value_);
+      value_.emplace(std::move(value));
+      if (!callback_)
+        return;
+      thread = thread_;
+    }
+    PostCallback(thread);
+  }
+
+  void Then(Thread* thread, std::function<void(T)> callback) {
+    RTC_DCHECK(thread);
+    RTC_DCHECK(callback);
+    {
+      CritScope lock(&crit_);
+      RTC_DCHECK(!callback_);
+      thread_ = thread;
+      callback_ = std::move(callback);
+      if (!value_)
+        return;
+    }
+    PostCallback(thread);
+  }
+
+ private:
+  void PostCallback(Thread* thread) {
+    scoped_refptr<FutureState<T>> state(this);
+    invoker_->AsyncInvoke<void>(RTC_FROM_HERE, thread,
+                                [state] { state->RunCallback(); });
+  }
+
+  void RunCallback() {
+    std::function<void(T)> callback;
+    absl::optional<T> value;
+    {
+      CritScope lock(&crit_);
+      callback.swap(callback_);
+      value.emplace(std::move(*value_));
+      value_.reset();
+    }
+    callback(std::move(*value));
+  }
+
+  AsyncInvoker* const invoker_;
+  CriticalSection crit_;
+  Thread* thread_ RTC_GUARDED_BY(crit_) = nullptr;
+  std::function<void(T)> callback_ RTC_GUARDED_BY(crit_);
+  absl::optional<T> value_ RTC_GUARDED_BY(crit_);
+};
+
+// Runs |functor| and hands its return value to the state. A class rather than
+// a lambda so that move-only functors can be passed to InvokeAsync(). The
+// callback passed to Then() is kept in a std::function, so it must be
+// copyable.
+template <typename ReturnT, typename FunctorT>
+class SetFutureClosure {
+ public:
+  SetFutureClosure(scoped_refptr<FutureState<ReturnT>> state,
+                   FunctorT&& functor)
+      : state_(std::move(state)), functor_(std::forward<FunctorT>(functor)) {}
+
+  void operator()() { state_->Set(functor_()); }
+
+ private:
+  scoped_refptr<FutureState<ReturnT>> state_;
+  typename std::decay<FunctorT>::type functor_;
+};
+
+}  // namespace future_impl
+
+// The result of a call made with InvokeAsync(). Unlike Thread::Invoke(), the
+// calling thread is not blocked while the call runs; instead it passes a
+// callback to Then(), which is posted back to it with the result:
+//
+//   InvokeAsync<Call::Stats>(&invoker_, RTC_FROM_HERE, worker_thread_,
+//                            [this] { return call_->GetStats(); })
+//       .Then(signaling_thread_,
+//             [this](Call::Stats stats) { OnCallStats(stats); });
+//
+// The call and the callback are both owned by the AsyncInvoker, so neither
+// runs once it has been destroyed.
+template <typename T>
+class Future {
+ public:
+  explicit Future(scoped_refptr<future_impl::FutureState<T>> state)
+      : state_(std::move(state)) {}
+
+  // Posts |callback| to |thread| with the result once it is available. Can be
+  // called once, from any thread. |callback| must be copyable.
+  void Then(Thread* thread, std::function<void(T)> callback) {
+    RTC_DCHECK(state_);
+    state_->Then(thread, std::move(callback));
+    state_ = nullptr;
+  }
+
+ private:
+  scoped_refptr<future_impl::FutureState<T>> state_;
+};
+
+// Calls |functor| asynchronously on |thread| and returns a Future for its
+// return value.
+template <typename ReturnT, typename FunctorT>
+Future<ReturnT> InvokeAsync(AsyncInvoker* invoker,
+                            const Location& posted_from,
+                            Thread* thread,
+                            FunctorT&& functor) {
+  scoped_refptr<future_impl::FutureState<ReturnT>> state(
+      new RefCountedObject<future_impl::FutureState<ReturnT>>(invoker));
+  invoker->AsyncInvoke<void>(
+      posted_from, thread,
+      future_impl::SetFutureClosure<ReturnT, FunctorT>(
+          state, std::forward<FunctorT>(functor)));
+  return Future<ReturnT>(std::move(state));
+}
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_FUTURE_H_
@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/synchronization/spin_lock.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+
+namespace {
+
+const int kOperationsPerThread = 200000;
+const int kMaxThreads = 8;
+const int kThreadCounts[] = {1, 2, 4, kMaxThreads};
+
+// Runs |operation| kOperationsPerThread times on each of |num_threads|
+// threads, all released at once, and returns the mean wall-clock time per
+// operation in nanoseconds. |operation| is passed the index of its thread.
+class ContentionRunner {
+ public:
+  ContentionRunner(int num_threads, std::function<void(int)> operation)
+      : num_threads_(num_threads), operation_(std::move(operation)) {}
+
+  double Run() {
+    std::vector<std::unique_ptr<PlatformThread>> threads;
+    for (int i = 0; i < num_threads_; ++i) {
+      threads.emplace_back(new PlatformThread(&ContentionRunner::RunThread,
+                                              this, "ContentionRunner"));
+      threads.back()->Start();
+    }
+    while (ready_threads_.load() < num_threads_) {
+    }
+    int64_t start_ns = SystemTimeNanos();
+    start_.store(true);
+    for (auto& thread : threads)
+      thread->Stop();
+    int64_t elapsed_ns = SystemTimeNanos() - start_ns;
+    return static_cast<double>(elapsed_ns) /
+           (static_cast<double>(num_threads_) * kOperationsPerThread);
+  }
+
+ private:
+  static void RunThread(void* obj) {
+    ContentionRunner* runner = static_cast<ContentionRunner*>(obj);
+    int index = runner->ready_threads_.fetch_add(1);
+    while (!runner->start_.load()) {
+    }
+    for (int i = 0; i < kOperationsPerThread; ++i)
+      runner->operation_(index);
+  }
+
+  const int num_threads_;
+  const std::function<void(int)> operation_;
+  std::atomic<int> ready_threads_{0};
+  std::atomic<bool> start_{false};
+};
+
+// One counter per thread, either packed next to each other, so that threads
+// keep stealing the cache line from each other, or each on its own line.
+struct PackedCounter {
+  std::atomic<int64_t> value{0};
+};
+struct alignas(64) PaddedCounter {
+  std::atomic<int64_t> value{0};
+};
+
+template <typename CounterT>
+double MeasurePerThreadCounters(int num_threads) {
+  CounterT counters[kMaxThreads];
+  return ContentionRunner(num_threads,
+                          [&counters](int index) {
+                            counters[index].value.fetch_add(
+                                1, std::memory_order_relaxed);
+                          })
+      .Run();
+}
+
+void PrintNanosPerOperation(const std::string& trace,
+                            int num_threads,
+                            double ns_per_operation) {
+  webrtc::test::PrintResult("lock_contention",
+                            "_" + ToString(num_threads) + "_threads", trace,
+                            ns_per_operation, "ns", false);
+}
+
+}  // namespace
+
+// AddRef() and Release() of an object shared by all threads, like a video
+// frame buffer handed between the capture, encoder and renderer threads.
+TEST(LockContentionPerformanceTest, RefCount) {
+  for (int num_threads : kThreadCounts) {
+    scoped_refptr<RefCountedObject<RefCountInterface>> object(
+        new RefCountedObject<RefCountInterface>());
+    double ns = ContentionRunner(num_threads, [&object](int) {
+                  object->AddRef();
+                  object->Release();
+                }).Run();
+    EXPECT_TRUE(object->HasOneRef());
+    PrintNanosPerOperation("add_ref_and_release", num_threads, ns);
+  }
+}
+
+// A short critical section, a couple of counter updates like those done for
+// every packet by stats and bitrate bookkeeping, under each kind of lock.
+TEST(LockContentionPerformanceTest, ShortCriticalSection) {
+  for (int num_threads : kThreadCounts) {
+    CriticalSection crit;
+    int64_t packets = 0;
+    int64_t bytes = 0;
+    double ns = ContentionRunner(num_threads, [&](int) {
+                  CritScope scope(&crit);
+                  ++packets;
+                  bytes += 1200;
+                }).Run();
+    EXPECT_EQ(static_cast<int64_t>(num_threads) * kOperationsPerThread,
+              packets);
+    PrintNanosPerOperation("critical_section", num_threads, ns);
+
+    SpinLock spin_lock;
+    packets = 0;
+    bytes = 0;
+    ns = ContentionRunner(num_threads, [&](int) {
+           SpinLockScope scope(&spin_lock);
+           ++packets;
+           bytes += 1200;
+         }).Run();
+    EXPECT_EQ(static_cast<int64_t>(num_threads) * kOperationsPerThread,
+              packets);
+    PrintNanosPerOperation("spin_lock", num_threads, ns);
+  }
+}
+
+// Counters that are private to each thread but share a cache line, as they do
+// when small per-stream or per-thread structs are packed into an array.
+TEST(LockContentionPerformanceTest, FalseSharing) {
+  for (int num_threads : kThreadCounts) {
+    PrintNanosPerOperation("packed_counters", num_threads,
+                           MeasurePerThreadCounters<PackedCounter>(num_threads));
+    PrintNanosPerOperation("padded_counters", num_threads,
+                           MeasurePerThreadCounters<PaddedCounter>(num_threads));
+  }
+}
+
+}  // namespace rtc
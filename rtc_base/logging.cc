@@ -30,13 +30,18 @@ static const int kMaxLogLineSize = 1024 - 60;
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <cstdlib>
 #include <iomanip>
+#include <memory>
 #include <ostream>
 #include <vector>
 
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/stringencode.h"
 #include "rtc_base/strings/string_builder.h"
@@ -76,8 +81,159 @@ std::ostream& GetNoopStream() {
 
 // Global lock for log subsystem, only needed to serialize access to streams_.
 CriticalSection g_log_crit;
+// Whether streams_ is empty, for IsNoop() to check without the lock.
+std::atomic<bool> g_no_streams(true);
+
+// Serializes enabling and disabling async logging. Separate from g_log_crit,
+// which the writer thread takes to write to the streams.
+CriticalSection g_async_crit;
+std::atomic<bool> g_async_logging(false);
+
+// Stops the writer thread and writes out the queued messages before exit
+// destroys streams_ and g_log_crit.
+void StopAsyncLoggingAtExit() {
+  LogMessage::SetAsyncLogging(false);
+}
 }  // namespace
 
+// A bounded queue of formatted messages, and the thread that writes them out.
+// Logging threads claim a slot with a compare-and-swap of the enqueue position
+// and publish it with the sequence number of the slot, as in Dmitry Vyukov's
+// bounded MPMC queue, so pushing a message never waits for a lock or another
+// thread. The writer thread is the only consumer.
+class LogMessage::AsyncWriter {
+ public:
+  AsyncWriter()
+      : slots_(new Slot[kQueueSize]),
+        enqueue_pos_(0),
+        dequeue_pos_(0),
+        dropped_(0),
+        running_(false),
+        wakeup_(false, false) {
+    for (size_t i = 0; i < kQueueSize; ++i)
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  void Start() {
+    running_ = true;
+    thread_.reset(new PlatformThread(&AsyncWriter::Run, this, "LogWriter",
+                                     kNormalPriority));
+    thread_->Start();
+  }
+
+  void Stop() {
+    running_ = false;
+    wakeup_.Set();
+    thread_->Stop();
+    thread_.reset();
+    // Messages pushed while the thread was stopping.
+    WriteQueued();
+  }
+
+  // Takes the contents of |str|. Returns false, and counts the message as
+  // dropped, if the queue is full.
+  bool Push(std::string* str, LoggingSeverity severity, const char* tag) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[pos & (kQueueSize - 1)];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (sequence == pos) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < pos) {
+        // The writer has not taken the message from a queue ago yet.
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->str.swap(*str);
+    slot->severity = severity;
+    // The tag may not outlive the LogMessage, so it is copied.
+    if (tag)
+      slot->tag.assign(tag);
+    else
+      slot->tag.clear();
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // Wake up the writer early once the queue is half full.
+    if (pos - dequeue_pos_.load(std::memory_order_relaxed) == kQueueSize / 2)
+      wakeup_.Set();
+    return true;
+  }
+
+  int64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::string str;
+    LoggingSeverity severity;
+    std::string tag;
+  };
+
+  // Must be a power of two.
+  static const size_t kQueueSize = 4096;
+  // How long the writer waits for messages before it writes them out.
+  static const int kWriteIntervalMs = 10;
+
+  static void Run(void* obj) {
+    AsyncWriter* writer = static_cast<AsyncWriter*>(obj);
+    while (writer->running_.load()) {
+      writer->wakeup_.Wait(kWriteIntervalMs);
+      writer->WriteQueued();
+    }
+    writer->WriteQueued();
+  }
+
+  void WriteQueued() {
+    std::string str;
+    LoggingSeverity severity;
+    std::string tag;
+    while (Pop(&str, &severity, &tag))
+      OutputMessage(str, severity, tag.c_str());
+
+    const int64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != dropped_reported_) {
+      char buf[64];
+      SimpleStringBuilder sb(buf);
+      sb << "Dropped " << dropped - dropped_reported_
+         << " log messages, the log writer is overloaded.\n";
+      OutputMessage(sb.str(), LS_WARNING, "libjingle");
+      dropped_reported_ = dropped;
+    }
+  }
+
+  bool Pop(std::string* str, LoggingSeverity* severity, std::string* tag) {
+    const size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = &slots_[pos & (kQueueSize - 1)];
+    if (slot->sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+    str->swap(slot->str);
+    *severity = slot->severity;
+    tag->swap(slot->tag);
+    slot->sequence.store(pos + kQueueSize, std::memory_order_release);
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  const std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> enqueue_pos_;
+  // Only advanced by the consumer; read by producers to decide when to wake
+  // it up.
+  std::atomic<size_t> dequeue_pos_;
+  std::atomic<int64_t> dropped_;
+  // Accessed by the consumer only.
+  int64_t dropped_reported_ = 0;
+  std::atomic<bool> running_;
+  Event wakeup_;
+  std::unique_ptr<PlatformThread> thread_;
+};
+
 // Inefficient default implementation, override is recommended.
 void LogSink::OnLogMessage(const std::string& msg,
                            LoggingSeverity severity,
@@ -100,6 +256,10 @@ LogMessage::StreamList LogMessage::streams_ RTC_GUARDED_BY(g_log_crit);
 // Boolean options default to false (0)
 bool LogMessage::thread_, LogMessage::timestamp_;
 
+// Never destroyed, since threads may still be logging at program exit. Its
+// thread is stopped at exit though, before streams_ is destroyed.
+LogMessage::AsyncWriter* LogMessage::async_writer_ = nullptr;
+
 LogMessage::LogMessage(const char* file, int line, LoggingSeverity sev)
     : LogMessage(file, line, sev, ERRCTX_NONE, 0) {}
 
@@ -213,21 +373,38 @@ LogMessage::~LogMessage() {
   // of the constructed string. This means that we always end up creating
   // two copies here (one owned by the stream, one by the return value of
   // |str()|). It would be nice to switch to something else.
-  const std::string str = print_stream_.str();
+  std::string str = print_stream_.str();
+
+#if defined(WEBRTC_ANDROID)
+  const char* tag = tag_;
+#else
+  const char* tag = nullptr;
+#endif
+  if (g_async_logging.load(std::memory_order_acquire)) {
+    // The message is dropped if the writer has fallen behind.
+    async_writer_->Push(&str, severity_, tag);
+    return;
+  }
+  OutputMessage(str, severity_, tag);
+}
 
-  if (severity_ >= g_dbg_sev) {
+// static
+void LogMessage::OutputMessage(const std::string& str,
+                               LoggingSeverity severity,
+                               const char* tag) {
+  if (severity >= g_dbg_sev) {
 #if defined(WEBRTC_ANDROID)
-    OutputToDebug(str, severity_, tag_);
+    OutputToDebug(str, severity, tag);
 #else
-    OutputToDebug(str, severity_);
+    OutputToDebug(str, severity);
 #endif
   }
 
   CritScope cs(&g_log_crit);
   for (auto& kv : streams_) {
-    if (severity_ >= kv.second) {
+    if (severity >= kv.second) {
 #if defined(WEBRTC_ANDROID)
-      kv.first->OnLogMessage(str, severity_, tag_);
+      kv.first->OnLogMessage(str, severity, tag);
 #else
       kv.first->OnLogMessage(str);
 #endif
@@ -255,6 +432,31 @@ int LogMessage::GetMinLogSeverity() {
   return g_min_sev;
 }
 
+void LogMessage::SetAsyncLogging(bool enable) {
+  CritScope cs(&g_async_crit);
+  if (enable == g_async_logging.load())
+    return;
+  if (enable) {
+    if (!async_writer_)
+      async_writer_ = new AsyncWriter();
+    // Registered on every enable, so that it runs before the destruction of
+    // streams_, g_log_crit and any static sink added before this.
+    std::atexit(&StopAsyncLoggingAtExit);
+    async_writer_->Start();
+    g_async_logging.store(true, std::memory_order_release);
+  } else {
+    // Messages logged concurrently with this may stay queued until async
+    // logging is enabled again.
+    g_async_logging.store(false);
+    async_writer_->Stop();
+  }
+}
+
+int64_t LogMessage::GetAsyncLoggingDroppedCount() {
+  CritScope cs(&g_async_crit);
+  return async_writer_ ? async_writer_->dropped() : 0;
+}
+
 LoggingSeverity LogMessage::GetLogToDebug() {
   return g_dbg_sev;
 }
@@ -373,6 +575,7 @@ void LogMessage::UpdateMinLogSeverity()
     min_sev = std::min(min_sev, sev);
   }
   g_min_sev = min_sev;
+  g_no_streams.store(streams_.empty(), std::memory_order_relaxed);
 }
 
 #if defined(WEBRTC_ANDROID)
@@ -479,11 +682,9 @@ bool LogMessage::IsNoop(LoggingSeverity severity) {
   if (severity >= g_dbg_sev)
     return false;
 
-  // TODO(tommi): We're grabbing this lock for every LogMessage instance that
-  // is going to be logged. This introduces unnecessary synchronization for
-  // a feature that's mostly used for testing.
-  CritScope cs(&g_log_crit);
-  return streams_.size() == 0;
+  // A stream that is being added or removed may or may not get the message,
+  // as if it had been added or removed before or after logging it.
+  return g_no_streams.load(std::memory_order_relaxed);
 }
 
 void LogMessage::FinishPrintStream() {
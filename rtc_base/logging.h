@@ -45,6 +45,7 @@
 #define RTC_BASE_LOGGING_H_
 
 #include <errno.h>
+#include <stdint.h>
 
 #include <list>
 #include <sstream>
@@ -460,12 +461,22 @@ class LogMessage {
   // logging operations by pre-checking the logging level.
   static int GetMinLogSeverity();
 
+  //  AsyncLogging: Hand the formatted messages to a background thread, which
+  //   writes them to the debug output and the streams. Logging threads then
+  //   never wait for the log lock or for the streams, but messages are
+  //   dropped while the queue of the background thread is full. Disabling
+  //   writes out the queued messages before it returns, and is done at exit.
+  //   GetAsyncLoggingDroppedCount returns the number of messages dropped.
+  static void SetAsyncLogging(bool enable);
+  static int64_t GetAsyncLoggingDroppedCount();
+
   // Parses the provided parameter stream to configure the options above.
   // Useful for configuring logging from the command line.
   static void ConfigureLogging(const char* params);
 
  private:
   friend class LogMessageForTesting;
+  class AsyncWriter;
   typedef std::pair<LogSink*, LoggingSeverity> StreamAndSeverity;
   typedef std::list<StreamAndSeverity> StreamList;
 
@@ -480,6 +491,11 @@ class LogMessage {
 #else
   static void OutputToDebug(const std::string& msg, LoggingSeverity severity);
 #endif
+  // Writes a formatted message to the debug output and the streams. |tag| is
+  // only used on Android.
+  static void OutputMessage(const std::string& str,
+                            LoggingSeverity severity,
+                            const char* tag);
 
   // Checks the current global debug severity and if the |streams_| collection
   // is empty. If |severity| is smaller than the global severity and if the
@@ -511,6 +527,10 @@ class LogMessage {
   // The output streams and their associated severities
   static StreamList streams_;
 
+  // Writes the messages when async logging is enabled. Created the first time
+  // it is enabled.
+  static AsyncWriter* async_writer_;
+
   // Flags for formatting options
   static bool thread_, timestamp_;
 
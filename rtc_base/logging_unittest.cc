@@ -9,6 +9,10 @@
  */
 
 #include "rtc_base/logging.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/event.h"
@@ -294,6 +298,88 @@ TEST(LogTest, MultipleThreads) {
   EXPECT_EQ(sev, LogMessage::GetLogToStream(nullptr));
 }
 
+// Test that with async logging, the messages reach the streams in order once
+// async logging is disabled again.
+TEST(LogTest, AsyncLogging) {
+  int sev = LogMessage::GetLogToStream(nullptr);
+
+  std::string str;
+  LogSinkImpl<StringStream> stream(&str);
+  LogMessage::AddLogToStream(&stream, LS_INFO);
+  LogMessage::SetAsyncLogging(true);
+  const int64_t dropped = LogMessage::GetAsyncLoggingDroppedCount();
+
+  RTC_LOG(LS_INFO) << "FIRST";
+  RTC_LOG(LS_INFO) << "SECOND";
+  RTC_LOG(LS_VERBOSE) << "VERBOSE";
+  LogMessage::SetAsyncLogging(false);
+
+  EXPECT_EQ(dropped, LogMessage::GetAsyncLoggingDroppedCount());
+  size_t first = str.find("FIRST");
+  ASSERT_NE(std::string::npos, first);
+  EXPECT_NE(std::string::npos, str.find("SECOND", first));
+  EXPECT_EQ(std::string::npos, str.find("VERBOSE"));
+
+  LogMessage::RemoveLogToStream(&stream);
+  EXPECT_EQ(sev, LogMessage::GetLogToStream(nullptr));
+}
+
+#if GTEST_HAS_DEATH_TEST
+// A stream that writes to stderr, for death tests to match.
+class StderrLogSink : public LogSink {
+ public:
+  void OnLogMessage(const std::string& message) override {
+    fprintf(stderr, "%s", message.c_str());
+  }
+};
+
+// Test that messages still queued at exit are written out, and that the
+// writer is stopped before the streams are destroyed.
+TEST(LogTest, AsyncLoggingWritesQueuedMessagesAtExit) {
+  EXPECT_EXIT(
+      {
+        static StderrLogSink stream;
+        LogMessage::AddLogToStream(&stream, LS_INFO);
+        LogMessage::SetAsyncLogging(true);
+        RTC_LOG(LS_INFO) << "WRITTEN AT EXIT";
+        exit(0);
+      },
+      ::testing::ExitedWithCode(0), "WRITTEN AT EXIT");
+}
+#endif
+
+// A stream that blocks until it is released.
+class BlockingLogSink : public LogSink {
+ public:
+  void OnLogMessage(const std::string& message) override {
+    released_.Wait(Event::kForever);
+  }
+  void Release() { released_.Set(); }
+
+ private:
+  Event released_{true, false};
+};
+
+// Test that messages are dropped and counted, rather than blocking the logging
+// thread, while a stream holds up the writer.
+TEST(LogTest, AsyncLoggingDropsWhenOverloaded) {
+  int sev = LogMessage::GetLogToStream(nullptr);
+
+  BlockingLogSink stream;
+  LogMessage::AddLogToStream(&stream, LS_SENSITIVE);
+  LogMessage::SetAsyncLogging(true);
+  const int64_t dropped = LogMessage::GetAsyncLoggingDroppedCount();
+
+  for (int i = 0; i < 10000; ++i)
+    RTC_LOG(LS_SENSITIVE) << "RTC_LOG";
+  EXPECT_GT(LogMessage::GetAsyncLoggingDroppedCount(), dropped);
+
+  stream.Release();
+  LogMessage::SetAsyncLogging(false);
+  LogMessage::RemoveLogToStream(&stream);
+  EXPECT_EQ(sev, LogMessage::GetLogToStream(nullptr));
+}
+
 TEST(LogTest, WallClockStartTime) {
   uint32_t time = LogMessage::WallClockStartTime();
   // Expect the time to be in a sensible range, e.g. > 2012-01-01.
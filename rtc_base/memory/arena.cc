@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/arena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+constexpr size_t Arena::kDefaultBlockSize;
+
+Arena::Arena(size_t block_size) : block_size_(block_size) {
+  RTC_DCHECK_GT(block_size_, 0);
+}
+
+Arena::~Arena() = default;
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  RTC_DCHECK_GT(alignment, 0);
+  RTC_DCHECK_EQ(0, alignment & (alignment - 1));
+  RTC_DCHECK_LE(alignment, alignof(std::max_align_t));
+  while (current_block_ < blocks_.size()) {
+    Block& block = blocks_[current_block_];
+    size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (start + size <= block.size) {
+      offset_ = start + size;
+      return block.data.get() + start;
+    }
+    // Blocks are reused in order, so a block that is too small for this
+    // allocation is skipped for the rest of the frame.
+    ++current_block_;
+    offset_ = 0;
+  }
+  // new[] returns memory aligned for any fundamental type.
+  Block block;
+  block.size = std::max(size, block_size_);
+  block.data.reset(new uint8_t[block.size]);
+  capacity_ += block.size;
+  blocks_.push_back(std::move(block));
+  current_block_ = blocks_.size() - 1;
+  offset_ = size;
+  return blocks_.back().data.get();
+}
+
+void Arena::Reset() {
+  current_block_ = 0;
+  offset_ = 0;
+}
+
+}  // namespace rtc
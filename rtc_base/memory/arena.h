@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_MEMORY_ARENA_H_
+#define RTC_BASE_MEMORY_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+
+namespace rtc {
+
+// Hands out memory for objects that all die at the same time, such as the
+// temporaries created while packetizing one video frame. Allocation bumps a
+// pointer, freeing individual allocations does nothing, and Reset() makes all
+// of the memory available again at once. Blocks are kept across Reset(), so
+// once the arena has grown to what a frame needs, it stops calling malloc.
+// Not thread safe.
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 4096;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of two
+  // no larger than alignof(std::max_align_t).
+  void* Allocate(size_t size, size_t alignment);
+
+  // Constructs a T in the arena. The object must be destroyed, with
+  // Arena::Deleter or by calling its destructor, before the arena is reset.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  // Makes all memory handed out so far available again.
+  void Reset();
+
+  // Total size of the blocks owned by the arena.
+  size_t capacity() const { return capacity_; }
+
+  // Deleter for unique_ptrs to objects created with New().
+  struct Deleter {
+    template <typename T>
+    void operator()(T* object) const {
+      object->~T();
+    }
+  };
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  const size_t block_size_;
+  std::vector<Block> blocks_;
+  size_t capacity_ = 0;
+  // Index into |blocks_| of the block currently allocated from, and the
+  // offset of its first free byte.
+  size_t current_block_ = 0;
+  size_t offset_ = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, Arena::Deleter>;
+
+// Standard allocator that takes memory from an Arena, so that containers built
+// per frame can reuse it. Falls back to the heap when no arena is given, which
+// lets the same container type be used both ways.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena* arena = nullptr) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT(runtime/explicit)
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (!arena_)
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, size_t n) {
+    if (!arena_)
+      ::operator delete(p);
+  }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return !(a == b);
+}
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_MEMORY_ARENA_H_
@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/arena.h"
+
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace rtc {
+
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+class Counted {
+ public:
+  explicit Counted(int* live) : live_(live) { ++*live_; }
+  ~Counted() { --*live_; }
+
+ private:
+  int* const live_;
+};
+
+}  // namespace
+
+TEST(ArenaTest, AllocationsAreAlignedAndDisjoint) {
+  Arena arena(64);
+  uint8_t* a = static_cast<uint8_t*>(arena.Allocate(3, 1));
+  uint8_t* b = static_cast<uint8_t*>(arena.Allocate(8, 8));
+  EXPECT_TRUE(IsAligned(b, 8));
+  EXPECT_GE(b, a + 3);
+  // Larger than a block.
+  uint8_t* c = static_cast<uint8_t*>(arena.Allocate(100, 4));
+  EXPECT_TRUE(IsAligned(c, 4));
+  memset(a, 1, 3);
+  memset(b, 2, 8);
+  memset(c, 3, 100);
+  EXPECT_EQ(1, a[2]);
+  EXPECT_EQ(2, b[7]);
+}
+
+TEST(ArenaTest, ReusesMemoryAfterReset) {
+  Arena arena(256);
+  for (int i = 0; i < 100; ++i)
+    arena.Allocate(16, 8);
+  size_t capacity = arena.capacity();
+  for (int frame = 0; frame < 10; ++frame) {
+    arena.Reset();
+    for (int i = 0; i < 100; ++i)
+      arena.Allocate(16, 8);
+  }
+  EXPECT_EQ(capacity, arena.capacity());
+}
+
+TEST(ArenaTest, DeleterRunsDestructor) {
+  Arena arena;
+  int live = 0;
+  {
+    ArenaPtr<Counted> object(arena.New<Counted>(&live));
+    EXPECT_EQ(1, live);
+  }
+  EXPECT_EQ(0, live);
+}
+
+TEST(ArenaTest, AllocatorWorksWithAndWithoutArena) {
+  Arena arena;
+  std::deque<int, ArenaAllocator<int>> in_arena((ArenaAllocator<int>(&arena)));
+  std::vector<int, ArenaAllocator<int>> on_heap;
+  for (int i = 0; i < 1000; ++i) {
+    in_arena.push_back(i);
+    on_heap.push_back(i);
+  }
+  EXPECT_GT(arena.capacity(), 1000 * sizeof(int));
+  EXPECT_EQ(999, in_arena.back());
+  EXPECT_EQ(999, on_heap.back());
+}
+
+}  // namespace rtc
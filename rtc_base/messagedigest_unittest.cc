@@ -10,6 +10,7 @@
 
 #include "rtc_base/messagedigest.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/opensslhmac.h"
 #include "rtc_base/stringencode.h"
 
 namespace rtc {
@@ -151,4 +152,35 @@ TEST(MessageDigestTest, TestBadHmac) {
   EXPECT_EQ("", ComputeHmac("sha-9000", "key", "abc"));
 }
 
+// Checks that an OpenSSLHmac can be reused for several messages, and gives
+// the same results as ComputeHmac (RFC 2202 vectors).
+TEST(MessageDigestTest, TestOpenSSLHmacReuse) {
+  std::string key(80, '\xaa');
+  OpenSSLHmac hmac(DIGEST_SHA_1, key.c_str(), key.size());
+  EXPECT_EQ(20U, hmac.Size());
+  char output[20];
+  for (int i = 0; i < 2; ++i) {
+    std::string input =
+        "Test Using Larger Than Block-Size Key - Hash Key First";
+    hmac.Update(input.c_str(), 10);
+    hmac.Update(input.c_str() + 10, input.size() - 10);
+    EXPECT_EQ(sizeof(output), hmac.Finish(output, sizeof(output)));
+    EXPECT_EQ("aa4ae5e15272d00e95705637ce8a3b55ed402112",
+              hex_encode(output, sizeof(output)));
+
+    input =
+        "Test Using Larger Than Block-Size Key and Larger "
+        "Than One Block-Size Data";
+    hmac.Update(input.c_str(), input.size());
+    EXPECT_EQ(sizeof(output), hmac.Finish(output, sizeof(output)));
+    EXPECT_EQ("e8e99d0f45237d786d6bbaa7965c7808bbff1a91",
+              hex_encode(output, sizeof(output)));
+  }
+  EXPECT_EQ(0U, hmac.Finish(output, sizeof(output) - 1));
+
+  OpenSSLHmac bad_hmac("sha-9000", key.c_str(), key.size());
+  EXPECT_EQ(0U, bad_hmac.Size());
+  EXPECT_EQ(0U, bad_hmac.Finish(output, sizeof(output)));
+}
+
 }  // namespace rtc
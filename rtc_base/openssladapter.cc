@@ -23,6 +23,7 @@
 #include <openssl/x509v3.h>
 #include "rtc_base/openssl.h"
 
+#include "rtc_base/byteorder.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_conversions.h"
@@ -30,6 +31,25 @@
 #include "rtc_base/stringencode.h"
 #include "rtc_base/stringutils.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/zero_memory.h"
+
+// Kernel TLS needs the key block and sequence number, which BoringSSL exports.
+#if defined(WEBRTC_LINUX) && defined(OPENSSL_IS_BORINGSSL)
+#include <errno.h>
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#define WEBRTC_KERNEL_TLS
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TLS_SET_RECORD_TYPE
+#define TLS_SET_RECORD_TYPE 1
+#endif
+#endif
 
 #ifndef OPENSSL_IS_BORINGSSL
 
@@ -259,6 +279,10 @@ void OpenSSLAdapter::SetRole(SSLRole role) {
   role_ = role;
 }
 
+void OpenSSLAdapter::SetKernelTlsOffload(bool enable) {
+  kernel_tls_ = enable;
+}
+
 AsyncSocket* OpenSSLAdapter::Accept(SocketAddress* paddr) {
   RTC_DCHECK(role_ == SSL_SERVER);
   AsyncSocket* socket = SSLAdapter::Accept(paddr);
@@ -270,6 +294,7 @@ AsyncSocket* OpenSSLAdapter::Accept(SocketAddress* paddr) {
   adapter->SetIdentity(identity_->GetReference());
   adapter->SetRole(rtc::SSL_SERVER);
   adapter->SetIgnoreBadCert(ignore_bad_cert_);
+  adapter->SetKernelTlsOffload(kernel_tls_);
   adapter->StartSSL("", false);
   return adapter;
 }
@@ -423,6 +448,10 @@ int OpenSSLAdapter::ContinueSSL() {
       }
 
       state_ = SSL_CONNECTED;
+      if (kernel_tls_ && EnableKernelTls()) {
+        RTC_LOG(LS_INFO) << "Records are sent with kernel TLS";
+        kernel_tls_tx_ = true;
+      }
       AsyncSocketAdapter::OnConnectEvent(this);
 #if 0  // TODO(benwright): worry about this
     // Don't let ourselves go away during the callbacks
@@ -470,6 +499,7 @@ void OpenSSLAdapter::Cleanup() {
   RTC_LOG(LS_INFO) << "OpenSSLAdapter::Cleanup";
 
   state_ = SSL_NONE;
+  kernel_tls_tx_ = false;
   ssl_read_needs_write_ = false;
   ssl_write_needs_read_ = false;
   custom_cert_verifier_status_ = false;
@@ -490,6 +520,133 @@ void OpenSSLAdapter::Cleanup() {
   Thread::Current()->Clear(this, MSG_TIMEOUT);
 }
 
+bool OpenSSLAdapter::EnableKernelTls() {
+#if defined(WEBRTC_KERNEL_TLS)
+  // The kernel implements AES-GCM for TLS 1.2, where the state of the
+  // connection is just the key, the implicit part of the nonce and the
+  // sequence number. Records are still received with SSL_read, which in TLS 1.2
+  // does not send any.
+  if (ssl_mode_ != SSL_MODE_TLS || SSL_version(ssl_) != TLS1_2_VERSION)
+    return false;
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl_);
+  if (!cipher)
+    return false;
+  size_t key_len;
+  switch (SSL_CIPHER_get_id(cipher)) {
+    case TLS1_CK_RSA_WITH_AES_128_GCM_SHA256:
+    case TLS1_CK_ECDHE_RSA_WITH_AES_128_GCM_SHA256:
+    case TLS1_CK_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256:
+      key_len = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+      break;
+    case TLS1_CK_RSA_WITH_AES_256_GCM_SHA384:
+    case TLS1_CK_ECDHE_RSA_WITH_AES_256_GCM_SHA384:
+    case TLS1_CK_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384:
+      key_len = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+      break;
+    default:
+      return false;
+  }
+  const int fd = socket_->GetSocketDescriptor();
+  if (fd < 0)
+    return false;
+
+  // The key block of an AEAD cipher is the client and server write keys
+  // followed by the client and server salts.
+  const size_t salt_len = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+  uint8_t key_block[2 * (TLS_CIPHER_AES_GCM_256_KEY_SIZE +
+                         TLS_CIPHER_AES_GCM_256_SALT_SIZE)];
+  const size_t key_block_len = 2 * (key_len + salt_len);
+  if (SSL_get_key_block_len(ssl_) != key_block_len ||
+      !SSL_generate_key_block(ssl_, key_block, key_block_len)) {
+    return false;
+  }
+  const bool server = (role_ == SSL_SERVER);
+  const uint8_t* key = key_block + (server ? key_len : 0);
+  const uint8_t* salt = key_block + 2 * key_len + (server ? salt_len : 0);
+  // The explicit part of the nonce is the sequence number, as BoringSSL and
+  // the kernel choose it.
+  uint8_t seq[TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE];
+  SetBE64(seq, SSL_get_write_sequence(ssl_));
+
+  bool enabled = false;
+  if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0) {
+    // Until TLS_TX is set, the kernel passes the data through unchanged.
+    if (key_len == TLS_CIPHER_AES_GCM_128_KEY_SIZE) {
+      tls12_crypto_info_aes_gcm_128 info;
+      memset(&info, 0, sizeof(info));
+      info.info.version = TLS_1_2_VERSION;
+      info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+      memcpy(info.key, key, key_len);
+      memcpy(info.salt, salt, salt_len);
+      memcpy(info.iv, seq, sizeof(seq));
+      memcpy(info.rec_seq, seq, sizeof(seq));
+      enabled = setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info)) == 0;
+      ExplicitZeroMemory(&info, sizeof(info));
+    } else {
+      tls12_crypto_info_aes_gcm_256 info;
+      memset(&info, 0, sizeof(info));
+      info.info.version = TLS_1_2_VERSION;
+      info.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+      memcpy(info.key, key, key_len);
+      memcpy(info.salt, salt, salt_len);
+      memcpy(info.iv, seq, sizeof(seq));
+      memcpy(info.rec_seq, seq, sizeof(seq));
+      enabled = setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info)) == 0;
+      ExplicitZeroMemory(&info, sizeof(info));
+    }
+  }
+  ExplicitZeroMemory(key_block, sizeof(key_block));
+  if (!enabled) {
+    RTC_LOG(LS_INFO) << "Kernel TLS is not available, errno=" << errno;
+    return false;
+  }
+  // BoringSSL no longer knows the write sequence number, so anything it
+  // writes from now on would be framed again by the kernel. Discard its
+  // writes, and send the alerts it reports (e.g. the close_notify of
+  // SSL_shutdown) as records made by the kernel instead.
+  SSL_set0_wbio(ssl_, BIO_new(BIO_s_null()));
+  SSL_set_info_callback(ssl_, KernelTlsInfoCallback);
+  return true;
+#else
+  return false;
+#endif  // defined(WEBRTC_KERNEL_TLS)
+}
+
+#if defined(WEBRTC_KERNEL_TLS)
+void OpenSSLAdapter::KernelTlsInfoCallback(const SSL* ssl, int where, int ret) {
+#if !defined(NDEBUG)
+  SSLInfoCallback(ssl, where, ret);
+#endif
+  if ((where & SSL_CB_WRITE_ALERT) != SSL_CB_WRITE_ALERT)
+    return;
+  OpenSSLAdapter* adapter =
+      reinterpret_cast<OpenSSLAdapter*>(SSL_get_app_data(ssl));
+  // |ret| holds the alert level and description.
+  uint8_t alert[2] = {static_cast<uint8_t>(ret >> 8),
+                      static_cast<uint8_t>(ret & 0xff)};
+  const uint8_t kAlertRecordType = 21;
+  char control[CMSG_SPACE(sizeof(kAlertRecordType))];
+  memset(control, 0, sizeof(control));
+  iovec iov = {alert, sizeof(alert)};
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(kAlertRecordType));
+  memcpy(CMSG_DATA(cmsg), &kAlertRecordType, sizeof(kAlertRecordType));
+  const int fd = adapter->socket_->GetSocketDescriptor();
+  if (sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof(alert)) {
+    RTC_LOG(LS_WARNING) << "Failed to send TLS alert through the kernel, errno="
+                        << errno;
+  }
+}
+#endif  // defined(WEBRTC_KERNEL_TLS)
+
 int OpenSSLAdapter::DoSslWrite(const void* pv, size_t cb, int* error) {
   // If we have pending data (that was previously only partially written by
   // SSL_write), we shouldn't be attempting to write anything else.
@@ -550,6 +707,10 @@ int OpenSSLAdapter::Send(const void* pv, size_t cb) {
       return SOCKET_ERROR;
   }
 
+  // The kernel makes the records, and buffers like for any TCP socket.
+  if (kernel_tls_tx_)
+    return AsyncSocketAdapter::Send(pv, cb);
+
   int ret;
   int error;
 
@@ -682,6 +843,12 @@ int OpenSSLAdapter::RecvFrom(void* pv,
 }
 
 int OpenSSLAdapter::Close() {
+  // With kernel TLS, send a close_notify, which goes through
+  // KernelTlsInfoCallback, so that the peer can tell the end of the data from
+  // a truncation. The socket is closed right after, so the peer's alert is
+  // not waited for.
+  if (state_ == SSL_CONNECTED && kernel_tls_tx_)
+    SSL_shutdown(ssl_);
   Cleanup();
   state_ = restartable_ ? SSL_WAIT : SSL_NONE;
   return AsyncSocketAdapter::Close();
@@ -52,6 +52,9 @@ class OpenSSLAdapter : public SSLAdapter, public MessageHandler {
   void SetCertVerifier(SSLCertificateVerifier* ssl_cert_verifier) override;
   void SetIdentity(SSLIdentity* identity) override;
   void SetRole(SSLRole role) override;
+  void SetKernelTlsOffload(bool enable) override;
+  // Whether records are being sent with kernel TLS.
+  bool IsKernelTlsActiveForTesting() const { return kernel_tls_tx_; }
   AsyncSocket* Accept(SocketAddress* paddr) override;
   int StartSSL(const char* hostname, bool restartable) override;
   int Send(const void* pv, size_t cb) override;
@@ -94,6 +97,11 @@ class OpenSSLAdapter : public SSLAdapter, public MessageHandler {
   int ContinueSSL();
   void Error(const char* context, int err, bool signal = true);
   void Cleanup();
+  // Hands the sending of records to the kernel. Returns false if that is not
+  // possible, in which case SSL_write is still used.
+  bool EnableKernelTls();
+  // Once records are sent by the kernel, sends the alerts BoringSSL writes.
+  static void KernelTlsInfoCallback(const SSL* ssl, int where, int ret);
 
   // Return value and arguments have the same meanings as for Send; |error| is
   // an output parameter filled with the result of SSL_get_error.
@@ -146,6 +154,9 @@ class OpenSSLAdapter : public SSLAdapter, public MessageHandler {
   std::vector<std::string> elliptic_curves_;
   // Holds the result of the call to run of the ssl_cert_verify_->Verify()
   bool custom_cert_verifier_status_;
+  // Whether to try kernel TLS, and whether records are sent by the kernel.
+  bool kernel_tls_ = false;
+  bool kernel_tls_tx_ = false;
 };
 
 // The OpenSSLAdapterFactory is responsbile for creating multiple new
@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/opensslhmac.h"
+
+#include "rtc_base/checks.h"
+#include "rtc_base/openssl.h"
+#include "rtc_base/openssldigest.h"
+
+namespace rtc {
+
+OpenSSLHmac::OpenSSLHmac(const std::string& algorithm,
+                         const void* key,
+                         size_t key_len) {
+  ctx_ = HMAC_CTX_new();
+  RTC_CHECK(ctx_ != nullptr);
+  if (!OpenSSLDigest::GetDigestEVP(algorithm, &md_) ||
+      !HMAC_Init_ex(ctx_, key, key_len, md_, nullptr)) {
+    md_ = nullptr;
+  }
+}
+
+OpenSSLHmac::~OpenSSLHmac() {
+  HMAC_CTX_free(ctx_);
+}
+
+size_t OpenSSLHmac::Size() const {
+  if (!md_) {
+    return 0;
+  }
+  return EVP_MD_size(md_);
+}
+
+void OpenSSLHmac::Update(const void* buf, size_t len) {
+  if (!md_) {
+    return;
+  }
+  HMAC_Update(ctx_, static_cast<const unsigned char*>(buf), len);
+}
+
+size_t OpenSSLHmac::Finish(void* buf, size_t len) {
+  if (!md_ || len < Size()) {
+    return 0;
+  }
+  unsigned int md_len;
+  HMAC_Final(ctx_, static_cast<unsigned char*>(buf), &md_len);
+  // Passing no key and no digest reuses the precomputed key pads.
+  HMAC_Init_ex(ctx_, nullptr, 0, nullptr, nullptr);
+  RTC_DCHECK(md_len == Size());
+  return md_len;
+}
+
+}  // namespace rtc
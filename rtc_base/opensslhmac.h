@@ -0,0 +1,50 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_OPENSSLHMAC_H_
+#define RTC_BASE_OPENSSLHMAC_H_
+
+#include <openssl/hmac.h>
+
+#include <string>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/messagedigest.h"
+
+namespace rtc {
+
+// An HMAC (RFC 2104) with a fixed key, computed with OpenSSL. The digest
+// states after hashing the inner and outer key pads are derived once, when
+// the object is created, and reused for every message; prefer this over
+// ComputeHmac when many messages are authenticated with the same key.
+class OpenSSLHmac : public MessageDigest {
+ public:
+  // Creates an HMAC with |algorithm| as the hash algorithm.
+  OpenSSLHmac(const std::string& algorithm, const void* key, size_t key_len);
+  ~OpenSSLHmac() override;
+  // Returns the HMAC output size (e.g. 20 bytes for SHA-1), or 0 if
+  // |algorithm| is not supported.
+  size_t Size() const override;
+  // Updates the HMAC of the current message with |len| bytes from |buf|.
+  void Update(const void* buf, size_t len) override;
+  // Outputs the HMAC of the current message to |buf| with length |len|, and
+  // starts a new message with the same key.
+  size_t Finish(void* buf, size_t len) override;
+
+ private:
+  HMAC_CTX* ctx_ = nullptr;
+  const EVP_MD* md_ = nullptr;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLHmac);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_OPENSSLHMAC_H_
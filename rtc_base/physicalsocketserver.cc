@@ -465,6 +465,12 @@ int PhysicalSocket::Close() {
   return err;
 }
 
+#if defined(WEBRTC_POSIX)
+int PhysicalSocket::GetSocketDescriptor() const {
+  return s_;
+}
+#endif
+
 SOCKET PhysicalSocket::DoAccept(SOCKET socket,
                                 sockaddr* addr,
                                 socklen_t* addrlen) {
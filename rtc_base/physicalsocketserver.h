@@ -169,6 +169,10 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
 
   int Close() override;
 
+#if defined(WEBRTC_POSIX)
+  int GetSocketDescriptor() const override;
+#endif
+
   SocketServer* socketserver() { return ss_; }
 
  protected:
@@ -10,7 +10,8 @@
 #ifndef RTC_BASE_REFCOUNTER_H_
 #define RTC_BASE_REFCOUNTER_H_
 
-#include "rtc_base/atomicops.h"
+#include <atomic>
+
 #include "rtc_base/refcount.h"
 
 namespace webrtc {
@@ -21,13 +22,16 @@ class RefCounter {
   explicit RefCounter(int ref_count) : ref_count_(ref_count) {}
   RefCounter() = delete;
 
-  void IncRef() { rtc::AtomicOps::Increment(&ref_count_); }
+  // A new reference can only be made from an existing one, which keeps the
+  // resource alive, so the increment needs no ordering.
+  void IncRef() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
 
-  // TODO(nisse): Switch return type to RefCountReleaseStatus?
-  // Returns true if this was the last reference, and the resource protected by
-  // the reference counter can be deleted.
+  // Returns kDroppedLastRef if this was the last reference, and the resource
+  // protected by the reference counter can be deleted. The decrement releases
+  // this thread's accesses to the resource and, for the last reference,
+  // acquires those of all other threads before it is deleted.
   rtc::RefCountReleaseStatus DecRef() {
-    return (rtc::AtomicOps::Decrement(&ref_count_) == 0)
+    return (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
                ? rtc::RefCountReleaseStatus::kDroppedLastRef
                : rtc::RefCountReleaseStatus::kOtherRefsRemained;
   }
@@ -39,11 +43,11 @@ class RefCounter {
   // needed for the owning thread to act on the resource protected by the
   // reference counter, knowing that it has exclusive access.
   bool HasOneRef() const {
-    return rtc::AtomicOps::AcquireLoad(&ref_count_) == 1;
+    return ref_count_.load(std::memory_order_acquire) == 1;
   }
 
  private:
-  volatile int ref_count_;
+  std::atomic<int> ref_count_;
 };
 
 }  // namespace webrtc_impl
@@ -201,6 +201,14 @@ class Socket {
   enum ConnState { CS_CLOSED, CS_CONNECTING, CS_CONNECTED };
   virtual ConnState GetState() const = 0;
 
+#if defined(WEBRTC_POSIX)
+  // Returns the descriptor of the kernel socket that this socket sends and
+  // receives on directly, or -1. Only meant for enabling kernel features that
+  // there is no Option for, such as kernel TLS. Adapters that transform the
+  // data must not pass it on.
+  virtual int GetSocketDescriptor() const { return -1; }
+#endif
+
   enum Option {
     OPT_DONTFRAGMENT,
     OPT_RCVBUF,                // receive buffer size
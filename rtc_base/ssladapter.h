@@ -72,6 +72,12 @@ class SSLAdapter : public AsyncSocketAdapter {
   // Choose whether the socket acts as a server socket or client socket.
   virtual void SetRole(SSLRole role) = 0;
 
+  // Choose whether, once the handshake is done, records are sent by the
+  // kernel (kernel TLS) where the platform, the underlying socket and the
+  // negotiated cipher allow it. Sockets accepted by a server socket inherit
+  // this. Implementations that do not support it ignore it.
+  virtual void SetKernelTlsOffload(bool enable) {}
+
   // StartSSL returns 0 if successful.
   // If StartSSL is called while the socket is closed or connecting, the SSL
   // negotiation will begin as soon as the socket connects.
@@ -15,6 +15,8 @@
 #include "absl/memory/memory.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/ipaddress.h"
+#include "rtc_base/openssladapter.h"
+#include "rtc_base/physicalsocketserver.h"
 #include "rtc_base/socketstream.h"
 #include "rtc_base/ssladapter.h"
 #include "rtc_base/sslidentity.h"
@@ -91,6 +93,16 @@ class SSLAdapterTestDummyClient : public sigslot::has_slots<> {
     ssl_adapter_->SetEllipticCurves(curves);
   }
 
+  void SetKernelTlsOffload(bool enable) {
+    ssl_adapter_->SetKernelTlsOffload(enable);
+  }
+
+  // SSLAdapter::Create() makes OpenSSLAdapters.
+  bool IsKernelTlsActive() const {
+    return static_cast<rtc::OpenSSLAdapter*>(ssl_adapter_.get())
+        ->IsKernelTlsActiveForTesting();
+  }
+
   rtc::SocketAddress GetAddress() const {
     return ssl_adapter_->GetLocalAddress();
   }
@@ -191,6 +203,9 @@ class SSLAdapterTestDummyServer : public sigslot::has_slots<> {
 
   const std::string& GetReceivedData() const { return data_; }
 
+  // Whether the client ended the stream with a close_notify alert.
+  bool closed_cleanly() const { return closed_cleanly_; }
+
   int Send(const std::string& message) {
     if (ssl_stream_adapter_ == nullptr ||
         ssl_stream_adapter_->GetState() != rtc::SS_OPEN) {
@@ -242,13 +257,16 @@ class SSLAdapterTestDummyServer : public sigslot::has_slots<> {
 
       // Read data received from the client and store it in our internal
       // buffer.
-      rtc::StreamResult r =
-          stream->Read(buffer, sizeof(buffer) - 1, &read, &error);
-      if (r == rtc::SR_SUCCESS) {
+      rtc::StreamResult r;
+      while ((r = stream->Read(buffer, sizeof(buffer) - 1, &read, &error)) ==
+             rtc::SR_SUCCESS) {
         buffer[read] = '\0';
         RTC_LOG(LS_INFO) << "Server received '" << buffer << "'";
         data_ += buffer;
       }
+      if (r == rtc::SR_EOS) {
+        closed_cleanly_ = true;
+      }
     }
   }
 
@@ -290,15 +308,20 @@ class SSLAdapterTestDummyServer : public sigslot::has_slots<> {
   std::unique_ptr<rtc::SSLIdentity> ssl_identity_;
 
   std::string data_;
+  bool closed_cleanly_ = false;
 };
 
 class SSLAdapterTestBase : public testing::Test, public sigslot::has_slots<> {
  public:
-  explicit SSLAdapterTestBase(const rtc::SSLMode& ssl_mode,
-                              const rtc::KeyParams& key_params)
+  // Uses real sockets if |use_physical_sockets|, e.g. for kernel features.
+  SSLAdapterTestBase(const rtc::SSLMode& ssl_mode,
+                     const rtc::KeyParams& key_params,
+                     bool use_physical_sockets = false)
       : ssl_mode_(ssl_mode),
-        vss_(new rtc::VirtualSocketServer()),
-        thread_(vss_.get()),
+        pss_(use_physical_sockets ? new rtc::PhysicalSocketServer() : nullptr),
+        vss_(use_physical_sockets ? nullptr : new rtc::VirtualSocketServer()),
+        thread_(pss_ ? static_cast<rtc::SocketServer*>(pss_.get())
+                     : vss_.get()),
         server_(new SSLAdapterTestDummyServer(ssl_mode_, key_params)),
         client_(new SSLAdapterTestDummyClient(ssl_mode_)),
         handshake_wait_(kTimeout) {}
@@ -387,6 +410,7 @@ class SSLAdapterTestBase : public testing::Test, public sigslot::has_slots<> {
  protected:
   const rtc::SSLMode ssl_mode_;
 
+  std::unique_ptr<rtc::PhysicalSocketServer> pss_;
   std::unique_ptr<rtc::VirtualSocketServer> vss_;
   rtc::AutoSocketServerThread thread_;
   std::unique_ptr<SSLAdapterTestDummyServer> server_;
@@ -408,6 +432,16 @@ class SSLAdapterTestTLS_ECDSA : public SSLAdapterTestBase {
       : SSLAdapterTestBase(rtc::SSL_MODE_TLS, rtc::KeyParams::ECDSA()) {}
 };
 
+class SSLAdapterTestTLS_KernelTls : public SSLAdapterTestBase {
+ public:
+  SSLAdapterTestTLS_KernelTls()
+      : SSLAdapterTestBase(rtc::SSL_MODE_TLS,
+                           rtc::KeyParams::ECDSA(),
+                           /*use_physical_sockets=*/true) {
+    client_->SetKernelTlsOffload(true);
+  }
+};
+
 class SSLAdapterTestDTLS_RSA : public SSLAdapterTestBase {
  public:
   SSLAdapterTestDTLS_RSA()
@@ -525,6 +559,33 @@ TEST_F(SSLAdapterTestTLS_ECDSA, TestTLSTransferCustomCertVerifier) {
   TestTransfer("Hello, world!");
 }
 
+// Test that with kernel TLS offload requested, records are still framed once:
+// the data, and with kernel TLS the close_notify sent when closing, reach the
+// server intact. Where kernel TLS is not available this tests the fallback to
+// SSL_write.
+TEST_F(SSLAdapterTestTLS_KernelTls, TestTLSTransferAndClose) {
+  TestHandshake(true);
+  TestTransfer("Hello, world!");
+  std::string message = "Goodbye, world!";
+  ASSERT_EQ(static_cast<int>(message.size()), client_->Send(message));
+  const bool kernel_tls = client_->IsKernelTlsActive();
+  EXPECT_EQ(0, client_->Close());
+  EXPECT_EQ_WAIT("Hello, world!" + message, server_->GetReceivedData(),
+                 kTimeout);
+  if (kernel_tls)
+    EXPECT_TRUE_WAIT(server_->closed_cleanly(), kTimeout);
+}
+
+// Test that closing without kernel TLS sends no close_notify, as before it was
+// added for kernel TLS.
+TEST_F(SSLAdapterTestTLS_ECDSA, TestTLSCloseSendsNoAlert) {
+  TestHandshake(true);
+  TestTransfer("Hello, world!");
+  EXPECT_EQ(0, client_->Close());
+  WAIT(server_->closed_cleanly(), 100);
+  EXPECT_FALSE(server_->closed_cleanly());
+}
+
 // Test transfer using ALPN with protos as h2 and http/1.1
 TEST_F(SSLAdapterTestTLS_ECDSA, TestTLSALPN) {
   std::vector<std::string> alpn_protos{"h2", "http/1.1"};
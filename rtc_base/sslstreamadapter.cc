@@ -96,13 +96,23 @@ CryptoOptions CryptoOptions::NoGcm() {
   return options;
 }
 
+void GetSupportedGcmCryptoSuites(const rtc::CryptoOptions& crypto_options,
+                                 std::vector<int>* crypto_suites) {
+  if (!crypto_options.enable_gcm_crypto_suites)
+    return;
+  if (crypto_options.prefer_aes128_gcm_crypto_suite) {
+    crypto_suites->push_back(rtc::SRTP_AEAD_AES_128_GCM);
+    crypto_suites->push_back(rtc::SRTP_AEAD_AES_256_GCM);
+  } else {
+    crypto_suites->push_back(rtc::SRTP_AEAD_AES_256_GCM);
+    crypto_suites->push_back(rtc::SRTP_AEAD_AES_128_GCM);
+  }
+}
+
 std::vector<int> GetSupportedDtlsSrtpCryptoSuites(
     const rtc::CryptoOptions& crypto_options) {
   std::vector<int> crypto_suites;
-  if (crypto_options.enable_gcm_crypto_suites) {
-    crypto_suites.push_back(rtc::SRTP_AEAD_AES_256_GCM);
-    crypto_suites.push_back(rtc::SRTP_AEAD_AES_128_GCM);
-  }
+  GetSupportedGcmCryptoSuites(crypto_options, &crypto_suites);
   // Note: SRTP_AES128_CM_SHA1_80 is what is required to be supported (by
   // draft-ietf-rtcweb-security-arch), but SRTP_AES128_CM_SHA1_32 is allowed as
   // well, and saves a few bytes per packet if it ends up selected.
@@ -82,6 +82,11 @@ struct CryptoOptions {
   // if both sides enable it.
   bool enable_gcm_crypto_suites = false;
 
+  // If set to true, AEAD_AES_128_GCM is preferred over AEAD_AES_256_GCM when
+  // GCM crypto suites are enabled. Both have the same overhead, but the 128
+  // bit key takes 10 AES rounds per block rather than 14.
+  bool prefer_aes128_gcm_crypto_suite = false;
+
   // If set to true, the (potentially insecure) crypto cipher
   // SRTP_AES128_CM_SHA1_32 will be included in the list of supported ciphers
   // during negotiation. It will only be used if both peers support it and no
@@ -93,6 +98,11 @@ struct CryptoOptions {
   bool enable_encrypted_rtp_header_extensions = false;
 };
 
+// Appends the GCM crypto suites enabled by |crypto_options| to
+// |crypto_suites|, in order of preference.
+void GetSupportedGcmCryptoSuites(const rtc::CryptoOptions& crypto_options,
+                                 std::vector<int>* crypto_suites);
+
 // Returns supported crypto suites, given |crypto_options|.
 // CS_AES_CM_128_HMAC_SHA1_32 will be preferred by default.
 std::vector<int> GetSupportedDtlsSrtpCryptoSuites(
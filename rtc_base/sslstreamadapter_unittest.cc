@@ -1281,6 +1281,27 @@ TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSrtpGCMMixed) {
   ASSERT_EQ(client_cipher, rtc::SRTP_AEAD_AES_256_GCM);
 };
 
+// Test DTLS-SRTP with GCM-128 preferred through CryptoOptions.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSrtpPreferAes128Gcm) {
+  rtc::CryptoOptions crypto_options;
+  crypto_options.enable_gcm_crypto_suites = true;
+  crypto_options.prefer_aes128_gcm_crypto_suite = true;
+  std::vector<int> crypto_suites =
+      rtc::GetSupportedDtlsSrtpCryptoSuites(crypto_options);
+  ASSERT_EQ(rtc::SRTP_AEAD_AES_128_GCM, crypto_suites[0]);
+  SetDtlsSrtpCryptoSuites(crypto_suites, true);
+  SetDtlsSrtpCryptoSuites(crypto_suites, false);
+  TestHandshake();
+
+  int client_cipher;
+  ASSERT_TRUE(GetDtlsSrtpCryptoSuite(true, &client_cipher));
+  int server_cipher;
+  ASSERT_TRUE(GetDtlsSrtpCryptoSuite(false, &server_cipher));
+
+  ASSERT_EQ(client_cipher, server_cipher);
+  ASSERT_EQ(client_cipher, rtc::SRTP_AEAD_AES_128_GCM);
+};
+
 // Test SRTP cipher suite lengths.
 TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSrtpKeyAndSaltLengths) {
   int key_len;
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SYNCHRONIZATION_SEQUENCE_LOCK_H_
+#define RTC_BASE_SYNCHRONIZATION_SEQUENCE_LOCK_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace rtc {
+
+// Holds a value of a small, trivially copyable type that is written often on
+// one thread and read now and then on others, such as the latest packet
+// counters of a stream that are polled for stats. Load() never blocks Store():
+// readers copy the value and retry if it was written meanwhile, so they are
+// the ones that pay when the two collide. Concurrent writers are serialized
+// by spinning, which is only meant for the rare case of a second writer.
+template <typename T>
+class SequenceLocked {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SequenceLocked requires a trivially copyable type");
+
+  SequenceLocked() : SequenceLocked(T()) {}
+  explicit SequenceLocked(const T& value) : sequence_(0) {
+    uint64_t words[kNumWords] = {0};
+    memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kNumWords; ++i)
+      words_[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  void Store(const T& value) {
+    uint64_t words[kNumWords] = {0};
+    memcpy(words, &value, sizeof(T));
+    // An odd sequence number tells readers that a write is in progress.
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    while ((sequence & 1) ||
+           !sequence_.compare_exchange_weak(sequence, sequence + 1,
+                                            std::memory_order_relaxed)) {
+      sequence = sequence_.load(std::memory_order_relaxed);
+    }
+    // Release stores keep the odd sequence number ahead of the new value.
+    for (size_t i = 0; i < kNumWords; ++i)
+      words_[i].store(words[i], std::memory_order_release);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Load() const {
+    uint64_t words[kNumWords];
+    while (true) {
+      uint32_t sequence = sequence_.load(std::memory_order_acquire);
+      if (sequence & 1)
+        continue;
+      // Acquire loads keep the second read of the sequence number after them.
+      for (size_t i = 0; i < kNumWords; ++i)
+        words[i] = words_[i].load(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence)
+        break;
+    }
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  // Increases every time the value is stored, so that readers can tell if it
+  // has changed since they last loaded it.
+  uint32_t Version() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  static constexpr size_t kNumWords = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint32_t> sequence_;
+  std::atomic<uint64_t> words_[kNumWords];
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_SYNCHRONIZATION_SEQUENCE_LOCK_H_
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/sequence_lock.h"
+
+#include <atomic>
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace rtc {
+
+namespace {
+
+// Every field holds the same value, so a torn read shows up as a mismatch.
+struct Counters {
+  int64_t a;
+  int64_t b;
+  int32_t c;
+};
+
+struct WriterState {
+  SequenceLocked<Counters>* counters;
+  std::atomic<bool> stop{false};
+};
+
+void WriteCounters(void* obj) {
+  WriterState* state = static_cast<WriterState*>(obj);
+  for (int32_t i = 1; !state->stop.load(); ++i)
+    state->counters->Store(Counters{i, i, i});
+}
+
+}  // namespace
+
+TEST(SequenceLockTest, LoadsStoredValue) {
+  SequenceLocked<Counters> counters(Counters{1, 2, 3});
+  EXPECT_EQ(0u, counters.Version());
+  EXPECT_EQ(2, counters.Load().b);
+
+  counters.Store(Counters{4, 5, 6});
+  EXPECT_EQ(1u, counters.Version());
+  Counters loaded = counters.Load();
+  EXPECT_EQ(4, loaded.a);
+  EXPECT_EQ(5, loaded.b);
+  EXPECT_EQ(6, loaded.c);
+}
+
+TEST(SequenceLockTest, LoadsAreNotTornByConcurrentStores) {
+  SequenceLocked<Counters> counters(Counters{0, 0, 0});
+  WriterState state;
+  state.counters = &counters;
+  PlatformThread writer(&WriteCounters, &state, "SequenceLockWriter");
+  writer.Start();
+
+  int32_t last = 0;
+  for (int i = 0; i < 100000; ++i) {
+    Counters loaded = counters.Load();
+    ASSERT_EQ(loaded.a, loaded.b);
+    ASSERT_EQ(loaded.a, loaded.c);
+    ASSERT_GE(loaded.c, last);
+    last = loaded.c;
+  }
+
+  state.stop.store(true);
+  writer.Stop();
+}
+
+}  // namespace rtc
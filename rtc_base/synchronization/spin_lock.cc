@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/spin_lock.h"
+
+#include "rtc_base/checks.h"
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(_MSC_VER)
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rtc {
+
+namespace {
+
+// Roughly the time it takes to update a few cache lines that another core
+// owns. Longer sections should use CriticalSection.
+const int kSpinIterations = 100;
+
+// Tells the CPU that this is a spin-wait loop, which saves power and frees
+// execution resources for a hyperthread sibling that may be holding the lock.
+inline void CpuRelax() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  _mm_pause();
+#elif defined(WEBRTC_ARCH_ARM_FAMILY) && !defined(_MSC_VER)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+}  // namespace
+
+SpinLock::SpinLock()
+    : state_(kUnlocked),
+      waiters_(false /* manual_reset */, false /* initially_signaled */) {}
+
+SpinLock::~SpinLock() {
+  RTC_DCHECK_EQ(kUnlocked, state_.load(std::memory_order_relaxed));
+}
+
+bool SpinLock::TryLock() {
+  int expected = kUnlocked;
+  return state_.compare_exchange_strong(expected, kLocked,
+                                        std::memory_order_acquire);
+}
+
+void SpinLock::LockSlow() {
+  for (int i = 0; i < kSpinIterations; ++i) {
+    CpuRelax();
+    // Only attempt the write once the lock looks free, so that spinning
+    // threads don't keep stealing the cache line from the owner.
+    if (state_.load(std::memory_order_relaxed) == kUnlocked && TryLock())
+      return;
+  }
+  // Mark the lock as contended before sleeping, so that Unlock() wakes us.
+  // Since we can't tell whether other threads are still waiting, the lock is
+  // taken in the contended state too, and its Unlock() wakes the next waiter.
+  while (state_.exchange(kLockedWithWaiters, std::memory_order_acquire) !=
+         kUnlocked) {
+    waiters_.Wait(Event::kForever);
+  }
+}
+
+}  // namespace rtc
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SYNCHRONIZATION_SPIN_LOCK_H_
+#define RTC_BASE_SYNCHRONIZATION_SPIN_LOCK_H_
+
+#include <atomic>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/event.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// A lock for critical sections that only last for a handful of instructions,
+// such as updating a few counters. Lock() first spins for a short while, which
+// is much cheaper than going to sleep when the owner is about to release the
+// lock, and only parks the thread on an event if that doesn't succeed.
+// Uncontended Lock() and Unlock() are a single atomic operation each.
+// Unlike CriticalSection, SpinLock is not recursive, and it's unsuitable for
+// sections that may block, since waiters spin before they sleep.
+class RTC_LOCKABLE SpinLock {
+ public:
+  SpinLock();
+  ~SpinLock();
+
+  void Lock() RTC_EXCLUSIVE_LOCK_FUNCTION() {
+    int expected = kUnlocked;
+    if (!state_.compare_exchange_strong(expected, kLocked,
+                                        std::memory_order_acquire)) {
+      LockSlow();
+    }
+  }
+  bool TryLock() RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true);
+  void Unlock() RTC_UNLOCK_FUNCTION() {
+    if (state_.exchange(kUnlocked, std::memory_order_release) ==
+        kLockedWithWaiters) {
+      waiters_.Set();
+    }
+  }
+
+ private:
+  enum : int { kUnlocked = 0, kLocked = 1, kLockedWithWaiters = 2 };
+
+  void LockSlow();
+
+  std::atomic<int> state_;
+  // Signaled by Unlock() when a thread may be sleeping in LockSlow().
+  Event waiters_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SpinLock);
+};
+
+class RTC_SCOPED_LOCKABLE SpinLockScope {
+ public:
+  explicit SpinLockScope(SpinLock* lock) RTC_EXCLUSIVE_LOCK_FUNCTION(lock)
+      : lock_(lock) {
+    lock_->Lock();
+  }
+  ~SpinLockScope() RTC_UNLOCK_FUNCTION() { lock_->Unlock(); }
+
+ private:
+  SpinLock* const lock_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SpinLockScope);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_SYNCHRONIZATION_SPIN_LOCK_H_
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/spin_lock.h"
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace rtc {
+
+namespace {
+
+const int kNumThreads = 4;
+const int kIterationsPerThread = 100000;
+
+struct SharedState {
+  SpinLock lock;
+  // Both are only touched under |lock|, so they stay equal unless two threads
+  // are ever inside the section at once.
+  int64_t counter = 0;
+  int64_t copy = 0;
+};
+
+void IncrementCounter(void* obj) {
+  SharedState* state = static_cast<SharedState*>(obj);
+  for (int i = 0; i < kIterationsPerThread; ++i) {
+    SpinLockScope scope(&state->lock);
+    state->copy = ++state->counter;
+  }
+}
+
+}  // namespace
+
+TEST(SpinLockTest, TryLockFailsWhileLocked) {
+  SpinLock lock;
+  lock.Lock();
+  EXPECT_FALSE(lock.TryLock());
+  lock.Unlock();
+  EXPECT_TRUE(lock.TryLock());
+  lock.Unlock();
+}
+
+TEST(SpinLockTest, ExcludesConcurrentThreads) {
+  SharedState state;
+  std::vector<std::unique_ptr<PlatformThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(
+        new PlatformThread(&IncrementCounter, &state, "SpinLockTest"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  SpinLockScope scope(&state.lock);
+  EXPECT_EQ(kNumThreads * kIterationsPerThread, state.counter);
+  EXPECT_EQ(state.counter, state.copy);
+}
+
+}  // namespace rtc
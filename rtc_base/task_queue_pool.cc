@@ -0,0 +1,530 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// TaskQueue implementation that multiplexes any number of queues onto a fixed
+// pool of worker threads per priority, instead of giving every queue its own
+// thread. A queue with pending tasks is scheduled on exactly one worker at a
+// time, so tasks posted to the same queue still run sequentially and in the
+// order they were posted. Idle workers steal scheduled queues from busy
+// workers.
+//
+// Since the workers are shared, a task that blocks waiting for a task on
+// another queue occupies a worker for as long as it blocks. Code that blocks
+// on more queues at once than there are workers in the pool will deadlock.
+
+#include "rtc_base/task_queue.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/task_queue_posix.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/timeutils.h"
+
+namespace rtc {
+using internal::GetQueuePtrTls;
+using internal::AutoSetCurrentQueuePtr;
+
+namespace {
+
+using Priority = TaskQueue::Priority;
+
+// Maximum number of tasks a worker runs from one queue before it lets other
+// queues scheduled on the same worker run.
+const int kMaxTasksPerSlice = 16;
+// The pool never has fewer workers than this, so that a few tasks blocking on
+// each other, as some code does with rtc::Event, don't stall the pool.
+const int kMinWorkers = 4;
+
+ThreadPriority TaskQueuePriorityToThreadPriority(Priority priority) {
+  switch (priority) {
+    case Priority::HIGH:
+      return kRealtimePriority;
+    case Priority::LOW:
+      return kLowPriority;
+    case Priority::NORMAL:
+      return kNormalPriority;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+  return kNormalPriority;
+}
+
+int NumberOfWorkers() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);  // NOLINT
+  return std::max(kMinWorkers, static_cast<int>(cores));
+}
+
+// The part of TaskQueue::Impl that the pool and the timer use.
+class PooledQueue : public RefCountInterface {
+ public:
+  virtual void PostTask(std::unique_ptr<QueuedTask> task) = 0;
+
+  // Called by a pool worker. Runs up to |max_tasks| pending tasks and returns
+  // true if the queue still has pending tasks and must be scheduled again.
+  virtual bool RunPendingTasks(int max_tasks) = 0;
+
+ protected:
+  ~PooledQueue() override {}
+};
+
+// A fixed set of threads, each with its own deque of queues that have pending
+// tasks. A worker takes queues from the front of its own deque and, when that
+// is empty, steals from the back of the other workers' deques.
+class WorkerPool {
+ public:
+  explicit WorkerPool(Priority priority) : num_workers_(NumberOfWorkers()) {
+    RTC_CHECK(pthread_key_create(&current_worker_tls_, nullptr) == 0);
+    workers_.reserve(num_workers_);
+    for (int i = 0; i < num_workers_; ++i)
+      workers_.emplace_back(new Worker(this, i, priority));
+    for (auto& worker : workers_)
+      worker->thread.Start();
+  }
+
+  // Pools live for the lifetime of the process.
+  static WorkerPool* Get(Priority priority) {
+    switch (priority) {
+      case Priority::HIGH: {
+        static WorkerPool* const pool = new WorkerPool(Priority::HIGH);
+        return pool;
+      }
+      case Priority::LOW: {
+        static WorkerPool* const pool = new WorkerPool(Priority::LOW);
+        return pool;
+      }
+      case Priority::NORMAL:
+      default: {
+        static WorkerPool* const pool = new WorkerPool(Priority::NORMAL);
+        return pool;
+      }
+    }
+  }
+
+  // Adds |queue| to a worker's deque. Queues scheduled from a worker stay on
+  // that worker, which keeps a queue that posts to itself on a warm cache.
+  void Schedule(scoped_refptr<PooledQueue> queue) {
+    Worker* worker = static_cast<Worker*>(
+        pthread_getspecific(current_worker_tls_));
+    if (!worker) {
+      worker = workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                        num_workers_]
+                   .get();
+    }
+    {
+      CritScope lock(&worker->lock);
+      worker->queues.push_back(std::move(queue));
+    }
+    WakeIdleWorker();
+  }
+
+ private:
+  struct Worker {
+    Worker(WorkerPool* pool, int index, Priority priority)
+        : pool(pool),
+          index(index),
+          wakeup(false, false),
+          thread(&WorkerPool::WorkerMain,
+                 this,
+                 "TaskQueuePool",
+                 TaskQueuePriorityToThreadPriority(priority)) {}
+
+    WorkerPool* const pool;
+    const int index;
+    rtc::CriticalSection lock;
+    std::deque<scoped_refptr<PooledQueue>> queues RTC_GUARDED_BY(lock);
+    std::atomic<bool> idle{false};
+    rtc::Event wakeup;
+    PlatformThread thread;
+  };
+
+  static void WorkerMain(void* context) {
+    Worker* worker = static_cast<Worker*>(context);
+    pthread_setspecific(worker->pool->current_worker_tls_, worker);
+    worker->pool->Run(worker);
+  }
+
+  void Run(Worker* worker) {
+    while (true) {
+      scoped_refptr<PooledQueue> queue = TakeQueue(worker);
+      if (!queue) {
+        // Announce that this worker is idle before looking for work one last
+        // time, so that a queue scheduled in between either is found here or
+        // wakes this worker up.
+        worker->idle.store(true);
+        queue = TakeQueue(worker);
+        if (!queue) {
+          worker->wakeup.Wait(Event::kForever);
+          worker->idle.store(false);
+          continue;
+        }
+        worker->idle.store(false);
+      }
+      if (queue->RunPendingTasks(kMaxTasksPerSlice)) {
+        CritScope lock(&worker->lock);
+        worker->queues.push_back(std::move(queue));
+      }
+    }
+  }
+
+  scoped_refptr<PooledQueue> TakeQueue(Worker* worker) {
+    scoped_refptr<PooledQueue> queue;
+    {
+      CritScope lock(&worker->lock);
+      if (!worker->queues.empty()) {
+        queue = std::move(worker->queues.front());
+        worker->queues.pop_front();
+        return queue;
+      }
+    }
+    for (int i = 1; i < num_workers_; ++i) {
+      Worker* victim = workers_[(worker->index + i) % num_workers_].get();
+      CritScope lock(&victim->lock);
+      if (!victim->queues.empty()) {
+        queue = std::move(victim->queues.back());
+        victim->queues.pop_back();
+        return queue;
+      }
+    }
+    return queue;
+  }
+
+  void WakeIdleWorker() {
+    for (auto& worker : workers_) {
+      bool idle = true;
+      if (worker->idle.compare_exchange_strong(idle, false)) {
+        worker->wakeup.Set();
+        return;
+      }
+    }
+  }
+
+  const int num_workers_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<unsigned int> next_worker_{0};
+  pthread_key_t current_worker_tls_;
+};
+
+// Holds delayed tasks for all queues and posts them to their queue when they
+// are due.
+class DelayedTaskTimer {
+ public:
+  static DelayedTaskTimer* Get() {
+    static DelayedTaskTimer* const timer = new DelayedTaskTimer();
+    return timer;
+  }
+
+  void Add(scoped_refptr<PooledQueue> queue,
+           std::unique_ptr<QueuedTask> task,
+           uint32_t milliseconds) {
+    bool wake_up;
+    {
+      CritScope lock(&lock_);
+      timers_.push_back(Timer{TimeMillis() + milliseconds, next_sequence_++,
+                              std::move(queue), std::move(task)});
+      std::push_heap(timers_.begin(), timers_.end(), &Timer::Later);
+      // Wake the timer thread up only if the new timer is the next one due.
+      wake_up = timers_.front().sequence + 1 == next_sequence_;
+    }
+    if (wake_up)
+      wakeup_.Set();
+  }
+
+  // Removes the timers of |queue| and returns their tasks, so that they can be
+  // deleted without holding the lock.
+  std::vector<std::unique_ptr<QueuedTask>> Remove(PooledQueue* queue) {
+    std::vector<std::unique_ptr<QueuedTask>> tasks;
+    CritScope lock(&lock_);
+    auto it = std::partition(
+        timers_.begin(), timers_.end(),
+        [queue](const Timer& timer) { return timer.queue.get() != queue; });
+    for (auto removed = it; removed != timers_.end(); ++removed)
+      tasks.push_back(std::move(removed->task));
+    if (it != timers_.end()) {
+      timers_.erase(it, timers_.end());
+      std::make_heap(timers_.begin(), timers_.end(), &Timer::Later);
+    }
+    return tasks;
+  }
+
+ private:
+  struct Timer {
+    // Orders |timers_| as a min-heap on the due time, with timers that are due
+    // at the same time in the order they were added.
+    static bool Later(const Timer& a, const Timer& b) {
+      if (a.run_time_ms != b.run_time_ms)
+        return a.run_time_ms > b.run_time_ms;
+      return a.sequence > b.sequence;
+    }
+
+    int64_t run_time_ms;
+    uint64_t sequence;
+    scoped_refptr<PooledQueue> queue;
+    std::unique_ptr<QueuedTask> task;
+  };
+
+  DelayedTaskTimer()
+      : wakeup_(false, false),
+        thread_(&DelayedTaskTimer::ThreadMain,
+                this,
+                "TaskQueueTimer",
+                kHighestPriority) {
+    thread_.Start();
+  }
+
+  static void ThreadMain(void* context) {
+    static_cast<DelayedTaskTimer*>(context)->Run();
+  }
+
+  void Run() {
+    while (true) {
+      int wait_ms = Event::kForever;
+      std::vector<Timer> due;
+      {
+        CritScope lock(&lock_);
+        int64_t now_ms = TimeMillis();
+        while (!timers_.empty() && timers_.front().run_time_ms <= now_ms) {
+          std::pop_heap(timers_.begin(), timers_.end(), &Timer::Later);
+          due.push_back(std::move(timers_.back()));
+          timers_.pop_back();
+        }
+        if (!timers_.empty())
+          wait_ms = static_cast<int>(timers_.front().run_time_ms - now_ms);
+      }
+      for (Timer& timer : due)
+        timer.queue->PostTask(std::move(timer.task));
+      due.clear();
+      if (wait_ms != 0)
+        wakeup_.Wait(wait_ms);
+    }
+  }
+
+  rtc::CriticalSection lock_;
+  std::vector<Timer> timers_ RTC_GUARDED_BY(lock_);
+  uint64_t next_sequence_ RTC_GUARDED_BY(lock_) = 0;
+  rtc::Event wakeup_;
+  PlatformThread thread_;
+};
+
+}  // namespace
+
+class TaskQueue::Impl : public PooledQueue {
+ public:
+  Impl(const char* queue_name, TaskQueue* queue, Priority priority);
+  ~Impl() override;
+
+  static TaskQueue* CurrentQueue();
+
+  // Used for DCHECKing the current queue.
+  bool IsCurrent() const;
+
+  void PostTask(std::unique_ptr<QueuedTask> task) override;
+  void PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                        std::unique_ptr<QueuedTask> reply,
+                        TaskQueue::Impl* reply_queue);
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task, uint32_t milliseconds);
+
+  // Drops all pending and delayed tasks and waits for the task that is
+  // currently running, if any. Tasks posted afterwards are dropped.
+  void Stop();
+
+  bool RunPendingTasks(int max_tasks) override;
+
+ private:
+  class PostAndReplyTask;
+
+  TaskQueue* const queue_;
+  WorkerPool* const pool_;
+  rtc::CriticalSection pending_lock_;
+  std::list<std::unique_ptr<QueuedTask>> pending_ RTC_GUARDED_BY(pending_lock_);
+  // True from when the first task is posted to an idle queue until a worker
+  // has run all pending tasks.
+  bool scheduled_ RTC_GUARDED_BY(pending_lock_) = false;
+  bool running_ RTC_GUARDED_BY(pending_lock_) = false;
+  bool stopped_ RTC_GUARDED_BY(pending_lock_) = false;
+  // Signaled when a worker stops running tasks from a stopped queue.
+  rtc::Event stopped_event_;
+};
+
+// Runs |task_| and then posts |reply_| to the reply queue. The reply queue is
+// kept alive by the reference, and drops the reply if it has been stopped.
+class TaskQueue::Impl::PostAndReplyTask : public QueuedTask {
+ public:
+  PostAndReplyTask(std::unique_ptr<QueuedTask> task,
+                   std::unique_ptr<QueuedTask> reply,
+                   TaskQueue::Impl* reply_queue)
+      : task_(std::move(task)),
+        reply_(std::move(reply)),
+        reply_queue_(reply_queue) {}
+
+ private:
+  bool Run() override {
+    if (!task_->Run())
+      task_.release();
+    reply_queue_->PostTask(std::move(reply_));
+    return true;
+  }
+
+  std::unique_ptr<QueuedTask> task_;
+  std::unique_ptr<QueuedTask> reply_;
+  const scoped_refptr<PooledQueue> reply_queue_;
+};
+
+TaskQueue::Impl::Impl(const char* queue_name,
+                      TaskQueue* queue,
+                      Priority priority)
+    : queue_(queue),
+      pool_(WorkerPool::Get(priority)),
+      stopped_event_(false, false) {
+  RTC_DCHECK(queue_name);
+}
+
+TaskQueue::Impl::~Impl() {}
+
+// static
+TaskQueue* TaskQueue::Impl::CurrentQueue() {
+  return static_cast<TaskQueue*>(pthread_getspecific(GetQueuePtrTls()));
+}
+
+bool TaskQueue::Impl::IsCurrent() const {
+  return CurrentQueue() == queue_;
+}
+
+void TaskQueue::Impl::PostTask(std::unique_ptr<QueuedTask> task) {
+  RTC_DCHECK(task.get());
+  {
+    CritScope lock(&pending_lock_);
+    // |task| is deleted after the lock is released, since its destructor may
+    // post to this queue.
+    if (stopped_)
+      return;
+    pending_.push_back(std::move(task));
+    if (scheduled_)
+      return;
+    scheduled_ = true;
+  }
+  pool_->Schedule(this);
+}
+
+void TaskQueue::Impl::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                      uint32_t milliseconds) {
+  if (milliseconds == 0) {
+    PostTask(std::move(task));
+    return;
+  }
+  DelayedTaskTimer::Get()->Add(this, std::move(task), milliseconds);
+}
+
+void TaskQueue::Impl::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                       std::unique_ptr<QueuedTask> reply,
+                                       TaskQueue::Impl* reply_queue) {
+  PostTask(std::unique_ptr<QueuedTask>(
+      new PostAndReplyTask(std::move(task), std::move(reply), reply_queue)));
+}
+
+void TaskQueue::Impl::Stop() {
+  RTC_DCHECK(!IsCurrent());
+  std::list<std::unique_ptr<QueuedTask>> dropped;
+  bool running;
+  {
+    CritScope lock(&pending_lock_);
+    stopped_ = true;
+    dropped.swap(pending_);
+    running = running_;
+  }
+  if (running)
+    stopped_event_.Wait(Event::kForever);
+  dropped.clear();
+  DelayedTaskTimer::Get()->Remove(this);
+}
+
+bool TaskQueue::Impl::RunPendingTasks(int max_tasks) {
+  AutoSetCurrentQueuePtr set_current(queue_);
+  for (int i = 0;; ++i) {
+    std::unique_ptr<QueuedTask> task;
+    {
+      CritScope lock(&pending_lock_);
+      if (stopped_ || pending_.empty()) {
+        if (running_ && stopped_)
+          stopped_event_.Set();
+        scheduled_ = false;
+        running_ = false;
+        return false;
+      }
+      if (i == max_tasks) {
+        running_ = false;
+        return true;
+      }
+      running_ = true;
+      task = std::move(pending_.front());
+      pending_.pop_front();
+    }
+    if (!task->Run())
+      task.release();
+  }
+}
+
+TaskQueue::TaskQueue(const char* queue_name, Priority priority)
+    : impl_(new RefCountedObject<TaskQueue::Impl>(queue_name, this, priority)) {
+}
+
+TaskQueue::~TaskQueue() {
+  impl_->Stop();
+}
+
+// static
+TaskQueue* TaskQueue::Current() {
+  return TaskQueue::Impl::CurrentQueue();
+}
+
+// Used for DCHECKing the current queue.
+bool TaskQueue::IsCurrent() const {
+  return impl_->IsCurrent();
+}
+
+void TaskQueue::PostTask(std::unique_ptr<QueuedTask> task) {
+  return TaskQueue::impl_->PostTask(std::move(task));
+}
+
+void TaskQueue::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                 std::unique_ptr<QueuedTask> reply,
+                                 TaskQueue* reply_queue) {
+  return TaskQueue::impl_->PostTaskAndReply(std::move(task), std::move(reply),
+                                            reply_queue->impl_.get());
+}
+
+void TaskQueue::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                 std::unique_ptr<QueuedTask> reply) {
+  return TaskQueue::impl_->PostTaskAndReply(std::move(task), std::move(reply),
+                                            impl_.get());
+}
+
+void TaskQueue::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                uint32_t milliseconds) {
+  return TaskQueue::impl_->PostDelayedTask(std::move(task), milliseconds);
+}
+
+}  // namespace rtc
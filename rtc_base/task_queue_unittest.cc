@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "rtc_base/bind.h"
+#include "rtc_base/criticalsection.h"
 #include "rtc_base/event.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/task_queue_for_test.h"
@@ -390,6 +391,43 @@ TEST(TaskQueueTest, PostAndReply2) {
   EXPECT_TRUE(event.Wait(1000));
 }
 
+// Posts to many queues at once, which with a pooled implementation are run by
+// fewer threads than there are queues, and checks that each queue still runs
+// its tasks one at a time and in order.
+TEST(TaskQueueTest, PostToManyQueues) {
+  static const int kNumQueues = 100;
+  static const int kTasksPerQueue = 100;
+  std::vector<std::vector<int>> runs(kNumQueues);
+  Event event(false, false);
+  int queues_done = 0;
+  CriticalSection crit;
+  std::vector<std::unique_ptr<TaskQueue>> queues;
+  for (int i = 0; i < kNumQueues; ++i)
+    queues.emplace_back(new TaskQueue("PostToManyQueues"));
+
+  for (int task = 0; task < kTasksPerQueue; ++task) {
+    for (int i = 0; i < kNumQueues; ++i) {
+      TaskQueue* queue = queues[i].get();
+      std::vector<int>* run = &runs[i];
+      queue->PostTask([queue, run, task, &event, &queues_done, &crit]() {
+        EXPECT_TRUE(queue->IsCurrent());
+        run->push_back(task);
+        if (task == kTasksPerQueue - 1) {
+          CritScope lock(&crit);
+          if (++queues_done == kNumQueues)
+            event.Set();
+        }
+      });
+    }
+  }
+  ASSERT_TRUE(event.Wait(10000));
+  for (const std::vector<int>& run : runs) {
+    ASSERT_EQ(static_cast<size_t>(kTasksPerQueue), run.size());
+    for (int task = 0; task < kTasksPerQueue; ++task)
+      EXPECT_EQ(task, run[task]);
+  }
+}
+
 // Tests posting more messages than a queue can queue up.
 // In situations like that, tasks will get dropped.
 TEST(TaskQueueTest, PostALot) {
@@ -13,6 +13,7 @@
 #include "rtc_base/asyncinvoker.h"
 #include "rtc_base/asyncudpsocket.h"
 #include "rtc_base/event.h"
+#include "rtc_base/future.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/nullsocketserver.h"
 #include "rtc_base/physicalsocketserver.h"
@@ -571,6 +572,55 @@ TEST_F(AsyncInvokeTest, FlushWithIds) {
   EXPECT_TRUE(flag2.get());
 }
 
+TEST_F(AsyncInvokeTest, InvokeAsyncThen) {
+  AsyncInvoker invoker;
+  auto thread = Thread::CreateWithSocketServer();
+  thread->Start();
+  Thread* target = thread.get();
+  SetExpectedThreadForIntCallback(Thread::Current());
+  InvokeAsync<int>(&invoker, RTC_FROM_HERE, target, [target] {
+    EXPECT_TRUE(target->IsCurrent());
+    return 42;
+  }).Then(Thread::Current(), [this](int value) { IntCallback(value); });
+  EXPECT_EQ_WAIT(42, int_value_, kWaitTimeout);
+  thread->Stop();
+}
+
+TEST_F(AsyncInvokeTest, InvokeAsyncThenAfterResult) {
+  AsyncInvoker invoker;
+  auto thread = Thread::CreateWithSocketServer();
+  thread->Start();
+  Future<std::unique_ptr<int>> future = InvokeAsync<std::unique_ptr<int>>(
+      &invoker, RTC_FROM_HERE, thread.get(),
+      [] { return std::unique_ptr<int>(new int(42)); });
+  // Make sure the result is set before the callback is given.
+  invoker.Flush(thread.get());
+  future.Then(Thread::Current(), [this](std::unique_ptr<int> value) {
+    IntCallback(*value);
+  });
+  SetExpectedThreadForIntCallback(Thread::Current());
+  EXPECT_EQ_WAIT(42, int_value_, kWaitTimeout);
+  thread->Stop();
+}
+
+TEST_F(AsyncInvokeTest, InvokeAsyncThenNotRunAfterInvokerDestroyed) {
+  Event result_set(false, false);
+  auto thread = Thread::CreateWithSocketServer();
+  thread->Start();
+  {
+    AsyncInvoker invoker;
+    InvokeAsync<int>(&invoker, RTC_FROM_HERE, thread.get(), [&result_set] {
+      result_set.Set();
+      return 42;
+    }).Then(Thread::Current(), [this](int value) { IntCallback(value); });
+    result_set.Wait(Event::kForever);
+  }
+  // The callback was posted to this thread, but dropped with the invoker.
+  Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(0, int_value_);
+  thread->Stop();
+}
+
 class GuardedAsyncInvokeTest : public testing::Test {
  public:
   void IntCallback(int value) {
@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/asyncsocket.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/messagehandler.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+
+namespace {
+
+const int kNumSockets = 1000;
+const int kPacketSize = 200;
+// How long the sockets send, in simulated time.
+const int kDurationMs = 10 * 1000;
+
+struct Scenario {
+  const char* name;
+  // How often each socket sends a packet.
+  int interval_ms;
+};
+
+// Media at 50 packets per second, and keepalives as sent by idle ICE
+// connections.
+const Scenario kScenarios[] = {
+    {"media", 20},
+    {"keepalive", 2500},
+};
+
+// A socket that periodically sends a packet to a peer, and counts the packets
+// it receives.
+class Endpoint : public MessageHandler, public sigslot::has_slots<> {
+ public:
+  Endpoint(VirtualSocketServer* ss, const SocketAddress& addr)
+      : socket_(ss->CreateAsyncSocket(addr.family(), SOCK_DGRAM)) {
+    EXPECT_EQ(0, socket_->Bind(addr));
+    socket_->SignalReadEvent.connect(this, &Endpoint::OnReadEvent);
+  }
+  ~Endpoint() override { Thread::Current()->Clear(this); }
+
+  SocketAddress address() const { return socket_->GetLocalAddress(); }
+  int packets_received() const { return packets_received_; }
+
+  // Sends to |peer| every |interval_ms| until |end_ms|, starting after
+  // |offset_ms|.
+  void Start(const SocketAddress& peer,
+             int offset_ms,
+             int interval_ms,
+             int64_t end_ms) {
+    peer_ = peer;
+    interval_ms_ = interval_ms;
+    end_ms_ = end_ms;
+    Thread::Current()->PostDelayed(RTC_FROM_HERE, offset_ms, this);
+  }
+
+  void OnMessage(Message* msg) override {
+    static const char kData[kPacketSize] = {0};
+    socket_->SendTo(kData, sizeof(kData), peer_);
+    if (TimeMillis() + interval_ms_ < end_ms_) {
+      Thread::Current()->PostDelayed(RTC_FROM_HERE, interval_ms_, this);
+    }
+  }
+
+ private:
+  void OnReadEvent(AsyncSocket* socket) {
+    char buffer[kPacketSize];
+    SocketAddress addr;
+    while (socket_->RecvFrom(buffer, sizeof(buffer), &addr, nullptr) > 0) {
+      ++packets_received_;
+    }
+  }
+
+  std::unique_ptr<AsyncSocket> socket_;
+  SocketAddress peer_;
+  int interval_ms_ = 0;
+  int64_t end_ms_ = 0;
+  int packets_received_ = 0;
+};
+
+}  // namespace
+
+class VirtualSocketPerformanceTest : public testing::Test {
+ public:
+  VirtualSocketPerformanceTest() : ss_(&fake_clock_), thread_(&ss_) {
+    srand(1);
+  }
+
+  // Runs kNumSockets sockets, each sending to the next, and returns the
+  // wall-clock time it took in milliseconds. |delivered| is set to the number
+  // of packets received.
+  double Run(const Scenario& scenario, bool fast_forward, int* delivered) {
+    ss_.set_delay_mean(50);
+    ss_.set_delay_stddev(10);
+    ss_.UpdateDelayDistribution();
+    ss_.set_fast_forward(fast_forward);
+
+    std::vector<std::unique_ptr<Endpoint>> endpoints;
+    for (int i = 0; i < kNumSockets; ++i) {
+      IPAddress ip(0x0a000000 + i);
+      endpoints.emplace_back(new Endpoint(&ss_, SocketAddress(ip, 5000)));
+    }
+    // Let the sockets signal their addresses.
+    ss_.ProcessMessagesUntilIdle();
+
+    const int64_t start_ns = SystemTimeNanos();
+    const int64_t end_ms = TimeMillis() + kDurationMs;
+    for (int i = 0; i < kNumSockets; ++i) {
+      endpoints[i]->Start(endpoints[(i + 1) % kNumSockets]->address(),
+                          rand() % scenario.interval_ms, scenario.interval_ms,
+                          end_ms);
+    }
+    ss_.ProcessMessagesUntilIdle();
+    const double elapsed_ms =
+        static_cast<double>(SystemTimeNanos() - start_ns) /
+        kNumNanosecsPerMillisec;
+
+    *delivered = 0;
+    for (const auto& endpoint : endpoints) {
+      *delivered += endpoint->packets_received();
+    }
+    return elapsed_ms;
+  }
+
+ protected:
+  ScopedFakeClock fake_clock_;
+  VirtualSocketServer ss_;
+  AutoSocketServerThread thread_;
+};
+
+// Measures how fast the simulated network delivers the packets of 1000 sockets
+// over 10 simulated seconds, stepping the fake clock by 1 ms and fast-
+// forwarding it to the next message.
+TEST_F(VirtualSocketPerformanceTest, ThousandSockets) {
+  for (const Scenario& scenario : kScenarios) {
+    for (bool fast_forward : {false, true}) {
+      int delivered = 0;
+      const double elapsed_ms = Run(scenario, fast_forward, &delivered);
+      EXPECT_GT(delivered, 0);
+      const char* modifier = fast_forward ? "_fast_forward" : "_step";
+      webrtc::test::PrintResult("virtualsocket_delivery_rate", modifier,
+                                scenario.name, delivered / elapsed_ms * 1000,
+                                "packets/s", false);
+      webrtc::test::PrintResult("virtualsocket_simulated_speed", modifier,
+                                scenario.name, kDurationMs / elapsed_ms,
+                                "x_realtime", false);
+    }
+  }
+}
+
+}  // namespace rtc
@@ -9,12 +9,14 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include <time.h>
 #if defined(WEBRTC_POSIX)
 #include <netinet/in.h>
 #endif
 
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "rtc_base/arraysize.h"
@@ -1127,3 +1129,84 @@ TEST_F(VirtualSocketServerTest, CreatesStandardDistribution) {
     }
   }
 }
+
+TEST_F(VirtualSocketServerTest, FastForwardAdvancesClockToNextPacket) {
+  ss_.set_delay_mean(100);
+  ss_.UpdateDelayDistribution();
+  ss_.set_fast_forward(true);
+
+  std::unique_ptr<AsyncSocket> socket1 = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> socket2 = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  socket1->Bind(kIPv4AnyAddress);
+  socket2->Bind(kIPv4AnyAddress);
+  ss_.ProcessMessagesUntilIdle();
+
+  const int64_t start_ms = rtc::TimeMillis();
+  EXPECT_EQ(3, socket1->SendTo("foo", 3, socket2->GetLocalAddress()));
+  EXPECT_TRUE(ss_.ProcessMessagesUntilIdle());
+  EXPECT_EQ(start_ms + 100, rtc::TimeMillis());
+
+  char buffer[16];
+  SocketAddress addr;
+  EXPECT_EQ(3, socket2->RecvFrom(buffer, sizeof(buffer), &addr, nullptr));
+  EXPECT_EQ(socket1->GetLocalAddress(), addr);
+}
+
+TEST_F(VirtualSocketServerTest, DeliversPacketsDueAtSameTimeInOrder) {
+  const int kNumSenders = 8;
+  ss_.set_delay_mean(10);
+  ss_.UpdateDelayDistribution();
+
+  std::unique_ptr<AsyncSocket> receiver = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  receiver->Bind(kIPv4AnyAddress);
+  std::vector<std::unique_ptr<AsyncSocket>> senders;
+  for (int i = 0; i < kNumSenders; ++i) {
+    senders.push_back(absl::WrapUnique(
+        ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM)));
+    senders.back()->Bind(kIPv4AnyAddress);
+  }
+  ss_.ProcessMessagesUntilIdle();
+
+  for (int i = 0; i < kNumSenders; ++i) {
+    char data = static_cast<char>(i);
+    EXPECT_EQ(1, senders[i]->SendTo(&data, 1, receiver->GetLocalAddress()));
+  }
+  ss_.ProcessMessagesUntilIdle();
+
+  for (int i = 0; i < kNumSenders; ++i) {
+    char data;
+    SocketAddress addr;
+    ASSERT_EQ(1, receiver->RecvFrom(&data, 1, &addr, nullptr));
+    EXPECT_EQ(i, data);
+    EXPECT_EQ(senders[i]->GetLocalAddress(), addr);
+  }
+}
+
+TEST_F(VirtualSocketServerTest, DestroyingSocketDropsPacketsInFlight) {
+  ss_.set_delay_mean(10);
+  ss_.UpdateDelayDistribution();
+
+  std::unique_ptr<AsyncSocket> socket1 = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> socket2 = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  std::unique_ptr<AsyncSocket> socket3 = absl::WrapUnique(
+      ss_.CreateAsyncSocket(kIPv4AnyAddress.family(), SOCK_DGRAM));
+  socket1->Bind(kIPv4AnyAddress);
+  socket2->Bind(kIPv4AnyAddress);
+  socket3->Bind(kIPv4AnyAddress);
+  ss_.ProcessMessagesUntilIdle();
+
+  EXPECT_EQ(3, socket1->SendTo("foo", 3, socket2->GetLocalAddress()));
+  EXPECT_EQ(3, socket1->SendTo("bar", 3, socket3->GetLocalAddress()));
+  socket2.reset();
+  ss_.ProcessMessagesUntilIdle();
+
+  char buffer[16];
+  SocketAddress addr;
+  EXPECT_EQ(3, socket3->RecvFrom(buffer, sizeof(buffer), &addr, nullptr));
+  EXPECT_EQ(0, memcmp(buffer, "bar", 3));
+}
@@ -43,6 +43,8 @@ const uint16_t kEphemeralPortCount =
     kLastEphemeralPort - kFirstEphemeralPort + 1;
 const uint32_t kDefaultNetworkCapacity = 64 * 1024;
 const uint32_t kDefaultTcpBufferSize = 32 * 1024;
+// The number of delivered packets kept for reuse.
+const size_t kMaxPooledPackets = 4096;
 
 const uint32_t UDP_HEADER_SIZE = 28;  // IP + UDP headers
 const uint32_t TCP_HEADER_SIZE = 40;  // IP + TCP headers
@@ -52,39 +54,42 @@ const uint32_t TCP_MSS = 1400;        // Maximum segment size
 const int NUM_SAMPLES = 1000;
 
 enum {
-  MSG_ID_PACKET,
+  MSG_ID_DELIVER,
   MSG_ID_ADDRESS_BOUND,
   MSG_ID_CONNECT,
   MSG_ID_DISCONNECT,
   MSG_ID_SIGNALREADEVENT,
 };
 
-// Packets are passed between sockets as messages.  We copy the data just like
-// the kernel does.
-class Packet : public MessageData {
+// Packets are passed between sockets by the server.  We copy the data just
+// like the kernel does, into a buffer that is reused once the packet has been
+// read.
+class Packet {
  public:
-  Packet(const char* data, size_t size, const SocketAddress& from)
-      : size_(size), consumed_(0), from_(from) {
-    RTC_DCHECK(nullptr != data);
-    data_ = new char[size_];
-    memcpy(data_, data, size_);
+  Packet(const char* data, size_t size, const SocketAddress& from) {
+    Assign(data, size, from);
   }
 
-  ~Packet() override { delete[] data_; }
+  void Assign(const char* data, size_t size, const SocketAddress& from) {
+    RTC_DCHECK(nullptr != data);
+    data_.assign(data, data + size);
+    consumed_ = 0;
+    from_ = from;
+  }
 
-  const char* data() const { return data_ + consumed_; }
-  size_t size() const { return size_ - consumed_; }
+  const char* data() const { return data_.data() + consumed_; }
+  size_t size() const { return data_.size() - consumed_; }
   const SocketAddress& from() const { return from_; }
 
   // Remove the first size bytes from the data.
   void Consume(size_t size) {
-    RTC_DCHECK(size + consumed_ < size_);
+    RTC_DCHECK(size + consumed_ < data_.size());
     consumed_ += size;
   }
 
  private:
-  char* data_;
-  size_t size_, consumed_;
+  std::vector<char> data_;
+  size_t consumed_;
   SocketAddress from_;
 };
 
@@ -116,10 +121,10 @@ VirtualSocket::VirtualSocket(VirtualSocketServer* server,
 
 VirtualSocket::~VirtualSocket() {
   Close();
+  server_->CancelPackets(this);
 
-  for (RecvBuffer::iterator it = recv_buffer_.begin(); it != recv_buffer_.end();
-       ++it) {
-    delete *it;
+  for (Packet* packet : recv_buffer_) {
+    server_->RecyclePacket(packet);
   }
 }
 
@@ -224,6 +229,7 @@ int VirtualSocket::Close() {
     if (server_->msg_queue_) {
       server_->msg_queue_->Clear(this);
     }
+    server_->CancelPackets(this);
   }
 
   state_ = CS_CLOSED;
@@ -293,7 +299,7 @@ int VirtualSocket::RecvFrom(void* pv,
     packet->Consume(data_read);
   } else {
     recv_buffer_.pop_front();
-    delete packet;
+    server_->RecyclePacket(packet);
   }
 
   // To behave like a real socket, SignalReadEvent should fire in the next
@@ -385,17 +391,16 @@ int VirtualSocket::SetOption(Option opt, int value) {
   return 0;  // 0 is success to emulate setsockopt()
 }
 
-void VirtualSocket::OnMessage(Message* pmsg) {
-  if (pmsg->message_id == MSG_ID_PACKET) {
-    RTC_DCHECK(nullptr != pmsg->pdata);
-    Packet* packet = static_cast<Packet*>(pmsg->pdata);
+void VirtualSocket::DeliverPacket(Packet* packet) {
+  recv_buffer_.push_back(packet);
 
-    recv_buffer_.push_back(packet);
+  if (async_) {
+    SignalReadEvent(this);
+  }
+}
 
-    if (async_) {
-      SignalReadEvent(this);
-    }
-  } else if (pmsg->message_id == MSG_ID_CONNECT) {
+void VirtualSocket::OnMessage(Message* pmsg) {
+  if (pmsg->message_id == MSG_ID_CONNECT) {
     RTC_DCHECK(nullptr != pmsg->pdata);
     MessageAddress* data = static_cast<MessageAddress*>(pmsg->pdata);
     if (listen_queue_ != nullptr) {
@@ -547,6 +552,15 @@ VirtualSocketServer::VirtualSocketServer(FakeClock* fake_clock)
 VirtualSocketServer::~VirtualSocketServer() {
   delete bindings_;
   delete connections_;
+
+  for (const auto& entry : pending_packets_) {
+    for (const PendingPacket& pending : entry.second) {
+      delete pending.packet;
+    }
+  }
+  for (Packet* packet : packet_pool_) {
+    delete packet;
+  }
 }
 
 IPAddress VirtualSocketServer::GetNextIP(int family) {
@@ -637,8 +651,16 @@ bool VirtualSocketServer::ProcessMessagesUntilIdle() {
   while (!msg_queue_->empty()) {
     if (fake_clock_) {
       // If using a fake clock, advance it in millisecond increments until the
-      // queue is empty.
-      fake_clock_->AdvanceTime(webrtc::TimeDelta::ms(1));
+      // queue is empty, or in fast-forward mode, to the next message. A delay
+      // of 0 still processes the messages that are due.
+      int delay_ms = 1;
+      if (fast_forward_) {
+        delay_ms = msg_queue_->GetDelay();
+        if (delay_ms == kForever) {
+          delay_ms = 1;
+        }
+      }
+      fake_clock_->AdvanceTime(webrtc::TimeDelta::ms(delay_ms));
     } else {
       // Otherwise, run a normal message loop.
       Message msg;
@@ -965,8 +987,7 @@ void VirtualSocketServer::AddPacketToNetwork(VirtualSocket* sender,
     sender_addr.SetIP(default_ip);
   }
 
-  // Post the packet as a message to be delivered (on our own thread)
-  Packet* p = new Packet(data, data_size, sender_addr);
+  Packet* p = CreatePacket(data, data_size, sender_addr);
 
   int64_t ts = TimeAfter(send_delay + transit_delay);
   if (ordered) {
@@ -976,7 +997,94 @@ void VirtualSocketServer::AddPacketToNetwork(VirtualSocket* sender,
     // delivery time only needs to be updated when it has ordered delivery.
     sender->last_delivery_time_ = ts;
   }
-  msg_queue_->PostAt(RTC_FROM_HERE, ts, recipient, MSG_ID_PACKET, p);
+
+  // Queue the packet with the others due at the same time, and post a message
+  // to deliver them (on our own thread) for the first one.
+  bool first;
+  {
+    CritScope cs(&pending_crit_);
+    std::vector<PendingPacket>& packets = pending_packets_[ts];
+    first = packets.empty();
+    packets.push_back(PendingPacket{recipient, p});
+  }
+  if (first) {
+    msg_queue_->PostAt(RTC_FROM_HERE, ts, this, MSG_ID_DELIVER);
+  }
+}
+
+void VirtualSocketServer::OnMessage(Message* msg) {
+  RTC_DCHECK_EQ(MSG_ID_DELIVER, msg->message_id);
+  DeliverPackets();
+}
+
+void VirtualSocketServer::DeliverPackets() {
+  // Messages are dispatched in order of their time, so the earliest packets
+  // are those of the message being dispatched.
+  std::vector<PendingPacket> packets;
+  {
+    CritScope cs(&pending_crit_);
+    auto it = pending_packets_.begin();
+    if (it == pending_packets_.end() || it->first > TimeMillis()) {
+      return;
+    }
+    // Packets sent while these are delivered go into a new entry, with their
+    // own message, even when they are due now.
+    packets.swap(it->second);
+    pending_packets_.erase(it);
+  }
+  for (const PendingPacket& pending : packets) {
+    pending.recipient->DeliverPacket(pending.packet);
+  }
+}
+
+void VirtualSocketServer::CancelPackets(VirtualSocket* recipient) {
+  std::vector<Packet*> cancelled;
+  {
+    CritScope cs(&pending_crit_);
+    for (auto& entry : pending_packets_) {
+      std::vector<PendingPacket>& packets = entry.second;
+      auto end = std::remove_if(
+          packets.begin(), packets.end(), [&](const PendingPacket& pending) {
+            if (pending.recipient != recipient)
+              return false;
+            cancelled.push_back(pending.packet);
+            return true;
+          });
+      packets.erase(end, packets.end());
+    }
+  }
+  for (Packet* packet : cancelled) {
+    RecyclePacket(packet);
+  }
+}
+
+Packet* VirtualSocketServer::CreatePacket(const char* data,
+                                          size_t data_size,
+                                          const SocketAddress& from) {
+  Packet* packet = nullptr;
+  {
+    CritScope cs(&pool_crit_);
+    if (!packet_pool_.empty()) {
+      packet = packet_pool_.back();
+      packet_pool_.pop_back();
+    }
+  }
+  if (!packet) {
+    return new Packet(data, data_size, from);
+  }
+  packet->Assign(data, data_size, from);
+  return packet;
+}
+
+void VirtualSocketServer::RecyclePacket(Packet* packet) {
+  {
+    CritScope cs(&pool_crit_);
+    if (packet_pool_.size() < kMaxPooledPackets) {
+      packet_pool_.push_back(packet);
+      return;
+    }
+  }
+  delete packet;
 }
 
 void VirtualSocketServer::PurgeNetworkPackets(VirtualSocket* socket,
@@ -1068,11 +1176,18 @@ VirtualSocketServer::Function* VirtualSocketServer::CreateDistribution(
 
 uint32_t VirtualSocketServer::GetTransitDelay(Socket* socket) {
   // Use the delay based on the address if it is set.
-  auto iter = delay_by_ip_.find(socket->GetLocalAddress().ipaddr());
-  if (iter != delay_by_ip_.end()) {
-    return static_cast<uint32_t>(iter->second);
+  if (!delay_by_ip_.empty()) {
+    auto iter = delay_by_ip_.find(socket->GetLocalAddress().ipaddr());
+    if (iter != delay_by_ip_.end()) {
+      return static_cast<uint32_t>(iter->second);
+    }
+  }
+  // Otherwise, use the delay from the distribution distribution. Its samples
+  // are sorted, so it is constant if the first and last are equal, as without
+  // deviation, and then there is nothing to draw.
+  if (delay_dist_->front().second == delay_dist_->back().second) {
+    return static_cast<uint32_t>(delay_dist_->front().second);
   }
-  // Otherwise, use the delay from the distribution distribution.
   size_t index = rand() % delay_dist_->size();
   double delay = (*delay_dist_)[index].second;
   // RTC_LOG_F(LS_INFO) << "random[" << index << "] = " << delay;
@@ -13,25 +13,34 @@
 
 #include <deque>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "rtc_base/checks.h"
 #include "rtc_base/constructormagic.h"
 #include "rtc_base/event.h"
 #include "rtc_base/fakeclock.h"
 #include "rtc_base/messagequeue.h"
+#include "rtc_base/socketaddresspair.h"
 #include "rtc_base/socketserver.h"
 
 namespace rtc {
 
 class Packet;
 class VirtualSocket;
-class SocketAddressPair;
 
 // Simulates a network in the same manner as a loopback interface.  The
 // interface can create as many addresses as you want.  All of the sockets
 // created by this network will be able to communicate with one another, unless
 // they are bound to addresses from incompatible families.
-class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
+//
+// Packets in flight are kept by the server, grouped by the time at which they
+// are delivered, and one message is posted to the message queue for each
+// group.
+class VirtualSocketServer : public SocketServer,
+                            public MessageHandler,
+                            public sigslot::has_slots<> {
  public:
   VirtualSocketServer();
   // This constructor needs to be used if the test uses a fake clock and
@@ -137,6 +146,14 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // if Thread::Stop() was called.
   bool ProcessMessagesUntilIdle();
 
+  // If true, ProcessMessagesUntilIdle advances the fake clock straight to the
+  // time of the next message on our message queue, instead of in millisecond
+  // increments. Messages of other threads that fall due in between are
+  // processed late, so this is for tests that run on a single thread. Defaults
+  // to false.
+  bool fast_forward() const { return fast_forward_; }
+  void set_fast_forward(bool fast_forward) { fast_forward_ = fast_forward; }
+
   // Sets the next port number to use for testing.
   void SetNextPortForTesting(uint16_t port);
 
@@ -152,6 +169,9 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // For testing purpose only. Fired when a client socket is created.
   sigslot::signal1<VirtualSocket*> SignalSocketCreated;
 
+  // MessageHandler implementation, for the delivery of packets.
+  void OnMessage(Message* msg) override;
+
  protected:
   // Returns a new IP not used before in this network.
   IPAddress GetNextIP(int family);
@@ -211,6 +231,21 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // Removes stale packets from the network
   void PurgeNetworkPackets(VirtualSocket* socket, int64_t cur_time);
 
+  // Delivers the packets in flight with the earliest delivery time, if that
+  // time has come.
+  void DeliverPackets();
+
+  // Drops the packets in flight to |recipient|.
+  void CancelPackets(VirtualSocket* recipient);
+
+  // Returns a packet with a copy of |data|, reusing a recycled one if there is
+  // any.
+  Packet* CreatePacket(const char* data,
+                       size_t data_size,
+                       const SocketAddress& from);
+  // Deletes |packet|, or keeps it to be reused by CreatePacket.
+  void RecyclePacket(Packet* packet);
+
   // Computes the number of milliseconds required to send a packet of this size.
   uint32_t SendDelay(uint32_t size);
 
@@ -258,8 +293,27 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // Sending was previously blocked, but now isn't.
   sigslot::signal0<> SignalReadyToSend;
 
-  typedef std::map<SocketAddress, VirtualSocket*> AddressMap;
-  typedef std::map<SocketAddressPair, VirtualSocket*> ConnectionMap;
+  struct SocketAddressHash {
+    size_t operator()(const SocketAddress& addr) const { return addr.Hash(); }
+  };
+  struct SocketAddressPairHash {
+    size_t operator()(const SocketAddressPair& pair) const {
+      return pair.Hash();
+    }
+  };
+
+  typedef std::unordered_map<SocketAddress, VirtualSocket*, SocketAddressHash>
+      AddressMap;
+  typedef std::
+      unordered_map<SocketAddressPair, VirtualSocket*, SocketAddressPairHash>
+          ConnectionMap;
+
+  struct PendingPacket {
+    VirtualSocket* recipient;
+    Packet* packet;
+  };
+  // Packets in flight, by delivery time.
+  typedef std::map<int64_t, std::vector<PendingPacket>> PendingPacketMap;
 
   // May be null if the test doesn't use a fake clock, or it does but doesn't
   // use ProcessMessagesUntilIdle.
@@ -269,6 +323,7 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   Event wakeup_;
   MessageQueue* msg_queue_;
   bool stop_on_idle_;
+  bool fast_forward_ = false;
   in_addr next_ipv4_;
   in6_addr next_ipv6_;
   uint16_t next_port_;
@@ -295,13 +350,19 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
 
   CriticalSection delay_crit_;
 
+  CriticalSection pending_crit_;
+  PendingPacketMap pending_packets_ RTC_GUARDED_BY(pending_crit_);
+
+  CriticalSection pool_crit_;
+  std::vector<Packet*> packet_pool_ RTC_GUARDED_BY(pool_crit_);
+
   double drop_prob_;
   bool sending_blocked_ = false;
   RTC_DISALLOW_COPY_AND_ASSIGN(VirtualSocketServer);
 };
 
 // Implements the socket interface using the virtual network.  Packets are
-// passed as messages using the message queue of the socket server.
+// delivered by the socket server on the thread of its message queue.
 class VirtualSocket : public AsyncSocket,
                       public MessageHandler,
                       public sigslot::has_slots<> {
@@ -347,7 +408,7 @@ class VirtualSocket : public AsyncSocket,
   typedef std::deque<SocketAddress> ListenQueue;
   typedef std::deque<NetworkEntry> NetworkQueue;
   typedef std::vector<char> SendBuffer;
-  typedef std::list<Packet*> RecvBuffer;
+  typedef std::deque<Packet*> RecvBuffer;
   typedef std::map<Option, int> OptionsMap;
 
   int InitiateConnect(const SocketAddress& addr, bool use_delay);
@@ -355,6 +416,9 @@ class VirtualSocket : public AsyncSocket,
   int SendUdp(const void* pv, size_t cb, const SocketAddress& addr);
   int SendTcp(const void* pv, size_t cb);
 
+  // Called by the server when |packet| arrives, which we take ownership of.
+  void DeliverPacket(Packet* packet);
+
   // Used by server sockets to set the local address without binding.
   void SetLocalAddress(const SocketAddress& addr);
 
@@ -14,6 +14,7 @@
 #include <memory>
 
 #include "rtc_base/synchronization/rw_lock_wrapper.h"
+#include "rtc_base/thread_checker.h"
 #include "system_wrappers/include/ntp_time.h"
 #include "typedefs.h"  // NOLINT(build/include)
 
@@ -51,6 +52,49 @@ class Clock {
 
   // Returns an instance of the real-time system clock implementation.
   static Clock* GetRealTimeClock();
+
+  // Returns a clock with the same time base as GetRealTimeClock() that is
+  // cheaper to read at the cost of some accuracy, for code that reads the time
+  // several times per packet. On x86 Linux hosts where the kernel keeps time
+  // with the TSC, it scales the TSC directly instead of calling
+  // clock_gettime(), and may be off by a few microseconds. Elsewhere, and
+  // while a clock is set with rtc::SetClockForTesting(), it is the same as
+  // GetRealTimeClock().
+  static Clock* GetFastClock();
+};
+
+// Returns the time of the last call to Refresh() rather than the current time
+// of |clock|, for code that reads the time many times while handling a single
+// event and does not need it to advance in between. Meant to be owned by one
+// thread and refreshed at the start of each iteration of its event loop.
+// NTP timestamps are not cached.
+class CachedClock : public Clock {
+ public:
+  explicit CachedClock(Clock* clock);
+
+  ~CachedClock() override;
+
+  // Return the cached timestamp in milliseconds.
+  int64_t TimeInMilliseconds() const override;
+
+  // Return the cached timestamp in microseconds.
+  int64_t TimeInMicroseconds() const override;
+
+  // Retrieve an NTP absolute timestamp from the underlying clock.
+  NtpTime CurrentNtpTime() const override;
+
+  // Retrieve an NTP absolute timestamp in milliseconds from the underlying
+  // clock.
+  int64_t CurrentNtpInMilliseconds() const override;
+
+  // Reads the current time from the underlying clock.
+  void Refresh();
+
+ private:
+  Clock* const clock_;
+  rtc::ThreadChecker thread_checker_;
+  int64_t time_ms_;
+  int64_t time_us_;
 };
 
 class SimulatedClock : public Clock {
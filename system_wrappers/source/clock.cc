@@ -10,6 +10,12 @@
 
 #include "system_wrappers/include/clock.h"
 
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_LINUX) && defined(WEBRTC_ARCH_X86_FAMILY)
+#define WEBRTC_TSC_CLOCK
+#endif
+
 #if defined(WEBRTC_WIN)
 
 // Windows needs to be included before mmsystem.h
@@ -24,6 +30,16 @@
 
 #endif  // defined(WEBRTC_POSIX)
 
+#if defined(WEBRTC_TSC_CLOCK)
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#endif  // defined(WEBRTC_TSC_CLOCK)
+
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/synchronization/rw_lock_wrapper.h"
 #include "rtc_base/timeutils.h"
@@ -200,6 +216,195 @@ class UnixRealTimeClock : public RealTimeClock {
 };
 #endif  // defined(WEBRTC_POSIX)
 
+#if defined(WEBRTC_TSC_CLOCK)
+// Converts TSC readings to rtc::SystemTimeNanos() time. The TSC rate is
+// measured against clock_gettime() over the last calibration interval, first
+// after kFirstCalibrationNs and then every kCalibrationIntervalNs, so that it
+// follows changes of the system clock rate, e.g. from NTP. Until the first
+// calibration the time is read with rtc::SystemTimeNanos(). Later offsets from
+// it are corrected by slewing the rate, so that the time neither jumps nor
+// goes back.
+//
+// The calibration is published with a sequence lock: it is written by at most
+// one thread at a time, under |calibration_crit_|, and readers retry if the
+// sequence number changed while they read it.
+class TscTime {
+ public:
+  TscTime()
+      : first_sample_(TakeSample()),
+        sequence_(0),
+        base_tsc_(0),
+        base_ns_(0),
+        ns_per_tick_(0),
+        next_calibration_tsc_(0),
+        last_sample_(first_sample_) {}
+
+  // Only use the TSC if the kernel does, which means that it has found it to
+  // run at a constant rate and to be synchronized between cores.
+  static bool IsSupported() {
+    FILE* file = fopen(
+        "/sys/devices/system/clocksource/clocksource0/current_clocksource",
+        "r");
+    if (!file)
+      return false;
+    char clocksource[16] = {0};
+    bool is_tsc = fgets(clocksource, sizeof(clocksource), file) &&
+                  strcmp(clocksource, "tsc\n") == 0;
+    fclose(file);
+    return is_tsc;
+  }
+
+  int64_t TimeNanos() const {
+    const uint64_t tsc = __rdtsc();
+    while (true) {
+      uint32_t sequence = sequence_.load(std::memory_order_acquire);
+      if (sequence & 1)
+        continue;
+      uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+      int64_t base_ns = base_ns_.load(std::memory_order_relaxed);
+      double ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+      uint64_t next_calibration_tsc =
+          next_calibration_tsc_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) != sequence)
+        continue;
+
+      if (ns_per_tick == 0) {
+        int64_t now_ns = rtc::SystemTimeNanos();
+        if (now_ns - first_sample_.ns < kFirstCalibrationNs)
+          return now_ns;
+      } else if (tsc < next_calibration_tsc) {
+        // |tsc| can be before |base_tsc| if another thread calibrated after
+        // it was read.
+        return base_ns + static_cast<int64_t>(
+                             static_cast<int64_t>(tsc - base_tsc) * ns_per_tick);
+      }
+      // If another thread is calibrating, wait for it to publish the result.
+      if (calibration_crit_.TryEnter()) {
+        Calibrate();
+        calibration_crit_.Leave();
+      }
+    }
+  }
+
+ private:
+  struct Sample {
+    uint64_t tsc;
+    int64_t ns;
+  };
+
+  static const int64_t kFirstCalibrationNs = 20 * rtc::kNumNanosecsPerMillisec;
+  static const int64_t kCalibrationIntervalNs = rtc::kNumNanosecsPerSec;
+  // The most the offset is corrected by per calibration interval, i.e. the
+  // rate is adjusted by at most 500 ppm, like adjtime() does.
+  static const int64_t kMaxSlewNs = kCalibrationIntervalNs / 2000;
+
+  // Reads the TSC right before and after clock_gettime(), keeping the
+  // narrowest of a few tries to leave out preemptions.
+  static Sample TakeSample() {
+    Sample sample = {0, 0};
+    uint64_t best_width = std::numeric_limits<uint64_t>::max();
+    for (int i = 0; i < 3; ++i) {
+      uint64_t before = __rdtsc();
+      int64_t ns = rtc::SystemTimeNanos();
+      uint64_t after = __rdtsc();
+      if (after - before < best_width) {
+        best_width = after - before;
+        sample.tsc = before + best_width / 2;
+        sample.ns = ns;
+      }
+    }
+    return sample;
+  }
+
+  void Calibrate() const RTC_EXCLUSIVE_LOCKS_REQUIRED(calibration_crit_) {
+    Sample sample = TakeSample();
+    uint64_t next_calibration_tsc =
+        next_calibration_tsc_.load(std::memory_order_relaxed);
+    double ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+    // Another thread may have calibrated since the caller checked.
+    if (ns_per_tick != 0 && sample.tsc < next_calibration_tsc)
+      return;
+    if (sample.tsc <= last_sample_.tsc)
+      return;
+
+    int64_t base_ns = sample.ns;
+    const double old_ns_per_tick = ns_per_tick;
+    ns_per_tick = static_cast<double>(sample.ns - last_sample_.ns) /
+                  (sample.tsc - last_sample_.tsc);
+    last_sample_ = sample;
+    if (old_ns_per_tick != 0) {
+      // Continue from the time the old calibration got to, and correct its
+      // offset over the next interval. Only a time that is behind by more than
+      // that can correct is stepped, forward. Readers calibrate before going
+      // past |next_calibration_tsc|, so the old rate, which may have been
+      // slewed, only applies until then.
+      int64_t estimated_ns =
+          base_ns_.load(std::memory_order_relaxed) +
+          static_cast<int64_t>(
+              (next_calibration_tsc -
+               base_tsc_.load(std::memory_order_relaxed)) *
+              old_ns_per_tick) +
+          static_cast<int64_t>((sample.tsc - next_calibration_tsc) *
+                               ns_per_tick);
+      int64_t offset_ns = sample.ns - estimated_ns;
+      if (offset_ns <= kMaxSlewNs) {
+        base_ns = estimated_ns;
+        offset_ns = std::max(offset_ns, -kMaxSlewNs);
+        ns_per_tick *=
+            1 + static_cast<double>(offset_ns) / kCalibrationIntervalNs;
+      }
+    }
+
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_tsc_.store(sample.tsc, std::memory_order_relaxed);
+    base_ns_.store(base_ns, std::memory_order_relaxed);
+    ns_per_tick_.store(ns_per_tick, std::memory_order_relaxed);
+    next_calibration_tsc_.store(
+        sample.tsc + static_cast<uint64_t>(kCalibrationIntervalNs / ns_per_tick),
+        std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  const Sample first_sample_;
+  rtc::CriticalSection calibration_crit_;
+  // Odd while the calibration below is being written.
+  mutable std::atomic<uint32_t> sequence_;
+  mutable std::atomic<uint64_t> base_tsc_;
+  mutable std::atomic<int64_t> base_ns_;
+  mutable std::atomic<double> ns_per_tick_;
+  mutable std::atomic<uint64_t> next_calibration_tsc_;
+  // The sample of the last calibration, which the next one measures from.
+  mutable Sample last_sample_ RTC_GUARDED_BY(calibration_crit_);
+};
+
+class TscClock : public UnixRealTimeClock {
+ public:
+  TscClock() {}
+
+  ~TscClock() override {}
+
+  int64_t TimeInMilliseconds() const override {
+    return TimeNanos() / rtc::kNumNanosecsPerMillisec;
+  }
+
+  int64_t TimeInMicroseconds() const override {
+    return TimeNanos() / rtc::kNumNanosecsPerMicrosec;
+  }
+
+ private:
+  int64_t TimeNanos() const {
+    if (rtc::GetClockForTesting())
+      return rtc::TimeNanos();
+    return tsc_time_.TimeNanos();
+  }
+
+  const TscTime tsc_time_;
+};
+#endif  // defined(WEBRTC_TSC_CLOCK)
+
 #if defined(WEBRTC_WIN)
 static WindowsRealTimeClock* volatile g_shared_clock = nullptr;
 #endif  // defined(WEBRTC_WIN)
@@ -228,6 +433,47 @@ Clock* Clock::GetRealTimeClock() {
 #endif  // !defined(WEBRTC_WIN) || defined(WEBRTC_POSIX)
 }
 
+Clock* Clock::GetFastClock() {
+#if defined(WEBRTC_TSC_CLOCK)
+  static Clock* const clock =
+      TscTime::IsSupported() ? new TscClock() : GetRealTimeClock();
+  return clock;
+#else
+  return GetRealTimeClock();
+#endif  // defined(WEBRTC_TSC_CLOCK)
+}
+
+CachedClock::CachedClock(Clock* clock) : clock_(clock) {
+  Refresh();
+  thread_checker_.DetachFromThread();
+}
+
+CachedClock::~CachedClock() {}
+
+int64_t CachedClock::TimeInMilliseconds() const {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  return time_ms_;
+}
+
+int64_t CachedClock::TimeInMicroseconds() const {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  return time_us_;
+}
+
+NtpTime CachedClock::CurrentNtpTime() const {
+  return clock_->CurrentNtpTime();
+}
+
+int64_t CachedClock::CurrentNtpInMilliseconds() const {
+  return clock_->CurrentNtpInMilliseconds();
+}
+
+void CachedClock::Refresh() {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  time_us_ = clock_->TimeInMicroseconds();
+  time_ms_ = clock_->TimeInMilliseconds();
+}
+
 SimulatedClock::SimulatedClock(int64_t initial_time_us)
     : time_us_(initial_time_us), lock_(RWLockWrapper::CreateRWLock()) {}
 
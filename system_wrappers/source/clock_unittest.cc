@@ -10,6 +10,7 @@
 
 #include "system_wrappers/include/clock.h"
 
+#include "rtc_base/timeutils.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -31,4 +32,43 @@ TEST(ClockTest, NtpTime) {
   EXPECT_GE(milliseconds_upper_bound + 1, ntp_time.ToMs());
 }
 
+TEST(ClockTest, FastClockFollowsRealTimeClock) {
+  Clock* clock = Clock::GetFastClock();
+  // Preemption or VM steal while the TSC is calibrated leaves an offset until
+  // the next calibration corrects it, so allow for a few ms of it.
+  const int64_t kToleranceUs = 5 * rtc::kNumMicrosecsPerMillisec;
+  // Run past the first calibration, when the TSC, if used, takes over, and the
+  // second one, which corrects the offset the first one left.
+  int64_t end_us = rtc::TimeMicros() + 1100 * rtc::kNumMicrosecsPerMillisec;
+  int64_t last_us = clock->TimeInMicroseconds();
+  while (true) {
+    int64_t lower_bound_us = rtc::TimeMicros();
+    int64_t now_us = clock->TimeInMicroseconds();
+    int64_t upper_bound_us = rtc::TimeMicros();
+    EXPECT_GE(now_us, last_us);
+    EXPECT_LE(lower_bound_us - kToleranceUs, now_us);
+    EXPECT_GE(upper_bound_us + kToleranceUs, now_us);
+    last_us = now_us;
+    if (lower_bound_us > end_us)
+      break;
+  }
+}
+
+TEST(ClockTest, CachedClockOnlyAdvancesOnRefresh) {
+  SimulatedClock simulated_clock(1000500);
+  CachedClock clock(&simulated_clock);
+  EXPECT_EQ(1000500, clock.TimeInMicroseconds());
+  EXPECT_EQ(1001, clock.TimeInMilliseconds());
+
+  simulated_clock.AdvanceTimeMicroseconds(1000);
+  EXPECT_EQ(1000500, clock.TimeInMicroseconds());
+  EXPECT_EQ(1001, clock.TimeInMilliseconds());
+  EXPECT_EQ(simulated_clock.CurrentNtpInMilliseconds(),
+            clock.CurrentNtpInMilliseconds());
+
+  clock.Refresh();
+  EXPECT_EQ(1001500, clock.TimeInMicroseconds());
+  EXPECT_EQ(1002, clock.TimeInMilliseconds());
+}
+
 }  // namespace webrtc
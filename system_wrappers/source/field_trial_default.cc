@@ -10,23 +10,41 @@
 #include "system_wrappers/include/field_trial_default.h"
 #include "system_wrappers/include/field_trial.h"
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "rtc_base/criticalsection.h"
 
 // Simple field trial implementation, which allows client to
 // specify desired flags in InitFieldTrialsFromString.
 namespace webrtc {
 namespace field_trial {
 
-static const char* trials_init_string = NULL;
+typedef std::unordered_map<std::string, std::string> TrialGroups;
 
-std::string FindFullName(const std::string& name) {
-  if (trials_init_string == NULL)
-    return std::string();
+static const char* trials_init_string = NULL;
+// The groups of the trials in |trials_init_string|, by trial name. Parsed when
+// the string is set, so that lookups neither copy nor tokenize it. Owned by
+// the ParsedTrialsCache, since lookups may run on any thread while the string
+// is replaced.
+static std::atomic<const TrialGroups*> trials(nullptr);
 
-  std::string trials_string(trials_init_string);
-  if (trials_string.empty())
-    return std::string();
+// Every trials string parsed so far, with its groups. The maps are never
+// freed, but stay reachable, and setting a string again, as
+// test::ScopedFieldTrials does when it restores the previous one, reuses its
+// map.
+struct ParsedTrialsCache {
+  rtc::CriticalSection crit;
+  std::unordered_map<std::string, std::unique_ptr<const TrialGroups>> groups
+      RTC_GUARDED_BY(crit);
+};
 
+static std::unique_ptr<const TrialGroups> ParseTrials(
+    const std::string& trials_string) {
+  std::unique_ptr<TrialGroups> parsed(new TrialGroups());
   static const char kPersistentStringSeparator = '/';
   size_t next_item = 0;
   while (next_item < trials_string.length()) {
@@ -46,15 +64,37 @@ std::string FindFullName(const std::string& name) {
                             field_value_end - field_name_end - 1);
     next_item = field_value_end + 1;
 
-    if (name == field_name)
-      return field_value;
+    // The first group given for a trial wins.
+    parsed->emplace(std::move(field_name), std::move(field_value));
   }
-  return std::string();
+  return std::move(parsed);
+}
+
+static const TrialGroups* GetParsedTrials(const char* trials_string) {
+  static ParsedTrialsCache* const cache = new ParsedTrialsCache();
+  rtc::CritScope lock(&cache->crit);
+  std::unique_ptr<const TrialGroups>& groups = cache->groups[trials_string];
+  if (!groups)
+    groups = ParseTrials(trials_string);
+  return groups.get();
+}
+
+std::string FindFullName(const std::string& name) {
+  const auto* current_trials = trials.load(std::memory_order_acquire);
+  if (current_trials == NULL)
+    return std::string();
+
+  auto it = current_trials->find(name);
+  if (it == current_trials->end())
+    return std::string();
+  return it->second;
 }
 
 // Optionally initialize field trial from a string.
 void InitFieldTrialsFromString(const char* trials_string) {
   trials_init_string = trials_string;
+  trials.store(trials_string ? GetParsedTrials(trials_string) : NULL,
+               std::memory_order_release);
 }
 
 const char* GetFieldTrialString() {
@@ -11,11 +11,21 @@
 #include "test/rtp_file_reader.h"
 
 #include <stdio.h>
+#include <string.h>
 
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "modules/rtp_rtcp/source/byte_io.h"
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/constructormagic.h"
@@ -36,102 +46,305 @@ static uint16_t kPacketHeaderSize = 8;
     }                                       \
   } while (0)
 
-bool ReadUint32(uint32_t* out, FILE* file) {
-  *out = 0;
-  for (size_t i = 0; i < 4; ++i) {
-    *out <<= 8;
-    uint8_t tmp;
-    if (fread(&tmp, 1, sizeof(uint8_t), file) != sizeof(uint8_t))
+// A read-only view of a whole file with a read position, standing in for the
+// FILE* calls the readers used to make. The file is mapped into memory where
+// mmap() is available, so that reading a packet is a memcpy rather than a
+// call into stdio per header field; elsewhere it is read into memory up front.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile() {
+#if defined(WEBRTC_POSIX)
+    if (mapped_)
+      munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  }
+
+  bool Open(const std::string& filename) {
+    RTC_DCHECK(!data_);
+#if defined(WEBRTC_POSIX)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+      void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        // Packets are read front to back.
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const uint8_t*>(data);
+        mapped_ = true;
+      }
+    }
+    close(fd);
+    if (mapped_ || size_ == 0)
+      return true;
+#endif
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
       return false;
-    *out |= tmp;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+      buffer_.insert(buffer_.end(), chunk, chunk + read);
+    fclose(file);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
   }
-  return true;
-}
 
-bool ReadUint16(uint16_t* out, FILE* file) {
-  *out = 0;
-  for (size_t i = 0; i < 2; ++i) {
-    *out <<= 8;
-    uint8_t tmp;
-    if (fread(&tmp, 1, sizeof(uint8_t), file) != sizeof(uint8_t))
+  bool Read(void* out, size_t length) {
+    if (length > size_ - pos_) {
+      pos_ = size_;
       return false;
-    *out |= tmp;
+    }
+    memcpy(out, data_ + pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  // Reads a line of at most |max_length| bytes, like fgets().
+  bool ReadLine(char* out, size_t max_length) {
+    RTC_DCHECK_GT(max_length, 0);
+    if (pos_ == size_)
+      return false;
+    size_t length = 0;
+    while (length + 1 < max_length && pos_ < size_) {
+      char c = static_cast<char>(data_[pos_++]);
+      out[length++] = c;
+      if (c == '\n')
+        break;
+    }
+    out[length] = '\0';
+    return true;
   }
+
+  // Like Read(), a failed seek leaves the file at its end, as feof() expects.
+  bool Seek(size_t pos) {
+    if (pos > size_) {
+      pos_ = size_;
+      return false;
+    }
+    pos_ = pos;
+    return true;
+  }
+
+  bool Skip(size_t length) { return Seek(pos_ + length); }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  size_t Tell() const { return pos_; }
+  bool AtEnd() const { return pos_ == size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t pos_ = 0;
+  bool mapped_ = false;
+  std::vector<uint8_t> buffer_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+bool ReadUint32(uint32_t* out, MappedFile* file) {
+  uint8_t tmp[4];
+  if (!file->Read(tmp, sizeof(tmp)))
+    return false;
+  *out = (static_cast<uint32_t>(tmp[0]) << 24) |
+         (static_cast<uint32_t>(tmp[1]) << 16) |
+         (static_cast<uint32_t>(tmp[2]) << 8) | tmp[3];
   return true;
 }
 
+bool ReadUint16(uint16_t* out, MappedFile* file) {
+  uint8_t tmp[2];
+  if (!file->Read(tmp, sizeof(tmp)))
+    return false;
+  *out = static_cast<uint16_t>((tmp[0] << 8) | tmp[1]);
+  return true;
+}
+
+// Holds the index of the packets in a file, which the reader for each format
+// builds when the file is opened, and returns the packets straight out of the
+// mapped file.
 class RtpFileReaderImpl : public RtpFileReader {
  public:
   virtual bool Init(const std::string& filename,
                     const std::set<uint32_t>& ssrc_filter) = 0;
-};
 
-class InterleavedRtpFileReader : public RtpFileReaderImpl {
- public:
-  virtual ~InterleavedRtpFileReader() {
-    if (file_ != NULL) {
-      fclose(file_);
-      file_ = NULL;
+  bool NextPacket(RtpPacket* packet) override {
+    while (next_ < NumSelected()) {
+      const PacketEntry& entry = Selected(next_++);
+      if (!IsSelected(entry))
+        continue;
+      if (entry.length > RtpPacket::kMaxPacketBufferSize)
+        return false;
+      memcpy(packet->data, file_.data() + entry.pos, entry.length);
+      packet->length = entry.length;
+      packet->original_length = entry.original_length;
+      packet->time_ms = entry.time_ms;
+      return true;
+    }
+    return false;
+  }
+
+  std::map<uint32_t, size_t> PacketsPerSsrc() const override {
+    std::map<uint32_t, size_t> packets_per_ssrc;
+    for (const auto& ssrc_packets : packets_by_ssrc_) {
+      size_t num_rtp = 0;
+      for (uint32_t index : ssrc_packets.second) {
+        if (!packets_[index].rtcp)
+          ++num_rtp;
+      }
+      if (num_rtp > 0)
+        packets_per_ssrc[ssrc_packets.first] = num_rtp;
     }
+    return packets_per_ssrc;
+  }
+
+  void SetFilter(const RtpFileFilter& filter) override {
+    filter_ = filter;
+    // Filtering on SSRC picks the packets from the per-SSRC index, rather
+    // than walking the index of the whole file.
+    selected_.clear();
+    for (uint32_t ssrc : filter_.ssrcs) {
+      auto it = packets_by_ssrc_.find(ssrc);
+      if (it != packets_by_ssrc_.end())
+        selected_.insert(selected_.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(selected_.begin(), selected_.end());
+    next_ = 0;
+  }
+
+  void SeekToTime(uint32_t time_ms) override {
+    next_ = 0;
+    while (next_ < NumSelected() && Selected(next_).time_ms < time_ms)
+      ++next_;
+  }
+
+ protected:
+  // Adds the packet of |length| bytes at |pos| in |file_| to the index.
+  void AddPacket(size_t pos,
+                 uint32_t length,
+                 uint32_t original_length,
+                 uint32_t time_ms) {
+    RTC_DCHECK_LE(pos + length, file_.size());
+    PacketEntry entry;
+    entry.pos = pos;
+    entry.length = length;
+    entry.original_length = original_length;
+    entry.time_ms = time_ms;
+    const uint8_t* data = file_.data() + pos;
+    RtpUtility::RtpHeaderParser rtp_parser(data, length);
+    entry.rtcp = rtp_parser.RTCP();
+    // The sender SSRC of RTCP, and the SSRC of RTP.
+    size_t ssrc_offset = entry.rtcp ? 4 : 8;
+    if (length >= ssrc_offset + 4) {
+      entry.ssrc = ByteReader<uint32_t>::ReadBigEndian(data + ssrc_offset);
+      packets_by_ssrc_[entry.ssrc].push_back(
+          static_cast<uint32_t>(packets_.size()));
+    }
+    entry.payload_type = length >= 2 ? (data[1] & 0x7f) : 0;
+    packets_.push_back(entry);
+  }
+
+  size_t num_packets() const { return packets_.size(); }
+
+  // The payload type of the first RTP packet of |ssrc|.
+  int PayloadType(uint32_t ssrc) const {
+    auto it = packets_by_ssrc_.find(ssrc);
+    if (it == packets_by_ssrc_.end())
+      return -1;
+    for (uint32_t index : it->second) {
+      if (!packets_[index].rtcp)
+        return packets_[index].payload_type;
+    }
+    return -1;
+  }
+
+  MappedFile file_;
+
+ private:
+  struct PacketEntry {
+    size_t pos = 0;  // Byte offset of the packet from start of file.
+    uint32_t length = 0;
+    uint32_t original_length = 0;
+    uint32_t time_ms = 0;
+    uint32_t ssrc = 0;
+    uint8_t payload_type = 0;
+    bool rtcp = false;
+  };
+
+  // Without an SSRC filter all packets are candidates, otherwise those in
+  // |selected_|.
+  size_t NumSelected() const {
+    return filter_.ssrcs.empty() ? packets_.size() : selected_.size();
+  }
+  const PacketEntry& Selected(size_t i) const {
+    return filter_.ssrcs.empty() ? packets_[i] : packets_[selected_[i]];
   }
 
+  bool IsSelected(const PacketEntry& entry) const {
+    return (entry.rtcp ? filter_.rtcp : filter_.rtp) &&
+           entry.time_ms >= filter_.start_time_ms &&
+           entry.time_ms < filter_.end_time_ms;
+  }
+
+  std::vector<PacketEntry> packets_;
+  // Indices into |packets_| of the RTP and RTCP packets of each SSRC.
+  std::map<uint32_t, std::vector<uint32_t>> packets_by_ssrc_;
+  RtpFileFilter filter_;
+  std::vector<uint32_t> selected_;
+  size_t next_ = 0;
+};
+
+class InterleavedRtpFileReader : public RtpFileReaderImpl {
+ public:
   virtual bool Init(const std::string& filename,
                     const std::set<uint32_t>& ssrc_filter) {
-    file_ = fopen(filename.c_str(), "rb");
-    if (file_ == NULL) {
+    if (!file_.Open(filename)) {
       printf("ERROR: Can't open file: %s\n", filename.c_str());
       return false;
     }
-    return true;
-  }
-  virtual bool NextPacket(RtpPacket* packet) {
-    assert(file_ != NULL);
-    packet->length = RtpPacket::kMaxPacketBufferSize;
+    uint32_t time_ms = 0;
     uint32_t len = 0;
-    TRY(ReadUint32(&len, file_));
-    if (packet->length < len) {
-      FATAL() << "Packet is too large to fit: " << len << " bytes vs "
-              << packet->length
-              << " bytes allocated. Consider increasing the buffer "
-                 "size";
+    while (ReadUint32(&len, &file_)) {
+      if (RtpPacket::kMaxPacketBufferSize < len) {
+        FATAL() << "Packet is too large to fit: " << len << " bytes vs "
+                << RtpPacket::kMaxPacketBufferSize
+                << " bytes allocated. Consider increasing the buffer "
+                   "size";
+      }
+      size_t pos = file_.Tell();
+      if (!file_.Skip(len))
+        break;
+      AddPacket(pos, len, len, time_ms);
+      time_ms += 5;
     }
-    if (fread(packet->data, 1, len, file_) != len)
-      return false;
-
-    packet->length = len;
-    packet->original_length = len;
-    packet->time_ms = time_ms_;
-    time_ms_ += 5;
     return true;
   }
-
- private:
-  FILE* file_ = NULL;
-  int64_t time_ms_ = 0;
 };
 
 // Read RTP packets from file in rtpdump format, as documented at:
 // http://www.cs.columbia.edu/irt/software/rtptools/
 class RtpDumpReader : public RtpFileReaderImpl {
  public:
-  RtpDumpReader() : file_(NULL) {}
-  virtual ~RtpDumpReader() {
-    if (file_ != NULL) {
-      fclose(file_);
-      file_ = NULL;
-    }
-  }
+  RtpDumpReader() {}
 
   bool Init(const std::string& filename,
             const std::set<uint32_t>& ssrc_filter) override {
-    file_ = fopen(filename.c_str(), "rb");
-    if (file_ == NULL) {
+    if (!file_.Open(filename)) {
       printf("ERROR: Can't open file: %s\n", filename.c_str());
       return false;
     }
 
     char firstline[kFirstLineLength + 1] = {0};
-    if (fgets(firstline, kFirstLineLength, file_) == NULL) {
+    if (!file_.ReadLine(firstline, kFirstLineLength)) {
       RTC_LOG(LS_INFO) << "Can't read from file";
       return false;
     }
@@ -155,47 +368,42 @@ class RtpDumpReader : public RtpFileReaderImpl {
     uint32_t source;
     uint16_t port;
     uint16_t padding;
-    TRY(ReadUint32(&start_sec, file_));
-    TRY(ReadUint32(&start_usec, file_));
-    TRY(ReadUint32(&source, file_));
-    TRY(ReadUint16(&port, file_));
-    TRY(ReadUint16(&padding, file_));
+    TRY(ReadUint32(&start_sec, &file_));
+    TRY(ReadUint32(&start_usec, &file_));
+    TRY(ReadUint32(&source, &file_));
+    TRY(ReadUint16(&port, &file_));
+    TRY(ReadUint16(&padding, &file_));
 
+    while (ReadPacket()) {
+    }
     return true;
   }
 
-  bool NextPacket(RtpPacket* packet) override {
-    uint8_t* rtp_data = packet->data;
-    packet->length = RtpPacket::kMaxPacketBufferSize;
-
+ private:
+  bool ReadPacket() {
     uint16_t len;
     uint16_t plen;
     uint32_t offset;
-    TRY(ReadUint16(&len, file_));
-    TRY(ReadUint16(&plen, file_));
-    TRY(ReadUint32(&offset, file_));
+    TRY(ReadUint16(&len, &file_));
+    TRY(ReadUint16(&plen, &file_));
+    TRY(ReadUint32(&offset, &file_));
 
     // Use 'len' here because a 'plen' of 0 specifies rtcp.
     len -= kPacketHeaderSize;
-    if (packet->length < len) {
+    if (RtpPacket::kMaxPacketBufferSize < len) {
       FATAL() << "Packet is too large to fit: " << len << " bytes vs "
-              << packet->length
+              << RtpPacket::kMaxPacketBufferSize
               << " bytes allocated. Consider increasing the buffer "
                  "size";
     }
-    if (fread(rtp_data, 1, len, file_) != len) {
+    size_t pos = file_.Tell();
+    if (!file_.Skip(len))
       return false;
-    }
 
-    packet->length = len;
-    packet->original_length = plen;
-    packet->time_ms = offset;
+    AddPacket(pos, len, plen, offset);
     return true;
   }
 
- private:
-  FILE* file_;
-
   RTC_DISALLOW_COPY_AND_ASSIGN(RtpDumpReader);
 };
 
@@ -241,24 +449,13 @@ const uint32_t kPcapBOMNoSwapOrder = 0xa1b2c3d4UL;
 class PcapReader : public RtpFileReaderImpl {
  public:
   PcapReader()
-      : file_(NULL),
-        swap_pcap_byte_order_(false),
+      : swap_pcap_byte_order_(false),
 #ifdef WEBRTC_ARCH_BIG_ENDIAN
         swap_network_byte_order_(false),
 #else
         swap_network_byte_order_(true),
 #endif
-        read_buffer_(),
-        packets_by_ssrc_(),
-        packets_(),
-        next_packet_it_() {
-  }
-
-  virtual ~PcapReader() {
-    if (file_ != NULL) {
-      fclose(file_);
-      file_ = NULL;
-    }
+        stream_start_ms_(0) {
   }
 
   bool Init(const std::string& filename,
@@ -268,8 +465,7 @@ class PcapReader : public RtpFileReaderImpl {
 
   int Initialize(const std::string& filename,
                  const std::set<uint32_t>& ssrc_filter) {
-    file_ = fopen(filename.c_str(), "rb");
-    if (file_ == NULL) {
+    if (!file_.Open(filename)) {
       printf("ERROR: Can't open file: %s\n", filename.c_str());
       return kResultFail;
     }
@@ -279,37 +475,28 @@ class PcapReader : public RtpFileReaderImpl {
     }
 
     int total_packet_count = 0;
-    uint32_t stream_start_ms = 0;
-    int32_t next_packet_pos = ftell(file_);
+    size_t next_packet_pos = file_.Tell();
     for (;;) {
-      TRY_PCAP(fseek(file_, next_packet_pos, SEEK_SET));
-      int result = ReadPacket(&next_packet_pos, stream_start_ms,
-                              ++total_packet_count, ssrc_filter);
-      if (result == kResultFail) {
+      if (!file_.Seek(next_packet_pos))
+        break;
+      int result =
+          ReadPacket(&next_packet_pos, ++total_packet_count, ssrc_filter);
+      if (result == kResultFail)
         break;
-      } else if (result == kResultSuccess && packets_.size() == 1) {
-        assert(stream_start_ms == 0);
-        PacketIterator it = packets_.begin();
-        stream_start_ms = it->time_offset_ms;
-        it->time_offset_ms = 0;
-      }
     }
 
-    if (feof(file_) == 0) {
+    if (!file_.AtEnd()) {
       printf("Failed reading file!\n");
       return kResultFail;
     }
 
     printf("Total packets in file: %d\n", total_packet_count);
-    printf("Total RTP/RTCP packets: %" PRIuS "\n", packets_.size());
+    printf("Total RTP/RTCP packets: %" PRIuS "\n", num_packets());
 
-    for (SsrcMapIterator mit = packets_by_ssrc_.begin();
-         mit != packets_by_ssrc_.end(); ++mit) {
-      uint32_t ssrc = mit->first;
-      const std::vector<uint32_t>& packet_indices = mit->second;
-      uint8_t pt = packets_[packet_indices[0]].rtp_header.payloadType;
+    for (const auto& ssrc_packets : PacketsPerSsrc()) {
+      uint32_t ssrc = ssrc_packets.first;
       printf("SSRC: %08x, %" PRIuS " packets, pt=%d\n", ssrc,
-             packet_indices.size(), pt);
+             ssrc_packets.second, PayloadType(ssrc));
     }
 
     // TODO(solenberg): Better validation of identified SSRC streams.
@@ -328,57 +515,20 @@ class PcapReader : public RtpFileReaderImpl {
     // - Can also use srcip:port->dstip:port pairs, assuming few SSRC collisions
     //   for up/down streams.
 
-    next_packet_it_ = packets_.begin();
     return kResultSuccess;
   }
 
-  bool NextPacket(RtpPacket* packet) override {
-    uint32_t length = RtpPacket::kMaxPacketBufferSize;
-    if (NextPcap(packet->data, &length, &packet->time_ms) != kResultSuccess)
-      return false;
-    packet->length = static_cast<size_t>(length);
-    packet->original_length = packet->length;
-    return true;
-  }
-
-  virtual int NextPcap(uint8_t* data, uint32_t* length, uint32_t* time_ms) {
-    assert(data);
-    assert(length);
-    assert(time_ms);
-
-    if (next_packet_it_ == packets_.end()) {
-      return -1;
-    }
-    if (*length < next_packet_it_->payload_length) {
-      return -1;
-    }
-    TRY_PCAP(fseek(file_, next_packet_it_->pos_in_file, SEEK_SET));
-    TRY_PCAP(Read(data, next_packet_it_->payload_length));
-    *length = next_packet_it_->payload_length;
-    *time_ms = next_packet_it_->time_offset_ms;
-    next_packet_it_++;
-
-    return 0;
-  }
-
  private:
   // A marker of an RTP packet within the file.
   struct RtpPacketMarker {
     uint32_t packet_number;  // One-based index (like in WireShark)
-    uint32_t time_offset_ms;
     uint32_t source_ip;
     uint32_t dest_ip;
     uint16_t source_port;
     uint16_t dest_port;
-    RTPHeader rtp_header;
-    int32_t pos_in_file;  // Byte offset of payload from start of file.
     uint32_t payload_length;
   };
 
-  typedef std::vector<RtpPacketMarker>::iterator PacketIterator;
-  typedef std::map<uint32_t, std::vector<uint32_t> > SsrcMap;
-  typedef std::map<uint32_t, std::vector<uint32_t> >::iterator SsrcMapIterator;
-
   int ReadGlobalHeader() {
     uint32_t magic;
     TRY_PCAP(Read(&magic, false));
@@ -417,8 +567,7 @@ class PcapReader : public RtpFileReaderImpl {
     return kResultSuccess;
   }
 
-  int ReadPacket(int32_t* next_packet_pos,
-                 uint32_t stream_start_ms,
+  int ReadPacket(size_t* next_packet_pos,
                  uint32_t number,
                  const std::set<uint32_t>& ssrc_filter) {
     assert(next_packet_pos);
@@ -432,45 +581,44 @@ class PcapReader : public RtpFileReaderImpl {
     TRY_PCAP(Read(&incl_len, false));
     TRY_PCAP(Read(&orig_len, false));
 
-    *next_packet_pos = ftell(file_) + incl_len;
+    *next_packet_pos = file_.Tell() + incl_len;
 
     RtpPacketMarker marker = {0};
     marker.packet_number = number;
-    marker.time_offset_ms = CalcTimeDelta(ts_sec, ts_usec, stream_start_ms);
     TRY_PCAP(ReadPacketHeader(&marker));
-    marker.pos_in_file = ftell(file_);
+    size_t pos_in_file = file_.Tell();
 
-    if (marker.payload_length > sizeof(read_buffer_)) {
+    if (marker.payload_length > kMaxReadBufferSize) {
       printf("Packet too large!\n");
       return kResultFail;
     }
-    TRY_PCAP(Read(read_buffer_, marker.payload_length));
+    TRY_PCAP(Skip(marker.payload_length));
 
-    RtpUtility::RtpHeaderParser rtp_parser(read_buffer_, marker.payload_length);
-    if (rtp_parser.RTCP()) {
-      rtp_parser.ParseRtcp(&marker.rtp_header);
-      packets_.push_back(marker);
-    } else {
-      if (!rtp_parser.Parse(&marker.rtp_header, nullptr)) {
+    // The packet is parsed in place, in the mapped file.
+    RtpUtility::RtpHeaderParser rtp_parser(file_.data() + pos_in_file,
+                                           marker.payload_length);
+    if (!rtp_parser.RTCP()) {
+      RTPHeader rtp_header;
+      if (!rtp_parser.Parse(&rtp_header, nullptr)) {
         RTC_LOG(LS_INFO) << "Not recognized as RTP/RTCP";
         return kResultSkip;
       }
 
-      uint32_t ssrc = marker.rtp_header.ssrc;
-      if (ssrc_filter.empty() || ssrc_filter.find(ssrc) != ssrc_filter.end()) {
-        packets_by_ssrc_[ssrc].push_back(
-            static_cast<uint32_t>(packets_.size()));
-        packets_.push_back(marker);
-      } else {
+      uint32_t ssrc = rtp_header.ssrc;
+      if (!ssrc_filter.empty() && ssrc_filter.find(ssrc) == ssrc_filter.end())
         return kResultSkip;
-      }
     }
 
+    // Times are relative to the first packet in the index.
+    if (num_packets() == 0)
+      stream_start_ms_ = CalcTimeMs(ts_sec, ts_usec);
+    AddPacket(pos_in_file, marker.payload_length, marker.payload_length,
+              CalcTimeDelta(ts_sec, ts_usec, stream_start_ms_));
     return kResultSuccess;
   }
 
   int ReadPacketHeader(RtpPacketMarker* marker) {
-    int32_t file_pos = ftell(file_);
+    size_t file_pos = file_.Tell();
 
     // Check for BSD null/loopback frame header. The header is just 4 bytes in
     // native byte order, so we check for both versions as we don't care about
@@ -486,7 +634,8 @@ class PcapReader : public RtpFileReaderImpl {
       }
     }
 
-    TRY_PCAP(fseek(file_, file_pos, SEEK_SET));
+    if (!file_.Seek(file_pos))
+      return kResultFail;
 
     // Check for Ethernet II, IP frame header.
     uint16_t type;
@@ -503,15 +652,17 @@ class PcapReader : public RtpFileReaderImpl {
     return kResultSkip;
   }
 
-  uint32_t CalcTimeDelta(uint32_t ts_sec, uint32_t ts_usec, uint32_t start_ms) {
+  uint64_t CalcTimeMs(uint32_t ts_sec, uint32_t ts_usec) {
     // Round to nearest ms.
-    uint64_t t2_ms =
-        ((static_cast<uint64_t>(ts_sec) * 1000000) + ts_usec + 500) / 1000;
-    uint64_t t1_ms = static_cast<uint64_t>(start_ms);
-    if (t2_ms < t1_ms) {
+    return ((static_cast<uint64_t>(ts_sec) * 1000000) + ts_usec + 500) / 1000;
+  }
+
+  uint32_t CalcTimeDelta(uint32_t ts_sec, uint32_t ts_usec, uint64_t start_ms) {
+    uint64_t t2_ms = CalcTimeMs(ts_sec, ts_usec);
+    if (t2_ms < start_ms) {
       return 0;
     } else {
-      return t2_ms - t1_ms;
+      return static_cast<uint32_t>(t2_ms - start_ms);
     }
   }
 
@@ -571,7 +722,7 @@ class PcapReader : public RtpFileReaderImpl {
 
   int Read(uint32_t* out, bool expect_network_order) {
     uint32_t tmp = 0;
-    if (fread(&tmp, 1, sizeof(uint32_t), file_) != sizeof(uint32_t)) {
+    if (!file_.Read(&tmp, sizeof(uint32_t))) {
       return kResultFail;
     }
     if ((!expect_network_order && swap_pcap_byte_order_) ||
@@ -585,7 +736,7 @@ class PcapReader : public RtpFileReaderImpl {
 
   int Read(uint16_t* out, bool expect_network_order) {
     uint16_t tmp = 0;
-    if (fread(&tmp, 1, sizeof(uint16_t), file_) != sizeof(uint16_t)) {
+    if (!file_.Read(&tmp, sizeof(uint16_t))) {
       return kResultFail;
     }
     if ((!expect_network_order && swap_pcap_byte_order_) ||
@@ -596,16 +747,9 @@ class PcapReader : public RtpFileReaderImpl {
     return kResultSuccess;
   }
 
-  int Read(uint8_t* out, uint32_t count) {
-    if (fread(out, 1, count, file_) != count) {
-      return kResultFail;
-    }
-    return kResultSuccess;
-  }
-
   int Read(int32_t* out, bool expect_network_order) {
     int32_t tmp = 0;
-    if (fread(&tmp, 1, sizeof(uint32_t), file_) != sizeof(uint32_t)) {
+    if (!file_.Read(&tmp, sizeof(uint32_t))) {
       return kResultFail;
     }
     if ((!expect_network_order && swap_pcap_byte_order_) ||
@@ -618,24 +762,24 @@ class PcapReader : public RtpFileReaderImpl {
   }
 
   int Skip(uint32_t length) {
-    if (fseek(file_, length, SEEK_CUR) != 0) {
+    if (!file_.Skip(length)) {
       return kResultFail;
     }
     return kResultSuccess;
   }
 
-  FILE* file_;
   bool swap_pcap_byte_order_;
   const bool swap_network_byte_order_;
-  uint8_t read_buffer_[kMaxReadBufferSize];
-
-  SsrcMap packets_by_ssrc_;
-  std::vector<RtpPacketMarker> packets_;
-  PacketIterator next_packet_it_;
+  uint64_t stream_start_ms_;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(PcapReader);
 };
 
+RtpFileFilter::RtpFileFilter() = default;
+RtpFileFilter::RtpFileFilter(const RtpFileFilter&) = default;
+RtpFileFilter::~RtpFileFilter() = default;
+RtpFileFilter& RtpFileFilter::operator=(const RtpFileFilter&) = default;
+
 RtpFileReader* RtpFileReader::Create(FileFormat format,
                                      const std::string& filename,
                                      const std::set<uint32_t>& ssrc_filter) {
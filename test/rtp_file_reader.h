@@ -10,6 +10,8 @@
 #ifndef TEST_RTP_FILE_READER_H_
 #define TEST_RTP_FILE_READER_H_
 
+#include <limits>
+#include <map>
 #include <set>
 #include <string>
 
@@ -31,6 +33,25 @@ struct RtpPacket {
   uint32_t time_ms;
 };
 
+// Selects the packets returned by an RtpFileReader. Readers index the file
+// when it is opened, so the packets a filter leaves out are skipped without
+// being read.
+struct RtpFileFilter {
+  RtpFileFilter();
+  RtpFileFilter(const RtpFileFilter&);
+  ~RtpFileFilter();
+  RtpFileFilter& operator=(const RtpFileFilter&);
+
+  // If not empty, only packets of these SSRCs are returned. The SSRC of an
+  // RTCP packet is the SSRC of its sender.
+  std::set<uint32_t> ssrcs;
+  bool rtp = true;
+  bool rtcp = true;
+  // Only packets recorded in [start_time_ms, end_time_ms) are returned.
+  uint32_t start_time_ms = 0;
+  uint32_t end_time_ms = std::numeric_limits<uint32_t>::max();
+};
+
 class RtpFileReader {
  public:
   enum FileFormat { kPcap, kRtpDump, kLengthPacketInterleaved };
@@ -42,6 +63,17 @@ class RtpFileReader {
                                const std::set<uint32_t>& ssrc_filter);
 
   virtual bool NextPacket(RtpPacket* packet) = 0;
+
+  // Returns the number of RTP packets of each SSRC in the file.
+  virtual std::map<uint32_t, size_t> PacketsPerSsrc() const = 0;
+
+  // Restarts reading from the beginning of the file, returning only the
+  // packets selected by |filter| from then on.
+  virtual void SetFilter(const RtpFileFilter& filter) = 0;
+
+  // Continues reading from the first of the selected packets that was
+  // recorded at or after |time_ms|.
+  virtual void SeekToTime(uint32_t time_ms) = 0;
 };
 }  // namespace test
 }  // namespace webrtc
@@ -8,12 +8,16 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
 #include <map>
 #include <memory>
 
+#include "modules/rtp_rtcp/source/byte_io.h"
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "test/gtest.h"
 #include "test/rtp_file_reader.h"
+#include "test/rtp_file_writer.h"
 #include "test/testsupport/fileutils.h"
 
 namespace webrtc {
@@ -93,6 +97,8 @@ class TestPcapFileReader : public ::testing::Test {
     return pps;
   }
 
+  test::RtpFileReader* rtp_packet_source() { return rtp_packet_source_.get(); }
+
  private:
   std::unique_ptr<test::RtpFileReader> rtp_packet_source_;
 };
@@ -123,4 +129,141 @@ TEST_F(TestPcapFileReader, TestThreeSsrc) {
   EXPECT_EQ(113, pps[0x59fe6ef0]);
   EXPECT_EQ(61, pps[0xed2bd2ac]);
 }
+
+TEST_F(TestPcapFileReader, TestIndexAndFilterSsrc) {
+  Init("ssrcs-3");
+  std::map<uint32_t, size_t> indexed = rtp_packet_source()->PacketsPerSsrc();
+  EXPECT_EQ(3UL, indexed.size());
+  EXPECT_EQ(162UL, indexed[0x938c5eaa]);
+
+  test::RtpFileFilter filter;
+  filter.ssrcs = {0x59fe6ef0};
+  filter.rtcp = false;
+  rtp_packet_source()->SetFilter(filter);
+  PacketsPerSsrc pps = CountRtpPacketsPerSsrc();
+  EXPECT_EQ(1UL, pps.size());
+  EXPECT_EQ(113, pps[0x59fe6ef0]);
+}
+
+namespace {
+const uint32_t kSsrc1 = 0x1111;
+const uint32_t kSsrc2 = 0x2222;
+const int kNumPackets = 300;
+}  // namespace
+
+// Writes an RTP dump with two interleaved RTP streams and some RTCP.
+class TestIndexedRtpFileReader : public ::testing::Test {
+ public:
+  void SetUp() override {
+    filename_ = test::OutputPath() + "test_indexed_rtp_file_reader.rtp";
+    std::unique_ptr<test::RtpFileWriter> writer(
+        test::RtpFileWriter::Create(test::RtpFileWriter::kRtpDump, filename_));
+    ASSERT_TRUE(writer);
+    test::RtpPacket packet;
+    for (int i = 0; i < kNumPackets; ++i) {
+      memset(packet.data, 0, sizeof(packet.data));
+      if (i % 10 == 9) {
+        // Receiver report from kSsrc1.
+        packet.data[0] = 0x80;
+        packet.data[1] = 201;
+        packet.length = 8;
+        packet.original_length = 0;
+        ByteWriter<uint32_t>::WriteBigEndian(&packet.data[4], kSsrc1);
+      } else {
+        packet.data[0] = 0x80;
+        packet.data[1] = 96;
+        packet.length = 100;
+        packet.original_length = packet.length;
+        ByteWriter<uint32_t>::WriteBigEndian(&packet.data[8],
+                                             i % 2 ? kSsrc2 : kSsrc1);
+      }
+      packet.time_ms = i * 10;
+      ASSERT_TRUE(writer->WritePacket(&packet));
+    }
+  }
+
+  std::unique_ptr<test::RtpFileReader> CreateReader() {
+    return std::unique_ptr<test::RtpFileReader>(
+        test::RtpFileReader::Create(test::RtpFileReader::kRtpDump, filename_));
+  }
+
+  static int CountPackets(test::RtpFileReader* reader) {
+    test::RtpPacket packet;
+    int c = 0;
+    while (reader->NextPacket(&packet))
+      c++;
+    return c;
+  }
+
+ private:
+  std::string filename_;
+};
+
+TEST_F(TestIndexedRtpFileReader, CountsPacketsPerSsrc) {
+  std::unique_ptr<test::RtpFileReader> reader = CreateReader();
+  ASSERT_TRUE(reader);
+  std::map<uint32_t, size_t> pps = reader->PacketsPerSsrc();
+  EXPECT_EQ(2UL, pps.size());
+  EXPECT_EQ(150UL, pps[kSsrc1]);
+  EXPECT_EQ(120UL, pps[kSsrc2]);
+  EXPECT_EQ(kNumPackets, CountPackets(reader.get()));
+}
+
+TEST_F(TestIndexedRtpFileReader, FiltersOnSsrcAndType) {
+  std::unique_ptr<test::RtpFileReader> reader = CreateReader();
+  ASSERT_TRUE(reader);
+  test::RtpFileFilter filter;
+  filter.ssrcs = {kSsrc1};
+  reader->SetFilter(filter);
+  // The RTCP is sent by kSsrc1.
+  EXPECT_EQ(150 + 30, CountPackets(reader.get()));
+
+  filter.rtcp = false;
+  reader->SetFilter(filter);
+  test::RtpPacket packet;
+  int c = 0;
+  while (reader->NextPacket(&packet)) {
+    EXPECT_EQ(kSsrc1, ByteReader<uint32_t>::ReadBigEndian(&packet.data[8]));
+    c++;
+  }
+  EXPECT_EQ(150, c);
+
+  filter.ssrcs.clear();
+  filter.rtp = false;
+  filter.rtcp = true;
+  reader->SetFilter(filter);
+  EXPECT_EQ(30, CountPackets(reader.get()));
+}
+
+TEST_F(TestIndexedRtpFileReader, FiltersOnTime) {
+  std::unique_ptr<test::RtpFileReader> reader = CreateReader();
+  ASSERT_TRUE(reader);
+  test::RtpFileFilter filter;
+  filter.start_time_ms = 1000;
+  filter.end_time_ms = 2000;
+  reader->SetFilter(filter);
+  test::RtpPacket packet;
+  ASSERT_TRUE(reader->NextPacket(&packet));
+  EXPECT_EQ(1000u, packet.time_ms);
+  EXPECT_EQ(100, 1 + CountPackets(reader.get()));
+}
+
+TEST_F(TestIndexedRtpFileReader, SeeksToTime) {
+  std::unique_ptr<test::RtpFileReader> reader = CreateReader();
+  ASSERT_TRUE(reader);
+  test::RtpPacket packet;
+  reader->SeekToTime(2505);
+  ASSERT_TRUE(reader->NextPacket(&packet));
+  EXPECT_EQ(2510u, packet.time_ms);
+
+  // Seeking back is allowed as well, and stays within the filter.
+  test::RtpFileFilter filter;
+  filter.ssrcs = {kSsrc2};
+  filter.rtcp = false;
+  reader->SetFilter(filter);
+  reader->SeekToTime(100);
+  ASSERT_TRUE(reader->NextPacket(&packet));
+  EXPECT_EQ(110u, packet.time_ms);
+  EXPECT_EQ(kSsrc2, ByteReader<uint32_t>::ReadBigEndian(&packet.data[8]));
+}
 }  // namespace webrtc
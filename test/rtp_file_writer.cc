@@ -11,6 +11,7 @@
 #include "test/rtp_file_writer.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include <string>
 
@@ -22,6 +23,8 @@ namespace test {
 
 static const uint16_t kPacketHeaderSize = 8;
 static const char kFirstLine[] = "#!rtpplay1.0 0.0.0.0/0\n";
+// Large enough that writing a dump takes few write() calls.
+static const size_t kWriteBufferSize = 1 << 20;
 
 // Write RTP packets to file in rtpdump format, as documented at:
 // http://www.cs.columbia.edu/irt/software/rtptools/
@@ -29,6 +32,7 @@ class RtpDumpWriter : public RtpFileWriter {
  public:
   explicit RtpDumpWriter(FILE* file) : file_(file) {
     RTC_CHECK(file_ != NULL);
+    setvbuf(file_, NULL, _IOFBF, kWriteBufferSize);
     Init();
   }
   virtual ~RtpDumpWriter() {
@@ -39,14 +43,17 @@ class RtpDumpWriter : public RtpFileWriter {
   }
 
   bool WritePacket(const RtpPacket* packet) override {
+    RTC_DCHECK_LE(packet->length, RtpPacket::kMaxPacketBufferSize);
     uint16_t len = static_cast<uint16_t>(packet->length + kPacketHeaderSize);
     uint16_t plen = static_cast<uint16_t>(packet->original_length);
     uint32_t offset = packet->time_ms;
-    RTC_CHECK(WriteUint16(len));
-    RTC_CHECK(WriteUint16(plen));
-    RTC_CHECK(WriteUint32(offset));
-    return fwrite(packet->data, sizeof(uint8_t), packet->length, file_) ==
-           packet->length;
+    // The record is put together first, so that it is written in one call.
+    uint8_t* record = record_;
+    record = PutUint16(record, len);
+    record = PutUint16(record, plen);
+    record = PutUint32(record, offset);
+    memcpy(record, packet->data, packet->length);
+    return fwrite(record_, sizeof(uint8_t), len, file_) == len;
   }
 
  private:
@@ -62,6 +69,17 @@ class RtpDumpWriter : public RtpFileWriter {
     return true;
   }
 
+  static uint8_t* PutUint32(uint8_t* out, uint32_t in) {
+    out = PutUint16(out, static_cast<uint16_t>(in >> 16));
+    return PutUint16(out, static_cast<uint16_t>(in & 0xFFFF));
+  }
+
+  static uint8_t* PutUint16(uint8_t* out, uint16_t in) {
+    out[0] = static_cast<uint8_t>((in >> 8) & 0xFF);
+    out[1] = static_cast<uint8_t>(in & 0xFF);
+    return out + 2;
+  }
+
   bool WriteUint32(uint32_t in) {
     // Loop through shifts = {24, 16, 8, 0}.
     for (int shifts = 24; shifts >= 0; shifts -= 8) {
@@ -85,6 +103,7 @@ class RtpDumpWriter : public RtpFileWriter {
   }
 
   FILE* file_;
+  uint8_t record_[kPacketHeaderSize + RtpPacket::kMaxPacketBufferSize];
 
   RTC_DISALLOW_COPY_AND_ASSIGN(RtpDumpWriter);
 };
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/encoder_cpu_budget.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/logging.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
+
+namespace webrtc {
+
+namespace {
+
+const char kFieldTrial[] = "WebRTC-EncoderCpuBudget";
+
+// Share of the cores the encoders may keep busy together, leaving the rest for
+// capture, packetization and the network.
+const double kDefaultCoreShare = 0.8;
+
+// Stepping up one resolution step raises the pixel count, and so roughly the
+// encode usage, by up to 5/3.
+const double kAdaptUpUsageGrowth = 0.7;
+
+EncoderCpuBudget* CreateFromFieldTrial() {
+  FieldTrialFlag enabled("Enabled");
+  FieldTrialOptional<int> cores("cores");
+  FieldTrialParameter<double> core_share("core_share", kDefaultCoreShare);
+  ParseFieldTrial({&enabled, &cores, &core_share},
+                  field_trial::FindFullName(kFieldTrial));
+  if (!enabled.Get())
+    return nullptr;
+
+  int num_cores = cores.Get().value_or(CpuInfo::DetectNumberOfCores());
+  if (num_cores <= 0 || core_share.Get() <= 0 || core_share.Get() > 1) {
+    RTC_LOG(LS_WARNING) << "Invalid " << kFieldTrial << " parameters, cores "
+                        << num_cores << " core_share " << core_share.Get();
+    return nullptr;
+  }
+  int budget_percent = static_cast<int>(num_cores * core_share.Get() * 100);
+  RTC_LOG(LS_INFO) << "Encoder CPU budget " << budget_percent << "% on "
+                   << num_cores << " cores.";
+  return new EncoderCpuBudget(budget_percent);
+}
+
+}  // namespace
+
+EncoderCpuBudget::EncoderCpuBudget(int budget_percent)
+    : budget_percent_(budget_percent), next_stream_id_(0) {
+  RTC_DCHECK_GT(budget_percent_, 0);
+}
+
+EncoderCpuBudget::~EncoderCpuBudget() = default;
+
+EncoderCpuBudget* EncoderCpuBudget::GetShared() {
+  // Read once, the streams of the process must agree on the budget.
+  static EncoderCpuBudget* const budget = CreateFromFieldTrial();
+  return budget;
+}
+
+int EncoderCpuBudget::AddStream(double priority) {
+  rtc::CritScope cs(&crit_);
+  int stream_id = next_stream_id_++;
+  streams_[stream_id] = Stream{priority, 0};
+  return stream_id;
+}
+
+void EncoderCpuBudget::RemoveStream(int stream_id) {
+  rtc::CritScope cs(&crit_);
+  RTC_DCHECK(streams_.find(stream_id) != streams_.end());
+  streams_.erase(stream_id);
+}
+
+void EncoderCpuBudget::SetPriority(int stream_id, double priority) {
+  rtc::CritScope cs(&crit_);
+  auto it = streams_.find(stream_id);
+  RTC_DCHECK(it != streams_.end());
+  it->second.priority = priority;
+}
+
+EncoderCpuBudget::Allocation EncoderCpuBudget::OnEncodeUsage(
+    int stream_id,
+    int encode_usage_percent) {
+  rtc::CritScope cs(&crit_);
+  auto it = streams_.find(stream_id);
+  RTC_DCHECK(it != streams_.end());
+  it->second.encode_usage_percent = std::max(0, encode_usage_percent);
+
+  // Serve the streams by decreasing priority, the oldest first when equal.
+  std::vector<std::pair<int, const Stream*>> ordered;
+  ordered.reserve(streams_.size());
+  int total_usage_percent = 0;
+  for (const auto& kv : streams_) {
+    ordered.emplace_back(kv.first, &kv.second);
+    total_usage_percent += kv.second.encode_usage_percent;
+  }
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [](const std::pair<int, const Stream*>& a,
+                      const std::pair<int, const Stream*>& b) {
+                     return a.second->priority > b.second->priority;
+                   });
+
+  int used_percent = 0;
+  double reserved_percent = 0;
+  for (const auto& stream : ordered) {
+    used_percent += stream.second->encode_usage_percent;
+    reserved_percent +=
+        stream.second->encode_usage_percent * kAdaptUpUsageGrowth;
+    if (stream.first != stream_id)
+      continue;
+    if (used_percent > budget_percent_)
+      return Allocation::kOverBudget;
+    // Leave the headroom to the streams before this one first.
+    if (total_usage_percent + reserved_percent <= budget_percent_)
+      return Allocation::kMayAdaptUp;
+    return Allocation::kWithinBudget;
+  }
+  RTC_NOTREACHED();
+  return Allocation::kWithinBudget;
+}
+
+}  // namespace webrtc
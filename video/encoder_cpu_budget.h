@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_ENCODER_CPU_BUDGET_H_
+#define VIDEO_ENCODER_CPU_BUDGET_H_
+
+#include <map>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Shares the CPU available for encoding between all the send streams of the
+// process, so that a host running many encoders degrades its least important
+// streams first instead of all of them together.
+//
+// Each stream reports its encode usage, in percent of the frame interval as
+// measured by OveruseFrameDetector, which for a software encoder is roughly
+// the share of one core it keeps busy. The budget is handed out in order of
+// priority: the streams that fit in it may keep their usage, the ones that
+// don't are told to adapt down. Streams are only told that they may adapt up
+// if the headroom left after the streams before them can take the extra load.
+//
+// Thread safe, the streams report from their own encoder task queues.
+class EncoderCpuBudget {
+ public:
+  enum class Allocation {
+    // The stream doesn't fit in the budget and should reduce its usage.
+    kOverBudget,
+    // The stream fits in the budget, but shouldn't increase its usage.
+    kWithinBudget,
+    // The stream fits in the budget with room for adapting up a step.
+    kMayAdaptUp,
+  };
+
+  // |budget_percent| is the total encode usage allowed across all streams,
+  // e.g. 400 to allow for four fully used cores.
+  explicit EncoderCpuBudget(int budget_percent);
+  ~EncoderCpuBudget();
+
+  // Returns the budget shared by all streams of the process, or null if the
+  // "WebRTC-EncoderCpuBudget" field trial isn't enabled.
+  static EncoderCpuBudget* GetShared();
+
+  // Adds a stream with the given |priority|, higher values being served
+  // first. Returns an id for the other calls.
+  int AddStream(double priority);
+  void RemoveStream(int stream_id);
+  void SetPriority(int stream_id, double priority);
+
+  // Updates the encode usage of a stream and returns its share of the budget
+  // given what all streams reported last.
+  Allocation OnEncodeUsage(int stream_id, int encode_usage_percent);
+
+  int budget_percent() const { return budget_percent_; }
+
+ private:
+  struct Stream {
+    double priority;
+    int encode_usage_percent;
+  };
+
+  const int budget_percent_;
+  rtc::CriticalSection crit_;
+  int next_stream_id_ RTC_GUARDED_BY(crit_);
+  std::map<int, Stream> streams_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EncoderCpuBudget);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_ENCODER_CPU_BUDGET_H_
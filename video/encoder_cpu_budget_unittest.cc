@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/encoder_cpu_budget.h"
+
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+const int kBudgetPercent = 200;
+}  // namespace
+
+using Allocation = EncoderCpuBudget::Allocation;
+
+TEST(EncoderCpuBudgetTest, SingleStreamWithinBudget) {
+  EncoderCpuBudget budget(kBudgetPercent);
+  int stream = budget.AddStream(1.0);
+  EXPECT_EQ(Allocation::kMayAdaptUp, budget.OnEncodeUsage(stream, 50));
+  // 150% leaves no room for another 70%.
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(stream, 150));
+  EXPECT_EQ(Allocation::kOverBudget, budget.OnEncodeUsage(stream, 250));
+}
+
+TEST(EncoderCpuBudgetTest, LowestPriorityStreamsAreOverBudget) {
+  EncoderCpuBudget budget(kBudgetPercent);
+  int low = budget.AddStream(1.0);
+  int high = budget.AddStream(2.0);
+  int medium = budget.AddStream(1.5);
+  budget.OnEncodeUsage(high, 100);
+  budget.OnEncodeUsage(medium, 80);
+  EXPECT_EQ(Allocation::kOverBudget, budget.OnEncodeUsage(low, 50));
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(medium, 80));
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(high, 100));
+
+  // Raising the priority of a stream, e.g. for the active speaker, moves the
+  // overuse to the others.
+  budget.SetPriority(low, 3.0);
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(low, 50));
+  EXPECT_EQ(Allocation::kOverBudget, budget.OnEncodeUsage(medium, 80));
+}
+
+TEST(EncoderCpuBudgetTest, EqualPrioritiesServeOldestStreamFirst) {
+  EncoderCpuBudget budget(kBudgetPercent);
+  int first = budget.AddStream(1.0);
+  int second = budget.AddStream(1.0);
+  budget.OnEncodeUsage(first, 150);
+  EXPECT_EQ(Allocation::kOverBudget, budget.OnEncodeUsage(second, 60));
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(first, 150));
+}
+
+TEST(EncoderCpuBudgetTest, HeadroomGoesToHigherPriorityFirst) {
+  EncoderCpuBudget budget(kBudgetPercent);
+  int high = budget.AddStream(2.0);
+  int low = budget.AddStream(1.0);
+  budget.OnEncodeUsage(high, 80);
+  // At 120% in total there is room for the high priority stream to grow by
+  // 56%, but not for both streams to grow by 70%.
+  EXPECT_EQ(Allocation::kWithinBudget, budget.OnEncodeUsage(low, 40));
+  EXPECT_EQ(Allocation::kMayAdaptUp, budget.OnEncodeUsage(high, 80));
+  budget.OnEncodeUsage(high, 60);
+  EXPECT_EQ(Allocation::kMayAdaptUp, budget.OnEncodeUsage(low, 40));
+}
+
+TEST(EncoderCpuBudgetTest, RemovedStreamFreesBudget) {
+  EncoderCpuBudget budget(kBudgetPercent);
+  int first = budget.AddStream(2.0);
+  int second = budget.AddStream(1.0);
+  budget.OnEncodeUsage(first, 180);
+  EXPECT_EQ(Allocation::kOverBudget, budget.OnEncodeUsage(second, 40));
+  budget.RemoveStream(first);
+  EXPECT_EQ(Allocation::kMayAdaptUp, budget.OnEncodeUsage(second, 40));
+}
+
+}  // namespace webrtc
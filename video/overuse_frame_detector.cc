@@ -512,6 +512,11 @@ class OveruseFrameDetector::CheckOveruseTask : public rtc::QueuedTask {
 
 OveruseFrameDetector::OveruseFrameDetector(
     CpuOveruseMetricsObserver* metrics_observer)
+    : OveruseFrameDetector(metrics_observer, EncoderCpuBudget::GetShared()) {}
+
+OveruseFrameDetector::OveruseFrameDetector(
+    CpuOveruseMetricsObserver* metrics_observer,
+    EncoderCpuBudget* cpu_budget)
     : check_overuse_task_(nullptr),
       metrics_observer_(metrics_observer),
       num_process_times_(0),
@@ -524,12 +529,15 @@ OveruseFrameDetector::OveruseFrameDetector(
       num_overuse_detections_(0),
       last_rampup_time_ms_(-1),
       in_quick_rampup_(false),
-      current_rampup_delay_ms_(kStandardRampUpDelayMs) {
+      current_rampup_delay_ms_(kStandardRampUpDelayMs),
+      cpu_budget_(cpu_budget) {
   task_checker_.Detach();
 }
 
 OveruseFrameDetector::~OveruseFrameDetector() {
   RTC_DCHECK(!check_overuse_task_) << "StopCheckForOverUse must be called.";
+  if (cpu_budget_stream_id_)
+    cpu_budget_->RemoveStream(*cpu_budget_stream_id_);
 }
 
 void OveruseFrameDetector::StartCheckForOveruse(
@@ -541,6 +549,7 @@ void OveruseFrameDetector::StartCheckForOveruse(
 
   SetOptions(options);
   check_overuse_task_ = new CheckOveruseTask(this, overuse_observer);
+  AddToCpuBudget();
 }
 void OveruseFrameDetector::StopCheckForOveruse() {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&task_checker_);
@@ -548,6 +557,34 @@ void OveruseFrameDetector::StopCheckForOveruse() {
     check_overuse_task_->Stop();
     check_overuse_task_ = nullptr;
   }
+  RemoveFromCpuBudget();
+}
+
+void OveruseFrameDetector::SetCpuBudgetPriority(
+    absl::optional<double> priority) {
+  RTC_DCHECK_CALLED_SEQUENTIALLY(&task_checker_);
+  cpu_budget_priority_ = priority;
+  if (!priority) {
+    RemoveFromCpuBudget();
+  } else if (cpu_budget_stream_id_) {
+    cpu_budget_->SetPriority(*cpu_budget_stream_id_, *priority);
+  } else {
+    AddToCpuBudget();
+  }
+}
+
+void OveruseFrameDetector::AddToCpuBudget() {
+  RTC_DCHECK_CALLED_SEQUENTIALLY(&task_checker_);
+  if (cpu_budget_ && cpu_budget_priority_ && !cpu_budget_stream_id_)
+    cpu_budget_stream_id_ = cpu_budget_->AddStream(*cpu_budget_priority_);
+}
+
+void OveruseFrameDetector::RemoveFromCpuBudget() {
+  RTC_DCHECK_CALLED_SEQUENTIALLY(&task_checker_);
+  if (cpu_budget_stream_id_) {
+    cpu_budget_->RemoveStream(*cpu_budget_stream_id_);
+    cpu_budget_stream_id_ = absl::nullopt;
+  }
 }
 
 void OveruseFrameDetector::EncodedFrameTimeMeasured(int encode_duration_ms) {
@@ -627,12 +664,21 @@ void OveruseFrameDetector::CheckForOveruse(
   RTC_DCHECK_CALLED_SEQUENTIALLY(&task_checker_);
   RTC_DCHECK(observer);
   ++num_process_times_;
+  // Streams that haven't measured anything yet, e.g. after a resolution
+  // change, leave their share of the budget to the others meanwhile.
+  EncoderCpuBudget::Allocation allocation =
+      EncoderCpuBudget::Allocation::kMayAdaptUp;
+  if (cpu_budget_stream_id_) {
+    allocation = cpu_budget_->OnEncodeUsage(
+        *cpu_budget_stream_id_, metrics_ ? metrics_->encode_usage_percent : 0);
+  }
   if (num_process_times_ <= options_.min_process_count || !metrics_)
     return;
 
   int64_t now_ms = rtc::TimeMillis();
 
-  if (IsOverusing(*metrics_)) {
+  if (IsOverusing(*metrics_) ||
+      allocation == EncoderCpuBudget::Allocation::kOverBudget) {
     // If the last thing we did was going up, and now have to back down, we need
     // to check if this peak was short. If so we should back off to avoid going
     // back and forth between this load, the system doesn't seem to handle it.
@@ -656,7 +702,8 @@ void OveruseFrameDetector::CheckForOveruse(
     ++num_overuse_detections_;
 
     observer->AdaptDown(kScaleReasonCpu);
-  } else if (IsUnderusing(*metrics_, now_ms)) {
+  } else if (IsUnderusing(*metrics_, now_ms) &&
+             allocation == EncoderCpuBudget::Allocation::kMayAdaptUp) {
     last_rampup_time_ms_ = now_ms;
     in_quick_rampup_ = true;
 
@@ -21,6 +21,7 @@
 #include "rtc_base/sequenced_task_checker.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/thread_annotations.h"
+#include "video/encoder_cpu_budget.h"
 
 namespace webrtc {
 
@@ -63,9 +64,16 @@ class CpuOveruseMetricsObserver {
 // be created and destroyed on an arbitrary thread.
 // OveruseFrameDetector::StartCheckForOveruse  must be called to periodically
 // check for overuse.
+// If the process has an EncoderCpuBudget, streams that take part in it are
+// also adapted down when they don't fit in their share of the budget, and only
+// adapted up when there is room for them in it.
 class OveruseFrameDetector {
  public:
+  // Uses the budget from EncoderCpuBudget::GetShared().
   explicit OveruseFrameDetector(CpuOveruseMetricsObserver* metrics_observer);
+  // |cpu_budget| may be null.
+  OveruseFrameDetector(CpuOveruseMetricsObserver* metrics_observer,
+                       EncoderCpuBudget* cpu_budget);
   virtual ~OveruseFrameDetector();
 
   // Start to periodically check for overuse.
@@ -83,6 +91,10 @@ class OveruseFrameDetector {
   // experience adaptation toggling.
   virtual void OnTargetFramerateUpdated(int framerate_fps);
 
+  // Sets the priority of the stream in the process-wide encoder CPU budget,
+  // or takes the stream out of it if unset, e.g. for hardware encoders.
+  void SetCpuBudgetPriority(absl::optional<double> priority);
+
   // Called for each captured frame.
   void FrameCaptured(const VideoFrame& frame, int64_t time_when_first_seen_us);
 
@@ -132,6 +144,9 @@ class OveruseFrameDetector {
 
   void ResetAll(int num_pixels);
 
+  void AddToCpuBudget();
+  void RemoveFromCpuBudget();
+
   static std::unique_ptr<ProcessingUsage> CreateProcessingUsage(
       const CpuOveruseOptions& options);
 
@@ -159,6 +174,10 @@ class OveruseFrameDetector {
 
   std::unique_ptr<ProcessingUsage> usage_ RTC_PT_GUARDED_BY(task_checker_);
 
+  EncoderCpuBudget* const cpu_budget_;
+  absl::optional<double> cpu_budget_priority_ RTC_GUARDED_BY(task_checker_);
+  absl::optional<int> cpu_budget_stream_id_ RTC_GUARDED_BY(task_checker_);
+
   RTC_DISALLOW_COPY_AND_ASSIGN(OveruseFrameDetector);
 };
 
@@ -59,6 +59,9 @@ class OveruseFrameDetectorUnderTest : public OveruseFrameDetector {
   explicit OveruseFrameDetectorUnderTest(
       CpuOveruseMetricsObserver* metrics_observer)
       : OveruseFrameDetector(metrics_observer) {}
+  OveruseFrameDetectorUnderTest(CpuOveruseMetricsObserver* metrics_observer,
+                                EncoderCpuBudget* cpu_budget)
+      : OveruseFrameDetector(metrics_observer, cpu_budget) {}
   ~OveruseFrameDetectorUnderTest() {}
 
   using OveruseFrameDetector::CheckForOveruse;
@@ -259,6 +262,47 @@ TEST_F(OveruseFrameDetectorTest, IncorrectConsecutiveCountTriggersNoOveruse) {
   TriggerOveruse(1);
 }
 
+TEST_F(OveruseFrameDetectorTest, TriggerOveruseWhenOverCpuBudget) {
+  // The 15% load is well below the thresholds, but above the budget.
+  EncoderCpuBudget cpu_budget(10);
+  overuse_detector_ =
+      absl::make_unique<OveruseFrameDetectorUnderTest>(this, &cpu_budget);
+  overuse_detector_->SetOptions(options_);
+  overuse_detector_->SetCpuBudgetPriority(1.0);
+  EXPECT_CALL(mock_observer_, AdaptUp(reason_)).Times(0);
+  EXPECT_CALL(mock_observer_, AdaptDown(reason_)).Times(1);
+  InsertAndSendFramesWithInterval(1000, kFrameIntervalUs, kWidth, kHeight,
+                                  kProcessTimeUs);
+  overuse_detector_->CheckForOveruse(observer_);
+
+  // Out of the budget, the detector is back to its own thresholds.
+  overuse_detector_->SetCpuBudgetPriority(absl::nullopt);
+  EXPECT_CALL(mock_observer_, AdaptUp(reason_)).Times(testing::AtLeast(1));
+  TriggerUnderuse();
+}
+
+TEST_F(OveruseFrameDetectorTest, HigherPriorityStreamKeepsCpuBudget) {
+  EncoderCpuBudget cpu_budget(25);
+  int other_stream = cpu_budget.AddStream(2.0);
+  cpu_budget.OnEncodeUsage(other_stream, 15);
+  overuse_detector_ =
+      absl::make_unique<OveruseFrameDetectorUnderTest>(this, &cpu_budget);
+  overuse_detector_->SetOptions(options_);
+  overuse_detector_->SetCpuBudgetPriority(1.0);
+  EXPECT_CALL(mock_observer_, AdaptDown(reason_)).Times(1);
+  InsertAndSendFramesWithInterval(1000, kFrameIntervalUs, kWidth, kHeight,
+                                  kProcessTimeUs);
+  overuse_detector_->CheckForOveruse(observer_);
+
+  // With the higher priority the stream fits in the budget, but may not use
+  // more of it.
+  overuse_detector_->SetCpuBudgetPriority(3.0);
+  EXPECT_CALL(mock_observer_, AdaptUp(reason_)).Times(0);
+  TriggerUnderuse();
+  overuse_detector_.reset();
+  cpu_budget.RemoveStream(other_stream);
+}
+
 TEST_F(OveruseFrameDetectorTest, ProcessingUsage) {
   overuse_detector_->SetOptions(options_);
   InsertAndSendFramesWithInterval(1000, kFrameIntervalUs, kWidth, kHeight,
@@ -49,6 +49,9 @@ const int kHighVarianceThreshold = 2;
 // the clients.
 const int kMovingMaxWindowMs = 1000;
 
+// How often the bitrate is updated from the packet path.
+const int64_t kTotalBytesUpdateIntervalMs = 100;
+
 // How large window we use to calculate the framerate/bitrate.
 const int kRateStatisticsWindowSizeMs = 1000;
 
@@ -106,11 +109,13 @@ ReceiveStatisticsProxy::ReceiveStatisticsProxy(
       render_fps_tracker_(100, 10u),
       render_pixel_tracker_(100, 10u),
       total_byte_tracker_(100, 10u),  // bucket_interval_ms, bucket_count
+      total_bytes_(0),
       video_quality_observer_(
           new VideoQualityObserver(VideoContentType::UNSPECIFIED)),
       interframe_delay_max_moving_(kMovingMaxWindowMs),
       freq_offset_counter_(clock, nullptr, kFreqOffsetProcessIntervalMs),
       first_report_block_time_ms_(-1),
+      next_total_bytes_update_ms_(-1),
       avg_rtt_ms_(0),
       last_content_type_(VideoContentType::UNSPECIFIED),
       last_codec_type_(kVideoCodecVP8),
@@ -120,11 +125,6 @@ ReceiveStatisticsProxy::ReceiveStatisticsProxy(
   decode_thread_.DetachFromThread();
   network_thread_.DetachFromThread();
   stats_.ssrc = config_.rtp.remote_ssrc;
-  // TODO(brandtr): Replace |rtx_stats_| with a single instance of
-  // StreamDataCounters.
-  if (config_.rtp.rtx_ssrc) {
-    rtx_stats_[config_.rtp.rtx_ssrc] = StreamDataCounters();
-  }
 }
 
 ReceiveStatisticsProxy::~ReceiveStatisticsProxy() {
@@ -411,10 +411,9 @@ void ReceiveStatisticsProxy::UpdateHistograms() {
     }
   }
 
+  UpdateRtpStats();
   StreamDataCounters rtp = stats_.rtp_stats;
-  StreamDataCounters rtx;
-  for (auto it : rtx_stats_)
-    rtx.Add(it.second);
+  StreamDataCounters rtx = rtx_stats_.Load();
   StreamDataCounters rtp_rtx = rtp;
   rtp_rtx.Add(rtx);
   int64_t elapsed_sec =
@@ -438,7 +437,7 @@ void ReceiveStatisticsProxy::UpdateHistograms() {
         "WebRTC.Video.RetransmittedBitrateReceivedInKbps",
         static_cast<int>(rtp_rtx.retransmitted.TotalBytes() * 8 / elapsed_sec /
                          1000));
-    if (!rtx_stats_.empty()) {
+    if (config_.rtp.rtx_ssrc) {
       RTC_HISTOGRAM_COUNTS_10000("WebRTC.Video.RtxBitrateReceivedInKbps",
                                  static_cast<int>(rtx.transmitted.TotalBytes() *
                                                   8 / elapsed_sec / 1000));
@@ -576,6 +575,7 @@ VideoReceiveStream::Stats ReceiveStatisticsProxy::GetStats() const {
   // us from ever correctly displaying frame rate of 0.
   int64_t now_ms = clock_->TimeInMilliseconds();
   UpdateFramerate(now_ms);
+  UpdateRtpStats();
   stats_.render_frame_rate = renders_fps_estimator_.Rate(now_ms).value_or(0);
   stats_.decode_frame_rate = decode_fps_estimator_.Rate(now_ms).value_or(0);
   stats_.total_bitrate_bps =
@@ -601,7 +601,7 @@ void ReceiveStatisticsProxy::OnIncomingRate(unsigned int framerate,
                                             unsigned int bitrate_bps) {
   RTC_DCHECK_RUN_ON(&network_thread_);
   rtc::CritScope lock(&crit_);
-  if (stats_.rtp_stats.first_packet_time_ms != -1)
+  if (rtp_stats_.Load().first_packet_time_ms != -1)
     QualitySample();
 }
 
@@ -678,25 +678,32 @@ void ReceiveStatisticsProxy::CNameChanged(const char* cname, uint32_t ssrc) {
 void ReceiveStatisticsProxy::DataCountersUpdated(
     const webrtc::StreamDataCounters& counters,
     uint32_t ssrc) {
-  size_t last_total_bytes = 0;
-  size_t total_bytes = 0;
-  rtc::CritScope lock(&crit_);
-  if (ssrc == stats_.ssrc) {
-    last_total_bytes = stats_.rtp_stats.transmitted.TotalBytes();
-    total_bytes = counters.transmitted.TotalBytes();
-    stats_.rtp_stats = counters;
+  if (ssrc == config_.rtp.remote_ssrc) {
+    rtp_stats_.Store(counters);
+  } else if (config_.rtp.rtx_ssrc && ssrc == config_.rtp.rtx_ssrc) {
+    rtx_stats_.Store(counters);
   } else {
-    auto it = rtx_stats_.find(ssrc);
-    if (it != rtx_stats_.end()) {
-      last_total_bytes = it->second.transmitted.TotalBytes();
-      total_bytes = counters.transmitted.TotalBytes();
-      it->second = counters;
-    } else {
-      RTC_NOTREACHED() << "Unexpected stream ssrc: " << ssrc;
-    }
+    RTC_NOTREACHED() << "Unexpected stream ssrc: " << ssrc;
+    return;
+  }
+
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  if (now_ms < next_total_bytes_update_ms_.load(std::memory_order_relaxed))
+    return;
+  next_total_bytes_update_ms_.store(now_ms + kTotalBytesUpdateIntervalMs,
+                                    std::memory_order_relaxed);
+  rtc::CritScope lock(&crit_);
+  UpdateRtpStats();
+}
+
+void ReceiveStatisticsProxy::UpdateRtpStats() const {
+  stats_.rtp_stats = rtp_stats_.Load();
+  size_t total_bytes = stats_.rtp_stats.transmitted.TotalBytes() +
+                       rtx_stats_.Load().transmitted.TotalBytes();
+  if (total_bytes > total_bytes_) {
+    total_byte_tracker_.AddSamples(total_bytes - total_bytes_);
+    total_bytes_ = total_bytes;
   }
-  if (total_bytes > last_total_bytes)
-    total_byte_tracker_.AddSamples(total_bytes - last_total_bytes);
 }
 
 void ReceiveStatisticsProxy::OnDecodedFrame(absl::optional<uint8_t> qp,
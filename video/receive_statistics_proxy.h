@@ -11,6 +11,7 @@
 #ifndef VIDEO_RECEIVE_STATISTICS_PROXY_H_
 #define VIDEO_RECEIVE_STATISTICS_PROXY_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 #include "rtc_base/numerics/sample_counter.h"
 #include "rtc_base/rate_statistics.h"
 #include "rtc_base/ratetracker.h"
+#include "rtc_base/synchronization/sequence_lock.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/thread_checker.h"
 #include "video/quality_threshold.h"
@@ -133,6 +135,9 @@ class ReceiveStatisticsProxy : public VCMReceiveStatisticsCallback,
 
   void QualitySample() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Copies the latest RTP counters into |stats_| and updates the bitrate.
+  void UpdateRtpStats() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Removes info about old frames and then updates the framerate.
   void UpdateFramerate(int64_t now_ms) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
@@ -161,7 +166,8 @@ class ReceiveStatisticsProxy : public VCMReceiveStatisticsCallback,
   RateStatistics renders_fps_estimator_ RTC_GUARDED_BY(crit_);
   rtc::RateTracker render_fps_tracker_ RTC_GUARDED_BY(crit_);
   rtc::RateTracker render_pixel_tracker_ RTC_GUARDED_BY(crit_);
-  rtc::RateTracker total_byte_tracker_ RTC_GUARDED_BY(crit_);
+  mutable rtc::RateTracker total_byte_tracker_ RTC_GUARDED_BY(crit_);
+  mutable size_t total_bytes_ RTC_GUARDED_BY(crit_);
   rtc::SampleCounter sync_offset_counter_ RTC_GUARDED_BY(crit_);
   rtc::SampleCounter decode_time_counter_ RTC_GUARDED_BY(crit_);
   rtc::SampleCounter jitter_buffer_delay_counter_ RTC_GUARDED_BY(crit_);
@@ -178,7 +184,11 @@ class ReceiveStatisticsProxy : public VCMReceiveStatisticsCallback,
   int64_t first_report_block_time_ms_ RTC_GUARDED_BY(crit_);
   ReportBlockStats report_block_stats_ RTC_GUARDED_BY(crit_);
   QpCounters qp_counters_ RTC_GUARDED_BY(decode_thread_);
-  std::map<uint32_t, StreamDataCounters> rtx_stats_ RTC_GUARDED_BY(crit_);
+  // Counters reported for every packet received. They are stored without
+  // taking |crit_| and read into |stats_| when needed.
+  rtc::SequenceLocked<StreamDataCounters> rtp_stats_;
+  rtc::SequenceLocked<StreamDataCounters> rtx_stats_;
+  std::atomic<int64_t> next_total_bytes_update_ms_;
   int64_t avg_rtt_ms_ RTC_GUARDED_BY(crit_);
   mutable std::map<int64_t, size_t> frame_window_ RTC_GUARDED_BY(&crit_);
   VideoContentType last_content_type_ RTC_GUARDED_BY(&crit_);
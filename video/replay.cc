@@ -10,18 +10,24 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "api/video_codecs/video_decoder.h"
 #include "call/call.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "logging/rtc_event_log/rtc_event_log.h"
 #include "modules/rtp_rtcp/include/rtp_header_parser.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
 #include "rtc_base/flags.h"
 #include "rtc_base/string_to_number.h"
+#include "rtc_base/stringencode.h"
 #include "rtc_base/timeutils.h"
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/sleep.h"
@@ -60,13 +66,15 @@ bool ValidateInputFilenameNotEmpty(const std::string& string) {
   return !string.empty();
 }
 
+static bool ValidateNumStreams(int32_t num_streams) {
+  return num_streams > 0;
+}
+
 }  // namespace
 
 namespace webrtc {
 namespace flags {
 
-// TODO(pbos): Multiple receivers.
-
 // Flag for payload type.
 DEFINE_int(media_payload_type,
            test::CallTest::kPayloadTypeVP8,
@@ -141,9 +149,39 @@ static int TransmissionOffsetId() {
 }
 
 // Flag for rtpdump input file.
-DEFINE_string(input_file, "", "input file");
-static std::string InputFile() {
-  return static_cast<std::string>(FLAG_input_file);
+DEFINE_string(input_file,
+              "",
+              "input file, or comma separated input files. The files are "
+              "replayed at the same time and must all use the SSRCs given by "
+              "--ssrc and --ssrc_rtx. Only the RTCP of the first file is "
+              "delivered.");
+static std::vector<std::string> InputFiles() {
+  std::vector<std::string> input_files;
+  rtc::split(FLAG_input_file, ',', &input_files);
+  return input_files;
+}
+
+DEFINE_int(num_streams,
+           1,
+           "Number of copies of each input file to replay at the same time. "
+           "The copies of all files are numbered in order, and the SSRCs of "
+           "copy n are offset by n, so that every copy is received as a "
+           "stream of its own.");
+static int NumStreams() {
+  return static_cast<int>(FLAG_num_streams);
+}
+
+DEFINE_bool(realtime,
+            true,
+            "Deliver packets at the pace they were recorded at. If false, "
+            "they are delivered as fast as possible.");
+static bool Realtime() {
+  return FLAG_realtime;
+}
+
+DEFINE_bool(headless, false, "Only decode, don't render to a window.");
+static bool Headless() {
+  return FLAG_headless;
 }
 
 // Flag for raw output files.
@@ -225,118 +263,305 @@ class DecoderBitstreamFileWriter : public test::FakeDecoder {
   FILE* file_;
 };
 
-void RtpReplay() {
-  std::stringstream window_title;
-  window_title << "Playback Video (" << flags::InputFile() << ")";
-  std::unique_ptr<test::VideoRenderer> playback_video(
-      test::VideoRenderer::Create(window_title.str().c_str(), 640, 480));
-  FileRenderPassthrough file_passthrough(flags::OutBase(),
-                                         playback_video.get());
+// Keeps track of the CPU time the decode thread of a stream spends decoding.
+class CpuTimingDecoder : public VideoDecoder {
+ public:
+  explicit CpuTimingDecoder(std::unique_ptr<VideoDecoder> decoder)
+      : decoder_(std::move(decoder)) {}
 
-  webrtc::RtcEventLogNullImpl event_log;
-  std::unique_ptr<Call> call(Call::Create(Call::Config(&event_log)));
+  int32_t InitDecode(const VideoCodec* codec_settings,
+                     int32_t number_of_cores) override {
+    return decoder_->InitDecode(codec_settings, number_of_cores);
+  }
 
-  test::NullTransport transport;
-  VideoReceiveStream::Config receive_config(&transport);
-  receive_config.rtp.remote_ssrc = flags::Ssrc();
-  receive_config.rtp.local_ssrc = kReceiverLocalSsrc;
-  receive_config.rtp.rtx_ssrc = flags::SsrcRtx();
-  receive_config.rtp
-      .rtx_associated_payload_types[flags::MediaPayloadTypeRtx()] =
-      flags::MediaPayloadType();
-  receive_config.rtp.rtx_associated_payload_types[flags::RedPayloadTypeRtx()] =
-      flags::RedPayloadType();
-  receive_config.rtp.ulpfec_payload_type = flags::UlpfecPayloadType();
-  receive_config.rtp.red_payload_type = flags::RedPayloadType();
-  receive_config.rtp.nack.rtp_history_ms = 1000;
-  if (flags::TransmissionOffsetId() != -1) {
-    receive_config.rtp.extensions.push_back(RtpExtension(
-        RtpExtension::kTimestampOffsetUri, flags::TransmissionOffsetId()));
+  int32_t Decode(const EncodedImage& input_image,
+                 bool missing_frames,
+                 const CodecSpecificInfo* codec_specific_info,
+                 int64_t render_time_ms) override {
+    int64_t start_ns = rtc::GetThreadCpuTimeNanos();
+    int32_t result = decoder_->Decode(input_image, missing_frames,
+                                      codec_specific_info, render_time_ms);
+    decode_cpu_ns_ += rtc::GetThreadCpuTimeNanos() - start_ns;
+    return result;
+  }
+
+  int32_t RegisterDecodeCompleteCallback(
+      DecodedImageCallback* callback) override {
+    return decoder_->RegisterDecodeCompleteCallback(callback);
   }
-  if (flags::AbsSendTimeId() != -1) {
-    receive_config.rtp.extensions.push_back(
-        RtpExtension(RtpExtension::kAbsSendTimeUri, flags::AbsSendTimeId()));
+
+  int32_t Release() override { return decoder_->Release(); }
+
+  bool PrefersLateDecoding() const override {
+    return decoder_->PrefersLateDecoding();
   }
-  receive_config.renderer = &file_passthrough;
-
-  VideoReceiveStream::Decoder decoder;
-  decoder =
-      test::CreateMatchingDecoder(flags::MediaPayloadType(), flags::Codec());
-  if (!flags::DecoderBitstreamFilename().empty()) {
-    // Replace decoder with file writer if we're writing the bitstream to a file
-    // instead.
-    delete decoder.decoder;
-    decoder.decoder = new DecoderBitstreamFileWriter(
-        flags::DecoderBitstreamFilename().c_str());
+
+  const char* ImplementationName() const override {
+    return decoder_->ImplementationName();
   }
-  receive_config.decoders.push_back(decoder);
 
-  VideoReceiveStream* receive_stream =
-      call->CreateVideoReceiveStream(std::move(receive_config));
+  int64_t decode_cpu_ns() const { return decode_cpu_ns_.load(); }
+
+ private:
+  const std::unique_ptr<VideoDecoder> decoder_;
+  std::atomic<int64_t> decode_cpu_ns_{0};
+};
 
-  std::unique_ptr<test::RtpFileReader> rtp_reader(test::RtpFileReader::Create(
-      test::RtpFileReader::kRtpDump, flags::InputFile()));
+// One copy of an input file, replayed into a receive stream of its own.
+struct ReplayStream {
+  std::string input_file;
+  // Added to the media and RTX SSRCs of the packets of this copy. Unique
+  // among the copies of all input files, since they share the same SSRCs.
+  uint32_t ssrc_offset = 0;
+  std::unique_ptr<test::RtpFileReader> rtp_reader;
+  // The next packet to deliver, valid as long as |has_packet| is true.
+  test::RtpPacket packet;
+  bool has_packet = false;
+
+  std::unique_ptr<test::VideoRenderer> playback_video;
+  std::unique_ptr<FileRenderPassthrough> file_passthrough;
+  CpuTimingDecoder* decoder = nullptr;
+  VideoReceiveStream* receive_stream = nullptr;
+};
+
+std::unique_ptr<test::RtpFileReader> CreateRtpReader(
+    const std::string& input_file) {
+  std::unique_ptr<test::RtpFileReader> rtp_reader(
+      test::RtpFileReader::Create(test::RtpFileReader::kRtpDump, input_file));
   if (!rtp_reader) {
-    rtp_reader.reset(test::RtpFileReader::Create(test::RtpFileReader::kPcap,
-                                                 flags::InputFile()));
+    rtp_reader.reset(
+        test::RtpFileReader::Create(test::RtpFileReader::kPcap, input_file));
     if (!rtp_reader) {
       fprintf(stderr,
               "Couldn't open input file as either a rtpdump or .pcap. Note "
               "that .pcapng is not supported.\nTrying to interpret the file as "
               "length/packet interleaved.\n");
       rtp_reader.reset(test::RtpFileReader::Create(
-          test::RtpFileReader::kLengthPacketInterleaved, flags::InputFile()));
+          test::RtpFileReader::kLengthPacketInterleaved, input_file));
       if (!rtp_reader) {
         fprintf(stderr,
                 "Unable to open input file with any supported format\n");
+      }
+    }
+  }
+  return rtp_reader;
+}
+
+// Moves a media or RTX packet of a copy of the input onto the SSRCs of its
+// receive stream.
+void RewriteSsrc(uint32_t ssrc_offset, test::RtpPacket* packet) {
+  uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&packet->data[8]);
+  ByteWriter<uint32_t>::WriteBigEndian(&packet->data[8], ssrc + ssrc_offset);
+}
+
+void DeliverPacket(Call* call,
+                   const test::RtpPacket& packet,
+                   std::map<uint32_t, int>* unknown_packets) {
+  switch (call->Receiver()->DeliverPacket(
+      webrtc::MediaType::VIDEO,
+      rtc::CopyOnWriteBuffer(packet.data, packet.length), PacketTime())) {
+    case PacketReceiver::DELIVERY_OK:
+      break;
+    case PacketReceiver::DELIVERY_UNKNOWN_SSRC: {
+      RTPHeader header;
+      std::unique_ptr<RtpHeaderParser> parser(RtpHeaderParser::Create());
+      parser->Parse(packet.data, packet.length, &header);
+      if ((*unknown_packets)[header.ssrc] == 0)
+        fprintf(stderr, "Unknown SSRC: %u!\n", header.ssrc);
+      ++(*unknown_packets)[header.ssrc];
+      break;
+    }
+    case PacketReceiver::DELIVERY_PACKET_ERROR: {
+      fprintf(stderr, "Packet error, corrupt packets or incorrect setup?\n");
+      RTPHeader header;
+      std::unique_ptr<RtpHeaderParser> parser(RtpHeaderParser::Create());
+      parser->Parse(packet.data, packet.length, &header);
+      fprintf(stderr, "Packet len=%zu pt=%u seq=%u ts=%u ssrc=0x%8x\n",
+              packet.length, header.payloadType, header.sequenceNumber,
+              header.timestamp, header.ssrc);
+      break;
+    }
+  }
+}
+
+uint32_t TotalFramesDecoded(
+    const std::vector<std::unique_ptr<ReplayStream>>& streams) {
+  uint32_t frames_decoded = 0;
+  for (const auto& stream : streams)
+    frames_decoded += stream->receive_stream->GetStats().frames_decoded;
+  return frames_decoded;
+}
+
+// Waits for the streams to decode the frames that are still buffered when the
+// last packet has been delivered, and returns when the last of them was.
+int64_t WaitForDecodingToFinish(
+    const std::vector<std::unique_ptr<ReplayStream>>& streams) {
+  const int kPollIntervalMs = 500;
+  int64_t last_decode_ms = rtc::TimeMillis();
+  uint32_t frames_decoded = TotalFramesDecoded(streams);
+  while (true) {
+    SleepMs(kPollIntervalMs);
+    uint32_t now_decoded = TotalFramesDecoded(streams);
+    if (now_decoded == frames_decoded)
+      return last_decode_ms;
+    frames_decoded = now_decoded;
+    last_decode_ms = rtc::TimeMillis();
+  }
+}
+
+void PrintReport(const std::vector<std::unique_ptr<ReplayStream>>& streams,
+                 int64_t elapsed_ms,
+                 int64_t process_cpu_ns) {
+  const double elapsed_s = std::max<int64_t>(elapsed_ms, 1) / 1000.0;
+  uint32_t total_decoded = 0;
+  int total_dropped = 0;
+  for (const auto& stream : streams) {
+    VideoReceiveStream::Stats stats = stream->receive_stream->GetStats();
+    // Frames that were assembled from the received packets but never made it
+    // through the decoder.
+    int dropped = std::max(0, stats.frame_counts.key_frames +
+                                  stats.frame_counts.delta_frames -
+                                  static_cast<int>(stats.frames_decoded));
+    double decode_cpu_ms =
+        static_cast<double>(stream->decoder->decode_cpu_ns()) /
+        rtc::kNumNanosecsPerMillisec;
+    fprintf(stderr,
+            "%s ssrc=%u: %dx%d %s, %u frames decoded (%.1f fps), "
+            "%u rendered, %d dropped, %d packets discarded, "
+            "decode cpu %.0f ms (%.1f%%)\n",
+            stream->input_file.c_str(), stats.ssrc, stats.width, stats.height,
+            stats.decoder_implementation_name.c_str(), stats.frames_decoded,
+            stats.frames_decoded / elapsed_s, stats.frames_rendered, dropped,
+            stats.discarded_packets, decode_cpu_ms,
+            decode_cpu_ms / (elapsed_s * 10));
+    total_decoded += stats.frames_decoded;
+    total_dropped += dropped;
+  }
+  double process_cpu_ms =
+      static_cast<double>(process_cpu_ns) / rtc::kNumNanosecsPerMillisec;
+  fprintf(stderr,
+          "%zu streams in %.2f s: %u frames decoded (%.1f fps), %d dropped, "
+          "process cpu %.0f ms (%.1f%%, %.1f ms per stream)\n",
+          streams.size(), elapsed_s, total_decoded, total_decoded / elapsed_s,
+          total_dropped, process_cpu_ms, process_cpu_ms / (elapsed_s * 10),
+          process_cpu_ms / streams.size());
+}
+
+void RtpReplay() {
+  webrtc::RtcEventLogNullImpl event_log;
+  std::unique_ptr<Call> call(Call::Create(Call::Config(&event_log)));
+  test::NullTransport transport;
+
+  std::vector<std::unique_ptr<ReplayStream>> streams;
+  for (const std::string& input_file : flags::InputFiles()) {
+    for (int copy = 0; copy < flags::NumStreams(); ++copy) {
+      std::unique_ptr<ReplayStream> stream(new ReplayStream());
+      stream->input_file = input_file;
+      stream->ssrc_offset = static_cast<uint32_t>(streams.size());
+      // With mmap-backed readers, every copy of a file shares its pages.
+      stream->rtp_reader = CreateRtpReader(input_file);
+      if (!stream->rtp_reader)
         return;
+      if (stream->ssrc_offset > 0) {
+        // Only the media and RTX SSRCs are rewritten, so RTCP, and RTP of
+        // other SSRCs, are only delivered by the first copy of the first
+        // input file.
+        test::RtpFileFilter filter;
+        filter.ssrcs = {flags::Ssrc(), flags::SsrcRtx()};
+        filter.rtcp = false;
+        stream->rtp_reader->SetFilter(filter);
       }
+      streams.push_back(std::move(stream));
     }
   }
-  receive_stream->Start();
 
-  int64_t replay_start_ms = -1;
+  for (const auto& stream : streams) {
+    std::string out_base = flags::OutBase();
+    if (!out_base.empty() && streams.size() > 1)
+      out_base += std::to_string(stream->ssrc_offset) + "_";
+    if (!flags::Headless()) {
+      std::stringstream window_title;
+      window_title << "Playback Video (" << stream->input_file << ")";
+      stream->playback_video.reset(
+          test::VideoRenderer::Create(window_title.str().c_str(), 640, 480));
+    }
+    stream->file_passthrough.reset(
+        new FileRenderPassthrough(out_base, stream->playback_video.get()));
+
+    VideoReceiveStream::Config receive_config(&transport);
+    receive_config.rtp.remote_ssrc = flags::Ssrc() + stream->ssrc_offset;
+    receive_config.rtp.local_ssrc = kReceiverLocalSsrc + stream->ssrc_offset;
+    receive_config.rtp.rtx_ssrc = flags::SsrcRtx() + stream->ssrc_offset;
+    receive_config.rtp
+        .rtx_associated_payload_types[flags::MediaPayloadTypeRtx()] =
+        flags::MediaPayloadType();
+    receive_config.rtp
+        .rtx_associated_payload_types[flags::RedPayloadTypeRtx()] =
+        flags::RedPayloadType();
+    receive_config.rtp.ulpfec_payload_type = flags::UlpfecPayloadType();
+    receive_config.rtp.red_payload_type = flags::RedPayloadType();
+    receive_config.rtp.nack.rtp_history_ms = 1000;
+    if (flags::TransmissionOffsetId() != -1) {
+      receive_config.rtp.extensions.push_back(RtpExtension(
+          RtpExtension::kTimestampOffsetUri, flags::TransmissionOffsetId()));
+    }
+    if (flags::AbsSendTimeId() != -1) {
+      receive_config.rtp.extensions.push_back(
+          RtpExtension(RtpExtension::kAbsSendTimeUri, flags::AbsSendTimeId()));
+    }
+    receive_config.renderer = stream->file_passthrough.get();
+
+    VideoReceiveStream::Decoder decoder =
+        test::CreateMatchingDecoder(flags::MediaPayloadType(), flags::Codec());
+    if (!flags::DecoderBitstreamFilename().empty()) {
+      // Replace decoder with file writer if we're writing the bitstream to a
+      // file instead.
+      delete decoder.decoder;
+      decoder.decoder = new DecoderBitstreamFileWriter(
+          flags::DecoderBitstreamFilename().c_str());
+    }
+    stream->decoder = new CpuTimingDecoder(
+        std::unique_ptr<VideoDecoder>(decoder.decoder));
+    decoder.decoder = stream->decoder;
+    receive_config.decoders.push_back(decoder);
+
+    stream->receive_stream =
+        call->CreateVideoReceiveStream(std::move(receive_config));
+  }
+
+  for (const auto& stream : streams) {
+    stream->receive_stream->Start();
+    stream->has_packet = stream->rtp_reader->NextPacket(&stream->packet);
+  }
+
+  int64_t replay_start_ms = rtc::TimeMillis();
+  int64_t replay_start_cpu_ns = rtc::GetProcessCpuTimeNanos();
   int num_packets = 0;
   std::map<uint32_t, int> unknown_packets;
   while (true) {
-    int64_t now_ms = rtc::TimeMillis();
-    if (replay_start_ms == -1)
-      replay_start_ms = now_ms;
-
-    test::RtpPacket packet;
-    if (!rtp_reader->NextPacket(&packet))
+    // Deliver the packets of all streams in the order they were recorded in.
+    ReplayStream* next = nullptr;
+    for (const auto& stream : streams) {
+      if (stream->has_packet &&
+          (!next || stream->packet.time_ms < next->packet.time_ms)) {
+        next = stream.get();
+      }
+    }
+    if (!next)
       break;
 
-    int64_t deliver_in_ms = replay_start_ms + packet.time_ms - now_ms;
-    if (deliver_in_ms > 0)
-      SleepMs(deliver_in_ms);
+    if (flags::Realtime()) {
+      int64_t deliver_in_ms =
+          replay_start_ms + next->packet.time_ms - rtc::TimeMillis();
+      if (deliver_in_ms > 0)
+        SleepMs(deliver_in_ms);
+    }
 
+    if (next->ssrc_offset > 0)
+      RewriteSsrc(next->ssrc_offset, &next->packet);
     ++num_packets;
-    switch (call->Receiver()->DeliverPacket(
-        webrtc::MediaType::VIDEO,
-        rtc::CopyOnWriteBuffer(packet.data, packet.length), PacketTime())) {
-      case PacketReceiver::DELIVERY_OK:
-        break;
-      case PacketReceiver::DELIVERY_UNKNOWN_SSRC: {
-        RTPHeader header;
-        std::unique_ptr<RtpHeaderParser> parser(RtpHeaderParser::Create());
-        parser->Parse(packet.data, packet.length, &header);
-        if (unknown_packets[header.ssrc] == 0)
-          fprintf(stderr, "Unknown SSRC: %u!\n", header.ssrc);
-        ++unknown_packets[header.ssrc];
-        break;
-      }
-      case PacketReceiver::DELIVERY_PACKET_ERROR: {
-        fprintf(stderr, "Packet error, corrupt packets or incorrect setup?\n");
-        RTPHeader header;
-        std::unique_ptr<RtpHeaderParser> parser(RtpHeaderParser::Create());
-        parser->Parse(packet.data, packet.length, &header);
-        fprintf(stderr, "Packet len=%zu pt=%u seq=%u ts=%u ssrc=0x%8x\n",
-                packet.length, header.payloadType, header.sequenceNumber,
-                header.timestamp, header.ssrc);
-        break;
-      }
-    }
+    DeliverPacket(call.get(), next->packet, &unknown_packets);
+    next->has_packet = next->rtp_reader->NextPacket(&next->packet);
   }
   fprintf(stderr, "num_packets: %d\n", num_packets);
 
@@ -346,9 +571,14 @@ void RtpReplay() {
             it->second);
   }
 
-  call->DestroyVideoReceiveStream(receive_stream);
+  int64_t replay_end_ms = WaitForDecodingToFinish(streams);
+  PrintReport(streams, replay_end_ms - replay_start_ms,
+              rtc::GetProcessCpuTimeNanos() - replay_start_cpu_ns);
 
-  delete decoder.decoder;
+  for (const auto& stream : streams) {
+    call->DestroyVideoReceiveStream(stream->receive_stream);
+    delete stream->decoder;
+  }
 }
 }  // namespace webrtc
 
@@ -375,6 +605,11 @@ int main(int argc, char* argv[]) {
   RTC_CHECK(
       ValidateRtpHeaderExtensionId(webrtc::flags::FLAG_transmission_offset_id));
   RTC_CHECK(ValidateInputFilenameNotEmpty(webrtc::flags::FLAG_input_file));
+  RTC_CHECK(ValidateNumStreams(webrtc::flags::FLAG_num_streams));
+  // The bitstream file has room for a single stream.
+  RTC_CHECK(webrtc::flags::DecoderBitstreamFilename().empty() ||
+            (webrtc::flags::InputFiles().size() == 1 &&
+             webrtc::flags::NumStreams() == 1));
 
   webrtc::test::RunTest(webrtc::RtpReplay);
   return 0;
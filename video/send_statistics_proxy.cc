@@ -28,6 +28,8 @@ const float kEncodeTimeWeigthFactor = 0.5f;
 const size_t kMaxEncodedFrameMapSize = 150;
 const int64_t kMaxEncodedFrameWindowMs = 800;
 const int64_t kBucketSizeMs = 100;
+// How often the packet path updates the UMA counters with the packet stats.
+const int64_t kPacketStatsUmaIntervalMs = 100;
 const size_t kBucketCount = 10;
 
 const char kVp8ForcedFallbackEncoderFieldTrial[] =
@@ -138,10 +140,19 @@ SendStatisticsProxy::SendStatisticsProxy(
       encoded_frame_rate_tracker_(kBucketSizeMs, kBucketCount),
       uma_container_(
           new UmaSamplesContainer(GetUmaPrefix(content_type_), stats_, clock)) {
+  for (uint32_t ssrc : rtp_config_.ssrcs)
+    packet_stats_[ssrc].reset(new PacketStats(ssrc, false, false));
+  for (uint32_t ssrc : rtp_config_.rtx.ssrcs)
+    packet_stats_[ssrc].reset(new PacketStats(ssrc, true, false));
+  if (rtp_config_.flexfec.payload_type != -1) {
+    uint32_t ssrc = rtp_config_.flexfec.ssrc;
+    packet_stats_[ssrc].reset(new PacketStats(ssrc, false, true));
+  }
 }
 
 SendStatisticsProxy::~SendStatisticsProxy() {
   rtc::CritScope lock(&crit_);
+  MergePacketStats();
   uma_container_->UpdateHistograms(rtp_config_, stats_);
 
   int64_t elapsed_sec = (clock_->TimeInMilliseconds() - start_ms_) / 1000;
@@ -642,6 +653,7 @@ void SendStatisticsProxy::OnEncoderReconfigured(
   rtc::CritScope lock(&crit_);
 
   if (content_type_ != config.content_type) {
+    MergePacketStats();
     uma_container_->UpdateHistograms(rtp_config_, stats_);
     uma_container_.reset(new UmaSamplesContainer(
         GetUmaPrefix(config.content_type), stats_, clock_));
@@ -700,6 +712,7 @@ void SendStatisticsProxy::OnSuspendChange(bool is_suspended) {
 
 VideoSendStream::Stats SendStatisticsProxy::GetStats() {
   rtc::CritScope lock(&crit_);
+  MergePacketStats();
   PurgeOldStats();
   stats_.input_frame_rate =
       round(uma_container_->input_frame_rate_tracker_.ComputeRate());
@@ -725,6 +738,101 @@ void SendStatisticsProxy::PurgeOldStats() {
   }
 }
 
+SendStatisticsProxy::PacketStats::PacketStats(uint32_t ssrc,
+                                              bool is_rtx,
+                                              bool is_flexfec)
+    : ssrc(ssrc),
+      is_rtx(is_rtx),
+      is_flexfec(is_flexfec),
+      reported(false),
+      bitrates(Bitrates{0, 0}),
+      delays(Delays{0, 0}),
+      delay_sum_ms(0),
+      max_delay_sum_ms(0),
+      num_delays(0),
+      next_uma_update_ms(-1),
+      uma_rtp_stats_version(0) {}
+
+SendStatisticsProxy::PacketStats::~PacketStats() {}
+
+SendStatisticsProxy::PacketStats* SendStatisticsProxy::GetPacketStats(
+    uint32_t ssrc) const {
+  auto it = packet_stats_.find(ssrc);
+  return it != packet_stats_.end() ? it->second.get() : nullptr;
+}
+
+void SendStatisticsProxy::MaybeUpdateUmaPacketStats(
+    PacketStats* packet_stats) {
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  if (now_ms < packet_stats->next_uma_update_ms.load(std::memory_order_relaxed))
+    return;
+  packet_stats->next_uma_update_ms.store(now_ms + kPacketStatsUmaIntervalMs,
+                                         std::memory_order_relaxed);
+  rtc::CritScope lock(&crit_);
+  UpdateUmaPacketStats(packet_stats);
+}
+
+void SendStatisticsProxy::UpdateUmaPacketStats(PacketStats* packet_stats) {
+  int64_t num_delays =
+      packet_stats->num_delays.exchange(0, std::memory_order_acquire);
+  if (num_delays > 0) {
+    uma_container_->delay_counter_.Add(
+        packet_stats->delay_sum_ms.exchange(0, std::memory_order_relaxed),
+        num_delays);
+    uma_container_->max_delay_counter_.Add(
+        packet_stats->max_delay_sum_ms.exchange(0, std::memory_order_relaxed),
+        num_delays);
+  }
+
+  uint32_t version = packet_stats->rtp_stats.Version();
+  if (version == packet_stats->uma_rtp_stats_version)
+    return;
+  packet_stats->uma_rtp_stats_version = version;
+  StreamDataCounters counters = packet_stats->rtp_stats.Load();
+  uint32_t ssrc = packet_stats->ssrc;
+
+  if (uma_container_->first_rtp_stats_time_ms_ == -1) {
+    int64_t now_ms = clock_->TimeInMilliseconds();
+    uma_container_->first_rtp_stats_time_ms_ = now_ms;
+    uma_container_->cpu_adapt_timer_.Restart(now_ms);
+    uma_container_->quality_adapt_timer_.Restart(now_ms);
+  }
+
+  uma_container_->total_byte_counter_.Set(counters.transmitted.TotalBytes(),
+                                          ssrc);
+  uma_container_->padding_byte_counter_.Set(counters.transmitted.padding_bytes,
+                                            ssrc);
+  uma_container_->retransmit_byte_counter_.Set(
+      counters.retransmitted.TotalBytes(), ssrc);
+  uma_container_->fec_byte_counter_.Set(counters.fec.TotalBytes(), ssrc);
+  if (packet_stats->is_rtx) {
+    uma_container_->rtx_byte_counter_.Set(counters.transmitted.TotalBytes(),
+                                          ssrc);
+  } else {
+    uma_container_->media_byte_counter_.Set(counters.MediaPayloadBytes(), ssrc);
+  }
+}
+
+void SendStatisticsProxy::MergePacketStats() {
+  for (const auto& it : packet_stats_) {
+    PacketStats* packet_stats = it.second.get();
+    if (!packet_stats->reported.load(std::memory_order_acquire))
+      continue;
+    UpdateUmaPacketStats(packet_stats);
+
+    VideoSendStream::StreamStats* stats = GetStatsEntry(packet_stats->ssrc);
+    RTC_DCHECK(stats);
+    if (!packet_stats->is_flexfec)
+      stats->rtp_stats = packet_stats->rtp_stats.Load();
+    Bitrates bitrates = packet_stats->bitrates.Load();
+    stats->total_bitrate_bps = bitrates.total_bps;
+    stats->retransmit_bitrate_bps = bitrates.retransmit_bps;
+    Delays delays = packet_stats->delays.Load();
+    stats->avg_delay_ms = delays.avg_ms;
+    stats->max_delay_ms = delays.max_ms;
+  }
+}
+
 VideoSendStream::StreamStats* SendStatisticsProxy::GetStatsEntry(
     uint32_t ssrc) {
   std::map<uint32_t, VideoSendStream::StreamStats>::iterator it =
@@ -758,6 +866,7 @@ void SendStatisticsProxy::OnInactiveSsrc(uint32_t ssrc) {
 
   stats->total_bitrate_bps = 0;
   stats->retransmit_bitrate_bps = 0;
+  GetPacketStats(ssrc)->bitrates.Store(Bitrates{0, 0});
   stats->height = 0;
   stats->width = 0;
 }
@@ -1102,49 +1211,30 @@ void SendStatisticsProxy::CNameChanged(const char* cname, uint32_t ssrc) {}
 void SendStatisticsProxy::DataCountersUpdated(
     const StreamDataCounters& counters,
     uint32_t ssrc) {
-  rtc::CritScope lock(&crit_);
-  VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
-  RTC_DCHECK(stats) << "DataCountersUpdated reported for unknown ssrc " << ssrc;
-
-  if (stats->is_flexfec) {
-    // The same counters are reported for both the media ssrc and flexfec ssrc.
-    // Bitrate stats are summed for all SSRCs. Use fec stats from media update.
+  PacketStats* packet_stats = GetPacketStats(ssrc);
+  RTC_DCHECK(packet_stats) << "DataCountersUpdated reported for unknown ssrc "
+                           << ssrc;
+  if (!packet_stats)
     return;
-  }
-
-  stats->rtp_stats = counters;
-  if (uma_container_->first_rtp_stats_time_ms_ == -1) {
-    int64_t now_ms = clock_->TimeInMilliseconds();
-    uma_container_->first_rtp_stats_time_ms_ = now_ms;
-    uma_container_->cpu_adapt_timer_.Restart(now_ms);
-    uma_container_->quality_adapt_timer_.Restart(now_ms);
-  }
 
-  uma_container_->total_byte_counter_.Set(counters.transmitted.TotalBytes(),
-                                          ssrc);
-  uma_container_->padding_byte_counter_.Set(counters.transmitted.padding_bytes,
-                                            ssrc);
-  uma_container_->retransmit_byte_counter_.Set(
-      counters.retransmitted.TotalBytes(), ssrc);
-  uma_container_->fec_byte_counter_.Set(counters.fec.TotalBytes(), ssrc);
-  if (stats->is_rtx) {
-    uma_container_->rtx_byte_counter_.Set(counters.transmitted.TotalBytes(),
-                                          ssrc);
-  } else {
-    uma_container_->media_byte_counter_.Set(counters.MediaPayloadBytes(), ssrc);
-  }
+  // The same counters are reported for both the media ssrc and flexfec ssrc.
+  // Bitrate stats are summed for all SSRCs. Use fec stats from media update.
+  if (!packet_stats->is_flexfec)
+    packet_stats->rtp_stats.Store(counters);
+  packet_stats->reported.store(true, std::memory_order_release);
+  if (!packet_stats->is_flexfec)
+    MaybeUpdateUmaPacketStats(packet_stats);
 }
 
 void SendStatisticsProxy::Notify(uint32_t total_bitrate_bps,
                                  uint32_t retransmit_bitrate_bps,
                                  uint32_t ssrc) {
-  rtc::CritScope lock(&crit_);
-  VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
-  if (!stats)
+  PacketStats* packet_stats = GetPacketStats(ssrc);
+  if (!packet_stats)
     return;
-
-  stats->total_bitrate_bps = total_bitrate_bps;
-  stats->retransmit_bitrate_bps = retransmit_bitrate_bps;
+  packet_stats->bitrates.Store(
+      Bitrates{total_bitrate_bps, retransmit_bitrate_bps});
+  packet_stats->reported.store(true, std::memory_order_release);
 }
 
 void SendStatisticsProxy::FrameCountUpdated(const FrameCounts& frame_counts,
@@ -1160,15 +1250,16 @@ void SendStatisticsProxy::FrameCountUpdated(const FrameCounts& frame_counts,
 void SendStatisticsProxy::SendSideDelayUpdated(int avg_delay_ms,
                                                int max_delay_ms,
                                                uint32_t ssrc) {
-  rtc::CritScope lock(&crit_);
-  VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
-  if (!stats)
+  PacketStats* packet_stats = GetPacketStats(ssrc);
+  if (!packet_stats)
     return;
-  stats->avg_delay_ms = avg_delay_ms;
-  stats->max_delay_ms = max_delay_ms;
-
-  uma_container_->delay_counter_.Add(avg_delay_ms);
-  uma_container_->max_delay_counter_.Add(max_delay_ms);
+  packet_stats->delays.Store(Delays{avg_delay_ms, max_delay_ms});
+  packet_stats->delay_sum_ms.fetch_add(avg_delay_ms, std::memory_order_relaxed);
+  packet_stats->max_delay_sum_ms.fetch_add(max_delay_ms,
+                                           std::memory_order_relaxed);
+  packet_stats->num_delays.fetch_add(1, std::memory_order_release);
+  packet_stats->reported.store(true, std::memory_order_release);
+  MaybeUpdateUmaPacketStats(packet_stats);
 }
 
 void SendStatisticsProxy::StatsTimer::Start(int64_t now_ms) {
@@ -1194,6 +1285,12 @@ void SendStatisticsProxy::SampleCounter::Add(int sample) {
   ++num_samples;
 }
 
+void SendStatisticsProxy::SampleCounter::Add(int64_t sample_sum,
+                                             int64_t count) {
+  sum += sample_sum;
+  num_samples += count;
+}
+
 int SendStatisticsProxy::SampleCounter::Avg(
     int64_t min_required_samples) const {
   if (num_samples < min_required_samples || num_samples == 0)
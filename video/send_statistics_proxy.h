@@ -11,6 +11,7 @@
 #ifndef VIDEO_SEND_STATISTICS_PROXY_H_
 #define VIDEO_SEND_STATISTICS_PROXY_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/numerics/exp_filter.h"
 #include "rtc_base/ratetracker.h"
+#include "rtc_base/synchronization/sequence_lock.h"
 #include "rtc_base/thread_annotations.h"
 #include "system_wrappers/include/clock.h"
 #include "video/overuse_frame_detector.h"
@@ -125,6 +127,7 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
     SampleCounter() : sum(0), num_samples(0) {}
     ~SampleCounter() {}
     void Add(int sample);
+    void Add(int64_t sample_sum, int64_t count);
     int Avg(int64_t min_required_samples) const;
 
    private:
@@ -212,6 +215,48 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
   };
   typedef std::map<uint32_t, Frame, TimestampOlderThan> EncodedFrameMap;
 
+  // Stats of one SSRC that are reported for every packet sent. They are
+  // written without taking |crit_|, so that the packet path does not contend
+  // with the encoder thread and with GetStats(), and are merged into |stats_|
+  // and the UMA counters when those are read, and at most every
+  // kPacketStatsUmaIntervalMs from the packet path.
+  struct Bitrates {
+    uint32_t total_bps;
+    uint32_t retransmit_bps;
+  };
+  struct Delays {
+    int avg_ms;
+    int max_ms;
+  };
+  struct PacketStats {
+    PacketStats(uint32_t ssrc, bool is_rtx, bool is_flexfec);
+    ~PacketStats();
+
+    const uint32_t ssrc;
+    const bool is_rtx;
+    const bool is_flexfec;
+    // Set once any stats have been reported for the SSRC, which is what adds
+    // it to |stats_.substreams|.
+    std::atomic<bool> reported;
+    rtc::SequenceLocked<StreamDataCounters> rtp_stats;
+    rtc::SequenceLocked<Bitrates> bitrates;
+    rtc::SequenceLocked<Delays> delays;
+    // Delays reported since the UMA counters were last updated.
+    std::atomic<int64_t> delay_sum_ms;
+    std::atomic<int64_t> max_delay_sum_ms;
+    std::atomic<int64_t> num_delays;
+    std::atomic<int64_t> next_uma_update_ms;
+    // Version of |rtp_stats| last given to the UMA counters. Guarded by
+    // |crit_|.
+    uint32_t uma_rtp_stats_version;
+  };
+
+  PacketStats* GetPacketStats(uint32_t ssrc) const;
+  void MaybeUpdateUmaPacketStats(PacketStats* packet_stats);
+  void UpdateUmaPacketStats(PacketStats* packet_stats)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void MergePacketStats() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   void PurgeOldStats() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
   VideoSendStream::StreamStats* GetStatsEntry(uint32_t ssrc)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
@@ -238,6 +283,8 @@ class SendStatisticsProxy : public CpuOveruseMetricsObserver,
   const RtpConfig rtp_config_;
   const absl::optional<int> fallback_max_pixels_;
   const absl::optional<int> fallback_max_pixels_disabled_;
+  // Created for all configured SSRCs on construction, then not modified.
+  std::map<uint32_t, std::unique_ptr<PacketStats>> packet_stats_;
   rtc::CriticalSection crit_;
   VideoEncoderConfig::ContentType content_type_ RTC_GUARDED_BY(crit_);
   const int64_t start_ms_;
@@ -12,7 +12,8 @@
 
 #include <algorithm>
 #include <limits>
-#include <map>
+#include <utility>
+#include <vector>
 
 #include "rtc_base/checks.h"
 #include "system_wrappers/include/clock.h"
@@ -85,17 +86,17 @@ class Samples {
   ~Samples() {}
 
   void Add(int sample, uint32_t stream_id) {
-    samples_[stream_id].Add(sample);
+    GetStats(stream_id)->Add(sample);
     ++total_count_;
   }
   void Set(int64_t sample, uint32_t stream_id) {
-    samples_[stream_id].Set(sample);
+    GetStats(stream_id)->Set(sample);
     ++total_count_;
   }
   void SetLast(int64_t sample, uint32_t stream_id) {
-    samples_[stream_id].SetLast(sample);
+    GetStats(stream_id)->SetLast(sample);
   }
-  int64_t GetLast(uint32_t stream_id) { return samples_[stream_id].GetLast(); }
+  int64_t GetLast(uint32_t stream_id) { return GetStats(stream_id)->GetLast(); }
 
   int64_t Count() const { return total_count_; }
   bool Empty() const { return total_count_ == 0; }
@@ -162,8 +163,20 @@ class Samples {
     int64_t last_sum_ = 0;
   };
 
+  // Counters are shared by a few SSRCs at most, few enough for a linear search
+  // to be cheaper than a map lookup.
+  Stats* GetStats(uint32_t stream_id) {
+    for (auto& it : samples_) {
+      if (it.first == stream_id)
+        return &it.second;
+    }
+    samples_.emplace_back(stream_id, Stats());
+    return &samples_.back().second;
+  }
+
   int64_t total_count_;
-  std::map<uint32_t, Stats> samples_;  // Gathered samples mapped by stream id.
+  // Gathered samples and the id of their stream.
+  std::vector<std::pair<uint32_t, Stats>> samples_;
 };
 
 // StatsCounter class.
@@ -101,6 +101,21 @@ CpuOveruseOptions GetCpuOveruseOptions(
   return options;
 }
 
+// Returns the priority of the stream in the process-wide encoder CPU budget.
+// Screenshares are served before cameras of the same priority, since text
+// quickly becomes unreadable at reduced resolution.
+absl::optional<double> GetCpuBudgetPriority(
+    const VideoEncoderConfig& encoder_config,
+    bool is_hardware_accelerated) {
+  if (is_hardware_accelerated)
+    return absl::nullopt;
+  const double kScreenshareFactor = 2.0;
+  return encoder_config.content_type ==
+                 VideoEncoderConfig::ContentType::kScreen
+             ? encoder_config.bitrate_priority * kScreenshareFactor
+             : encoder_config.bitrate_priority;
+}
+
 }  //  namespace
 
 // VideoSourceProxy is responsible ensuring thread safety between calls to
@@ -330,6 +345,7 @@ VideoStreamEncoder::VideoStreamEncoder(
       overuse_detector_(std::move(overuse_detector)),
       stats_proxy_(stats_proxy),
       pre_encode_callback_(pre_encode_callback),
+      encoder_is_hardware_accelerated_(false),
       max_framerate_(-1),
       pending_encoder_reconfiguration_(false),
       pending_encoder_creation_(false),
@@ -554,6 +570,7 @@ void VideoStreamEncoder::ReconfigureEncoder() {
         settings_.encoder_factory->QueryVideoEncoder(
             encoder_config_.video_format);
 
+    encoder_is_hardware_accelerated_ = info.is_hardware_accelerated;
     overuse_detector_->StopCheckForOveruse();
     overuse_detector_->StartCheckForOveruse(
         GetCpuOveruseOptions(settings_, info.is_hardware_accelerated), this);
@@ -589,6 +606,8 @@ void VideoStreamEncoder::ReconfigureEncoder() {
   int target_framerate = std::min(
       max_framerate_, source_proxy_->GetActiveSinkWants().max_framerate_fps);
   overuse_detector_->OnTargetFramerateUpdated(target_framerate);
+  overuse_detector_->SetCpuBudgetPriority(GetCpuBudgetPriority(
+      encoder_config_, encoder_is_hardware_accelerated_));
 
   ConfigureQualityScaler();
 }